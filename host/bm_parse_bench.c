@@ -0,0 +1,275 @@
+/**
+ * DayZ Server Tracker - BattleMetrics Parse Benchmark (host tool)
+ *
+ * Times battlemetrics_parse_response() over a corpus of response bodies and
+ * reports, per document: ns per parse, ns per byte, peak heap held by cJSON
+ * during the parse and the number of allocations. Heap is measured through
+ * cJSON_InitHooks(), so it is exactly what the parse costs on the device.
+ *
+ * The corpus in host/corpus/battlemetrics/ covers typical, mod-heavy,
+ * oversized (> HTTP_RESPONSE_BUFFER_SIZE, truncated by the device before
+ * parsing), truncated and malformed documents. Add captured responses
+ * (curl https://api.battlemetrics.com/servers/<id>) as new files; a
+ * replacement parser must be faster on the valid documents and give the
+ * same results on all of them.
+ *
+ * Build (host target, see host/CMakeLists.txt):
+ *   cmake -S host -B build-host -DCMAKE_BUILD_TYPE=Release
+ *   cmake --build build-host --target bm_parse_bench
+ *
+ * Usage:
+ *   ./build-host/bm_parse_bench [--min-ms N] [--out results.json] [FILE...]
+ *
+ * Without FILE arguments the bundled corpus is used. Output is JSON.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <dirent.h>
+#include "cJSON.h"
+#include "esp_log.h"
+#include "config.h"
+#include "battlemetrics.h"
+
+#ifndef BM_CORPUS_DIR
+#define BM_CORPUS_DIR   "host/corpus/battlemetrics"
+#endif
+
+#define BENCH_SCHEMA_VERSION    1
+#define MAX_FILES               256
+#define MIN_ITERATIONS          20
+
+// ============== HEAP ACCOUNTING ==============
+
+typedef struct {
+    size_t size;
+    size_t pad;     // Keep the user block 16-byte aligned
+} alloc_hdr_t;
+
+static size_t s_heap_cur = 0;
+static size_t s_heap_peak = 0;
+static unsigned long s_allocs = 0;
+
+static void *counting_malloc(size_t size) {
+    alloc_hdr_t *h = malloc(sizeof(alloc_hdr_t) + size);
+    if (!h) return NULL;
+    h->size = size;
+    s_heap_cur += size;
+    if (s_heap_cur > s_heap_peak) s_heap_peak = s_heap_cur;
+    s_allocs++;
+    return h + 1;
+}
+
+static void counting_free(void *ptr) {
+    if (!ptr) return;
+    alloc_hdr_t *h = (alloc_hdr_t *)ptr - 1;
+    s_heap_cur -= h->size;
+    free(h);
+}
+
+// ============== CORPUS ==============
+
+typedef struct {
+    char path[512];
+    char *data;
+    size_t len;
+} doc_t;
+
+static doc_t s_docs[MAX_FILES];
+static int s_doc_count = 0;
+
+static bool load_doc(const char *path) {
+    if (s_doc_count >= MAX_FILES) return false;
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return false;
+    }
+    fseek(f, 0, SEEK_END);
+    long len = ftell(f);
+    fseek(f, 0, SEEK_SET);
+
+    doc_t *d = &s_docs[s_doc_count];
+    d->data = malloc(len > 0 ? (size_t)len : 1);
+    d->len = len > 0 ? (size_t)len : 0;
+    if (!d->data || fread(d->data, 1, d->len, f) != d->len) {
+        fclose(f);
+        free(d->data);
+        fprintf(stderr, "cannot read %s\n", path);
+        return false;
+    }
+    fclose(f);
+    strncpy(d->path, path, sizeof(d->path) - 1);
+    s_doc_count++;
+    return true;
+}
+
+static int cmp_doc(const void *a, const void *b) {
+    return strcmp(((const doc_t *)a)->path, ((const doc_t *)b)->path);
+}
+
+static void load_corpus_dir(const char *dir_path) {
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        fprintf(stderr, "cannot open corpus directory %s\n", dir_path);
+        return;
+    }
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        size_t n = strlen(entry->d_name);
+        if (n > 5 && strcmp(entry->d_name + n - 5, ".json") == 0) {
+            char path[512];
+            snprintf(path, sizeof(path), "%s/%s", dir_path, entry->d_name);
+            load_doc(path);
+        }
+    }
+    closedir(dir);
+    qsort(s_docs, s_doc_count, sizeof(doc_t), cmp_doc);
+}
+
+// ============== BENCHMARK ==============
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static cJSON* bench_doc(const doc_t *d, int64_t min_ns) {
+    server_status_t status;
+    const char *error_msg = NULL;
+
+    // One counted run for heap figures and the result (relative to what
+    // the result tree already holds)
+    size_t base = s_heap_cur;
+    s_heap_peak = base;
+    s_allocs = 0;
+    esp_err_t err = battlemetrics_parse_response(d->data, d->len, &status, &error_msg);
+    size_t peak = s_heap_peak - base;
+    unsigned long allocs = s_allocs;
+    size_t leaked = s_heap_cur - base;
+
+    // Then repeat until min_ns has passed
+    long iters = 0;
+    int64_t t0 = now_ns();
+    int64_t elapsed = 0;
+    do {
+        for (int i = 0; i < MIN_ITERATIONS; i++) {
+            battlemetrics_parse_response(d->data, d->len, &status, NULL);
+        }
+        iters += MIN_ITERATIONS;
+        elapsed = now_ns() - t0;
+    } while (elapsed < min_ns);
+
+    double ns_per_parse = (double)elapsed / iters;
+    const char *name = strrchr(d->path, '/');
+
+    cJSON *obj = cJSON_CreateObject();
+    cJSON_AddStringToObject(obj, "file", name ? name + 1 : d->path);
+    cJSON_AddNumberToObject(obj, "bytes", (double)d->len);
+    cJSON_AddBoolToObject(obj, "exceeds_device_buffer", d->len >= HTTP_RESPONSE_BUFFER_SIZE);
+    cJSON_AddStringToObject(obj, "result", esp_err_to_name(err));
+    if (err != ESP_OK && error_msg) {
+        cJSON_AddStringToObject(obj, "error", error_msg);
+    } else {
+        cJSON_AddNumberToObject(obj, "players", status.players);
+    }
+    cJSON_AddNumberToObject(obj, "iterations", (double)iters);
+    cJSON_AddNumberToObject(obj, "ns_per_parse", round(ns_per_parse));
+    cJSON_AddNumberToObject(obj, "ns_per_byte",
+                            d->len > 0 ? round(ns_per_parse / d->len * 100) / 100 : 0);
+    cJSON_AddNumberToObject(obj, "peak_heap_bytes", (double)peak);
+    cJSON_AddNumberToObject(obj, "allocations", (double)allocs);
+    cJSON_AddNumberToObject(obj, "leaked_bytes", (double)leaked);
+    return obj;
+}
+
+static void usage(const char *argv0) {
+    fprintf(stderr, "usage: %s [--min-ms N] [--out FILE] [FILE...]\n"
+                    "  default corpus: %s\n", argv0, BM_CORPUS_DIR);
+}
+
+int main(int argc, char **argv) {
+    int min_ms = 50;
+    const char *out_path = NULL;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--min-ms") == 0 && i + 1 < argc) {
+            min_ms = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out_path = argv[++i];
+        } else if (argv[i][0] == '-') {
+            usage(argv[0]);
+            return 1;
+        } else if (!load_doc(argv[i])) {
+            return 1;
+        }
+    }
+    if (s_doc_count == 0) {
+        load_corpus_dir(BM_CORPUS_DIR);
+    }
+    if (s_doc_count == 0 || min_ms < 1) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    esp_log_level_set("*", ESP_LOG_NONE);
+
+    // Every cJSON allocation is counted, results included
+    cJSON_Hooks counting = { .malloc_fn = counting_malloc, .free_fn = counting_free };
+    cJSON_InitHooks(&counting);
+
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "tool", "bm_parse_bench");
+    cJSON_AddNumberToObject(root, "schema", BENCH_SCHEMA_VERSION);
+    cJSON_AddNumberToObject(root, "generated", (double)time(NULL));
+    cJSON_AddNumberToObject(root, "device_buffer_bytes", HTTP_RESPONSE_BUFFER_SIZE);
+    cJSON *docs = cJSON_AddArrayToObject(root, "documents");
+
+    double ok_ns = 0, ok_bytes = 0;
+    size_t ok_peak = 0;
+    int ok_docs = 0;
+    for (int i = 0; i < s_doc_count; i++) {
+        cJSON *res = bench_doc(&s_docs[i], (int64_t)min_ms * 1000000);
+
+        if (strcmp(cJSON_GetObjectItem(res, "result")->valuestring, "ESP_OK") == 0) {
+            ok_ns += cJSON_GetObjectItem(res, "ns_per_parse")->valuedouble;
+            ok_bytes += s_docs[i].len;
+            size_t peak = (size_t)cJSON_GetObjectItem(res, "peak_heap_bytes")->valuedouble;
+            if (peak > ok_peak) ok_peak = peak;
+            ok_docs++;
+        }
+        cJSON_AddItemToArray(docs, res);
+        free(s_docs[i].data);
+    }
+
+    // Valid documents only: malformed ones bail out early and would flatter the figure
+    cJSON *sum = cJSON_AddObjectToObject(root, "summary");
+    cJSON_AddNumberToObject(sum, "documents", s_doc_count);
+    cJSON_AddNumberToObject(sum, "parsed_ok", ok_docs);
+    cJSON_AddNumberToObject(sum, "ns_per_byte_ok",
+                            ok_bytes > 0 ? round(ok_ns / ok_bytes * 100) / 100 : 0);
+    cJSON_AddNumberToObject(sum, "max_peak_heap_bytes_ok", (double)ok_peak);
+
+    char *json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "cannot open %s\n", out_path);
+        cJSON_free(json);
+        return 1;
+    }
+    fprintf(out, "%s\n", json);
+    if (out != stdout) fclose(out);
+    cJSON_free(json);
+    return 0;
+}
@@ -0,0 +1,94 @@
+/**
+ * DayZ Server Tracker - Columnar Export Reader (host tool)
+ *
+ * Prints a .dzc file written by the device exporter (format in
+ * main/services/history_export.h) as CSV, the same columns the device
+ * would have written with format=csv, so PC scripts can take either.
+ *
+ * Build (host target, see host/CMakeLists.txt):
+ *   cmake -S host -B build-host -DCMAKE_BUILD_TYPE=Release
+ *   cmake --build build-host --target dzc_dump
+ *
+ * Usage:
+ *   ./build-host/dzc_dump [--info] FILE.dzc > out.csv
+ *
+ * --info prints the header and per-group time ranges instead of rows.
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <inttypes.h>
+#include "config.h"
+#include "services/history_export.h"
+
+static int32_t s_cols[EXPORT_DZC_MAX_COLUMNS][EXPORT_GROUP_ROWS];
+
+int main(int argc, char **argv) {
+    bool info = false;
+    const char *path = NULL;
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--info") == 0) {
+            info = true;
+        } else {
+            path = argv[i];
+        }
+    }
+    if (!path) {
+        fprintf(stderr, "usage: %s [--info] FILE.dzc\n", argv[0]);
+        return 2;
+    }
+
+    export_dzc_reader_t r;
+    esp_err_t err = export_dzc_open(&r, path);
+    if (err != ESP_OK) {
+        fprintf(stderr, "%s: %s\n", path, err == ESP_ERR_NOT_FOUND ? "cannot open" : "not a DZC file");
+        return 1;
+    }
+
+    const export_dzc_header_t *h = &r.header;
+    bool rolled = h->columns == EXPORT_DZC_MAX_COLUMNS;
+    if (info) {
+        printf("server %u (%.*s), %" PRIu32 "..%" PRIu32 ", step %" PRIu32 " s, %u columns\n",
+               h->server_index, EXPORT_ID_LEN, h->server_id, h->start_time, h->end_time,
+               h->step_sec, h->columns);
+    } else {
+        printf(rolled ? "time,avg,min,max,samples\n" : "time,players\n");
+    }
+
+    int32_t *cols[EXPORT_DZC_MAX_COLUMNS];
+    for (int c = 0; c < EXPORT_DZC_MAX_COLUMNS; c++) {
+        cols[c] = s_cols[c];
+    }
+
+    export_dzc_group_t group;
+    uint32_t rows = 0;
+    int groups = 0;
+    int n;
+    while ((n = export_dzc_next(&r, &group, cols)) > 0) {
+        rows += n;
+        groups++;
+        if (info) {
+            printf("group %d: %d rows, %" PRIu32 "..%" PRIu32 ", %" PRIu32 " bytes\n",
+                   groups, n, group.first_ts, group.last_ts, group.bytes);
+            continue;
+        }
+        for (int i = 0; i < n; i++) {
+            printf("%" PRIu32 ",%" PRId32, (uint32_t)cols[EXPORT_COL_TIME][i], cols[EXPORT_COL_PLAYERS][i]);
+            if (rolled) {
+                printf(",%" PRId32 ",%" PRId32 ",%" PRId32, cols[EXPORT_COL_MIN][i],
+                       cols[EXPORT_COL_MAX][i], cols[EXPORT_COL_SAMPLES][i]);
+            }
+            printf("\n");
+        }
+    }
+    export_dzc_close(&r);
+
+    if (n < 0) {
+        fprintf(stderr, "%s: truncated or corrupt after %" PRIu32 " rows\n", path, rows);
+        return 1;
+    }
+    if (info) {
+        printf("%d groups, %" PRIu32 " rows\n", groups, rows);
+    }
+    return 0;
+}
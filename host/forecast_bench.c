@@ -0,0 +1,182 @@
+/**
+ * DayZ Server Tracker - Forecast Accuracy Benchmark (host tool)
+ *
+ * Replays SD card history files (history/server_X/YYYY-MM-DD.jsonl with
+ * {"t":ts,"p":players} lines) through forecast_model and reports the error of
+ * the 1h / 3h forecasts against two baselines:
+ *   - persistence:     "same as now"
+ *   - seasonal naive:  "same as one week earlier"
+ *
+ * Build (host target, see host/CMakeLists.txt):
+ *   cmake -S host -B build-host && cmake --build build-host --target forecast_bench
+ *
+ * Usage:
+ *   ./build-host/forecast_bench /sdcard/history/server_0/20??-*.jsonl
+ *
+ * Uses local time for day/hour buckets, so run with the device timezone
+ * (e.g. TZ="CET-1CEST,M3.5.0,M10.5.0/3" ./forecast_bench ...).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "forecast_model.h"
+
+#define MATCH_WINDOW_SEC    300     // Actual sample must be within +-5 min
+#define WEEK_SEC            (7 * 24 * 3600)
+
+typedef struct {
+    uint32_t t;
+    int p;
+} sample_t;
+
+typedef struct {
+    const char *name;
+    double abs_sum;
+    double sq_sum;
+    int n;
+} err_acc_t;
+
+static sample_t *s_samples = NULL;
+static size_t s_count = 0;
+static size_t s_cap = 0;
+
+static void add_sample(uint32_t t, int p) {
+    if (s_count == s_cap) {
+        s_cap = s_cap ? s_cap * 2 : 4096;
+        s_samples = realloc(s_samples, s_cap * sizeof(sample_t));
+        if (!s_samples) {
+            fprintf(stderr, "out of memory\n");
+            exit(1);
+        }
+    }
+    s_samples[s_count].t = t;
+    s_samples[s_count].p = p;
+    s_count++;
+}
+
+static int load_file(const char *path) {
+    FILE *f = fopen(path, "r");
+    if (!f) {
+        fprintf(stderr, "cannot open %s\n", path);
+        return 0;
+    }
+
+    char line[128];
+    int loaded = 0;
+    while (fgets(line, sizeof(line), f)) {
+        unsigned long t;
+        int p;
+        // Header lines ({"v":..}) don't match and are skipped
+        if (sscanf(line, "{\"t\":%lu,\"p\":%d}", &t, &p) == 2 && p >= 0) {
+            add_sample((uint32_t)t, p);
+            loaded++;
+        }
+    }
+    fclose(f);
+    return loaded;
+}
+
+static int cmp_sample(const void *a, const void *b) {
+    uint32_t ta = ((const sample_t *)a)->t;
+    uint32_t tb = ((const sample_t *)b)->t;
+    return (ta > tb) - (ta < tb);
+}
+
+/**
+ * Find the sample nearest to ts (within MATCH_WINDOW_SEC)
+ * @return Player count, or -1 if no sample is close enough
+ */
+static int actual_at(uint32_t ts) {
+    size_t lo = 0, hi = s_count;
+    while (lo < hi) {
+        size_t mid = (lo + hi) / 2;
+        if (s_samples[mid].t < ts) lo = mid + 1;
+        else hi = mid;
+    }
+
+    int best = -1;
+    uint32_t best_d = MATCH_WINDOW_SEC + 1;
+    for (size_t i = (lo > 0 ? lo - 1 : 0); i < s_count && i <= lo; i++) {
+        uint32_t d = s_samples[i].t > ts ? s_samples[i].t - ts : ts - s_samples[i].t;
+        if (d < best_d) {
+            best_d = d;
+            best = s_samples[i].p;
+        }
+    }
+    return best;
+}
+
+static void acc_add(err_acc_t *a, double predicted, int actual) {
+    double e = predicted - actual;
+    a->abs_sum += fabs(e);
+    a->sq_sum += e * e;
+    a->n++;
+}
+
+static void acc_print(const err_acc_t *a) {
+    if (a->n == 0) {
+        printf("  %-16s  (no samples)\n", a->name);
+        return;
+    }
+    printf("  %-16s  MAE %6.2f  RMSE %6.2f  (n=%d)\n",
+           a->name, a->abs_sum / a->n, sqrt(a->sq_sum / a->n), a->n);
+}
+
+static void run_horizon(uint32_t horizon) {
+    static forecast_model_t model;
+    forecast_model_reset(&model);
+
+    err_acc_t acc_model = { .name = "forecast" };
+    err_acc_t acc_persist = { .name = "persistence" };
+    err_acc_t acc_naive = { .name = "seasonal naive" };
+
+    for (size_t i = 0; i < s_count; i++) {
+        const sample_t *s = &s_samples[i];
+        forecast_model_update(&model, s->t, s->p);
+
+        if (!forecast_model_ready(&model)) continue;
+
+        int actual = actual_at(s->t + horizon);
+        if (actual < 0) continue;
+
+        // Only score where all three methods have an answer
+        int week_ago = actual_at(s->t + horizon - WEEK_SEC);
+        if (week_ago < 0) continue;
+
+        acc_add(&acc_model, forecast_model_predict(&model, s->t, horizon), actual);
+        acc_add(&acc_persist, s->p, actual);
+        acc_add(&acc_naive, week_ago, actual);
+    }
+
+    printf("Horizon %luh:\n", (unsigned long)(horizon / 3600));
+    acc_print(&acc_model);
+    acc_print(&acc_persist);
+    acc_print(&acc_naive);
+}
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        fprintf(stderr, "usage: %s history/server_X/*.jsonl...\n", argv[0]);
+        return 1;
+    }
+
+    for (int i = 1; i < argc; i++) {
+        load_file(argv[i]);
+    }
+    if (s_count == 0) {
+        fprintf(stderr, "no samples loaded\n");
+        return 1;
+    }
+
+    qsort(s_samples, s_count, sizeof(sample_t), cmp_sample);
+    printf("Loaded %zu samples spanning %.1f days\n\n", s_count,
+           (s_samples[s_count - 1].t - s_samples[0].t) / 86400.0);
+
+    run_horizon(3600);
+    run_horizon(3 * 3600);
+
+    free(s_samples);
+    return 0;
+}
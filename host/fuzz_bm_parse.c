@@ -0,0 +1,92 @@
+/**
+ * DayZ Server Tracker - BattleMetrics Parse Fuzz Harness (host tool)
+ *
+ * Feeds arbitrary bytes to battlemetrics_parse_response(), the code that
+ * handles the untrusted HTTP body on every poll, and checks the invariants
+ * the UI relies on (all strings NUL terminated within their fields, player
+ * counts in range).
+ *
+ * libFuzzer build (clang, ASan + UBSan):
+ *   CC=clang cmake -S host -B build-fuzz -DHOST_FUZZ=ON
+ *   cmake --build build-fuzz --target fuzz_bm_parse
+ *   mkdir -p fuzz-work && cp host/corpus/battlemetrics/*.json fuzz-work/
+ *   ./build-fuzz/fuzz_bm_parse -dict=host/corpus/battlemetrics.dict \
+ *       -max_len=16384 fuzz-work
+ *
+ * Without HOST_FUZZ the same file builds a replayer that runs each file
+ * given on the command line once (use for crash reproducers / CI with
+ * -DCMAKE_C_FLAGS=-fsanitize=address,undefined).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include "esp_log.h"
+#include "battlemetrics.h"
+
+static void check_terminated(const char *field, size_t size) {
+    if (memchr(field, '\0', size) == NULL) {
+        abort();
+    }
+}
+
+int LLVMFuzzerInitialize(int *argc, char ***argv) {
+    (void)argc;
+    (void)argv;
+    esp_log_level_set("*", ESP_LOG_NONE);
+    return 0;
+}
+
+int LLVMFuzzerTestOneInput(const uint8_t *data, size_t size) {
+    server_status_t status;
+    const char *error_msg = NULL;
+
+    esp_err_t err = battlemetrics_parse_response((const char *)data, size, &status, &error_msg);
+    if (err != ESP_OK && !error_msg) {
+        abort();
+    }
+
+    check_terminated(status.server_time, sizeof(status.server_time));
+    check_terminated(status.ip_address, sizeof(status.ip_address));
+    check_terminated(status.server_name, sizeof(status.server_name));
+    check_terminated(status.map_name, sizeof(status.map_name));
+
+    // -1 = unknown; anything else must be a real count
+    if (status.players < -1 || status.max_players < 0) {
+        abort();
+    }
+    return 0;
+}
+
+#ifndef HOST_FUZZ_LIBFUZZER
+int main(int argc, char **argv) {
+    LLVMFuzzerInitialize(&argc, &argv);
+
+    int ran = 0;
+    for (int i = 1; i < argc; i++) {
+        FILE *f = fopen(argv[i], "rb");
+        if (!f) {
+            fprintf(stderr, "cannot open %s\n", argv[i]);
+            return 1;
+        }
+        fseek(f, 0, SEEK_END);
+        long len = ftell(f);
+        fseek(f, 0, SEEK_SET);
+
+        // Exact-size heap copy so ASan catches reads past the end
+        uint8_t *buf = malloc(len > 0 ? (size_t)len : 1);
+        if (!buf || fread(buf, 1, (size_t)len, f) != (size_t)len) {
+            fprintf(stderr, "cannot read %s\n", argv[i]);
+            return 1;
+        }
+        fclose(f);
+
+        LLVMFuzzerTestOneInput(buf, (size_t)len);
+        free(buf);
+        ran++;
+    }
+    printf("Executed %d inputs\n", ran);
+    return 0;
+}
+#endif
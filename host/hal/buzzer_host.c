@@ -0,0 +1,35 @@
+/**
+ * DayZ Server Tracker - Host HAL: buzzer (logs patterns instead of playing)
+ */
+
+#include "drivers/buzzer.h"
+#include "esp_log.h"
+
+static const char *TAG = "buzzer_host";
+
+void buzzer_init(void) {
+}
+
+bool buzzer_is_ready(void) {
+    return true;
+}
+
+bool buzzer_play(buzzer_pattern_t pattern) {
+    ESP_LOGD(TAG, "Pattern %d", (int)pattern);
+    return true;
+}
+
+void buzzer_stop(void) {
+}
+
+void buzzer_alert_restart(void) {
+    buzzer_play(BUZZER_PATTERN_RESTART);
+}
+
+void buzzer_alert_threshold(void) {
+    buzzer_play(BUZZER_PATTERN_THRESHOLD);
+}
+
+void buzzer_test(void) {
+    buzzer_play(BUZZER_PATTERN_TEST);
+}
@@ -0,0 +1,159 @@
+/**
+ * DayZ Server Tracker - Host HAL: logging, clock, heap and error names
+ */
+
+#include "esp_err.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "esp_crt_bundle.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "host_hal.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include <pthread.h>
+#include <sys/random.h>
+
+static pthread_once_t s_once = PTHREAD_ONCE_INIT;
+static struct timespec s_start;
+static esp_log_level_t s_log_level = ESP_LOG_INFO;
+static pthread_mutex_t s_log_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_mutex_t s_critical;
+
+// Virtual clock (host_hal_set_clock)
+static volatile bool s_clock_set = false;
+static volatile int64_t s_clock_us = 0;         // Current virtual Unix time
+static int64_t s_clock_base_us = 0;             // First virtual time set
+static volatile int64_t s_uptime_skew_us = 0;   // Added to real uptime
+
+static void host_once_init(void) {
+    clock_gettime(CLOCK_MONOTONIC, &s_start);
+
+    const char *lvl = getenv("HOST_LOG_LEVEL");
+    if (lvl && *lvl >= '0' && *lvl <= '5') {
+        s_log_level = (esp_log_level_t)(*lvl - '0');
+    }
+
+    pthread_mutexattr_t attr;
+    pthread_mutexattr_init(&attr);
+    pthread_mutexattr_settype(&attr, PTHREAD_MUTEX_RECURSIVE);
+    pthread_mutex_init(&s_critical, &attr);
+    pthread_mutexattr_destroy(&attr);
+}
+
+static int64_t real_uptime_us(void) {
+    pthread_once(&s_once, host_once_init);
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (int64_t)(now.tv_sec - s_start.tv_sec) * 1000000 +
+           (now.tv_nsec - s_start.tv_nsec) / 1000;
+}
+
+int64_t esp_timer_get_time(void) {
+    return real_uptime_us() + s_uptime_skew_us;
+}
+
+void host_hal_set_clock(int64_t epoch_us) {
+    if (!s_clock_set) {
+        s_clock_base_us = epoch_us;
+        s_clock_set = true;
+    }
+    s_clock_us = epoch_us;
+
+    // Uptime never runs backwards, and never lags the virtual clock
+    int64_t behind = (epoch_us - s_clock_base_us) - real_uptime_us();
+    if (behind > s_uptime_skew_us) s_uptime_skew_us = behind;
+}
+
+// Linked with -Wl,--wrap=time: every time() in the program lands here
+time_t __real_time(time_t *t);
+
+time_t __wrap_time(time_t *t) {
+    if (!s_clock_set) return __real_time(t);
+    time_t now = (time_t)(s_clock_us / 1000000);
+    if (t) *t = now;
+    return now;
+}
+
+uint32_t esp_log_timestamp(void) {
+    return (uint32_t)(esp_timer_get_time() / 1000);
+}
+
+void esp_log_level_set(const char *tag, esp_log_level_t level) {
+    (void)tag;  // Global level only
+    pthread_once(&s_once, host_once_init);
+    s_log_level = level;
+}
+
+void host_log_write(esp_log_level_t level, const char *tag, const char *fmt, ...) {
+    pthread_once(&s_once, host_once_init);
+    if (level > s_log_level) return;
+
+    static const char letters[] = "NEWIDV";
+    va_list ap;
+    va_start(ap, fmt);
+    pthread_mutex_lock(&s_log_lock);
+    fprintf(stderr, "%c (%u) %s: ", letters[level], (unsigned)esp_log_timestamp(), tag);
+    vfprintf(stderr, fmt, ap);
+    fputc('\n', stderr);
+    pthread_mutex_unlock(&s_log_lock);
+    va_end(ap);
+}
+
+void host_critical_enter(void) {
+    pthread_once(&s_once, host_once_init);
+    pthread_mutex_lock(&s_critical);
+}
+
+void host_critical_exit(void) {
+    pthread_mutex_unlock(&s_critical);
+}
+
+size_t heap_caps_get_free_size(unsigned caps) {
+    (void)caps;
+    return 8 * 1024 * 1024;
+}
+
+size_t heap_caps_get_largest_free_block(unsigned caps) {
+    return heap_caps_get_free_size(caps);
+}
+
+size_t heap_caps_get_minimum_free_size(unsigned caps) {
+    return heap_caps_get_free_size(caps);
+}
+
+uint32_t esp_random(void) {
+    uint32_t r = 0;
+    if (getrandom(&r, sizeof(r), 0) != sizeof(r)) {
+        r = (uint32_t)rand() ^ (uint32_t)real_uptime_us();
+    }
+    return r;
+}
+
+esp_err_t esp_crt_bundle_attach(void *conf) {
+    (void)conf;
+    return ESP_OK;
+}
+
+const char* esp_err_to_name(esp_err_t code) {
+    switch (code) {
+        case ESP_OK:                        return "ESP_OK";
+        case ESP_FAIL:                      return "ESP_FAIL";
+        case ESP_ERR_NO_MEM:                return "ESP_ERR_NO_MEM";
+        case ESP_ERR_INVALID_ARG:           return "ESP_ERR_INVALID_ARG";
+        case ESP_ERR_INVALID_STATE:         return "ESP_ERR_INVALID_STATE";
+        case ESP_ERR_INVALID_SIZE:          return "ESP_ERR_INVALID_SIZE";
+        case ESP_ERR_NOT_FOUND:             return "ESP_ERR_NOT_FOUND";
+        case ESP_ERR_NOT_SUPPORTED:         return "ESP_ERR_NOT_SUPPORTED";
+        case ESP_ERR_TIMEOUT:               return "ESP_ERR_TIMEOUT";
+        case ESP_ERR_INVALID_RESPONSE:      return "ESP_ERR_INVALID_RESPONSE";
+        case ESP_ERR_NVS_NOT_INITIALIZED:   return "ESP_ERR_NVS_NOT_INITIALIZED";
+        case ESP_ERR_NVS_NOT_FOUND:         return "ESP_ERR_NVS_NOT_FOUND";
+        case ESP_ERR_NVS_INVALID_LENGTH:    return "ESP_ERR_NVS_INVALID_LENGTH";
+        case ESP_ERR_HTTP_CONNECT:          return "ESP_ERR_HTTP_CONNECT";
+        default:                            return "UNKNOWN_ERROR";
+    }
+}
@@ -0,0 +1,401 @@
+/**
+ * DayZ Server Tracker - Host HAL: FreeRTOS primitives on pthreads
+ *
+ * Timeouts are in ticks (1 tick = 1 ms), portMAX_DELAY waits forever.
+ */
+
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
+#include "esp_timer.h"
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static void deadline_from_ticks(TickType_t ticks, struct timespec *ts) {
+    clock_gettime(CLOCK_REALTIME, ts);
+    ts->tv_sec += ticks / 1000;
+    ts->tv_nsec += (long)(ticks % 1000) * 1000000L;
+    if (ts->tv_nsec >= 1000000000L) {
+        ts->tv_sec++;
+        ts->tv_nsec -= 1000000000L;
+    }
+}
+
+/**
+ * Wait on cond until pred() holds or the tick timeout expires (lock held)
+ * @return true if pred() holds
+ */
+static bool cond_wait_ticks(pthread_cond_t *cond, pthread_mutex_t *lock, TickType_t ticks,
+                            bool (*pred)(void *), void *arg) {
+    if (pred(arg)) return true;
+    if (ticks == 0) return false;
+
+    struct timespec deadline;
+    if (ticks != portMAX_DELAY) deadline_from_ticks(ticks, &deadline);
+
+    while (!pred(arg)) {
+        int rc = (ticks == portMAX_DELAY) ? pthread_cond_wait(cond, lock)
+                                          : pthread_cond_timedwait(cond, lock, &deadline);
+        if (rc == ETIMEDOUT) return pred(arg);
+    }
+    return true;
+}
+
+// ============== SEMAPHORES ==============
+
+// Counting semaphore; a mutex is one with max 1 starting available
+struct host_semaphore {
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    unsigned count;
+    unsigned max;
+    bool recursive;
+    pthread_t owner;
+    unsigned depth;
+};
+
+static SemaphoreHandle_t sem_create(unsigned initial, unsigned max, bool recursive) {
+    SemaphoreHandle_t sem = calloc(1, sizeof(*sem));
+    if (!sem) return NULL;
+    pthread_mutex_init(&sem->lock, NULL);
+    pthread_cond_init(&sem->cond, NULL);
+    sem->count = initial;
+    sem->max = max;
+    sem->recursive = recursive;
+    return sem;
+}
+
+SemaphoreHandle_t xSemaphoreCreateMutex(void) {
+    return sem_create(1, 1, false);
+}
+
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) {
+    return sem_create(1, 1, true);
+}
+
+SemaphoreHandle_t xSemaphoreCreateBinary(void) {
+    return sem_create(0, 1, false);
+}
+
+static bool sem_available(void *arg) {
+    return ((SemaphoreHandle_t)arg)->count > 0;
+}
+
+BaseType_t xSemaphoreTake(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (!sem) return pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    bool ok = cond_wait_ticks(&sem->cond, &sem->lock, ticks, sem_available, sem);
+    if (ok) {
+        sem->count--;
+        sem->owner = pthread_self();
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGive(SemaphoreHandle_t sem) {
+    if (!sem) return pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    bool ok = sem->count < sem->max;
+    if (ok) {
+        sem->count++;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t sem, TickType_t ticks) {
+    if (!sem) return pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    if (sem->depth > 0 && pthread_equal(sem->owner, pthread_self())) {
+        sem->depth++;
+        pthread_mutex_unlock(&sem->lock);
+        return pdTRUE;
+    }
+    bool ok = cond_wait_ticks(&sem->cond, &sem->lock, ticks, sem_available, sem);
+    if (ok) {
+        sem->count--;
+        sem->owner = pthread_self();
+        sem->depth = 1;
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t sem) {
+    if (!sem) return pdFALSE;
+
+    pthread_mutex_lock(&sem->lock);
+    bool ok = sem->depth > 0 && pthread_equal(sem->owner, pthread_self());
+    if (ok && --sem->depth == 0) {
+        sem->count++;
+        pthread_cond_signal(&sem->cond);
+    }
+    pthread_mutex_unlock(&sem->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+void vSemaphoreDelete(SemaphoreHandle_t sem) {
+    if (!sem) return;
+    pthread_mutex_destroy(&sem->lock);
+    pthread_cond_destroy(&sem->cond);
+    free(sem);
+}
+
+// ============== QUEUES ==============
+
+struct host_queue {
+    pthread_mutex_t lock;
+    pthread_cond_t not_empty;
+    pthread_cond_t not_full;
+    uint8_t *buf;
+    UBaseType_t length;
+    UBaseType_t item_size;
+    UBaseType_t head;
+    UBaseType_t count;
+};
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size) {
+    if (length == 0 || item_size == 0) return NULL;
+
+    QueueHandle_t q = calloc(1, sizeof(*q));
+    if (!q) return NULL;
+    q->buf = malloc((size_t)length * item_size);
+    if (!q->buf) {
+        free(q);
+        return NULL;
+    }
+    pthread_mutex_init(&q->lock, NULL);
+    pthread_cond_init(&q->not_empty, NULL);
+    pthread_cond_init(&q->not_full, NULL);
+    q->length = length;
+    q->item_size = item_size;
+    return q;
+}
+
+static bool queue_has_space(void *arg) {
+    QueueHandle_t q = arg;
+    return q->count < q->length;
+}
+
+static bool queue_has_items(void *arg) {
+    return ((QueueHandle_t)arg)->count > 0;
+}
+
+static BaseType_t queue_send(QueueHandle_t q, const void *item, TickType_t ticks, bool front) {
+    if (!q || !item) return pdFALSE;
+
+    pthread_mutex_lock(&q->lock);
+    bool ok = cond_wait_ticks(&q->not_full, &q->lock, ticks, queue_has_space, q);
+    if (ok) {
+        UBaseType_t slot;
+        if (front) {
+            q->head = (q->head + q->length - 1) % q->length;
+            slot = q->head;
+        } else {
+            slot = (q->head + q->count) % q->length;
+        }
+        memcpy(q->buf + (size_t)slot * q->item_size, item, q->item_size);
+        q->count++;
+        pthread_cond_signal(&q->not_empty);
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks) {
+    return queue_send(q, item, ticks, false);
+}
+
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks) {
+    return queue_send(q, item, ticks, true);
+}
+
+static BaseType_t queue_read(QueueHandle_t q, void *item, TickType_t ticks, bool remove) {
+    if (!q || !item) return pdFALSE;
+
+    pthread_mutex_lock(&q->lock);
+    bool ok = cond_wait_ticks(&q->not_empty, &q->lock, ticks, queue_has_items, q);
+    if (ok) {
+        memcpy(item, q->buf + (size_t)q->head * q->item_size, q->item_size);
+        if (remove) {
+            q->head = (q->head + 1) % q->length;
+            q->count--;
+            pthread_cond_signal(&q->not_full);
+        }
+    }
+    pthread_mutex_unlock(&q->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
+
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks) {
+    return queue_read(q, item, ticks, true);
+}
+
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticks) {
+    return queue_read(q, item, ticks, false);
+}
+
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q) {
+    if (!q) return 0;
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q) {
+    if (!q) return 0;
+    pthread_mutex_lock(&q->lock);
+    UBaseType_t n = q->length - q->count;
+    pthread_mutex_unlock(&q->lock);
+    return n;
+}
+
+BaseType_t xQueueReset(QueueHandle_t q) {
+    if (!q) return pdFALSE;
+    pthread_mutex_lock(&q->lock);
+    q->head = 0;
+    q->count = 0;
+    pthread_cond_broadcast(&q->not_full);
+    pthread_mutex_unlock(&q->lock);
+    return pdTRUE;
+}
+
+void vQueueDelete(QueueHandle_t q) {
+    if (!q) return;
+    pthread_mutex_destroy(&q->lock);
+    pthread_cond_destroy(&q->not_empty);
+    pthread_cond_destroy(&q->not_full);
+    free(q->buf);
+    free(q);
+}
+
+// ============== TASKS ==============
+
+struct host_task {
+    pthread_t thread;
+    TaskFunction_t fn;
+    void *arg;
+    char name[16];
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    uint32_t notify_value;
+    bool notify_pending;
+};
+
+static __thread TaskHandle_t t_self = NULL;
+
+static void *task_trampoline(void *p) {
+    TaskHandle_t task = p;
+    t_self = task;
+    task->fn(task->arg);
+    return NULL;
+}
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out) {
+    (void)stack_depth;
+    (void)priority;
+
+    TaskHandle_t task = calloc(1, sizeof(*task));
+    if (!task) return pdFAIL;
+    task->fn = fn;
+    task->arg = arg;
+    strncpy(task->name, name ? name : "task", sizeof(task->name) - 1);
+    pthread_mutex_init(&task->lock, NULL);
+    pthread_cond_init(&task->cond, NULL);
+
+    if (pthread_create(&task->thread, NULL, task_trampoline, task) != 0) {
+        free(task);
+        return pdFAIL;
+    }
+    pthread_detach(task->thread);
+    if (out) *out = task;
+    return pdPASS;
+}
+
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *out,
+                                   BaseType_t core) {
+    (void)core;
+    return xTaskCreate(fn, name, stack_depth, arg, priority, out);
+}
+
+void vTaskDelete(TaskHandle_t task) {
+    // Only self-deletion is supported (the pattern used by the services)
+    if (task == NULL || task == t_self) {
+        pthread_exit(NULL);
+    }
+}
+
+void vTaskDelay(TickType_t ticks) {
+    struct timespec ts = {
+        .tv_sec = ticks / 1000,
+        .tv_nsec = (long)(ticks % 1000) * 1000000L,
+    };
+    while (nanosleep(&ts, &ts) != 0 && errno == EINTR) {
+    }
+}
+
+TickType_t xTaskGetTickCount(void) {
+    return (TickType_t)(esp_timer_get_time() / 1000);
+}
+
+TaskHandle_t xTaskGetCurrentTaskHandle(void) {
+    return t_self;
+}
+
+const char* pcTaskGetName(TaskHandle_t task) {
+    if (!task) task = t_self;
+    return task ? task->name : "main";
+}
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action) {
+    if (!task) return pdFAIL;
+
+    BaseType_t ret = pdPASS;
+    pthread_mutex_lock(&task->lock);
+    switch (action) {
+        case eSetBits:                  task->notify_value |= value; break;
+        case eIncrement:                task->notify_value++; break;
+        case eSetValueWithOverwrite:    task->notify_value = value; break;
+        case eSetValueWithoutOverwrite:
+            if (task->notify_pending) ret = pdFAIL;
+            else task->notify_value = value;
+            break;
+        default:                        break;
+    }
+    task->notify_pending = true;
+    pthread_cond_signal(&task->cond);
+    pthread_mutex_unlock(&task->lock);
+    return ret;
+}
+
+static bool notify_pending(void *arg) {
+    return ((TaskHandle_t)arg)->notify_pending;
+}
+
+BaseType_t xTaskNotifyWait(unsigned long clear_on_entry, unsigned long clear_on_exit,
+                           uint32_t *value, TickType_t ticks) {
+    TaskHandle_t task = t_self;
+    if (!task) return pdFALSE;
+
+    pthread_mutex_lock(&task->lock);
+    if (!task->notify_pending) task->notify_value &= ~(uint32_t)clear_on_entry;
+    bool ok = cond_wait_ticks(&task->cond, &task->lock, ticks, notify_pending, task);
+    if (value) *value = task->notify_value;
+    if (ok) {
+        task->notify_value &= ~(uint32_t)clear_on_exit;
+        task->notify_pending = false;
+    }
+    pthread_mutex_unlock(&task->lock);
+    return ok ? pdTRUE : pdFALSE;
+}
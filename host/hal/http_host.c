@@ -0,0 +1,168 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp_http_client over a pluggable transport
+ */
+
+#include "esp_http_client.h"
+#include "host_hal.h"
+#include "esp_log.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "http_host";
+
+struct esp_http_client {
+    char *url;
+    int timeout_ms;
+    http_event_handle_cb handler;
+    void *user_data;
+    int status_code;
+    int64_t content_length;
+};
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static host_http_transport_t s_transport = NULL;
+static void *s_transport_ctx = NULL;
+
+void host_hal_set_http_transport(host_http_transport_t transport, void *ctx) {
+    pthread_mutex_lock(&s_lock);
+    s_transport = transport;
+    s_transport_ctx = ctx;
+    pthread_mutex_unlock(&s_lock);
+}
+
+esp_http_client_handle_t esp_http_client_init(const esp_http_client_config_t *config) {
+    if (!config) return NULL;
+
+    esp_http_client_handle_t client = calloc(1, sizeof(*client));
+    if (!client) return NULL;
+    client->timeout_ms = config->timeout_ms;
+    client->handler = config->event_handler;
+    client->user_data = config->user_data;
+    if (config->url && esp_http_client_set_url(client, config->url) != ESP_OK) {
+        free(client);
+        return NULL;
+    }
+    return client;
+}
+
+esp_err_t esp_http_client_set_url(esp_http_client_handle_t client, const char *url) {
+    if (!client || !url) return ESP_ERR_INVALID_ARG;
+    char *copy = strdup(url);
+    if (!copy) return ESP_ERR_NO_MEM;
+    free(client->url);
+    client->url = copy;
+    return ESP_OK;
+}
+
+esp_err_t esp_http_client_set_header(esp_http_client_handle_t client, const char *key, const char *value) {
+    (void)key;
+    (void)value;
+    return client ? ESP_OK : ESP_ERR_INVALID_ARG;
+}
+
+static void emit(esp_http_client_handle_t client, esp_http_client_event_id_t id, void *data, int len) {
+    if (!client->handler) return;
+    esp_http_client_event_t evt = {
+        .event_id = id,
+        .client = client,
+        .data = data,
+        .data_len = len,
+        .user_data = client->user_data,
+    };
+    client->handler(&evt);
+}
+
+esp_err_t esp_http_client_perform(esp_http_client_handle_t client) {
+    if (!client || !client->url) return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&s_lock);
+    host_http_transport_t transport = s_transport;
+    void *ctx = s_transport_ctx;
+    pthread_mutex_unlock(&s_lock);
+
+    client->status_code = 0;
+    client->content_length = -1;
+    if (!transport) {
+        ESP_LOGW(TAG, "No HTTP transport installed");
+        emit(client, HTTP_EVENT_ERROR, NULL, 0);
+        return ESP_ERR_HTTP_CONNECT;
+    }
+
+    char *body = NULL;
+    size_t body_len = 0;
+    int status = 0;
+    esp_err_t err = transport(client->url, client->timeout_ms, &body, &body_len, &status, ctx);
+    if (err != ESP_OK) {
+        free(body);
+        emit(client, HTTP_EVENT_ERROR, NULL, 0);
+        return err;
+    }
+
+    client->status_code = status;
+    client->content_length = (int64_t)body_len;
+    emit(client, HTTP_EVENT_ON_CONNECTED, NULL, 0);
+    for (size_t off = 0; off < body_len; off += HOST_HTTP_CHUNK_SIZE) {
+        size_t n = body_len - off;
+        if (n > HOST_HTTP_CHUNK_SIZE) n = HOST_HTTP_CHUNK_SIZE;
+        emit(client, HTTP_EVENT_ON_DATA, body + off, (int)n);
+    }
+    emit(client, HTTP_EVENT_ON_FINISH, NULL, 0);
+    free(body);
+    return ESP_OK;
+}
+
+int esp_http_client_get_status_code(esp_http_client_handle_t client) {
+    return client ? client->status_code : 0;
+}
+
+int64_t esp_http_client_get_content_length(esp_http_client_handle_t client) {
+    return client ? client->content_length : -1;
+}
+
+esp_err_t esp_http_client_cleanup(esp_http_client_handle_t client) {
+    if (!client) return ESP_ERR_INVALID_ARG;
+    free(client->url);
+    free(client);
+    return ESP_OK;
+}
+
+esp_err_t host_http_file_transport(const char *url, int timeout_ms,
+                                   char **body, size_t *body_len,
+                                   int *status_code, void *ctx) {
+    (void)timeout_ms;
+    const char *dir = ctx ? (const char *)ctx : ".";
+
+    // Last path segment, without a query string
+    const char *seg = strrchr(url, '/');
+    seg = seg ? seg + 1 : url;
+    size_t seg_len = strcspn(seg, "?#");
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%.*s.json", dir, (int)seg_len, seg);
+
+    *body = NULL;
+    *body_len = 0;
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        *status_code = 404;
+        return ESP_OK;
+    }
+
+    fseek(f, 0, SEEK_END);
+    long size = ftell(f);
+    fseek(f, 0, SEEK_SET);
+    char *buf = malloc(size > 0 ? (size_t)size : 1);
+    if (!buf) {
+        fclose(f);
+        return ESP_ERR_NO_MEM;
+    }
+    size_t n = fread(buf, 1, size > 0 ? (size_t)size : 0, f);
+    fclose(f);
+
+    *body = buf;
+    *body_len = n;
+    *status_code = 200;
+    return ESP_OK;
+}
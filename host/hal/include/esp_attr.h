@@ -0,0 +1,11 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp_attr.h
+ * Placement attributes are no-ops (one flat memory on the host)
+ */
+
+#ifndef HOST_ESP_ATTR_H
+#define HOST_ESP_ATTR_H
+
+#define EXT_RAM_BSS_ATTR
+
+#endif // HOST_ESP_ATTR_H
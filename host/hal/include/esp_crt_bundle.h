@@ -0,0 +1,13 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp_crt_bundle.h
+ * TLS is the host transport's business - attach is a no-op
+ */
+
+#ifndef HOST_ESP_CRT_BUNDLE_H
+#define HOST_ESP_CRT_BUNDLE_H
+
+#include "esp_err.h"
+
+esp_err_t esp_crt_bundle_attach(void *conf);
+
+#endif // HOST_ESP_CRT_BUNDLE_H
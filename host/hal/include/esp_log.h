@@ -0,0 +1,31 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp_log.h
+ * ESP_LOGx to stderr, level from HOST_LOG_LEVEL (0=none .. 5=verbose, default 3)
+ */
+
+#ifndef HOST_ESP_LOG_H
+#define HOST_ESP_LOG_H
+
+#include <stdint.h>
+
+typedef enum {
+    ESP_LOG_NONE = 0,
+    ESP_LOG_ERROR,
+    ESP_LOG_WARN,
+    ESP_LOG_INFO,
+    ESP_LOG_DEBUG,
+    ESP_LOG_VERBOSE,
+} esp_log_level_t;
+
+void host_log_write(esp_log_level_t level, const char *tag, const char *fmt, ...)
+    __attribute__((format(printf, 3, 4)));
+void esp_log_level_set(const char *tag, esp_log_level_t level);
+uint32_t esp_log_timestamp(void);
+
+#define ESP_LOGE(tag, fmt, ...) host_log_write(ESP_LOG_ERROR,   tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGW(tag, fmt, ...) host_log_write(ESP_LOG_WARN,    tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGI(tag, fmt, ...) host_log_write(ESP_LOG_INFO,    tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGD(tag, fmt, ...) host_log_write(ESP_LOG_DEBUG,   tag, fmt, ##__VA_ARGS__)
+#define ESP_LOGV(tag, fmt, ...) host_log_write(ESP_LOG_VERBOSE, tag, fmt, ##__VA_ARGS__)
+
+#endif // HOST_ESP_LOG_H
@@ -0,0 +1,16 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp_random.h
+ * Random words from the OS entropy pool
+ */
+
+#ifndef HOST_ESP_RANDOM_H
+#define HOST_ESP_RANDOM_H
+
+#include <stdint.h>
+
+/**
+ * Random 32-bit value
+ */
+uint32_t esp_random(void);
+
+#endif // HOST_ESP_RANDOM_H
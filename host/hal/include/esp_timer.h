@@ -0,0 +1,16 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp_timer.h
+ * Monotonic microsecond clock (one-shot/periodic timers are not shimmed)
+ */
+
+#ifndef HOST_ESP_TIMER_H
+#define HOST_ESP_TIMER_H
+
+#include <stdint.h>
+
+/**
+ * Microseconds since process start
+ */
+int64_t esp_timer_get_time(void);
+
+#endif // HOST_ESP_TIMER_H
@@ -0,0 +1,48 @@
+/**
+ * DayZ Server Tracker - Host HAL: FreeRTOS.h
+ * Base types and tick math (1 tick = 1 ms)
+ */
+
+#ifndef HOST_FREERTOS_H
+#define HOST_FREERTOS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <limits.h>
+#include <pthread.h>
+
+typedef uint32_t TickType_t;
+typedef int BaseType_t;
+typedef unsigned int UBaseType_t;
+
+#define configTICK_RATE_HZ      1000
+#define portTICK_PERIOD_MS      1
+#define portMAX_DELAY           ((TickType_t)0xFFFFFFFFu)
+#define pdMS_TO_TICKS(ms)       ((TickType_t)(ms))
+#define pdTICKS_TO_MS(t)        ((uint32_t)(t))
+
+// One "core": per-core metric slots collapse to a single slot
+#define portNUM_PROCESSORS      1
+static inline BaseType_t xPortGetCoreID(void) { return 0; }
+
+#define pdFALSE                 0
+#define pdTRUE                  1
+#define pdFAIL                  pdFALSE
+#define pdPASS                  pdTRUE
+
+// Critical sections: one process-wide recursive lock is enough off-device
+typedef struct {
+    int unused;
+} portMUX_TYPE;
+
+#define portMUX_INITIALIZER_UNLOCKED    { 0 }
+
+void host_critical_enter(void);
+void host_critical_exit(void);
+
+#define portENTER_CRITICAL(mux)         do { (void)(mux); host_critical_enter(); } while (0)
+#define portEXIT_CRITICAL(mux)          do { (void)(mux); host_critical_exit(); } while (0)
+#define portENTER_CRITICAL_ISR(mux)     portENTER_CRITICAL(mux)
+#define portEXIT_CRITICAL_ISR(mux)      portEXIT_CRITICAL(mux)
+
+#endif // HOST_FREERTOS_H
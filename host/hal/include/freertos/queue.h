@@ -0,0 +1,26 @@
+/**
+ * DayZ Server Tracker - Host HAL: queue.h
+ * Fixed-size copy queues on a mutex + condition variables
+ */
+
+#ifndef HOST_QUEUE_H
+#define HOST_QUEUE_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_queue *QueueHandle_t;
+
+QueueHandle_t xQueueCreate(UBaseType_t length, UBaseType_t item_size);
+BaseType_t xQueueSend(QueueHandle_t q, const void *item, TickType_t ticks);
+BaseType_t xQueueSendToFront(QueueHandle_t q, const void *item, TickType_t ticks);
+BaseType_t xQueueReceive(QueueHandle_t q, void *item, TickType_t ticks);
+BaseType_t xQueuePeek(QueueHandle_t q, void *item, TickType_t ticks);
+UBaseType_t uxQueueMessagesWaiting(QueueHandle_t q);
+UBaseType_t uxQueueSpacesAvailable(QueueHandle_t q);
+BaseType_t xQueueReset(QueueHandle_t q);
+void vQueueDelete(QueueHandle_t q);
+
+#define xQueueSendToBack(q, item, ticks)    xQueueSend(q, item, ticks)
+#define xQueueOverwrite(q, item)            (xQueueReset(q), xQueueSend(q, item, 0))
+
+#endif // HOST_QUEUE_H
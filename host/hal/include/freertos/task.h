@@ -0,0 +1,44 @@
+/**
+ * DayZ Server Tracker - Host HAL: task.h
+ * Tasks are detached pthreads; priorities and stack sizes are ignored
+ */
+
+#ifndef HOST_TASK_H
+#define HOST_TASK_H
+
+#include "freertos/FreeRTOS.h"
+
+typedef struct host_task *TaskHandle_t;
+typedef void (*TaskFunction_t)(void *arg);
+
+#define tskIDLE_PRIORITY    0
+#define tskNO_AFFINITY      0x7FFFFFFF
+
+BaseType_t xTaskCreate(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                       void *arg, UBaseType_t priority, TaskHandle_t *out);
+BaseType_t xTaskCreatePinnedToCore(TaskFunction_t fn, const char *name, uint32_t stack_depth,
+                                   void *arg, UBaseType_t priority, TaskHandle_t *out,
+                                   BaseType_t core);
+void vTaskDelete(TaskHandle_t task);
+void vTaskDelay(TickType_t ticks);
+TickType_t xTaskGetTickCount(void);
+TaskHandle_t xTaskGetCurrentTaskHandle(void);
+const char* pcTaskGetName(TaskHandle_t task);
+
+// Notifications: one 32-bit value per task, eSetBits / eIncrement / overwrite
+typedef enum {
+    eNoAction = 0,
+    eSetBits,
+    eIncrement,
+    eSetValueWithOverwrite,
+    eSetValueWithoutOverwrite,
+} eNotifyAction;
+
+BaseType_t xTaskNotify(TaskHandle_t task, uint32_t value, eNotifyAction action);
+// Bits as unsigned long like the ESP32 port, so ULONG_MAX (all bits) fits
+BaseType_t xTaskNotifyWait(unsigned long clear_on_entry, unsigned long clear_on_exit,
+                           uint32_t *value, TickType_t ticks);
+
+#define xTaskNotifyGive(task)   xTaskNotify(task, 0, eIncrement)
+
+#endif // HOST_TASK_H
@@ -0,0 +1,84 @@
+/**
+ * DayZ Server Tracker - Host HAL
+ * Controls for the POSIX shims that stand in for ESP-IDF on Linux
+ *
+ * The service layer is compiled unchanged against IDF-named headers in
+ * this directory. Host programs use these hooks to point the shims at
+ * local resources before calling any service init function.
+ */
+
+#ifndef HOST_HAL_H
+#define HOST_HAL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include "esp_err.h"
+
+// ============== CLOCK ==============
+
+/**
+ * Drive wall-clock time from the caller (replay of recorded traces)
+ * Once set, time() returns this instant until the next call, and
+ * esp_timer_get_time() is advanced so uptime keeps pace with it - cooldowns
+ * and windows measured in uptime age with the trace. time() is only
+ * virtualized in programs linked with --wrap=time (host_hal adds it).
+ * @param epoch_us Unix time in microseconds (never move it backwards)
+ */
+void host_hal_set_clock(int64_t epoch_us);
+
+// ============== SD CARD ==============
+
+/**
+ * Mark the SD card mounted/unmounted (sd_card_init() mounts)
+ * The card is the SD_MOUNT_POINT directory chosen at configure time.
+ */
+void host_hal_set_sd_mounted(bool mounted);
+
+// ============== NVS ==============
+
+/**
+ * Set the file backing NVS (default "nvs.bin" in the working directory)
+ * Call before nvs_flash_init(); NULL keeps NVS in memory only.
+ */
+void host_hal_set_nvs_file(const char *path);
+
+// ============== HTTP ==============
+
+/**
+ * Transport callback for esp_http_client_perform()
+ * @param url Requested URL
+ * @param timeout_ms Client timeout
+ * @param body Output body, malloc'd by the transport (freed by the shim)
+ * @param body_len Output body length
+ * @param status_code Output HTTP status
+ * @param ctx Context given to host_hal_set_http_transport()
+ * @return ESP_OK, or a connection error for the client to report
+ */
+typedef esp_err_t (*host_http_transport_t)(const char *url, int timeout_ms,
+                                           char **body, size_t *body_len,
+                                           int *status_code, void *ctx);
+
+/**
+ * Install the HTTP transport (NULL = every request fails to connect)
+ */
+void host_hal_set_http_transport(host_http_transport_t transport, void *ctx);
+
+/**
+ * Built-in transport serving canned responses from a directory
+ * The last path segment of the URL selects <dir>/<segment>.json; a
+ * missing file answers 404. Pass the directory as ctx.
+ */
+esp_err_t host_http_file_transport(const char *url, int timeout_ms,
+                                   char **body, size_t *body_len,
+                                   int *status_code, void *ctx);
+
+// ============== UI ==============
+
+/**
+ * Observer for alert banners (ui_alerts_show), NULL to remove
+ */
+typedef void (*host_alert_hook_t)(const char *message, uint32_t color_hex, void *ctx);
+void host_hal_set_alert_hook(host_alert_hook_t hook, void *ctx);
+
+#endif // HOST_HAL_H
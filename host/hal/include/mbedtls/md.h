@@ -0,0 +1,32 @@
+/**
+ * DayZ Server Tracker - Host HAL: mbedtls/md.h
+ * One-shot HMAC over SHA-256 only (fleet packet authentication)
+ */
+
+#ifndef HOST_MBEDTLS_MD_H
+#define HOST_MBEDTLS_MD_H
+
+#include <stddef.h>
+
+typedef enum {
+    MBEDTLS_MD_NONE = 0,
+    MBEDTLS_MD_SHA256 = 9,
+} mbedtls_md_type_t;
+
+typedef struct mbedtls_md_info_t mbedtls_md_info_t;
+
+#define MBEDTLS_ERR_MD_BAD_INPUT_DATA   -0x5100
+
+/**
+ * Digest info for a type; NULL for anything but MBEDTLS_MD_SHA256
+ */
+const mbedtls_md_info_t *mbedtls_md_info_from_type(mbedtls_md_type_t md_type);
+
+/**
+ * HMAC of input under key, 32 bytes written to output
+ * @return 0, or MBEDTLS_ERR_MD_BAD_INPUT_DATA if md_info is NULL
+ */
+int mbedtls_md_hmac(const mbedtls_md_info_t *md_info, const unsigned char *key, size_t keylen,
+                    const unsigned char *input, size_t ilen, unsigned char *output);
+
+#endif // HOST_MBEDTLS_MD_H
@@ -0,0 +1,99 @@
+/**
+ * DayZ Server Tracker - Host HAL: mqtt_client.h
+ * Subset of the esp-mqtt client API as a small MQTT 3.1.1 client over
+ * POSIX sockets, so host programs can publish to a real broker
+ * (e.g. mosquitto on the dev machine)
+ *
+ * mqtt:// URIs only. QoS 0 and 1 publish with a last will; no subscribe.
+ * Like esp-mqtt, QoS 1 messages stay in an outbox until PUBACK and are
+ * resent (DUP) after a reconnect or a stop/start, and connect failures
+ * report MQTT_EVENT_ERROR then MQTT_EVENT_DISCONNECTED.
+ */
+
+#ifndef HOST_MQTT_CLIENT_H
+#define HOST_MQTT_CLIENT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+typedef const char *esp_event_base_t;
+typedef void (*esp_event_handler_t)(void *handler_args, esp_event_base_t base,
+                                    int32_t event_id, void *event_data);
+
+typedef struct esp_mqtt_client *esp_mqtt_client_handle_t;
+
+typedef enum {
+    MQTT_EVENT_ANY = -1,
+    MQTT_EVENT_ERROR = 0,
+    MQTT_EVENT_CONNECTED,
+    MQTT_EVENT_DISCONNECTED,
+    MQTT_EVENT_SUBSCRIBED,
+    MQTT_EVENT_UNSUBSCRIBED,
+    MQTT_EVENT_PUBLISHED,
+    MQTT_EVENT_DATA,
+    MQTT_EVENT_BEFORE_CONNECT,
+    MQTT_EVENT_DELETED,
+} esp_mqtt_event_id_t;
+
+typedef struct {
+    esp_mqtt_event_id_t event_id;
+    esp_mqtt_client_handle_t client;
+    int msg_id;
+} esp_mqtt_event_t;
+
+typedef esp_mqtt_event_t *esp_mqtt_event_handle_t;
+
+typedef struct {
+    struct {
+        struct {
+            const char *uri;
+        } address;
+    } broker;
+    struct {
+        const char *client_id;
+    } credentials;
+    struct {
+        struct {
+            const char *topic;
+            const char *msg;
+            int msg_len;
+            int qos;
+            int retain;
+        } last_will;
+        int keepalive;
+    } session;
+    struct {
+        int reconnect_timeout_ms;
+        int timeout_ms;
+        bool disable_auto_reconnect;
+    } network;
+    struct {
+        int priority;
+        int stack_size;
+    } task;
+    struct {
+        int size;
+    } buffer;
+} esp_mqtt_client_config_t;
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config);
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void *handler_args);
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client);
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client);
+
+/**
+ * @return Message ID (0 for QoS 0), or -1 if it could not be sent/queued
+ */
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain);
+
+/**
+ * Bytes of QoS 1 messages waiting for PUBACK
+ */
+int esp_mqtt_client_get_outbox_size(esp_mqtt_client_handle_t client);
+
+#endif // HOST_MQTT_CLIENT_H
@@ -0,0 +1,22 @@
+/**
+ * DayZ Server Tracker - Host HAL: nvs_flash.h
+ */
+
+#ifndef HOST_NVS_FLASH_H
+#define HOST_NVS_FLASH_H
+
+#include "nvs.h"
+
+/**
+ * Load the backing file (see host_hal_set_nvs_file)
+ */
+esp_err_t nvs_flash_init(void);
+
+/**
+ * Drop all keys and truncate the backing file
+ */
+esp_err_t nvs_flash_erase(void);
+
+esp_err_t nvs_flash_deinit(void);
+
+#endif // HOST_NVS_FLASH_H
@@ -0,0 +1,524 @@
+/**
+ * DayZ Server Tracker - Host HAL: esp-mqtt over POSIX sockets
+ *
+ * One thread per client connects, reads acks and keeps the session alive;
+ * publishes are written from the caller's thread. Socket writes and the
+ * outbox share the client lock.
+ */
+
+#include "mqtt_client.h"
+#include "esp_log.h"
+#include <errno.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+static const char *TAG = "mqtt_host";
+
+#define MQTT_HOST_DEFAULT_PORT      1883
+#define MQTT_HOST_IO_TIMEOUT_MS     10000
+#define MQTT_HOST_RECONNECT_MS      10000   // esp-mqtt default
+
+// Control packet types (upper nibble of the first byte)
+#define PKT_CONNECT     0x10
+#define PKT_CONNACK     0x20
+#define PKT_PUBLISH     0x30
+#define PKT_PUBACK      0x40
+#define PKT_PINGREQ     0xC0
+#define PKT_PINGRESP    0xD0
+#define PKT_DISCONNECT  0xE0
+#define PKT_DUP         0x08
+
+typedef struct outbox_msg {
+    int msg_id;
+    uint8_t *pkt;
+    size_t len;
+    struct outbox_msg *next;
+} outbox_msg_t;
+
+struct esp_mqtt_client {
+    char *host;
+    int port;
+    char *client_id;
+    char *will_topic;
+    char *will_msg;
+    int will_len;
+    int will_qos;
+    int will_retain;
+    int keepalive;
+    int reconnect_ms;
+    bool auto_reconnect;
+
+    esp_event_handler_t handler;
+    void *handler_args;
+
+    pthread_mutex_t lock;
+    pthread_cond_t cond;
+    pthread_t thread;
+    bool started;
+    bool run;
+    bool reconnect_now;
+    int fd;
+    bool connected;
+    uint16_t next_id;
+    outbox_msg_t *outbox;
+    size_t outbox_bytes;
+};
+
+// ============== WIRE ==============
+
+typedef struct {
+    uint8_t *buf;
+    size_t len;
+    size_t size;
+} pkt_t;
+
+static void pkt_put(pkt_t *p, const void *data, size_t n) {
+    if (p->len + n > p->size) {
+        size_t size = p->size ? p->size : 64;
+        while (size < p->len + n) size *= 2;
+        p->buf = realloc(p->buf, size);
+        p->size = size;
+    }
+    memcpy(p->buf + p->len, data, n);
+    p->len += n;
+}
+
+static void pkt_u8(pkt_t *p, uint8_t v) {
+    pkt_put(p, &v, 1);
+}
+
+static void pkt_u16(pkt_t *p, uint16_t v) {
+    uint8_t b[2] = { (uint8_t)(v >> 8), (uint8_t)v };
+    pkt_put(p, b, 2);
+}
+
+static void pkt_str(pkt_t *p, const char *s, size_t n) {
+    pkt_u16(p, (uint16_t)n);
+    pkt_put(p, s, n);
+}
+
+/**
+ * Prefix a body with its fixed header (type byte + remaining length)
+ */
+static pkt_t pkt_finish(uint8_t type, const pkt_t *body) {
+    pkt_t out = {0};
+    pkt_u8(&out, type);
+    size_t rem = body->len;
+    do {
+        uint8_t b = rem % 128;
+        rem /= 128;
+        pkt_u8(&out, rem ? (b | 0x80) : b);
+    } while (rem);
+    if (body->len) pkt_put(&out, body->buf, body->len);
+    return out;
+}
+
+static bool write_all(int fd, const uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = send(fd, buf, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+static bool read_all(int fd, uint8_t *buf, size_t len) {
+    while (len > 0) {
+        ssize_t n = recv(fd, buf, len, 0);
+        if (n < 0 && errno == EINTR) continue;
+        if (n <= 0) return false;
+        buf += n;
+        len -= (size_t)n;
+    }
+    return true;
+}
+
+/**
+ * Read one packet; the body is kept up to body_size, the rest discarded
+ * @return Body length, or -1 on a closed/broken connection
+ */
+static int read_packet(int fd, uint8_t *type, uint8_t *body, size_t body_size) {
+    if (!read_all(fd, type, 1)) return -1;
+
+    size_t rem = 0;
+    int shift = 0;
+    uint8_t b;
+    do {
+        if (shift > 21 || !read_all(fd, &b, 1)) return -1;
+        rem |= (size_t)(b & 0x7F) << shift;
+        shift += 7;
+    } while (b & 0x80);
+
+    size_t keep = rem < body_size ? rem : body_size;
+    if (!read_all(fd, body, keep)) return -1;
+    for (size_t left = rem - keep; left > 0;) {
+        uint8_t sink[256];
+        size_t n = left < sizeof(sink) ? left : sizeof(sink);
+        if (!read_all(fd, sink, n)) return -1;
+        left -= n;
+    }
+    return (int)keep;
+}
+
+static int tcp_connect(const char *host, int port) {
+    char port_str[8];
+    snprintf(port_str, sizeof(port_str), "%d", port);
+
+    struct addrinfo hints = { .ai_family = AF_UNSPEC, .ai_socktype = SOCK_STREAM };
+    struct addrinfo *res = NULL;
+    if (getaddrinfo(host, port_str, &hints, &res) != 0) return -1;
+
+    int fd = -1;
+    for (struct addrinfo *ai = res; ai; ai = ai->ai_next) {
+        fd = socket(ai->ai_family, ai->ai_socktype, ai->ai_protocol);
+        if (fd < 0) continue;
+        struct timeval tv = { .tv_sec = MQTT_HOST_IO_TIMEOUT_MS / 1000 };
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) == 0) break;
+        close(fd);
+        fd = -1;
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+static bool mqtt_handshake(esp_mqtt_client_handle_t c, int fd) {
+    pkt_t body = {0};
+    pkt_str(&body, "MQTT", 4);
+    pkt_u8(&body, 4);                   // Protocol level 3.1.1
+
+    uint8_t flags = 0x02;               // Clean session
+    if (c->will_topic) {
+        flags |= 0x04 | (uint8_t)(c->will_qos << 3) | (c->will_retain ? 0x20 : 0);
+    }
+    pkt_u8(&body, flags);
+    pkt_u16(&body, (uint16_t)c->keepalive);
+    pkt_str(&body, c->client_id, strlen(c->client_id));
+    if (c->will_topic) {
+        pkt_str(&body, c->will_topic, strlen(c->will_topic));
+        pkt_str(&body, c->will_msg, (size_t)c->will_len);
+    }
+
+    pkt_t pkt = pkt_finish(PKT_CONNECT, &body);
+    bool ok = write_all(fd, pkt.buf, pkt.len);
+    free(body.buf);
+    free(pkt.buf);
+
+    uint8_t type;
+    uint8_t ack[2];
+    if (!ok || read_packet(fd, &type, ack, sizeof(ack)) != 2 || (type & 0xF0) != PKT_CONNACK) {
+        ESP_LOGW(TAG, "No CONNACK from %s:%d", c->host, c->port);
+        return false;
+    }
+    if (ack[1] != 0) {
+        ESP_LOGW(TAG, "Broker refused connection (code %u)", ack[1]);
+        return false;
+    }
+    return true;
+}
+
+// ============== CLIENT THREAD ==============
+
+static void dispatch(esp_mqtt_client_handle_t c, esp_mqtt_event_id_t id, int msg_id) {
+    if (!c->handler) return;
+    esp_mqtt_event_t evt = { .event_id = id, .client = c, .msg_id = msg_id };
+    c->handler(c->handler_args, "MQTT_EVENTS", id, &evt);
+}
+
+static void outbox_remove(esp_mqtt_client_handle_t c, int msg_id) {
+    for (outbox_msg_t **pp = &c->outbox; *pp; pp = &(*pp)->next) {
+        if ((*pp)->msg_id == msg_id) {
+            outbox_msg_t *m = *pp;
+            *pp = m->next;
+            c->outbox_bytes -= m->len;
+            free(m->pkt);
+            free(m);
+            return;
+        }
+    }
+}
+
+/**
+ * Serve one connection until it breaks or the client stops
+ */
+static void session_loop(esp_mqtt_client_handle_t c, int fd) {
+    int ping_ms = c->keepalive > 0 ? c->keepalive * 500 : 30000;
+    bool ping_pending = false;
+
+    for (;;) {
+        pthread_mutex_lock(&c->lock);
+        bool run = c->run;
+        pthread_mutex_unlock(&c->lock);
+        if (!run) return;
+
+        struct pollfd pfd = { .fd = fd, .events = POLLIN };
+        int r = poll(&pfd, 1, ping_ms);
+        if (r < 0 && errno == EINTR) continue;
+        if (r < 0) return;
+
+        if (r == 0) {
+            // Idle: ping, and give up if the last ping went unanswered
+            if (ping_pending) {
+                ESP_LOGW(TAG, "Ping timeout");
+                return;
+            }
+            uint8_t ping[2] = { PKT_PINGREQ, 0 };
+            pthread_mutex_lock(&c->lock);
+            bool ok = write_all(fd, ping, sizeof(ping));
+            pthread_mutex_unlock(&c->lock);
+            if (!ok) return;
+            ping_pending = true;
+            continue;
+        }
+
+        uint8_t type;
+        uint8_t body[4];
+        int n = read_packet(fd, &type, body, sizeof(body));
+        if (n < 0) return;
+        ping_pending = false;
+
+        if ((type & 0xF0) == PKT_PUBACK && n >= 2) {
+            int msg_id = (body[0] << 8) | body[1];
+            pthread_mutex_lock(&c->lock);
+            outbox_remove(c, msg_id);
+            pthread_mutex_unlock(&c->lock);
+            dispatch(c, MQTT_EVENT_PUBLISHED, msg_id);
+        }
+    }
+}
+
+static void *client_thread(void *arg) {
+    esp_mqtt_client_handle_t c = arg;
+
+    for (;;) {
+        pthread_mutex_lock(&c->lock);
+        bool run = c->run;
+        c->reconnect_now = false;
+        pthread_mutex_unlock(&c->lock);
+        if (!run) break;
+
+        dispatch(c, MQTT_EVENT_BEFORE_CONNECT, 0);
+        int fd = tcp_connect(c->host, c->port);
+        if (fd >= 0 && mqtt_handshake(c, fd)) {
+            // Unacked QoS 1 messages go out again, flagged as duplicates,
+            // before anything the CONNECTED handler publishes
+            pthread_mutex_lock(&c->lock);
+            c->fd = fd;
+            c->connected = true;
+            for (outbox_msg_t *m = c->outbox; m; m = m->next) {
+                m->pkt[0] |= PKT_DUP;
+                if (!write_all(fd, m->pkt, m->len)) break;
+            }
+            pthread_mutex_unlock(&c->lock);
+            dispatch(c, MQTT_EVENT_CONNECTED, 0);
+
+            session_loop(c, fd);
+
+            pthread_mutex_lock(&c->lock);
+            c->connected = false;
+            c->fd = -1;
+            run = c->run;
+            pthread_mutex_unlock(&c->lock);
+            close(fd);
+        } else {
+            if (fd >= 0) close(fd);
+            ESP_LOGW(TAG, "Connect to %s:%d failed", c->host, c->port);
+            dispatch(c, MQTT_EVENT_ERROR, 0);
+        }
+        if (!run) break;
+        dispatch(c, MQTT_EVENT_DISCONNECTED, 0);
+
+        // Wait for the reconnect timeout, esp_mqtt_client_reconnect() or stop
+        struct timespec until;
+        clock_gettime(CLOCK_REALTIME, &until);
+        until.tv_sec += c->reconnect_ms / 1000;
+        until.tv_nsec += (long)(c->reconnect_ms % 1000) * 1000000L;
+        if (until.tv_nsec >= 1000000000L) {
+            until.tv_sec++;
+            until.tv_nsec -= 1000000000L;
+        }
+        pthread_mutex_lock(&c->lock);
+        while (c->run && !c->reconnect_now) {
+            if (c->auto_reconnect) {
+                if (pthread_cond_timedwait(&c->cond, &c->lock, &until) == ETIMEDOUT) break;
+            } else {
+                pthread_cond_wait(&c->cond, &c->lock);
+            }
+        }
+        pthread_mutex_unlock(&c->lock);
+    }
+    return NULL;
+}
+
+// ============== API ==============
+
+esp_mqtt_client_handle_t esp_mqtt_client_init(const esp_mqtt_client_config_t *config) {
+    if (!config || !config->broker.address.uri) return NULL;
+
+    const char *uri = config->broker.address.uri;
+    const char *rest = NULL;
+    if (strncmp(uri, "mqtt://", 7) == 0) {
+        rest = uri + 7;
+    } else if (strncmp(uri, "tcp://", 6) == 0) {
+        rest = uri + 6;
+    } else {
+        ESP_LOGE(TAG, "Unsupported broker URI %s (mqtt:// only)", uri);
+        return NULL;
+    }
+
+    esp_mqtt_client_handle_t c = calloc(1, sizeof(*c));
+    if (!c) return NULL;
+
+    size_t host_len = strcspn(rest, ":/");
+    c->host = strndup(rest, host_len);
+    c->port = rest[host_len] == ':' ? atoi(rest + host_len + 1) : MQTT_HOST_DEFAULT_PORT;
+    c->client_id = strdup(config->credentials.client_id ? config->credentials.client_id : "host");
+    if (config->session.last_will.topic) {
+        const char *msg = config->session.last_will.msg ? config->session.last_will.msg : "";
+        c->will_topic = strdup(config->session.last_will.topic);
+        c->will_len = config->session.last_will.msg_len ? config->session.last_will.msg_len
+                                                        : (int)strlen(msg);
+        c->will_msg = malloc((size_t)c->will_len + 1);
+        memcpy(c->will_msg, msg, (size_t)c->will_len);
+        c->will_qos = config->session.last_will.qos;
+        c->will_retain = config->session.last_will.retain;
+    }
+    c->keepalive = config->session.keepalive ? config->session.keepalive : 120;
+    c->reconnect_ms = config->network.reconnect_timeout_ms ? config->network.reconnect_timeout_ms
+                                                            : MQTT_HOST_RECONNECT_MS;
+    c->auto_reconnect = !config->network.disable_auto_reconnect;
+    c->fd = -1;
+    c->next_id = 1;
+    pthread_mutex_init(&c->lock, NULL);
+    pthread_cond_init(&c->cond, NULL);
+    return c;
+}
+
+esp_err_t esp_mqtt_client_register_event(esp_mqtt_client_handle_t client, esp_mqtt_event_id_t event,
+                                         esp_event_handler_t handler, void *handler_args) {
+    (void)event;
+    if (!client) return ESP_ERR_INVALID_ARG;
+    client->handler = handler;
+    client->handler_args = handler_args;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_start(esp_mqtt_client_handle_t client) {
+    if (!client) return ESP_ERR_INVALID_ARG;
+    if (client->started) return ESP_FAIL;
+
+    client->run = true;
+    if (pthread_create(&client->thread, NULL, client_thread, client) != 0) {
+        client->run = false;
+        return ESP_FAIL;
+    }
+    client->started = true;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_stop(esp_mqtt_client_handle_t client) {
+    if (!client || !client->started) return ESP_FAIL;
+
+    pthread_mutex_lock(&client->lock);
+    client->run = false;
+    if (client->connected) {
+        uint8_t disc[2] = { PKT_DISCONNECT, 0 };
+        write_all(client->fd, disc, sizeof(disc));
+        shutdown(client->fd, SHUT_RDWR);
+    }
+    pthread_cond_broadcast(&client->cond);
+    pthread_mutex_unlock(&client->lock);
+
+    pthread_join(client->thread, NULL);
+    client->started = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_reconnect(esp_mqtt_client_handle_t client) {
+    if (!client || !client->started) return ESP_FAIL;
+
+    pthread_mutex_lock(&client->lock);
+    client->reconnect_now = true;
+    pthread_cond_broadcast(&client->cond);
+    pthread_mutex_unlock(&client->lock);
+    return ESP_OK;
+}
+
+esp_err_t esp_mqtt_client_destroy(esp_mqtt_client_handle_t client) {
+    if (!client) return ESP_ERR_INVALID_ARG;
+    if (client->started) esp_mqtt_client_stop(client);
+
+    while (client->outbox) {
+        outbox_remove(client, client->outbox->msg_id);
+    }
+    pthread_mutex_destroy(&client->lock);
+    pthread_cond_destroy(&client->cond);
+    free(client->host);
+    free(client->client_id);
+    free(client->will_topic);
+    free(client->will_msg);
+    free(client);
+    return ESP_OK;
+}
+
+int esp_mqtt_client_publish(esp_mqtt_client_handle_t client, const char *topic,
+                            const char *data, int len, int qos, int retain) {
+    if (!client || !topic || qos < 0 || qos > 1) return -1;
+    if (!data) data = "";
+    if (len <= 0) len = (int)strlen(data);
+
+    pthread_mutex_lock(&client->lock);
+    if (qos == 0 && !client->connected) {
+        pthread_mutex_unlock(&client->lock);
+        return -1;
+    }
+
+    int msg_id = 0;
+    pkt_t body = {0};
+    pkt_str(&body, topic, strlen(topic));
+    if (qos) {
+        msg_id = client->next_id++;
+        if (client->next_id == 0) client->next_id = 1;
+        pkt_u16(&body, (uint16_t)msg_id);
+    }
+    pkt_put(&body, data, (size_t)len);
+    pkt_t pkt = pkt_finish(PKT_PUBLISH | (uint8_t)(qos << 1) | (retain ? 1 : 0), &body);
+    free(body.buf);
+
+    bool sent = client->connected && write_all(client->fd, pkt.buf, pkt.len);
+    if (qos) {
+        // Kept until PUBACK, sent or not
+        outbox_msg_t *m = calloc(1, sizeof(*m));
+        m->msg_id = msg_id;
+        m->pkt = pkt.buf;
+        m->len = pkt.len;
+        outbox_msg_t **tail = &client->outbox;
+        while (*tail) tail = &(*tail)->next;
+        *tail = m;
+        client->outbox_bytes += pkt.len;
+    } else {
+        free(pkt.buf);
+        if (!sent) msg_id = -1;
+    }
+    pthread_mutex_unlock(&client->lock);
+    return msg_id;
+}
+
+int esp_mqtt_client_get_outbox_size(esp_mqtt_client_handle_t client) {
+    if (!client) return 0;
+    pthread_mutex_lock(&client->lock);
+    int bytes = (int)client->outbox_bytes;
+    pthread_mutex_unlock(&client->lock);
+    return bytes;
+}
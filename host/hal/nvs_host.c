@@ -0,0 +1,380 @@
+/**
+ * DayZ Server Tracker - Host HAL: NVS backed by a single file
+ *
+ * All namespaces live in one in-memory table. nvs_commit() rewrites the
+ * whole file, which is fine for the few hundred keys the firmware uses.
+ */
+
+#include "nvs.h"
+#include "nvs_flash.h"
+#include "host_hal.h"
+#include "esp_log.h"
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *TAG = "nvs_host";
+
+#define NVS_HOST_MAGIC      0x53564E48  // "HNVS"
+#define NVS_NAME_MAX        16          // 15 chars + NUL, as on the device
+#define NVS_MAX_HANDLES     32
+
+typedef enum {
+    NVS_TYPE_U8 = 1,
+    NVS_TYPE_I8,
+    NVS_TYPE_U16,
+    NVS_TYPE_I16,
+    NVS_TYPE_U32,
+    NVS_TYPE_I32,
+    NVS_TYPE_STR,
+    NVS_TYPE_BLOB,
+} nvs_host_type_t;
+
+typedef struct {
+    char ns[NVS_NAME_MAX];
+    char key[NVS_NAME_MAX];
+    uint8_t type;
+    uint32_t len;
+    uint8_t *data;
+} nvs_host_entry_t;
+
+typedef struct {
+    bool used;
+    bool writable;
+    char ns[NVS_NAME_MAX];
+} nvs_host_handle_t;
+
+static pthread_mutex_t s_lock = PTHREAD_MUTEX_INITIALIZER;
+static nvs_host_entry_t *s_entries = NULL;
+static int s_count = 0;
+static int s_capacity = 0;
+static nvs_host_handle_t s_handles[NVS_MAX_HANDLES];
+static bool s_initialized = false;
+static char s_file[256] = "nvs.bin";
+static bool s_file_enabled = true;
+
+void host_hal_set_nvs_file(const char *path) {
+    pthread_mutex_lock(&s_lock);
+    s_file_enabled = path != NULL;
+    if (path) {
+        snprintf(s_file, sizeof(s_file), "%s", path);
+    }
+    pthread_mutex_unlock(&s_lock);
+}
+
+static void entries_clear(void) {
+    for (int i = 0; i < s_count; i++) {
+        free(s_entries[i].data);
+    }
+    free(s_entries);
+    s_entries = NULL;
+    s_count = 0;
+    s_capacity = 0;
+}
+
+static nvs_host_entry_t *entry_find(const char *ns, const char *key) {
+    for (int i = 0; i < s_count; i++) {
+        if (strcmp(s_entries[i].ns, ns) == 0 && strcmp(s_entries[i].key, key) == 0) {
+            return &s_entries[i];
+        }
+    }
+    return NULL;
+}
+
+static nvs_host_entry_t *entry_add(const char *ns, const char *key) {
+    if (s_count == s_capacity) {
+        int cap = s_capacity ? s_capacity * 2 : 64;
+        nvs_host_entry_t *grown = realloc(s_entries, cap * sizeof(*grown));
+        if (!grown) return NULL;
+        s_entries = grown;
+        s_capacity = cap;
+    }
+    nvs_host_entry_t *e = &s_entries[s_count++];
+    memset(e, 0, sizeof(*e));
+    snprintf(e->ns, sizeof(e->ns), "%s", ns);
+    snprintf(e->key, sizeof(e->key), "%s", key);
+    return e;
+}
+
+static void file_load(void) {
+    if (!s_file_enabled) return;
+
+    FILE *f = fopen(s_file, "rb");
+    if (!f) return;
+
+    uint32_t magic = 0, count = 0;
+    if (fread(&magic, 4, 1, f) != 1 || magic != NVS_HOST_MAGIC || fread(&count, 4, 1, f) != 1) {
+        ESP_LOGW(TAG, "Ignoring invalid NVS file %s", s_file);
+        fclose(f);
+        return;
+    }
+
+    for (uint32_t i = 0; i < count; i++) {
+        nvs_host_entry_t tmp;
+        memset(&tmp, 0, sizeof(tmp));
+        if (fread(tmp.ns, NVS_NAME_MAX, 1, f) != 1 || fread(tmp.key, NVS_NAME_MAX, 1, f) != 1 ||
+            fread(&tmp.type, 1, 1, f) != 1 || fread(&tmp.len, 4, 1, f) != 1) {
+            break;
+        }
+        tmp.ns[NVS_NAME_MAX - 1] = '\0';
+        tmp.key[NVS_NAME_MAX - 1] = '\0';
+        uint8_t *data = malloc(tmp.len ? tmp.len : 1);
+        if (!data || fread(data, 1, tmp.len, f) != tmp.len) {
+            free(data);
+            break;
+        }
+        nvs_host_entry_t *e = entry_add(tmp.ns, tmp.key);
+        if (!e) {
+            free(data);
+            break;
+        }
+        e->type = tmp.type;
+        e->len = tmp.len;
+        e->data = data;
+    }
+    fclose(f);
+    ESP_LOGI(TAG, "Loaded %d keys from %s", s_count, s_file);
+}
+
+static esp_err_t file_save(void) {
+    if (!s_file_enabled) return ESP_OK;
+
+    FILE *f = fopen(s_file, "wb");
+    if (!f) {
+        ESP_LOGE(TAG, "Cannot write %s", s_file);
+        return ESP_FAIL;
+    }
+
+    uint32_t magic = NVS_HOST_MAGIC, count = (uint32_t)s_count;
+    fwrite(&magic, 4, 1, f);
+    fwrite(&count, 4, 1, f);
+    for (int i = 0; i < s_count; i++) {
+        nvs_host_entry_t *e = &s_entries[i];
+        fwrite(e->ns, NVS_NAME_MAX, 1, f);
+        fwrite(e->key, NVS_NAME_MAX, 1, f);
+        fwrite(&e->type, 1, 1, f);
+        fwrite(&e->len, 4, 1, f);
+        fwrite(e->data, 1, e->len, f);
+    }
+    fclose(f);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_init(void) {
+    pthread_mutex_lock(&s_lock);
+    if (!s_initialized) {
+        file_load();
+        s_initialized = true;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_flash_erase(void) {
+    pthread_mutex_lock(&s_lock);
+    entries_clear();
+    esp_err_t err = file_save();
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t nvs_flash_deinit(void) {
+    pthread_mutex_lock(&s_lock);
+    entries_clear();
+    memset(s_handles, 0, sizeof(s_handles));
+    s_initialized = false;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+esp_err_t nvs_open(const char *name_space, nvs_open_mode_t mode, nvs_handle_t *out_handle) {
+    if (!name_space || !out_handle || strlen(name_space) >= NVS_NAME_MAX) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    pthread_mutex_lock(&s_lock);
+    if (!s_initialized) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_NVS_NOT_INITIALIZED;
+    }
+
+    // Read-only open of a namespace with no keys fails like on the device
+    if (mode == NVS_READONLY) {
+        bool exists = false;
+        for (int i = 0; i < s_count && !exists; i++) {
+            exists = strcmp(s_entries[i].ns, name_space) == 0;
+        }
+        if (!exists) {
+            pthread_mutex_unlock(&s_lock);
+            return ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+
+    for (int i = 0; i < NVS_MAX_HANDLES; i++) {
+        if (!s_handles[i].used) {
+            s_handles[i].used = true;
+            s_handles[i].writable = (mode == NVS_READWRITE);
+            snprintf(s_handles[i].ns, sizeof(s_handles[i].ns), "%s", name_space);
+            *out_handle = (nvs_handle_t)(i + 1);
+            pthread_mutex_unlock(&s_lock);
+            return ESP_OK;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return ESP_ERR_NO_MEM;
+}
+
+// Lock held by caller
+static nvs_host_handle_t *handle_get(nvs_handle_t handle) {
+    if (handle == 0 || handle > NVS_MAX_HANDLES) return NULL;
+    nvs_host_handle_t *h = &s_handles[handle - 1];
+    return h->used ? h : NULL;
+}
+
+void nvs_close(nvs_handle_t handle) {
+    pthread_mutex_lock(&s_lock);
+    nvs_host_handle_t *h = handle_get(handle);
+    if (h) h->used = false;
+    pthread_mutex_unlock(&s_lock);
+}
+
+esp_err_t nvs_commit(nvs_handle_t handle) {
+    pthread_mutex_lock(&s_lock);
+    esp_err_t err = handle_get(handle) ? file_save() : ESP_ERR_INVALID_ARG;
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_key(nvs_handle_t handle, const char *key) {
+    pthread_mutex_lock(&s_lock);
+    nvs_host_handle_t *h = handle_get(handle);
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+    if (h && h->writable && key) {
+        nvs_host_entry_t *e = entry_find(h->ns, key);
+        if (e) {
+            free(e->data);
+            *e = s_entries[--s_count];
+            err = ESP_OK;
+        } else {
+            err = ESP_ERR_NVS_NOT_FOUND;
+        }
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+esp_err_t nvs_erase_all(nvs_handle_t handle) {
+    pthread_mutex_lock(&s_lock);
+    nvs_host_handle_t *h = handle_get(handle);
+    esp_err_t err = ESP_ERR_INVALID_ARG;
+    if (h && h->writable) {
+        for (int i = s_count - 1; i >= 0; i--) {
+            if (strcmp(s_entries[i].ns, h->ns) == 0) {
+                free(s_entries[i].data);
+                s_entries[i] = s_entries[--s_count];
+            }
+        }
+        err = ESP_OK;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+static esp_err_t nvs_host_set(nvs_handle_t handle, const char *key, uint8_t type,
+                              const void *value, size_t len) {
+    if (!key || strlen(key) >= NVS_NAME_MAX || (!value && len)) return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&s_lock);
+    nvs_host_handle_t *h = handle_get(handle);
+    if (!h || !h->writable) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    uint8_t *data = malloc(len ? len : 1);
+    if (!data) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    memcpy(data, value, len);
+
+    nvs_host_entry_t *e = entry_find(h->ns, key);
+    if (!e) e = entry_add(h->ns, key);
+    if (!e) {
+        free(data);
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_NO_MEM;
+    }
+    free(e->data);
+    e->type = type;
+    e->len = (uint32_t)len;
+    e->data = data;
+    pthread_mutex_unlock(&s_lock);
+    return ESP_OK;
+}
+
+/**
+ * Read a value; out == NULL queries the size (strings/blobs)
+ * For fixed-size types len points at the exact size expected.
+ */
+static esp_err_t nvs_host_get(nvs_handle_t handle, const char *key, uint8_t type,
+                              void *out, size_t *len, bool variable) {
+    if (!key || !len) return ESP_ERR_INVALID_ARG;
+
+    pthread_mutex_lock(&s_lock);
+    nvs_host_handle_t *h = handle_get(handle);
+    if (!h) {
+        pthread_mutex_unlock(&s_lock);
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_host_entry_t *e = entry_find(h->ns, key);
+    esp_err_t err = ESP_OK;
+    if (!e || e->type != type) {
+        err = ESP_ERR_NVS_NOT_FOUND;
+    } else if (variable && !out) {
+        *len = e->len;
+    } else if (*len < e->len) {
+        err = ESP_ERR_NVS_INVALID_LENGTH;
+    } else {
+        memcpy(out, e->data, e->len);
+        *len = e->len;
+    }
+    pthread_mutex_unlock(&s_lock);
+    return err;
+}
+
+#define NVS_HOST_SCALAR(suffix, ctype, tag)                                             \
+    esp_err_t nvs_set_##suffix(nvs_handle_t handle, const char *key, ctype value) {    \
+        return nvs_host_set(handle, key, tag, &value, sizeof(value));                   \
+    }                                                                                   \
+    esp_err_t nvs_get_##suffix(nvs_handle_t handle, const char *key, ctype *out_value) { \
+        size_t len = sizeof(*out_value);                                                \
+        if (!out_value) return ESP_ERR_INVALID_ARG;                                     \
+        return nvs_host_get(handle, key, tag, out_value, &len, false);                  \
+    }
+
+NVS_HOST_SCALAR(u8, uint8_t, NVS_TYPE_U8)
+NVS_HOST_SCALAR(i8, int8_t, NVS_TYPE_I8)
+NVS_HOST_SCALAR(u16, uint16_t, NVS_TYPE_U16)
+NVS_HOST_SCALAR(i16, int16_t, NVS_TYPE_I16)
+NVS_HOST_SCALAR(u32, uint32_t, NVS_TYPE_U32)
+NVS_HOST_SCALAR(i32, int32_t, NVS_TYPE_I32)
+
+esp_err_t nvs_set_str(nvs_handle_t handle, const char *key, const char *value) {
+    if (!value) return ESP_ERR_INVALID_ARG;
+    return nvs_host_set(handle, key, NVS_TYPE_STR, value, strlen(value) + 1);
+}
+
+esp_err_t nvs_set_blob(nvs_handle_t handle, const char *key, const void *value, size_t length) {
+    return nvs_host_set(handle, key, NVS_TYPE_BLOB, value, length);
+}
+
+esp_err_t nvs_get_str(nvs_handle_t handle, const char *key, char *out_value, size_t *length) {
+    return nvs_host_get(handle, key, NVS_TYPE_STR, out_value, length, true);
+}
+
+esp_err_t nvs_get_blob(nvs_handle_t handle, const char *key, void *out_value, size_t *length) {
+    return nvs_host_get(handle, key, NVS_TYPE_BLOB, out_value, length, true);
+}
@@ -0,0 +1,101 @@
+/**
+ * DayZ Server Tracker - Host HAL: SD card as a local directory
+ *
+ * SD_MOUNT_POINT is set at configure time (HOST_SD_ROOT); all storage
+ * paths derive from it, so the services read and write there unchanged.
+ */
+
+#include "drivers/sd_card.h"
+#include "host_hal.h"
+#include "storage_config.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <errno.h>
+#include <stdint.h>
+#include <sys/stat.h>
+#include <sys/statvfs.h>
+
+static const char *TAG = "sd_host";
+
+static bool s_mounted = false;
+static int s_leases = 0;
+static bool s_draining = false;
+
+void host_hal_set_sd_mounted(bool mounted) {
+    s_mounted = mounted;
+}
+
+esp_err_t sd_card_init(void) {
+    if (mkdir(SD_MOUNT_POINT, 0755) != 0 && errno != EEXIST) {
+        ESP_LOGE(TAG, "Cannot create %s", SD_MOUNT_POINT);
+        return ESP_FAIL;
+    }
+    s_mounted = true;
+    __atomic_store_n(&s_draining, false, __ATOMIC_SEQ_CST);
+    ESP_LOGI(TAG, "SD card directory: %s", SD_MOUNT_POINT);
+    return ESP_OK;
+}
+
+bool sd_card_is_mounted(void) {
+    return s_mounted;
+}
+
+bool sd_card_verify_access(void) {
+    struct stat st;
+    if (stat(SD_MOUNT_POINT, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        s_mounted = false;
+    }
+    return s_mounted;
+}
+
+esp_err_t sd_card_deinit(void) {
+    if (s_mounted && !sd_card_drain(SD_LEASE_DRAIN_MS)) {
+        ESP_LOGE(TAG, "Not unmounting: SD leases still held");
+        return ESP_ERR_TIMEOUT;
+    }
+    s_mounted = false;
+    __atomic_store_n(&s_draining, false, __ATOMIC_SEQ_CST);
+    return ESP_OK;
+}
+
+bool sd_card_lease(void) {
+    __atomic_add_fetch(&s_leases, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&s_draining, __ATOMIC_SEQ_CST) || !s_mounted) {
+        __atomic_sub_fetch(&s_leases, 1, __ATOMIC_SEQ_CST);
+        return false;
+    }
+    return true;
+}
+
+void sd_card_release(void) {
+    __atomic_sub_fetch(&s_leases, 1, __ATOMIC_SEQ_CST);
+}
+
+bool sd_card_drain(uint32_t timeout_ms) {
+    __atomic_store_n(&s_draining, true, __ATOMIC_SEQ_CST);
+    for (uint32_t waited = 0; __atomic_load_n(&s_leases, __ATOMIC_SEQ_CST) > 0; waited += 10) {
+        if (waited >= timeout_ms) {
+            __atomic_store_n(&s_draining, false, __ATOMIC_SEQ_CST);
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
+}
+
+esp_err_t sd_card_get_space(uint32_t *total_mb, uint32_t *free_mb) {
+    if (!s_mounted) return ESP_ERR_INVALID_STATE;
+
+    struct statvfs vfs;
+    if (statvfs(SD_MOUNT_POINT, &vfs) != 0) return ESP_FAIL;
+    if (total_mb) *total_mb = (uint32_t)((uint64_t)vfs.f_blocks * vfs.f_frsize / (1024 * 1024));
+    if (free_mb) *free_mb = (uint32_t)((uint64_t)vfs.f_bavail * vfs.f_frsize / (1024 * 1024));
+    return ESP_OK;
+}
+
+int sd_card_get_usage_percent(void) {
+    uint32_t total = 0, free_mb = 0;
+    if (sd_card_get_space(&total, &free_mb) != ESP_OK || total == 0) return -1;
+    return (int)((total - free_mb) * 100 / total);
+}
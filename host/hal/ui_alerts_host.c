@@ -0,0 +1,34 @@
+/**
+ * DayZ Server Tracker - Host HAL: alert banners go to the log
+ */
+
+#include "ui/ui_alerts.h"
+#include "host_hal.h"
+#include "esp_log.h"
+
+static const char *TAG = "alert_host";
+static bool s_visible = false;
+static host_alert_hook_t s_hook = NULL;
+static void *s_hook_ctx = NULL;
+
+void host_hal_set_alert_hook(host_alert_hook_t hook, void *ctx) {
+    s_hook = hook;
+    s_hook_ctx = ctx;
+}
+
+void ui_alerts_init(void) {
+}
+
+void ui_alerts_show(const char *message, uint32_t color_hex) {
+    ESP_LOGI(TAG, "[#%06X] %s", (unsigned)color_hex, message);
+    s_visible = true;
+    if (s_hook) s_hook(message, color_hex, s_hook_ctx);
+}
+
+void ui_alerts_hide(void) {
+    s_visible = false;
+}
+
+bool ui_alerts_is_visible(void) {
+    return s_visible;
+}
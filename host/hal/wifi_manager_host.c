@@ -0,0 +1,19 @@
+/**
+ * DayZ Server Tracker - Host HAL: WiFi link state
+ * No radio on the host - the link is whatever app_state says it is
+ * (set by the replay tool from recorded link changes).
+ */
+
+#include "services/wifi_manager.h"
+#include <stdio.h>
+#include <stdlib.h>
+
+bool wifi_manager_is_connected(void) {
+    return app_state_is_wifi_connected();
+}
+
+// HOST_MAC tells several host instances apart (device names derive from it)
+void wifi_manager_get_mac_str(char *buf, size_t buf_size) {
+    const char *mac = getenv("HOST_MAC");
+    snprintf(buf, buf_size, "%s", mac && *mac ? mac : "02:00:00:00:00:01");
+}
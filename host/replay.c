@@ -0,0 +1,646 @@
+/**
+ * DayZ Server Tracker - Field Trace Replay (host tool)
+ *
+ * Feeds traces captured by the device recorder (/sdcard/replay/*.trc,
+ * format in main/services/recorder.h) back through the same pipeline the
+ * fetch tasks run:
+ *   - main server:  server_query_execute()
+ *   - secondaries:  secondary_fetch_slot()
+ * which drive battlemetrics parsing, history, alerts, restart detection,
+ * forecasts, anomaly detection and the analytics cache.
+ *
+ * Recorded fetch results are turned back into BattleMetrics responses by
+ * an HTTP transport (errors come back as the same connect failure, HTTP
+ * status or malformed body), so parsing is exercised too. The wall clock
+ * is virtual: time() follows the trace, and uptime keeps pace with it.
+ * Server switches are replayed from config records (the list and active
+ * index the device had at each fetch); touch events are only tallied, as
+ * their pipeline effects are the switches and fetches that follow them.
+ *
+ * Output checksum: FNV-1a 64 over what each fetch produced (runtime
+ * player data, analytics summary, forecast, restart countdown, anomaly),
+ * every alert banner, and finally the history files on the host SD root.
+ * Two builds that agree on the checksum processed the trace identically;
+ * pass it back with --expect to make a regression check of it.
+ *
+ * Build (host target, see host/CMakeLists.txt):
+ *   cmake -S host -B build-host -DCMAKE_BUILD_TYPE=Release
+ *   cmake --build build-host --target replay
+ *
+ * Usage:
+ *   ./build-host/replay [--speed N] [--expect HEX] [--out results.json]
+ *                       [--mqtt mqtt://localhost:1883] TRACE...
+ *
+ * --speed N throttles to N times real time (default 0: as fast as
+ * possible). Traces are replayed in the order given. Existing history
+ * under the host SD root (HOST_SD_ROOT) is deleted.
+ *
+ * --mqtt also runs the MQTT publisher (main/services/mqtt_publisher.h)
+ * against that broker, e.g. mosquitto on the dev machine; recorded WiFi
+ * drops take the publisher offline too. The queue is flushed at the end
+ * and the publisher counters are added to the output. The checksum does
+ * not depend on it.
+ */
+
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <inttypes.h>
+#include <dirent.h>
+#include <time.h>
+#include "cJSON.h"
+#include "host_hal.h"
+#include "esp_log.h"
+#include "nvs_flash.h"
+#include "drivers/sd_card.h"
+#include "config.h"
+#include "app_state.h"
+#include "events.h"
+#include "storage_backend.h"
+#include "storage_config.h"
+#include "storage_paths.h"
+#include "recorder.h"
+#include "battlemetrics.h"
+#include "server_query.h"
+#include "secondary_fetch.h"
+#include "history_store.h"
+#include "alert_manager.h"
+#include "restart_manager.h"
+#include "forecast.h"
+#include "anomaly_detector.h"
+#include "analytics_cache.h"
+#include "mqtt_publisher.h"
+#include "metrics.h"
+#include "time_util.h"
+
+#define REPLAY_SCHEMA_VERSION   1
+#define MAX_HISTORY_FILES       1024
+#define MQTT_FLUSH_TIMEOUT_MS   30000
+
+typedef struct {
+    uint64_t count;
+    int64_t total_ns;
+    int64_t max_ns;
+} path_timing_t;
+
+typedef struct {
+    uint64_t records;
+    uint64_t configs;
+    uint64_t fetch_main;
+    uint64_t fetch_secondary;
+    uint64_t fetch_failed;          // Recorded as failed on the device
+    uint64_t fetch_unmatched;       // Server not in the list at that point
+    uint64_t wifi_changes;
+    uint64_t wifi_forced;           // Fetch recorded while the link looked down
+    uint64_t events[256];
+    uint64_t alerts;
+    uint64_t clock_backsteps;
+    uint64_t corrupt_files;
+    uint32_t first_ts;
+    uint32_t last_ts;
+    path_timing_t main_path;
+    path_timing_t secondary_path;
+} replay_stats_t;
+
+static replay_stats_t s_stats;
+static uint64_t s_hash = 0xcbf29ce484222325ULL;
+static bool s_services_ready = false;
+static int64_t s_clock_us = 0;
+static const recorder_record_t *s_pending = NULL;   // Fetch the transport answers
+
+// ============== CHECKSUM ==============
+
+static void hash_bytes(const void *data, size_t len) {
+    const uint8_t *p = data;
+    for (size_t i = 0; i < len; i++) {
+        s_hash ^= p[i];
+        s_hash *= 0x100000001b3ULL;
+    }
+}
+
+static void hash_line(const char *fmt, ...) __attribute__((format(printf, 1, 2)));
+
+static void hash_line(const char *fmt, ...) {
+    char line[256];
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(line, sizeof(line), fmt, ap);
+    va_end(ap);
+    if (n < 0) return;
+    hash_bytes(line, (size_t)n < sizeof(line) ? (size_t)n : sizeof(line) - 1);
+}
+
+static void on_alert(const char *message, uint32_t color_hex, void *ctx) {
+    (void)ctx;
+    s_stats.alerts++;
+    hash_line("alert %06x %s\n", (unsigned)color_hex, message);
+}
+
+// What a fetch left behind for one server
+static void hash_server_outputs(int server_idx) {
+    app_state_t *state = app_state_get();
+    server_config_t *srv = &state->settings.servers[server_idx];
+
+    analytics_summary_t a;
+    if (analytics_cache_get(server_idx, &a)) {
+        hash_line("an %d %d%d%d %" PRIu32 " %d/%d t%d:%d p%d:%d@%" PRIu32 " r%" PRIu32 ":%d\n",
+                  server_idx, a.valid, a.stale, a.online, (uint32_t)a.updated_ts,
+                  a.players, a.max_players, a.has_trend, a.trend_2h, a.has_peak,
+                  a.peak_players, (uint32_t)a.peak_ts, (uint32_t)a.next_restart_ts,
+                  a.restart_confidence);
+    }
+
+    forecast_summary_t f;
+    if (forecast_get_summary(server_idx, srv->max_players, &f)) {
+        hash_line("fc %d %d %d %d %d@%" PRIu32 "\n", server_idx, f.expected_1h, f.expected_3h,
+                  f.has_best_join, f.best_join_players, (uint32_t)f.best_join_ts);
+    }
+
+    hash_line("rs %d %d %d an %d\n", server_idx, restart_get_countdown(srv),
+              restart_get_confidence(srv), (int)anomaly_get_active(server_idx));
+}
+
+static void hash_history_files(void) {
+    static char names[MAX_HISTORY_FILES][STORAGE_FILENAME_MAX_LEN];
+    static uint8_t buf[4096];
+
+    for (int server_idx = 0; server_idx < MAX_SERVERS; server_idx++) {
+        char dir_path[STORAGE_PATH_MAX_LEN];
+        storage_path_history_dir(server_idx, dir_path, sizeof(dir_path));
+        DIR *dir = opendir(dir_path);
+        if (!dir) continue;
+
+        int n = 0;
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL && n < MAX_HISTORY_FILES) {
+            if (entry->d_name[0] == '.') continue;
+            snprintf(names[n++], STORAGE_FILENAME_MAX_LEN, "%s", entry->d_name);
+        }
+        closedir(dir);
+        qsort(names, n, sizeof(names[0]), (int (*)(const void *, const void *))strcmp);
+
+        for (int i = 0; i < n; i++) {
+            char path[STORAGE_PATH_MAX_LEN + STORAGE_FILENAME_MAX_LEN];
+            snprintf(path, sizeof(path), "%s/%s", dir_path, names[i]);
+            FILE *f = fopen(path, "rb");
+            if (!f) continue;
+            hash_line("file %d/%s\n", server_idx, names[i]);
+            size_t got;
+            while ((got = fread(buf, 1, sizeof(buf), f)) > 0) {
+                hash_bytes(buf, got);
+            }
+            fclose(f);
+        }
+    }
+}
+
+// ============== TRANSPORT ==============
+
+static esp_err_t trace_transport(const char *url, int timeout_ms, char **body, size_t *body_len,
+                                 int *status_code, void *ctx) {
+    (void)url;
+    (void)timeout_ms;
+    (void)ctx;
+    *body = NULL;
+    *body_len = 0;
+
+    const recorder_record_t *rec = s_pending;
+    if (!rec) return ESP_ERR_HTTP_CONNECT;
+
+    esp_err_t err = rec->fetch.err;
+    if (err >= ESP_ERR_HTTP_BASE + 100 && err < ESP_ERR_HTTP_BASE + 600) {
+        *status_code = err - ESP_ERR_HTTP_BASE;
+        return ESP_OK;
+    }
+    if (err == ESP_ERR_INVALID_RESPONSE) {
+        *status_code = 200;
+        *body = strdup("{}");
+        *body_len = 2;
+        return ESP_OK;
+    }
+    if (err != ESP_OK) return err;     // Connect failure / timeout as recorded
+
+    const server_status_t *st = &rec->fetch.status;
+    cJSON *root = cJSON_CreateObject();
+    cJSON *data = cJSON_AddObjectToObject(root, "data");
+    cJSON *attr = cJSON_AddObjectToObject(data, "attributes");
+    if (st->players >= 0) cJSON_AddNumberToObject(attr, "players", st->players);
+    cJSON_AddNumberToObject(attr, "maxPlayers", st->max_players);
+    cJSON_AddStringToObject(attr, "name", st->server_name);
+    cJSON_AddStringToObject(attr, "status", st->online ? "online" : "offline");
+    if (st->rank > 0) {
+        cJSON_AddNumberToObject(attr, "rank", st->rank);
+    } else {
+        cJSON_AddNullToObject(attr, "rank");
+    }
+    if (st->ip_address[0]) cJSON_AddStringToObject(attr, "ip", st->ip_address);
+    cJSON_AddNumberToObject(attr, "port", st->port);
+    cJSON *details = cJSON_AddObjectToObject(attr, "details");
+    if (st->server_time[0]) cJSON_AddStringToObject(details, "time", st->server_time);
+    if (st->map_name[0]) cJSON_AddStringToObject(details, "map", st->map_name);
+
+    *body = cJSON_PrintUnformatted(root);
+    cJSON_Delete(root);
+    if (!*body) return ESP_ERR_NO_MEM;
+    *body_len = strlen(*body);
+    *status_code = 200;
+    return ESP_OK;
+}
+
+// ============== PIPELINE ==============
+
+static int64_t now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000000 + ts.tv_nsec;
+}
+
+static void timing_add(path_timing_t *t, int64_t ns) {
+    t->count++;
+    t->total_ns += ns;
+    if (ns > t->max_ns) t->max_ns = ns;
+}
+
+static const char *s_mqtt_uri = NULL;
+
+static void services_init(void) {
+    metrics_init();
+    app_state_init();
+    events_init();
+    battlemetrics_init();
+    history_init();
+    restart_init();
+    alert_init();
+    forecast_init();
+    anomaly_init();
+    analytics_cache_init();
+    if (s_mqtt_uri && mqtt_publisher_start(s_mqtt_uri) != ESP_OK) {
+        fprintf(stderr, "MQTT publisher failed to start for %s\n", s_mqtt_uri);
+    }
+    s_services_ready = true;
+}
+
+static void apply_config(const recorder_record_t *rec) {
+    app_state_t *state = app_state_get();
+    int old_active = state->settings.active_server_index;
+    bool had_servers = state->settings.server_count > 0;
+
+    // Keep configs (max players, restart history) of servers that stay
+    server_config_t old[MAX_SERVERS];
+    int old_count = state->settings.server_count;
+    memcpy(old, state->settings.servers, sizeof(old));
+    memset(state->settings.servers, 0, sizeof(state->settings.servers));
+
+    for (int i = 0; i < rec->config.server_count; i++) {
+        server_config_t *srv = &state->settings.servers[i];
+        const char *id = rec->config.server_ids[i];
+        for (int k = 0; k < old_count; k++) {
+            if (strcmp(old[k].server_id, id) == 0) {
+                *srv = old[k];
+                break;
+            }
+        }
+        if (srv->server_id[0] == '\0') {
+            snprintf(srv->server_id, sizeof(srv->server_id), "%s", id);
+            snprintf(srv->display_name, sizeof(srv->display_name), "Server %d", i + 1);
+            srv->max_players = DEFAULT_MAX_PLAYERS;
+        }
+        srv->active = true;
+    }
+    state->settings.server_count = rec->config.server_count;
+    state->settings.active_server_index =
+        rec->config.active_index < rec->config.server_count ? rec->config.active_index : 0;
+
+    // Same steps as a server switch in event_handler.c
+    int new_active = state->settings.active_server_index;
+    if (had_servers && new_active != old_active) {
+        state->runtime.current_players = -1;
+        state->runtime.server_time[0] = '\0';
+        app_state_clear_main_trend();
+        app_state_clear_secondary_data();
+        app_state_update_secondary_indices();
+        history_switch_server(old_active, new_active);
+    } else {
+        app_state_update_secondary_indices();
+    }
+}
+
+static int find_secondary_slot(const char *server_id, int *server_idx) {
+    app_state_t *state = app_state_get();
+    app_state_update_secondary_indices();
+    for (int slot = 0; slot < state->runtime.secondary_count; slot++) {
+        int idx = state->runtime.secondary_server_indices[slot];
+        if (idx < state->settings.server_count &&
+            strcmp(state->settings.servers[idx].server_id, server_id) == 0) {
+            *server_idx = idx;
+            return slot;
+        }
+    }
+    return -1;
+}
+
+static void replay_fetch(const recorder_record_t *rec) {
+    app_state_t *state = app_state_get();
+    if (rec->fetch.err != ESP_OK) s_stats.fetch_failed++;
+
+    server_config_t *active = app_state_get_active_server();
+    bool is_main = active && strcmp(active->server_id, rec->fetch.server_id) == 0;
+    int slot = -1;
+    int server_idx = -1;
+    if (is_main) {
+        server_idx = state->settings.active_server_index;
+    } else {
+        slot = find_secondary_slot(rec->fetch.server_id, &server_idx);
+        if (slot < 0) {
+            s_stats.fetch_unmatched++;
+            return;
+        }
+    }
+
+    s_pending = rec;
+    int64_t t0 = now_ns();
+    if (is_main) {
+        // The device only fetched with the link up - the record proves it was
+        if (!app_state_is_wifi_connected()) {
+            app_state_set_wifi_connected(true);
+            s_stats.wifi_forced++;
+        }
+        server_query_execute();
+        timing_add(&s_stats.main_path, now_ns() - t0);
+        s_stats.fetch_main++;
+        hash_line("main %d/%d %s %d r%d\n", state->runtime.current_players,
+                  state->runtime.max_players, state->runtime.server_time,
+                  state->runtime.is_daytime, state->runtime.server_rank);
+    } else {
+        secondary_fetch_slot(slot);
+        timing_add(&s_stats.secondary_path, now_ns() - t0);
+        s_stats.fetch_secondary++;
+        secondary_server_status_t *sec = &state->runtime.secondary[slot];
+        hash_line("sec %d %d/%d %d\n", server_idx, sec->player_count, sec->max_players,
+                  sec->is_daytime);
+    }
+    s_pending = NULL;
+
+    hash_server_outputs(server_idx);
+}
+
+static void drain_events(void) {
+    app_event_t evt;
+    while (events_receive(&evt)) {
+    }
+}
+
+static void replay_record(const recorder_record_t *rec) {
+    s_stats.records++;
+
+    // Virtual clock only moves forward (SNTP corrections can step it back)
+    int64_t t = (int64_t)rec->ts * 1000000 + (int64_t)rec->ms * 1000;
+    if (t < s_clock_us) {
+        s_stats.clock_backsteps++;
+    } else {
+        s_clock_us = t;
+    }
+    host_hal_set_clock(s_clock_us);
+    if (s_stats.first_ts == 0) s_stats.first_ts = rec->ts;
+    s_stats.last_ts = rec->ts;
+
+    if (!s_services_ready) services_init();
+
+    switch (rec->type) {
+        case RECORDER_REC_CONFIG:
+            s_stats.configs++;
+            apply_config(rec);
+            break;
+        case RECORDER_REC_FETCH:
+            replay_fetch(rec);
+            break;
+        case RECORDER_REC_EVENT:
+            s_stats.events[rec->event.type]++;
+            break;
+        case RECORDER_REC_WIFI:
+            s_stats.wifi_changes++;
+            app_state_set_wifi_connected(rec->wifi.connected);
+            break;
+        default:
+            break;
+    }
+    drain_events();
+}
+
+static void throttle(int64_t wall_start_ns, double speed) {
+    if (speed <= 0 || s_stats.first_ts == 0) return;
+
+    double virt_ns = ((double)s_clock_us - (double)s_stats.first_ts * 1e6) * 1000.0;
+    int64_t due = wall_start_ns + (int64_t)(virt_ns / speed);
+    int64_t wait = due - now_ns();
+    if (wait > 0) {
+        struct timespec ts = { wait / 1000000000, wait % 1000000000 };
+        nanosleep(&ts, NULL);
+    }
+}
+
+// ============== OUTPUT ==============
+
+static void timing_add_json(cJSON *obj, const char *name, const path_timing_t *t) {
+    cJSON *o = cJSON_AddObjectToObject(obj, name);
+    cJSON_AddNumberToObject(o, "count", (double)t->count);
+    cJSON_AddNumberToObject(o, "avg_ns", t->count ? (double)(t->total_ns / (int64_t)t->count) : 0);
+    cJSON_AddNumberToObject(o, "max_ns", (double)t->max_ns);
+}
+
+static const char* event_name(int type) {
+    switch (type) {
+        case EVT_SCREEN_CHANGE:             return "screen_change";
+        case EVT_REFRESH_DATA:              return "refresh";
+        case EVT_SERVER_DELETE:             return "server_delete";
+        case EVT_SETTINGS_CHANGED:          return "settings_changed";
+        case EVT_SERVER_NEXT:               return "server_next";
+        case EVT_SERVER_PREV:               return "server_prev";
+        case EVT_SECONDARY_SERVER_CLICKED:  return "secondary_clicked";
+        default:                            return NULL;
+    }
+}
+
+// ============== MAIN ==============
+
+static void usage(const char *argv0) {
+    fprintf(stderr,
+            "usage: %s [--speed N] [--expect HEX] [--out FILE] [--mqtt URI] TRACE...\n"
+            "  --speed N    N x real time, 0 = unthrottled (default)\n"
+            "  --expect HEX exit 2 unless the output checksum matches\n"
+            "  --mqtt URI   also publish to this broker (mqtt://host[:port])\n",
+            argv0);
+}
+
+int main(int argc, char **argv) {
+    double speed = 0;
+    const char *expect = NULL;
+    const char *out_path = NULL;
+    const char *traces[256];
+    int n_traces = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char *arg = argv[i];
+        const char *val = (i + 1 < argc) ? argv[i + 1] : NULL;
+        if (strcmp(arg, "--speed") == 0 && val) {
+            speed = atof(val);
+            i++;
+        } else if (strcmp(arg, "--expect") == 0 && val) {
+            expect = val;
+            i++;
+        } else if (strcmp(arg, "--out") == 0 && val) {
+            out_path = val;
+            i++;
+        } else if (strcmp(arg, "--mqtt") == 0 && val) {
+            s_mqtt_uri = val;
+            i++;
+        } else if (arg[0] != '-' && n_traces < (int)(sizeof(traces) / sizeof(traces[0]))) {
+            traces[n_traces++] = arg;
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+    if (n_traces == 0 || speed < 0) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    // Recorded fetch failures replay as service errors - counted in the output instead
+    if (!getenv("HOST_LOG_LEVEL")) {
+        esp_log_level_set("*", ESP_LOG_NONE);
+    }
+
+    // Fresh device: empty NVS, empty card
+    time_util_set_timezone(TIMEZONE_POSIX);
+    host_hal_set_nvs_file(NULL);
+    nvs_flash_init();
+    sd_card_init();
+    history_clear_all_storage();
+    char analytics_path[STORAGE_PATH_MAX_LEN];
+    storage_path_analytics(analytics_path, sizeof(analytics_path));
+    storage_delete(analytics_path);
+
+    host_hal_set_http_transport(trace_transport, NULL);
+    host_hal_set_alert_hook(on_alert, NULL);
+
+    int64_t wall_start = now_ns();
+    for (int i = 0; i < n_traces; i++) {
+        recorder_reader_t reader;
+        esp_err_t err = recorder_reader_open(&reader, traces[i]);
+        if (err != ESP_OK) {
+            fprintf(stderr, "%s: %s\n", traces[i],
+                    err == ESP_ERR_NOT_FOUND ? "cannot open" : "not a trace file");
+            return 1;
+        }
+
+        recorder_record_t rec;
+        int r;
+        while ((r = recorder_reader_next(&reader, &rec)) > 0) {
+            throttle(wall_start, speed);
+            replay_record(&rec);
+        }
+        if (r < 0) {
+            // A power cut mid-append leaves a partial record - use what came before
+            fprintf(stderr, "%s: truncated, replayed up to the damage\n", traces[i]);
+            s_stats.corrupt_files++;
+        }
+        recorder_reader_close(&reader);
+    }
+    int64_t wall_ns = now_ns() - wall_start;
+
+    bool mqtt_flushed = false;
+    if (s_mqtt_uri && s_services_ready) {
+        mqtt_flushed = mqtt_publisher_flush(MQTT_FLUSH_TIMEOUT_MS);
+        if (!mqtt_flushed) {
+            fprintf(stderr, "MQTT: broker did not take the whole queue within %d ms\n",
+                    MQTT_FLUSH_TIMEOUT_MS);
+        }
+        mqtt_publisher_stop();
+    }
+
+    hash_history_files();
+    char checksum[17];
+    snprintf(checksum, sizeof(checksum), "%016" PRIx64, s_hash);
+
+    double span = s_stats.last_ts > s_stats.first_ts ? (double)(s_stats.last_ts - s_stats.first_ts) : 0;
+    cJSON *root = cJSON_CreateObject();
+    cJSON_AddStringToObject(root, "tool", "replay");
+    cJSON_AddNumberToObject(root, "schema", REPLAY_SCHEMA_VERSION);
+    cJSON_AddStringToObject(root, "checksum", checksum);
+
+    cJSON *cfg = cJSON_AddObjectToObject(root, "config");
+    cJSON_AddNumberToObject(cfg, "traces", n_traces);
+    cJSON_AddNumberToObject(cfg, "speed", speed);
+    cJSON_AddStringToObject(cfg, "timezone", TIMEZONE_POSIX);
+    cJSON_AddStringToObject(cfg, "sd_root", SD_MOUNT_POINT);
+
+    cJSON *trace = cJSON_AddObjectToObject(root, "trace");
+    cJSON_AddNumberToObject(trace, "records", (double)s_stats.records);
+    cJSON_AddNumberToObject(trace, "first_ts", s_stats.first_ts);
+    cJSON_AddNumberToObject(trace, "last_ts", s_stats.last_ts);
+    cJSON_AddNumberToObject(trace, "span_sec", span);
+    cJSON_AddNumberToObject(trace, "configs", (double)s_stats.configs);
+    cJSON_AddNumberToObject(trace, "fetch_main", (double)s_stats.fetch_main);
+    cJSON_AddNumberToObject(trace, "fetch_secondary", (double)s_stats.fetch_secondary);
+    cJSON_AddNumberToObject(trace, "fetch_failed", (double)s_stats.fetch_failed);
+    cJSON_AddNumberToObject(trace, "fetch_unmatched", (double)s_stats.fetch_unmatched);
+    cJSON_AddNumberToObject(trace, "wifi_changes", (double)s_stats.wifi_changes);
+    cJSON_AddNumberToObject(trace, "wifi_forced", (double)s_stats.wifi_forced);
+    cJSON_AddNumberToObject(trace, "alerts", (double)s_stats.alerts);
+    cJSON_AddNumberToObject(trace, "clock_backsteps", (double)s_stats.clock_backsteps);
+    cJSON_AddNumberToObject(trace, "truncated_files", (double)s_stats.corrupt_files);
+    cJSON *events = cJSON_AddObjectToObject(trace, "events");
+    for (int t = 0; t < 256; t++) {
+        if (!s_stats.events[t]) continue;
+        const char *name = event_name(t);
+        char other[16];
+        if (!name) {
+            snprintf(other, sizeof(other), "type_%d", t);
+            name = other;
+        }
+        cJSON_AddNumberToObject(events, name, (double)s_stats.events[t]);
+    }
+
+    cJSON *timing = cJSON_AddObjectToObject(root, "timing");
+    cJSON_AddNumberToObject(timing, "wall_ms", (double)(wall_ns / 1000000));
+    cJSON_AddNumberToObject(timing, "speedup", wall_ns > 0 ? span * 1e9 / (double)wall_ns : 0);
+    timing_add_json(timing, "main_fetch", &s_stats.main_path);
+    timing_add_json(timing, "secondary_fetch", &s_stats.secondary_path);
+
+    if (s_mqtt_uri) {
+        metrics_snapshot_t m;
+        metrics_snapshot(&m);
+        cJSON *mqtt = cJSON_AddObjectToObject(root, "mqtt");
+        cJSON_AddStringToObject(mqtt, "broker", s_mqtt_uri);
+        cJSON_AddNumberToObject(mqtt, "published", m.counters[METRIC_CNT_MQTT_PUBLISHED]);
+        cJSON_AddNumberToObject(mqtt, "dropped", m.counters[METRIC_CNT_MQTT_DROPPED]);
+        cJSON_AddNumberToObject(mqtt, "connects", m.counters[METRIC_CNT_MQTT_CONNECTS]);
+        cJSON_AddBoolToObject(mqtt, "flushed", mqtt_flushed);
+    }
+
+    char *json = cJSON_Print(root);
+    cJSON_Delete(root);
+    if (!json) {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    FILE *out = out_path ? fopen(out_path, "w") : stdout;
+    if (!out) {
+        fprintf(stderr, "cannot open %s\n", out_path);
+        free(json);
+        return 1;
+    }
+    fprintf(out, "%s\n", json);
+    if (out != stdout) fclose(out);
+    free(json);
+
+    if (expect && strcasecmp(expect, checksum) != 0) {
+        fprintf(stderr, "checksum mismatch: expected %s, got %s\n", expect, checksum);
+        return 2;
+    }
+    return 0;
+}
@@ -22,6 +22,19 @@
 #include "services/history_store.h"
 #include "services/secondary_fetch.h"
 #include "services/restart_manager.h"
+#include "services/alert_manager.h"
+#include "services/forecast.h"
+#include "services/anomaly_detector.h"
+#include "services/analytics_cache.h"
+#include "services/time_util.h"
+#include "services/metrics.h"
+#include "services/arena.h"
+#include "services/profiler.h"
+#include "services/trace.h"
+#include "services/recorder.h"
+#include "services/http_api.h"
+#include "services/mqtt_publisher.h"
+#include "services/fleet.h"
 #include "ui/ui_styles.h"
 
 static const char *TAG = "app_init";
@@ -29,6 +42,9 @@ static const char *TAG = "app_init";
 bool app_init_system(void) {
     ESP_LOGI(TAG, "%s v%s Starting...", APP_NAME, APP_VERSION);
 
+    // Local time zone first - history file names and buckets depend on it
+    time_util_set_timezone(TIMEZONE_POSIX);
+
     // Initialize NVS
     esp_err_t ret = nvs_flash_init();
     if (ret == ESP_ERR_NVS_NO_FREE_PAGES || ret == ESP_ERR_NVS_NEW_VERSION_FOUND) {
@@ -48,6 +64,12 @@ bool app_init_system(void) {
         return true;  // USB mode was attempted
     }
 
+    // Metrics and arenas before any module that records or allocates
+    metrics_init();
+    arena_init();
+    profiler_init();
+    trace_init();
+
     // Initialize application state
     app_state_init();
 
@@ -61,8 +83,16 @@ bool app_init_system(void) {
     buzzer_init();
     buzzer_test();
 
-    // Initialize history
+    // Initialize history and restart tracking
     history_init();
+    restart_init();
+
+    // Initialize alert rules, forecasts, anomaly detection and the
+    // analytics cache (before any fetch task feeds samples)
+    alert_init();
+    forecast_init();
+    anomaly_init();
+    analytics_cache_init();
 
     return false;  // Normal boot continues
 }
@@ -88,6 +118,10 @@ lv_display_t* app_init_display(void) {
     if (sd_card_init() == ESP_OK) {
         // Load JSON history (primary source with full 7-day data)
         history_load_json_for_server(active_srv);
+        // Last-known summaries so the comparison view has data before the first fetch
+        analytics_cache_load_snapshot();
+        // Capture pipeline inputs for host replay
+        recorder_init();
     }
     // Fallback to NVS if no JSON data loaded
     if (history_get_count() == 0) {
@@ -162,10 +196,10 @@ void app_init_network(void) {
                 ESP_LOGI(TAG, "History reloaded: %d entries", history_get_count());
             }
 
-            // Check if restart data is stale and reset if needed
+            // Clock and TZ are valid now - learn restart schedule from history
             server_config_t *srv = app_state_get_active_server();
             if (srv) {
-                restart_check_stale_and_reset(srv);
+                restart_update_schedule(srv);
             }
         } else {
             ESP_LOGW(TAG, "Time sync timeout, timestamps may be wrong");
@@ -177,7 +211,16 @@ void app_init_network(void) {
         }
     }
 
+    // Share fetched results with other trackers on the LAN (before the fetch tasks)
+    fleet_start();
+
     // Start secondary server fetch background task
     secondary_fetch_init();
     secondary_fetch_start();
+
+    // Live data for dashboards (serves once WiFi is up, below the fetch tasks)
+    http_api_start();
+
+    // Samples and events to a local broker, if one is configured
+    mqtt_publisher_start(NULL);
 }
@@ -5,13 +5,16 @@
 #include "app_state.h"
 #include <string.h>
 #include "esp_log.h"
-#include "esp_heap_caps.h"
+#include "esp_attr.h"
 #include "esp_timer.h"
+#include "services/arena.h"
+#include "services/history_ring.h"
+#include "services/recorder.h"
 
 static const char *TAG = "app_state";
 
-// Global application state
-static app_state_t g_state;
+// Global application state (PSRAM .bss - keeps ~10KB of internal RAM for WiFi/TLS)
+static EXT_RAM_BSS_ATTR app_state_t g_state;
 
 void app_state_init(void) {
     memset(&g_state, 0, sizeof(app_state_t));
@@ -47,23 +50,18 @@ void app_state_init(void) {
     g_state.ui.screensaver_active = false;
     g_state.ui.last_activity_time = 0;  // Will be set when LVGL starts
 
-    // Initialize history - allocate in PSRAM
-    g_state.history.entries = heap_caps_calloc(MAX_HISTORY_ENTRIES,
-                                                sizeof(history_entry_t),
-                                                MALLOC_CAP_SPIRAM);
-    if (!g_state.history.entries) {
-        ESP_LOGW(TAG, "Failed to allocate history in PSRAM, trying regular RAM");
-        g_state.history.entries = calloc(MAX_HISTORY_ENTRIES, sizeof(history_entry_t));
-    }
+    // Initialize history ring (PSRAM; internal RAM only with headroom to spare)
+    size_t ring_bytes = history_ring_bytes(MAX_HISTORY_ENTRIES);
+    void *ring_mem = arena_calloc(ARENA_BULK, 1, ring_bytes, "history");
 
-    if (!g_state.history.entries) {
+    if (!ring_mem) {
         ESP_LOGE(TAG, "Failed to allocate history buffer!");
     } else {
-        ESP_LOGI(TAG, "History buffer allocated (%d entries)", MAX_HISTORY_ENTRIES);
+        history_ring_bind(&g_state.history.ring, ring_mem, MAX_HISTORY_ENTRIES);
+        ESP_LOGI(TAG, "History buffer allocated (%d entries, %u bytes)",
+                 MAX_HISTORY_ENTRIES, (unsigned)ring_bytes);
     }
 
-    g_state.history.head = 0;
-    g_state.history.count = 0;
     g_state.history.unsaved_count = 0;
 
     // Initialize multi-WiFi defaults
@@ -111,6 +109,9 @@ bool app_state_is_wifi_connected(void) {
 }
 
 void app_state_set_wifi_connected(bool connected) {
+    if (g_state.runtime.wifi_connected != connected) {
+        recorder_log_wifi(connected);
+    }
     g_state.runtime.wifi_connected = connected;
 }
 
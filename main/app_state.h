@@ -16,11 +16,20 @@
 
 // Restart tracking per server
 typedef struct {
-    uint32_t restart_times[MAX_RESTART_HISTORY];    // Unix timestamps of detected restarts
+    uint32_t restart_times[MAX_RESTART_HISTORY];    // Ring buffer of detected restarts (Unix)
+    uint8_t restart_head;                           // Next write position in restart_times
     uint8_t restart_count;                          // Number of recorded restarts
-    uint32_t avg_interval_sec;                      // Calculated average interval between restarts
     uint32_t last_restart_time;                     // Most recent restart timestamp
-    int16_t last_known_players;                     // Player count before restart (for detection)
+    int16_t last_known_players;                     // Previous sample (-1 = none yet)
+    uint32_t last_sample_time;                      // Timestamp of previous sample
+    bool last_online;                               // Online flag of previous sample
+
+    // Learned schedule - derived from restart_times, recomputed on change
+    bool schedule_valid;                            // Estimate matches restart_times
+    uint32_t period_sec;                            // Phase-locked period (0 = none found)
+    uint32_t phase_sec;                             // Local time-of-day offset modulo period
+    uint32_t median_interval_sec;                   // Fallback when no period locks
+    uint8_t confidence;                             // Prediction confidence 0-100
 } restart_history_t;
 
 // Server configuration
@@ -36,8 +45,8 @@ typedef struct {
     bool active;                    // Is this slot in use?
     restart_history_t restart_history;  // Restart pattern tracking
 
-    // Manual restart schedule (CET timezone)
-    uint8_t restart_hour;           // Known restart hour (0-23 CET)
+    // Manual restart schedule (local time, TIMEZONE_POSIX)
+    uint8_t restart_hour;           // Known restart hour (0-23 local)
     uint8_t restart_minute;         // Known restart minute (0-59)
     uint8_t restart_interval_hours; // Interval: 4, 6, 8, or 12 hours
     bool manual_restart_set;        // True if user manually set restart time
@@ -49,6 +58,18 @@ typedef struct {
     int16_t player_count;           // Player count (-1 if unknown)
 } history_entry_t;
 
+// Packed history ring (structure of arrays, see history_ring.h)
+// Slots are grouped in blocks of HISTORY_BLOCK_SIZE that share a base
+// timestamp; each slot stores only a 16-bit offset from it.
+typedef struct {
+    int16_t *players;               // [capacity], start of the backing block
+    uint16_t *ts_offset;            // [capacity] seconds since the block base
+    uint32_t *ts_base;              // [capacity / HISTORY_BLOCK_SIZE]
+    uint16_t capacity;              // Slots, multiple of HISTORY_BLOCK_SIZE
+    uint16_t head;                  // Next slot to write
+    uint16_t count;                 // Valid slots ending at head
+} history_ring_t;
+
 // Trend tracking data (ring buffer for ~2 hour trend)
 typedef struct {
     int16_t player_counts[TREND_HISTORY_SIZE];
@@ -71,17 +92,38 @@ typedef struct {
     trend_data_t trend;             // Trend tracking data
 } secondary_server_status_t;
 
-// History file header structure
+// Legacy (v2) history file header, followed by the history_entry_t ring
 typedef struct {
-    uint32_t magic;                 // HISTORY_FILE_MAGIC
+    uint32_t magic;                 // HISTORY_FILE_MAGIC_V2
     uint16_t head;                  // history_head
     uint16_t count;                 // history_count
 } history_file_header_t;
 
+// Packed history header (SD file and NVS blob), followed by the ring arrays
+typedef struct {
+    uint32_t magic;                 // HISTORY_FILE_MAGIC
+    uint16_t capacity;              // Ring slots the arrays are sized for
+    uint16_t block_size;            // HISTORY_BLOCK_SIZE when written
+    uint16_t head;
+    uint16_t count;
+} history_pack_header_t;
+
+// Per-credential connection cache (persisted, drives fast reconnect)
+typedef struct {
+    uint8_t bssid[6];               // AP of the last successful connect
+    uint8_t channel;                // Primary channel (0 = nothing cached)
+    int8_t rssi;                    // RSSI at last connect
+    uint32_t last_success;          // Unix timestamp of last connect (0 = unknown)
+    uint16_t success_count;
+    uint16_t fail_count;
+    uint8_t consecutive_fails;      // Reset on success; stops pinning when high
+} wifi_conn_cache_t;
+
 // WiFi credential pair
 typedef struct {
     char ssid[33];
     char password[65];
+    wifi_conn_cache_t cache;
 } wifi_credential_t;
 
 // WiFi scan result entry
@@ -124,6 +166,9 @@ typedef enum {
     SCREEN_ADD_SERVER,
     SCREEN_HISTORY,
     SCREEN_HEATMAP,
+    SCREEN_COMPARE,
+    SCREEN_DIAGNOSTICS,
+    SCREEN_TASKS,
     SCREEN_ALERTS,
     SCREEN_SCREENSAVER
 } screen_id_t;
@@ -178,9 +223,7 @@ typedef struct {
 
 // History state
 typedef struct {
-    history_entry_t *entries;       // PSRAM allocated buffer
-    uint16_t head;
-    uint16_t count;
+    history_ring_t ring;            // Packed ring in one PSRAM block
     int unsaved_count;              // Track new entries since last save
 } history_state_t;
 
@@ -11,7 +11,8 @@
 #define APP_VERSION         "2.8.0"
 
 #define MAX_SERVERS         5
-#define MAX_HISTORY_ENTRIES 10080   // 7 days at 1 min intervals
+#define MAX_HISTORY_ENTRIES 20160   // 7 days at the 30s default refresh (packed, ~80KB)
+#define HISTORY_BLOCK_SIZE  64      // Ring slots sharing one base timestamp
 #define NVS_NAMESPACE       "dayz_tracker"
 
 // ============== DISPLAY SETTINGS ==============
@@ -79,18 +80,34 @@
 // ============== BUZZER CONFIGURATION ==============
 #define BUZZER_PIN          GPIO_NUM_6  // SENSOR AD pin on Waveshare board
 #define BUZZER_ENABLED      true        // Set to false if no buzzer connected
+#define BUZZER_USE_LEDC     0           // 1 = passive buzzer driven by LEDC tones
+#define BUZZER_LEDC_TIMER   LEDC_TIMER_0
+#define BUZZER_LEDC_CHANNEL LEDC_CHANNEL_0
+#define BUZZER_QUEUE_LEN    4           // Pending patterns
+#define BUZZER_RATE_LIMIT_MS 5000       // Min time between starts of the same pattern
+#define BUZZER_PATTERN_GAP_MS 300       // Silence between queued patterns
 
 // ============== RESTART DETECTION ==============
 #define RESTART_DETECT_MIN_PLAYERS  5       // Server must have had at least this many players
-#define RESTART_DETECT_DROP_TO      0       // Player count drops to this (0 = server restart)
+#define RESTART_DETECT_NEAR_ZERO    2       // ...and drop to this many or fewer in one sample
+#define RESTART_DETECT_MAX_GAP_SEC  900     // Drops across longer sample gaps are ignored
 #define MIN_RESTART_INTERVAL_SEC    1800    // Minimum 30 min between detected restarts
-#define MAX_RESTART_HISTORY         10      // Track last 10 restarts per server
+#define MAX_RESTART_HISTORY         32      // Restarts kept per server (ring buffer)
+
+// Restart schedule learning
+#define RESTART_CANDIDATE_PERIODS_H { 24, 12, 8, 6, 4, 3, 2 }  // Longest first
+#define RESTART_LEARN_WINDOW_SEC    (14 * 86400)    // Only learn from recent restarts
+#define RESTART_PHASE_TOL_SEC       600     // Restart counts as on-schedule within +-10 min
+#define RESTART_MIN_INLIERS         3       // Restarts needed to lock a schedule
+#define RESTART_MIN_INLIER_PCT      70      // Share of restarts that must fit the schedule
+#define RESTART_OVERDUE_GRACE_SEC   300     // Show "Imminent" this long past a missed slot
 
 // ============== HISTORY STORAGE ==============
 // Storage constants moved to services/storage_config.h
 // Backward compatibility aliases:
 #include "services/storage_config.h"
 #define HISTORY_FILE_MAGIC      STORAGE_HISTORY_FILE_MAGIC
+#define HISTORY_FILE_MAGIC_V2   STORAGE_HISTORY_FILE_MAGIC_V2
 #define HISTORY_FILE_PREFIX     STORAGE_HISTORY_BIN_PREFIX
 #define NVS_HISTORY_MAX         NVS_HISTORY_MAX_ENTRIES
 #define HISTORY_SAVE_INTERVAL   NVS_SAVE_INTERVAL
@@ -112,8 +129,25 @@
 #define WIFI_SCAN_MAX_RESULTS       20
 #define WIFI_RECONNECT_SCAN_THRESHOLD 3
 
+// WiFi roaming task (event-driven, off the system event loop)
+#define WIFI_ROAM_TASK_STACK        4096
+#define WIFI_ROAM_TASK_PRIORITY     4
+#define WIFI_ROAM_QUEUE_SIZE        8
+#define WIFI_ROAM_CANDIDATE_TIMEOUT_MS  5000    // Per-network connect attempt
+#define WIFI_ROAM_SCAN_TIMEOUT_MS   5000        // Give up on a stuck scan
+#define WIFI_ROAM_BACKOFF_MIN_MS    2000        // Rescan delay after all candidates fail
+#define WIFI_ROAM_BACKOFF_MAX_MS    60000
+
+// Fast reconnect cache (BSSID/channel pinning)
+#define WIFI_ROAM_PINNED_TIMEOUT_MS 3000        // Single-channel attempt to a cached AP
+#define WIFI_ROAM_PINNED_MAX_TRIES  2           // Cached APs tried before a full scan
+#define WIFI_CACHE_MAX_CONSECUTIVE_FAILS 3      // Stop pinning after this many misses
+#define WIFI_CACHE_MAX_AGE_SEC      (30 * 86400)
+#define WIFI_CACHE_COUNT_LIMIT      1000        // Halve counters above this (aging)
+
 // BattleMetrics API
 #define BATTLEMETRICS_API_BASE      "https://api.battlemetrics.com/servers/"
+#define BATTLEMETRICS_MAX_PLAYERS   1000    // Player counts above this are rejected as bogus
 
 // ============== UI STYLING ==============
 #define UI_CARD_RADIUS              12      // Standard card corner radius
@@ -127,6 +161,142 @@
 #define LVGL_TASK_STACK             8192
 #define SCREEN_OFF_LONG_PRESS_MS    2000    // Hold screen for 2s to turn off
 
+// ============== ALERT RULES ==============
+#define ALERT_MAX_RULES             6       // Rules per server
+#define ALERT_HYSTERESIS_PLAYERS    3       // Threshold re-arm margin
+#define ALERT_THRESHOLD_COOLDOWN_SEC 600    // Min gap between threshold alerts
+#define ALERT_RATE_PER_HOUR         30      // Rising/falling rate trigger (players/hour)
+#define ALERT_RATE_COOLDOWN_SEC     1800
+#define ALERT_RATE_EWMA_ALPHA       0.3f    // Smoothing for the rate estimate
+#define ALERT_RATE_MAX_GAP_SEC      1800    // Reset rate estimate after longer gaps
+#define ALERT_SLOT_COOLDOWN_SEC     300
+#define ALERT_RESTART_LEAD_SEC      600     // Warn this long before predicted restart
+#define ALERT_RESTART_COOLDOWN_SEC  3600
+
+// ============== TIME ZONE ==============
+// POSIX TZ rule for all local-time bucketing and display (DST aware)
+#define TIMEZONE_POSIX              "CET-1CEST,M3.5.0,M10.5.0/3"
+
+// ============== FORECAST ==============
+// Model tuning lives in services/forecast_model.h (shared with host tools)
+#define FORECAST_SEED_DAYS          28      // SD history replayed to seed each model
+#define FORECAST_SEED_BACKLOG       32      // Live samples held per server while its seed loads
+#define FORECAST_SEED_TASK_PRIORITY 1       // Below the fetch tasks (3)
+#define FORECAST_SEED_TASK_STACK    4096
+
+// ============== ANOMALY DETECTION ==============
+#define ANOMALY_Z_ENTER             4.0f    // |z| to flag a sample as anomalous
+#define ANOMALY_Z_EXIT              2.0f    // |z| below which an anomaly ends
+#define ANOMALY_CONFIRM_SAMPLES     2       // Consecutive samples before flagging
+#define ANOMALY_WARMUP_SAMPLES      30      // Samples before any flagging
+#define ANOMALY_MIN_STD             2.0f    // Floor on residual std (players)
+#define ANOMALY_BASELINE_TAU_SEC    21600   // Residual mean/variance memory (6h)
+#define ANOMALY_LEVEL_TAU_SEC       3600    // Fallback baseline until forecast is ready
+#define ANOMALY_GAP_SEC             1800    // No step detection across longer gaps
+#define ANOMALY_STEP_DROP_MIN       10      // Step drop: at least this many players...
+#define ANOMALY_STEP_DROP_PCT       40      // ...and this % of the previous count at once
+#define ANOMALY_RESTART_MASK_SEC    900     // Ignore samples this long after a restart
+
+// ============== ANALYTICS CACHE ==============
+#define ANALYTICS_TREND_WINDOW_SEC      7200    // Trend column compares against 2h ago
+#define ANALYTICS_TREND_SLOT_SEC        600     // Trend ring resolution
+#define ANALYTICS_SNAPSHOT_INTERVAL_SEC 900     // SD snapshot for instant data after boot
+
+// ============== METRICS ==============
+#define METRICS_SAMPLE_INTERVAL_MS      1000    // Heap watermark sampling
+#define METRICS_DUMP_INTERVAL_SEC       300     // Snapshot line to SD
+#define METRICS_FILE_MAX_BYTES          (256 * 1024)    // Rotate (keeps one old file)
+
+// ============== TASK PROFILER ==============
+// Needs CONFIG_FREERTOS_USE_TRACE_FACILITY + GENERATE_RUN_TIME_STATS;
+// per-task heap also needs CONFIG_HEAP_TASK_TRACKING
+#define PROFILER_SAMPLE_INTERVAL_SEC    10
+#define PROFILER_WINDOW_SAMPLES         90      // Rolling window in PSRAM (15 min)
+#define PROFILER_MAX_TASKS              24
+#define PROFILER_LOG_INTERVAL_SEC       300     // Window summary line to SD
+#define PROFILER_FILE_MAX_BYTES         (256 * 1024)
+
+// ============== FIELD RECORDER ==============
+// Pipeline inputs to /sdcard/replay/ for host/replay (see recorder.h)
+#define RECORDER_ENABLED                1
+#define RECORDER_BUFFER_SIZE            4096    // RAM buffer before an SD append
+#define RECORDER_FLUSH_INTERVAL_SEC     60
+#define RECORDER_RETENTION_DAYS         28      // Daily trace files kept
+
+// ============== MEMORY ARENAS ==============
+// Buffer placement policy (see arena.h)
+#define ARENA_SCRATCH_BYTES             (64 * 1024)     // PSRAM reserved at boot, > config import / heatmap load
+#define ARENA_DMA_BYTES                 512             // Internal DMA RAM reserved at boot (one SD sector)
+#define ARENA_INTERNAL_HEADROOM         (64 * 1024)     // Largest internal block kept for WiFi/TLS
+
+// ============== TRACING ==============
+// Pipeline latency spans, exported to /sdcard/trace.json (see trace.h)
+#define TRACE_ENABLED                   1
+#define TRACE_RING_SIZE                 2048    // Spans kept in PSRAM (~64KB)
+#define TRACE_EXPORT_INTERVAL_SEC       600
+#define TRACE_FRAME_TIMEOUT_MS          1000    // Give up matching a cycle to a frame
+
+// ============== HTTP API ==============
+// Live status/history/heatmap over HTTP (see http_api.h)
+#define HTTP_API_ENABLED                1
+#define HTTP_API_PORT                   80
+#define HTTP_API_TASK_PRIORITY          1       // Below the fetch tasks (3) and LVGL (4)
+#define HTTP_API_TASK_STACK             6144
+#define HTTP_API_MAX_SOCKETS            3
+#define HTTP_API_CHUNK_SIZE             1024    // Response buffer, sent as one chunk when full
+#define HTTP_API_DEFAULT_RANGE_SEC      86400   // /history without from=
+#define HTTP_API_MAX_RANGE_DAYS         31      // Longest from..to accepted
+#define HTTP_API_RAM_CHUNK              128     // /history entries copied per state lock (RAM fallback)
+#define HTTP_API_EXPORT_TOKEN           ""      // POST /export needs "Authorization: Bearer <token>"; empty = off
+
+// ============== HISTORY EXPORT ==============
+// CSV / columnar export of the JSONL history (see history_export.h)
+#define EXPORT_TASK_PRIORITY            1       // Below the fetch tasks (3)
+#define EXPORT_TASK_STACK               6144
+#define EXPORT_WRITE_BUF_SIZE           (32 * 1024) // PSRAM; one fwrite per fill
+#define EXPORT_GROUP_ROWS               4096    // Rows per columnar group (16KB per column)
+#define EXPORT_MAX_RANGE_DAYS           400
+#define EXPORT_KEEP_FILES               16      // Oldest files in /sdcard/export are deleted beyond this
+
+// ============== USB EXPORT ==============
+// Lend the SD card to a PC while tracking runs (see usb_msc.h)
+#define USB_EXPORT_CONNECT_SEC          60      // Take the card back if no host enumerates
+#define USB_EXPORT_MAX_SEC              7200    // Take the card back after this long regardless
+#define USB_EXPORT_REMOUNT_SEC          10      // Retry a failed remount (appends stay journaled)
+
+// ============== MQTT PUBLISHER ==============
+// Samples, trend and restart events to a local broker (see mqtt_publisher.h)
+#define MQTT_BROKER_URI                 ""      // e.g. "mqtt://192.168.1.10:1883"; empty = off
+#define MQTT_TOPIC_PREFIX               "dayz"  // <prefix>/<device>/...
+#define MQTT_TASK_PRIORITY              1       // Publisher and esp-mqtt tasks, below the fetch tasks (3)
+#define MQTT_TASK_STACK                 4096
+#define MQTT_KEEPALIVE_SEC              60
+#define MQTT_BATCH_SAMPLES              10      // Samples per message
+#define MQTT_BATCH_MAX_AGE_SEC          300     // Send a partial batch once its oldest sample is this old
+#define MQTT_QUEUE_SAMPLES              2880    // Per server while offline (24h at 30s, PSRAM)
+#define MQTT_QUEUE_EVENTS               32
+#define MQTT_OUTBOX_MAX_BYTES           8192    // Unacked QoS 1 data held by esp-mqtt
+#define MQTT_PAYLOAD_SIZE               1024
+#define MQTT_BACKOFF_MIN_MS             2000
+#define MQTT_BACKOFF_MAX_MS             300000
+
+// ============== FLEET MODE ==============
+// Trackers on one LAN share fetched results (see fleet.h)
+#define FLEET_ENABLED                   0       // Opt-in, and only with FLEET_KEY set
+#define FLEET_KEY                       ""      // Shared secret, same on every tracker; packets are HMAC'd with it
+#define FLEET_GROUP_ADDR                "239.255.43.21" // Administratively scoped multicast
+#define FLEET_PORT                      43821
+#define FLEET_TTL                       1       // Stay on the local subnet
+#define FLEET_TASK_PRIORITY             2       // Below the fetch tasks (3), results land before they look
+#define FLEET_TASK_STACK                4096
+#define FLEET_HELLO_SEC                 10
+#define FLEET_PEER_TIMEOUT_SEC          35      // Silent this long = gone, its servers get a new leader
+#define FLEET_MAX_PEERS                 8
+#define FLEET_CACHE_SIZE                16      // Newest peer result per server
+#define FLEET_FRESH_GRACE_SEC           15      // Peer result may be this much older than our interval
+#define FLEET_LEADER_WAIT_MS            5000    // Then poll directly
+#define FLEET_MAX_SKEW_SEC              30      // Ignore peers whose clock disagrees more than this
+
 // ============== MULTI-SERVER WATCH ==============
 #define MAX_SECONDARY_SERVERS       3       // Show up to 3 secondary servers
 #define SECONDARY_REFRESH_SEC       120     // Fetch secondary servers every 2 minutes
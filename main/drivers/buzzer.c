@@ -1,20 +1,177 @@
 /**
  * DayZ Server Tracker - Buzzer Driver Implementation
+ *
+ * All output changes happen in the esp_timer callback. Callers only touch
+ * the queue (under a spinlock) and, when the sequencer is idle or must
+ * preempt, re-arm the timer to fire immediately.
  */
 
 #include "buzzer.h"
 #include "config.h"
 #include "driver/gpio.h"
+#if BUZZER_USE_LEDC
+#include "driver/ledc.h"
+#endif
+#include "esp_timer.h"
 #include "freertos/FreeRTOS.h"
-#include "freertos/task.h"
 #include "esp_log.h"
 
 static const char *TAG = "buzzer";
 static bool buzzer_initialized = false;
 
+// One segment: tone for on_ms, then silence for off_ms
+typedef struct {
+    uint16_t on_ms;
+    uint16_t off_ms;
+    uint16_t freq_hz;               // Used with BUZZER_USE_LEDC (passive buzzer)
+} buzzer_step_t;
+
+typedef struct {
+    const buzzer_step_t *steps;
+    uint8_t step_count;
+} buzzer_pattern_def_t;
+
+static const buzzer_step_t s_steps_test[] = {
+    { 200, 100, 1000 },
+    { 200, 0,   1500 },
+};
+
+static const buzzer_step_t s_steps_threshold[] = {
+    { 100, 80, 1000 },
+    { 100, 0,  1000 },
+};
+
+// Three ascending beeps for "server restarted - fresh loot!"
+static const buzzer_step_t s_steps_restart[] = {
+    { 150, 100, 800 },
+    { 150, 100, 1000 },
+    { 200, 0,   1200 },
+};
+
+static const buzzer_pattern_def_t s_patterns[BUZZER_PATTERN_COUNT] = {
+    [BUZZER_PATTERN_TEST]      = { s_steps_test,      2 },
+    [BUZZER_PATTERN_THRESHOLD] = { s_steps_threshold, 2 },
+    [BUZZER_PATTERN_RESTART]   = { s_steps_restart,   3 },
+};
+
+// Sequencer state (guarded by s_lock)
+static portMUX_TYPE s_lock = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = NULL;
+static buzzer_pattern_t s_queue[BUZZER_QUEUE_LEN];     // Sorted, highest priority first
+static int s_queue_len = 0;
+static int s_current = -1;                              // Playing pattern (-1 = idle)
+static int s_step = 0;
+static bool s_in_pause = false;
+static bool s_preempt = false;
+static int64_t s_last_start_us[BUZZER_PATTERN_COUNT];
+
+static void buzzer_output(bool on, uint16_t freq_hz) {
+#if BUZZER_USE_LEDC
+    if (on) {
+        ledc_set_freq(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_TIMER, freq_hz);
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL, 1 << 9);   // 50% of 10-bit
+    } else {
+        ledc_set_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL, 0);
+    }
+    ledc_update_duty(LEDC_LOW_SPEED_MODE, BUZZER_LEDC_CHANNEL);
+#else
+    (void)freq_hz;  // Active buzzer has its own tone
+    gpio_set_level(BUZZER_PIN, on ? 1 : 0);
+#endif
+}
+
+/**
+ * Pop the highest priority queued pattern into s_current (lock held)
+ * @return true if a pattern was started
+ */
+static bool sequencer_load_next(void) {
+    if (s_queue_len == 0) {
+        s_current = -1;
+        return false;
+    }
+
+    s_current = s_queue[0];
+    for (int i = 1; i < s_queue_len; i++) {
+        s_queue[i - 1] = s_queue[i];
+    }
+    s_queue_len--;
+    s_step = 0;
+    s_in_pause = false;
+    s_last_start_us[s_current] = esp_timer_get_time();
+    return true;
+}
+
+static void sequencer_tick(void *arg) {
+    bool on = false;
+    uint16_t freq = 0;
+    uint32_t next_ms = 0;
+
+    portENTER_CRITICAL(&s_lock);
+
+    if (s_current < 0 || s_preempt) {
+        s_preempt = false;
+        sequencer_load_next();
+    } else if (!s_in_pause) {
+        // Tone finished, go to its pause (skipped if zero)
+        s_in_pause = true;
+        if (s_patterns[s_current].steps[s_step].off_ms == 0) {
+            s_in_pause = false;
+            s_step++;
+        }
+    } else {
+        s_in_pause = false;
+        s_step++;
+    }
+
+    // Pattern finished: short gap, then the next queued one
+    if (s_current >= 0 && s_step >= s_patterns[s_current].step_count) {
+        s_current = -1;
+        if (s_queue_len > 0) {
+            s_preempt = true;
+            next_ms = BUZZER_PATTERN_GAP_MS;
+        }
+    }
+
+    if (s_current >= 0) {
+        const buzzer_step_t *step = &s_patterns[s_current].steps[s_step];
+        on = !s_in_pause;
+        freq = step->freq_hz;
+        next_ms = s_in_pause ? step->off_ms : step->on_ms;
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+
+    buzzer_output(on, freq);
+    if (next_ms > 0) {
+        // Fails only if a caller re-armed us meanwhile - that kick wins
+        esp_timer_start_once(s_timer, (uint64_t)next_ms * 1000);
+    }
+}
+
 void buzzer_init(void) {
     if (!BUZZER_ENABLED || buzzer_initialized) return;
 
+#if BUZZER_USE_LEDC
+    ledc_timer_config_t timer_conf = {
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .duty_resolution = LEDC_TIMER_10_BIT,
+        .timer_num = BUZZER_LEDC_TIMER,
+        .freq_hz = 1000,
+        .clk_cfg = LEDC_AUTO_CLK,
+    };
+    ledc_channel_config_t channel_conf = {
+        .gpio_num = BUZZER_PIN,
+        .speed_mode = LEDC_LOW_SPEED_MODE,
+        .channel = BUZZER_LEDC_CHANNEL,
+        .timer_sel = BUZZER_LEDC_TIMER,
+        .duty = 0,
+        .hpoint = 0,
+    };
+    if (ledc_timer_config(&timer_conf) != ESP_OK || ledc_channel_config(&channel_conf) != ESP_OK) {
+        ESP_LOGE(TAG, "LEDC setup failed on GPIO%d", BUZZER_PIN);
+        return;
+    }
+#else
     gpio_config_t io_conf = {
         .pin_bit_mask = (1ULL << BUZZER_PIN),
         .mode = GPIO_MODE_OUTPUT,
@@ -24,43 +181,99 @@ void buzzer_init(void) {
     };
     gpio_config(&io_conf);
     gpio_set_level(BUZZER_PIN, 0);
+#endif
+
+    const esp_timer_create_args_t timer_args = {
+        .callback = sequencer_tick,
+        .name = "buzzer",
+    };
+    if (esp_timer_create(&timer_args, &s_timer) != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to create sequencer timer");
+        return;
+    }
+
     buzzer_initialized = true;
-    ESP_LOGI(TAG, "Buzzer initialized on GPIO%d", BUZZER_PIN);
+    ESP_LOGI(TAG, "Buzzer initialized on GPIO%d (%s)", BUZZER_PIN,
+             BUZZER_USE_LEDC ? "LEDC" : "GPIO");
 }
 
 bool buzzer_is_ready(void) {
     return BUZZER_ENABLED && buzzer_initialized;
 }
 
-void buzzer_beep(int duration_ms, int frequency_hz) {
-    (void)frequency_hz;  // Active buzzer ignores frequency - has its own tone
-    if (!BUZZER_ENABLED || !buzzer_initialized) return;
+bool buzzer_play(buzzer_pattern_t pattern) {
+    if (!BUZZER_ENABLED || !buzzer_initialized) return false;
+    if ((int)pattern < 0 || pattern >= BUZZER_PATTERN_COUNT) return false;
+
+    int64_t now_us = esp_timer_get_time();
+    bool kick = false;
+
+    portENTER_CRITICAL(&s_lock);
+
+    bool limited = s_last_start_us[pattern] != 0 &&
+                   now_us - s_last_start_us[pattern] < (int64_t)BUZZER_RATE_LIMIT_MS * 1000;
+    bool duplicate = (s_current == (int)pattern);
+    for (int i = 0; i < s_queue_len && !duplicate; i++) {
+        duplicate = (s_queue[i] == pattern);
+    }
+
+    if (limited || duplicate) {
+        portEXIT_CRITICAL(&s_lock);
+        return false;
+    }
+
+    // Insert by priority (after equal ones); full queue drops the lowest
+    int pos = 0;
+    while (pos < s_queue_len && s_queue[pos] >= pattern) pos++;
+    if (pos >= BUZZER_QUEUE_LEN) {
+        portEXIT_CRITICAL(&s_lock);
+        return false;
+    }
+    int last = (s_queue_len < BUZZER_QUEUE_LEN) ? s_queue_len : BUZZER_QUEUE_LEN - 1;
+    for (int i = last; i > pos; i--) {
+        s_queue[i] = s_queue[i - 1];
+    }
+    s_queue[pos] = pattern;
+    if (s_queue_len < BUZZER_QUEUE_LEN) s_queue_len++;
+
+    if (s_current < 0 && !s_preempt) {
+        kick = true;                    // Idle: start now
+    } else if (s_current >= 0 && (int)pattern > s_current) {
+        s_preempt = true;               // Cut the lower priority pattern short
+        kick = true;
+    }
+
+    portEXIT_CRITICAL(&s_lock);
+
+    if (kick) {
+        esp_timer_stop(s_timer);
+        esp_timer_start_once(s_timer, 0);
+    }
+    return true;
+}
+
+void buzzer_stop(void) {
+    if (!buzzer_initialized) return;
+
+    portENTER_CRITICAL(&s_lock);
+    s_queue_len = 0;
+    s_current = -1;
+    s_preempt = false;
+    portEXIT_CRITICAL(&s_lock);
 
-    gpio_set_level(BUZZER_PIN, 1);  // Turn ON
-    vTaskDelay(pdMS_TO_TICKS(duration_ms));
-    gpio_set_level(BUZZER_PIN, 0);  // Turn OFF
+    esp_timer_stop(s_timer);
+    buzzer_output(false, 0);
 }
 
 void buzzer_alert_restart(void) {
-    // Three ascending beeps for "server restarted - fresh loot!"
-    buzzer_beep(150, 800);
-    vTaskDelay(pdMS_TO_TICKS(100));
-    buzzer_beep(150, 1000);
-    vTaskDelay(pdMS_TO_TICKS(100));
-    buzzer_beep(200, 1200);
+    buzzer_play(BUZZER_PATTERN_RESTART);
 }
 
 void buzzer_alert_threshold(void) {
-    // Two quick beeps for player threshold
-    buzzer_beep(100, 1000);
-    vTaskDelay(pdMS_TO_TICKS(80));
-    buzzer_beep(100, 1000);
+    buzzer_play(BUZZER_PATTERN_THRESHOLD);
 }
 
 void buzzer_test(void) {
     ESP_LOGI(TAG, "Testing buzzer...");
-    buzzer_beep(200, 1000);     // 200ms beep at 1kHz
-    vTaskDelay(pdMS_TO_TICKS(100));
-    buzzer_beep(200, 1500);     // Second beep at 1.5kHz
-    ESP_LOGI(TAG, "Buzzer test complete");
+    buzzer_play(BUZZER_PATTERN_TEST);
 }
@@ -1,6 +1,11 @@
 /**
  * DayZ Server Tracker - Buzzer Driver
- * Controls the active buzzer for alerts
+ * Controls the buzzer for alerts
+ *
+ * Patterns are played asynchronously by a one-shot esp_timer that steps
+ * through tone/pause segments, so callers (fetch tasks, alert engine)
+ * never wait for audio. Higher priority patterns preempt the one playing,
+ * lower ones wait in a small queue, repeats are rate limited.
  */
 
 #ifndef BUZZER_H
@@ -8,8 +13,16 @@
 
 #include <stdbool.h>
 
+// Built-in patterns, in ascending priority
+typedef enum {
+    BUZZER_PATTERN_TEST = 0,        // Startup test (2 beeps)
+    BUZZER_PATTERN_THRESHOLD,       // Player threshold (2 quick beeps)
+    BUZZER_PATTERN_RESTART,         // Server restarted (3 ascending beeps)
+    BUZZER_PATTERN_COUNT
+} buzzer_pattern_t;
+
 /**
- * Initialize the buzzer GPIO
+ * Initialize the buzzer output and sequencer timer
  */
 void buzzer_init(void);
 
@@ -19,24 +32,31 @@ void buzzer_init(void);
 bool buzzer_is_ready(void);
 
 /**
- * Simple beep for specified duration
- * @param duration_ms Duration in milliseconds
- * @param frequency_hz Frequency (ignored for active buzzer)
+ * Queue a pattern for playback (returns immediately)
+ * Preempts a lower priority pattern that is playing. Dropped if the same
+ * pattern started less than BUZZER_RATE_LIMIT_MS ago or is already queued.
+ * @param pattern Pattern to play
+ * @return true if the pattern was queued
+ */
+bool buzzer_play(buzzer_pattern_t pattern);
+
+/**
+ * Stop playback and clear the queue
  */
-void buzzer_beep(int duration_ms, int frequency_hz);
+void buzzer_stop(void);
 
 /**
- * Play restart alert pattern (3 ascending beeps)
+ * Play restart alert pattern (3 ascending beeps, non-blocking)
  */
 void buzzer_alert_restart(void);
 
 /**
- * Play threshold alert pattern (2 quick beeps)
+ * Play threshold alert pattern (2 quick beeps, non-blocking)
  */
 void buzzer_alert_threshold(void);
 
 /**
- * Play startup test beeps
+ * Play startup test beeps (non-blocking)
  */
 void buzzer_test(void);
 
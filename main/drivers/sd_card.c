@@ -12,6 +12,8 @@
 #include "sdmmc_cmd.h"
 #include "esp_log.h"
 #include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
 #include "ff.h"  // For f_getfree()
 #include <dirent.h>  // For opendir/readdir
 #include <stdio.h>   // For FILE operations
@@ -19,13 +21,18 @@
 #include <errno.h>   // For errno
 #include <unistd.h>  // For fsync
 #include <string.h>  // For memset
-#include "esp_heap_caps.h"  // For heap_caps_malloc
+#include "services/arena.h"
 
 static const char *TAG = "sd_card";
 
 static sdmmc_card_t *sd_card = NULL;
 static bool sd_mounted = false;
 
+// Leases held by SD users and whether new ones are refused; seq_cst so a
+// lease either sees the drain or the drain sees the lease
+static int s_leases = 0;
+static bool s_draining = false;
+
 /**
  * DEBUG: Read raw sectors from SD card to diagnose partition issues
  * Checks if card is MBR-partitioned or superfloppy (no partition table)
@@ -36,7 +43,7 @@ static void debug_verify_raw_sector(void) {
         return;
     }
 
-    uint8_t *sector = heap_caps_malloc(512, MALLOC_CAP_DMA);
+    uint8_t *sector = arena_alloc(ARENA_DMA, 512, "sd_sector");
     if (!sector) {
         ESP_LOGE(TAG, "DEBUG: Failed to allocate sector buffer");
         return;
@@ -48,7 +55,7 @@ static void debug_verify_raw_sector(void) {
     esp_err_t ret = sdmmc_read_sectors(sd_card, sector, 0, 1);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "DEBUG: Sector 0 read FAILED: %s", esp_err_to_name(ret));
-        free(sector);
+        arena_free(sector);
         return;
     }
 
@@ -121,7 +128,7 @@ static void debug_verify_raw_sector(void) {
 
     ESP_LOGI(TAG, "==============================================");
 
-    free(sector);
+    arena_free(sector);
 }
 
 esp_err_t sd_card_init(void) {
@@ -152,8 +159,9 @@ esp_err_t sd_card_init(void) {
         .max_transfer_sz = 4000,
     };
 
+    // The bus stays up across unmounts (remount after a USB export)
     esp_err_t ret = spi_bus_initialize(SPI2_HOST, &bus_cfg, SPI_DMA_CH_AUTO);
-    if (ret != ESP_OK) {
+    if (ret != ESP_OK && ret != ESP_ERR_INVALID_STATE) {
         ESP_LOGE(TAG, "Failed to initialize SPI bus: %s", esp_err_to_name(ret));
         return ret;
     }
@@ -243,6 +251,7 @@ esp_err_t sd_card_init(void) {
 
     ESP_LOGI(TAG, "SD card write test PASSED - SD card is working!");
     sd_mounted = true;
+    __atomic_store_n(&s_draining, false, __ATOMIC_SEQ_CST);
 
     // List root directory contents
     DIR *dir = opendir("/sdcard");
@@ -337,13 +346,47 @@ bool sd_card_is_mounted(void) {
     return sd_mounted;
 }
 
-void sd_card_deinit(void) {
+esp_err_t sd_card_deinit(void) {
     if (sd_mounted) {
+        // A leaked lease must not hang the caller with the card half torn down
+        if (!sd_card_drain(SD_LEASE_DRAIN_MS)) {
+            ESP_LOGE(TAG, "Not unmounting: %d SD lease(s) still held",
+                     __atomic_load_n(&s_leases, __ATOMIC_SEQ_CST));
+            return ESP_ERR_TIMEOUT;
+        }
         esp_vfs_fat_sdcard_unmount("/sdcard", sd_card);
         sd_card = NULL;
         sd_mounted = false;
         ESP_LOGI(TAG, "SD card unmounted");
     }
+    __atomic_store_n(&s_draining, false, __ATOMIC_SEQ_CST);
+    return ESP_OK;
+}
+
+bool sd_card_lease(void) {
+    __atomic_add_fetch(&s_leases, 1, __ATOMIC_SEQ_CST);
+    if (__atomic_load_n(&s_draining, __ATOMIC_SEQ_CST) || !sd_mounted) {
+        __atomic_sub_fetch(&s_leases, 1, __ATOMIC_SEQ_CST);
+        return false;
+    }
+    return true;
+}
+
+void sd_card_release(void) {
+    __atomic_sub_fetch(&s_leases, 1, __ATOMIC_SEQ_CST);
+}
+
+bool sd_card_drain(uint32_t timeout_ms) {
+    __atomic_store_n(&s_draining, true, __ATOMIC_SEQ_CST);
+    int64_t deadline = esp_timer_get_time() + (int64_t)timeout_ms * 1000;
+    while (__atomic_load_n(&s_leases, __ATOMIC_SEQ_CST) > 0) {
+        if (esp_timer_get_time() >= deadline) {
+            __atomic_store_n(&s_draining, false, __ATOMIC_SEQ_CST);
+            return false;
+        }
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    return true;
 }
 
 esp_err_t sd_card_get_space(uint32_t *total_mb, uint32_t *free_mb) {
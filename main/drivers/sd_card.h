@@ -7,6 +7,7 @@
 #define SD_CARD_H
 
 #include <stdbool.h>
+#include <stdint.h>
 #include "esp_err.h"
 
 /**
@@ -30,8 +31,36 @@ bool sd_card_verify_access(void);
 
 /**
  * Unmount SD card (if needed)
+ * Waits up to SD_LEASE_DRAIN_MS for outstanding leases first (see
+ * sd_card_drain); a lease still held then leaves the card mounted.
+ * @return ESP_OK if unmounted (or was not mounted), ESP_ERR_TIMEOUT if a
+ *         lease was not returned in time (card stays mounted and usable)
  */
-void sd_card_deinit(void);
+esp_err_t sd_card_deinit(void);
+
+/**
+ * Lease the card for file I/O
+ * Every SD user holds a lease from fopen()/opendir() to the matching
+ * close, so the card is never unmounted under an open file. Leases nest
+ * and any number of tasks may hold one at a time. Never blocks.
+ * @return true if the card is mounted and leased - call sd_card_release();
+ *         false if unmounted or being drained (nothing to release)
+ */
+bool sd_card_lease(void);
+
+/**
+ * Return a lease taken with sd_card_lease()
+ */
+void sd_card_release(void);
+
+/**
+ * Refuse new leases and wait for the outstanding ones to be returned
+ * Call before lending the card out; sd_card_deinit() and sd_card_init()
+ * open leases again.
+ * @param timeout_ms Longest wait
+ * @return true when no lease is held, false on timeout (leases reopened)
+ */
+bool sd_card_drain(uint32_t timeout_ms);
 
 /**
  * Get SD card space information
@@ -8,8 +8,14 @@
 #include "sd_card.h"
 #include "display.h"
 #include "io_expander.h"
+#include "app_state.h"
+#include "services/history_store.h"
+#include "services/alert_manager.h"
+#include "services/history_export.h"
+#include "services/storage_config.h"
 
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "driver/gpio.h"
 #include "driver/i2c.h"
 #include "driver/spi_common.h"
@@ -18,6 +24,7 @@
 
 #include "tinyusb.h"
 #include "tinyusb_msc.h"
+#include "tusb.h"
 
 #include "lvgl.h"
 #include "esp_lvgl_port.h"
@@ -25,8 +32,20 @@
 static const char *TAG = "usb_msc";
 static bool usb_msc_active = false;
 static sdmmc_card_t *msc_card = NULL;
+static sdspi_dev_handle_t msc_sdspi = -1;
 static tinyusb_msc_storage_handle_t storage_handle = NULL;
 
+#define USB_EXPORT_COLOR    0x2563EB
+
+// Live export (card lent to USB while tracking runs)
+static struct {
+    bool active;
+    bool host_seen;             // Host has enumerated since the start
+    bool remount_pending;       // Card not back yet; appends stay journaled
+    int64_t started_us;
+    int64_t remount_at_us;      // Next remount attempt
+} s_export = { 0 };
+
 // GT911 touch controller registers
 #define GT911_ADDR          0x5D
 #define GT911_POINT_INFO    0x814E  // Touch status register
@@ -147,10 +166,10 @@ static esp_err_t init_sd_for_msc(void) {
         return ret;
     }
 
-    sdspi_dev_handle_t handle;
-    ret = sdspi_host_init_device(&slot_config, &handle);
+    ret = sdspi_host_init_device(&slot_config, &msc_sdspi);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "SDSPI device init failed: %s", esp_err_to_name(ret));
+        msc_sdspi = -1;
         return ret;
     }
 
@@ -171,21 +190,10 @@ static esp_err_t init_sd_for_msc(void) {
     return ESP_OK;
 }
 
-esp_err_t usb_msc_init(void) {
-    ESP_LOGI(TAG, "Initializing USB Mass Storage mode...");
-
-    // I2C and IO expander already initialized by usb_msc_touch_detected()
-    // Set USB mode via centralized IO expander
-    io_expander_set_usb_mode(true);
-    vTaskDelay(pdMS_TO_TICKS(10));
-
-    // Initialize SD card
-    esp_err_t ret = init_sd_for_msc();
-    if (ret != ESP_OK) {
-        ESP_LOGE(TAG, "SD card init for MSC failed");
-        return ret;
-    }
-
+/**
+ * Install TinyUSB and expose msc_card to the host
+ */
+static esp_err_t msc_install(void) {
     // Configure TinyUSB driver
     const tinyusb_config_t tusb_cfg = {
         .port = TINYUSB_PORT_FULL_SPEED_0,
@@ -211,7 +219,7 @@ esp_err_t usb_msc_init(void) {
         .event_arg = NULL,
     };
 
-    ret = tinyusb_driver_install(&tusb_cfg);
+    esp_err_t ret = tinyusb_driver_install(&tusb_cfg);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "TinyUSB driver install failed: %s", esp_err_to_name(ret));
         return ret;
@@ -251,6 +259,49 @@ esp_err_t usb_msc_init(void) {
     ret = tinyusb_msc_new_storage_sdmmc(&storage_cfg, &storage_handle);
     if (ret != ESP_OK) {
         ESP_LOGE(TAG, "MSC storage init failed: %s", esp_err_to_name(ret));
+        storage_handle = NULL;
+        return ret;
+    }
+
+    return ESP_OK;
+}
+
+/**
+ * Detach from the host and release the card (safe after a partial install)
+ */
+static void msc_uninstall(void) {
+    if (storage_handle) {
+        tinyusb_msc_delete_storage(storage_handle);
+        storage_handle = NULL;
+    }
+    tinyusb_msc_uninstall_driver();
+    tinyusb_driver_uninstall();
+
+    if (msc_sdspi >= 0) {
+        sdspi_host_remove_device(msc_sdspi);
+        msc_sdspi = -1;
+    }
+    free(msc_card);
+    msc_card = NULL;
+}
+
+esp_err_t usb_msc_init(void) {
+    ESP_LOGI(TAG, "Initializing USB Mass Storage mode...");
+
+    // I2C and IO expander already initialized by usb_msc_touch_detected()
+    // Set USB mode via centralized IO expander
+    io_expander_set_usb_mode(true);
+    vTaskDelay(pdMS_TO_TICKS(10));
+
+    // Initialize SD card
+    esp_err_t ret = init_sd_for_msc();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "SD card init for MSC failed");
+        return ret;
+    }
+
+    ret = msc_install();
+    if (ret != ESP_OK) {
         return ret;
     }
 
@@ -327,3 +378,149 @@ void usb_msc_task(void) {
 bool usb_msc_is_active(void) {
     return usb_msc_active;
 }
+
+// ============== LIVE EXPORT ==============
+
+/**
+ * Mount the card again and catch it up with what was journaled meanwhile
+ * On failure the journal stays open so nothing collected is lost.
+ */
+static bool export_remount(void) {
+    esp_err_t ret = sd_card_init();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Export: SD remount failed: %s", esp_err_to_name(ret));
+        return false;
+    }
+    int replayed = history_journal_end();
+    history_save_to_sd(app_state_get()->settings.active_server_index);
+    ESP_LOGI(TAG, "Export: SD card back, %d journal lines replayed", replayed);
+    return true;
+}
+
+// Keep journaling and let usb_msc_export_tick() try again later
+static void schedule_remount(void) {
+    s_export.remount_pending = true;
+    s_export.remount_at_us = esp_timer_get_time() + (int64_t)USB_EXPORT_REMOUNT_SEC * 1000000;
+}
+
+esp_err_t usb_msc_export_start(void) {
+    if (s_export.active || s_export.remount_pending || usb_msc_active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    if (!sd_card_is_mounted()) {
+        alert_show("USB export: no SD card", USB_EXPORT_COLOR);
+        return ESP_ERR_INVALID_STATE;
+    }
+    export_status_t export_status;
+    history_export_get_status(&export_status);
+    if (export_status.busy) {
+        alert_show("USB export: file export still running", USB_EXPORT_COLOR);
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    // Snapshot: the ring goes to its .bin file, then JSON appends switch to
+    // the journal. Every other SD user (recorder, analytics snapshot,
+    // forecast seeding, HTTP history, file export) holds an sd_card_lease()
+    // while it has files open; draining refuses new leases and waits for
+    // the open ones, so nothing is mid-write when the card is unmounted.
+    int server_idx = app_state_get()->settings.active_server_index;
+    history_save_to_sd(server_idx);
+
+    esp_err_t ret = history_journal_begin();
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Export: journal unavailable: %s", esp_err_to_name(ret));
+        alert_show("USB export: out of memory", USB_EXPORT_COLOR);
+        return ret;
+    }
+    if (!sd_card_drain(SD_LEASE_DRAIN_MS)) {
+        ESP_LOGW(TAG, "Export: SD card still in use, not lending it out");
+        history_journal_end();
+        alert_show("USB export: SD card busy", USB_EXPORT_COLOR);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    // Drained above, but a lease can still leak - then keep the card and abort
+    if (sd_card_deinit() != ESP_OK) {
+        ESP_LOGW(TAG, "Export: SD card could not be unmounted, not lending it out");
+        history_journal_end();
+        alert_show("USB export: SD card busy", USB_EXPORT_COLOR);
+        return ESP_ERR_TIMEOUT;
+    }
+    io_expander_set_usb_mode(true);
+
+    ret = init_sd_for_msc();
+    if (ret == ESP_OK) {
+        ret = msc_install();
+    }
+    if (ret != ESP_OK) {
+        ESP_LOGE(TAG, "Export: MSC start failed: %s", esp_err_to_name(ret));
+        msc_uninstall();
+        io_expander_set_usb_mode(false);
+        if (!export_remount()) {
+            schedule_remount();
+        }
+        alert_show("USB export failed", USB_EXPORT_COLOR);
+        return ret;
+    }
+
+    s_export.active = true;
+    s_export.host_seen = false;
+    s_export.started_us = esp_timer_get_time();
+
+    ESP_LOGI(TAG, "Export started - SD card lent to USB, tracking continues");
+    alert_show("USB export: SD card on PC, tracking continues", USB_EXPORT_COLOR);
+    return ESP_OK;
+}
+
+void usb_msc_export_stop(void) {
+    if (!s_export.active) return;
+    s_export.active = false;
+
+    msc_uninstall();
+    io_expander_set_usb_mode(false);
+
+    int64_t elapsed = (esp_timer_get_time() - s_export.started_us) / 1000000;
+    ESP_LOGI(TAG, "Export ended after %llds", (long long)elapsed);
+    if (export_remount()) {
+        alert_show("USB export ended, SD card back in use", USB_EXPORT_COLOR);
+    } else {
+        schedule_remount();
+        alert_show("USB export ended, SD card not remounted", USB_EXPORT_COLOR);
+    }
+}
+
+bool usb_msc_export_active(void) {
+    return s_export.active;
+}
+
+void usb_msc_export_tick(void) {
+    if (s_export.remount_pending && esp_timer_get_time() >= s_export.remount_at_us) {
+        if (export_remount()) {
+            s_export.remount_pending = false;
+            alert_show("SD card remounted, history caught up", USB_EXPORT_COLOR);
+        } else {
+            schedule_remount();
+        }
+    }
+    if (!s_export.active) return;
+
+    int64_t elapsed = (esp_timer_get_time() - s_export.started_us) / 1000000;
+    bool mounted = tud_mounted();
+    if (mounted) {
+        s_export.host_seen = true;
+    }
+
+    const char *reason = NULL;
+    if (s_export.host_seen && !mounted) {
+        reason = "host disconnected";
+    } else if (!s_export.host_seen && elapsed > USB_EXPORT_CONNECT_SEC) {
+        reason = "no host";
+    } else if (elapsed > USB_EXPORT_MAX_SEC) {
+        reason = "time limit";
+    }
+
+    if (reason) {
+        ESP_LOGI(TAG, "Export: %s, taking the card back", reason);
+        usb_msc_export_stop();
+    }
+}
@@ -1,6 +1,13 @@
 /**
  * DayZ Server Tracker - USB Mass Storage Driver
  * Exposes SD card as USB storage when connected to USB OTG port
+ *
+ * Two ways in: touch-and-hold at boot (dedicated mode, nothing else runs),
+ * or a live export from Settings. A live export saves the history ring,
+ * diverts JSON appends to a PSRAM journal, unmounts the card and lends it
+ * to the host; polling and recording carry on. When the host goes away
+ * (or on timeout, or the Settings button) the card is remounted and the
+ * journal is written out, so the files catch up with no gap.
  */
 
 #ifndef USB_MSC_H
@@ -36,4 +43,32 @@ void usb_msc_task(void);
  */
 bool usb_msc_is_active(void);
 
+/**
+ * Lend the SD card to a USB host while tracking keeps running
+ * Call from the main loop. Shows a banner with the outcome.
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if no card or already exporting,
+ *         ESP_ERR_TIMEOUT if an SD user did not let go (card stays mounted)
+ */
+esp_err_t usb_msc_export_start(void);
+
+/**
+ * Take the card back, remount it and replay the history journal
+ * Ask the user to eject on the PC first. No-op if not exporting. If the
+ * remount fails, appends stay journaled and usb_msc_export_tick() retries
+ * every USB_EXPORT_REMOUNT_SEC.
+ */
+void usb_msc_export_stop(void);
+
+/**
+ * Check if a live export is in progress
+ */
+bool usb_msc_export_active(void);
+
+/**
+ * Main loop housekeeping: ends the export when the host disconnects, or
+ * after USB_EXPORT_CONNECT_SEC without a host / USB_EXPORT_MAX_SEC total,
+ * and retries a failed remount
+ */
+void usb_msc_export_tick(void);
+
 #endif // USB_MSC_H
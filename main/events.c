@@ -3,10 +3,13 @@
  */
 
 #include "events.h"
+#include "services/metrics.h"
+#include "services/recorder.h"
 #include <string.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/queue.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char *TAG = "events";
 
@@ -14,6 +17,30 @@ static const char *TAG = "events";
 
 static QueueHandle_t event_queue = NULL;
 
+// Touch-originated events that change what the pipeline does, with their argument.
+// WiFi events are never recorded (they carry credentials).
+static void record_event(const app_event_t *event) {
+    switch (event->type) {
+        case EVT_SCREEN_CHANGE:
+            recorder_log_event(event->type, event->data.screen);
+            break;
+        case EVT_SECONDARY_SERVER_CLICKED:
+            recorder_log_event(event->type, event->data.secondary.slot);
+            break;
+        case EVT_SERVER_DELETE:
+            recorder_log_event(event->type, event->data.server_index);
+            break;
+        case EVT_REFRESH_DATA:
+        case EVT_SERVER_NEXT:
+        case EVT_SERVER_PREV:
+        case EVT_SETTINGS_CHANGED:
+            recorder_log_event(event->type, 0);
+            break;
+        default:
+            break;
+    }
+}
+
 void events_init(void) {
     if (event_queue) {
         // Already initialized
@@ -31,11 +58,20 @@ void events_init(void) {
 bool events_post(const app_event_t *event) {
     if (!event_queue || !event) return false;
 
-    if (xQueueSend(event_queue, event, 0) != pdTRUE) {
+    app_event_t stamped = *event;
+    stamped.posted_us = esp_timer_get_time();
+
+    if (xQueueSend(event_queue, &stamped, 0) != pdTRUE) {
         ESP_LOGW(TAG, "Event queue full, dropping event type %d", event->type);
+        metrics_count(METRIC_CNT_EVENTS_DROPPED);
         return false;
     }
 
+    metrics_count(METRIC_CNT_EVENTS_POSTED);
+    record_event(event);
+    int depth = (int)uxQueueMessagesWaiting(event_queue);
+    metrics_gauge_set(METRIC_G_EVENT_QUEUE_DEPTH, depth);
+    metrics_gauge_max(METRIC_G_EVENT_QUEUE_PEAK, depth);
     return true;
 }
 
@@ -44,6 +80,11 @@ bool events_post_simple(event_type_t type) {
     return events_post(&event);
 }
 
+bool events_post_traced(event_type_t type, uint32_t trace_id) {
+    app_event_t event = { .type = type, .trace_id = trace_id };
+    return events_post(&event);
+}
+
 bool events_post_screen_change(screen_id_t screen) {
     app_event_t event = {
         .type = EVT_SCREEN_CHANGE,
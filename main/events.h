@@ -48,6 +48,9 @@ typedef enum {
     EVT_WIFI_DELETE_CREDENTIAL,
     EVT_WIFI_CONNECT_CREDENTIAL,
 
+    // USB export
+    EVT_USB_EXPORT_TOGGLE,
+
 } event_type_t;
 
 // ============== EVENT DATA ==============
@@ -87,6 +90,8 @@ typedef struct {
         secondary_click_data_t secondary;
         wifi_credential_event_t wifi_credential;
     } data;
+    uint32_t trace_id;      // Fetch cycle this event belongs to (0 = none, trace.h)
+    int64_t posted_us;      // Set by events_post, for queue latency
 } app_event_t;
 
 // ============== EVENT QUEUE API ==============
@@ -109,6 +114,13 @@ bool events_post(const app_event_t *event);
  */
 bool events_post_simple(event_type_t type);
 
+/**
+ * Post a simple event that carries a fetch cycle's trace ID
+ * @param type Event type
+ * @param trace_id From trace_cycle_begin()
+ */
+bool events_post_traced(event_type_t type, uint32_t trace_id);
+
 /**
  * Post a screen change event
  * @param screen Target screen
@@ -14,6 +14,14 @@
 #include "services/history_store.h"
 #include "services/secondary_fetch.h"
 #include "services/server_query.h"
+#include "services/alert_manager.h"
+#include "services/forecast.h"
+#include "services/anomaly_detector.h"
+#include "services/analytics_cache.h"
+#include "services/mqtt_publisher.h"
+#include "services/trace.h"
+#include "drivers/usb_msc.h"
+#include "ui/ui_context.h"
 #include "ui/ui_main.h"
 #include "ui/ui_update.h"
 
@@ -51,6 +59,12 @@ void event_handler_process_deferred(void) {
 
 // Private: process a single event (shared by blocking and non-blocking paths)
 static void handle_event(app_event_t *evt, app_state_t *state) {
+    // Fetch results carry their cycle's trace ID; time spent queued is a span
+    trace_set_context(evt->trace_id);
+    if (evt->trace_id) {
+        trace_record("event_queue", evt->trace_id, evt->posted_us, esp_timer_get_time(), NULL);
+    }
+
     switch (evt->type) {
         case EVT_SCREEN_CHANGE:
             ui_switch_screen(evt->data.screen);
@@ -98,6 +112,14 @@ static void handle_event(app_event_t *evt, app_state_t *state) {
             int old_idx = state->settings.active_server_index;
             settings_delete_server(evt->data.server_index);
             int new_idx = state->settings.active_server_index;
+            // Slots shifted down - drop rule state from the deleted index on
+            for (int i = evt->data.server_index; i < MAX_SERVERS; i++) {
+                alert_reset_server(i);
+                forecast_reset_server(i);
+                anomaly_reset_server(i);
+                analytics_cache_reset_server(i);
+                mqtt_publisher_reset_server(i);
+            }
             // Switch history if active server changed
             if (old_idx != new_idx || evt->data.server_index == old_idx) {
                 history_switch_server(-1, new_idx);  // -1 because deleted server data is gone
@@ -160,10 +182,17 @@ static void handle_event(app_event_t *evt, app_state_t *state) {
             server_query_request_refresh();
             break;
 
-        case EVT_DATA_UPDATED:
+        case EVT_DATA_UPDATED: {
             // Background query task completed - update UI if on main screen
+            TRACE_BEGIN(sp, "ui_update");
             ui_update_all();
+            ui_update_compare();
+            ui_update_diagnostics();
+            ui_update_tasks();
+            TRACE_END(sp);
+            ui_trace_frame(evt->trace_id);
             break;
+        }
 
         case EVT_SECONDARY_SERVER_CLICKED: {
             // Swap clicked secondary server with main
@@ -234,10 +263,15 @@ static void handle_event(app_event_t *evt, app_state_t *state) {
             break;
         }
 
-        case EVT_SECONDARY_DATA_UPDATED:
+        case EVT_SECONDARY_DATA_UPDATED: {
             // Refresh secondary boxes display
+            TRACE_BEGIN(sp, "ui_update");
             ui_update_secondary();
+            ui_update_compare();
+            TRACE_END(sp);
+            ui_trace_frame(evt->trace_id);
             break;
+        }
 
         case EVT_WIFI_SCAN_START:
             wifi_manager_start_scan();
@@ -269,9 +303,19 @@ static void handle_event(app_event_t *evt, app_state_t *state) {
             wifi_manager_connect_index(evt->data.wifi_credential.index);
             break;
 
+        case EVT_USB_EXPORT_TOGGLE:
+            if (usb_msc_export_active()) {
+                usb_msc_export_stop();
+            } else {
+                usb_msc_export_start();
+            }
+            break;
+
         default:
             break;
     }
+
+    trace_set_context(0);
 }
 
 void event_handler_process(void) {
@@ -41,6 +41,10 @@
 #include "services/restart_manager.h"
 #include "services/alert_manager.h"
 #include "services/server_query.h"
+#include "services/metrics.h"
+#include "services/profiler.h"
+#include "services/recorder.h"
+#include "services/trace.h"
 #include "ui/ui_styles.h"
 #include "ui/ui_widgets.h"
 #include "ui/screen_history.h"
@@ -81,6 +85,7 @@ void app_main(void) {
     if (lvgl_port_lock(1000)) {
         screen_builder_create_main();
         lv_screen_load(screen_main);
+        ui_trace_attach(disp);
         lvgl_port_unlock();
     }
 
@@ -113,5 +118,10 @@ void app_main(void) {
         // Periodic housekeeping (~10Hz when idle, immediate after events)
         alert_check_auto_hide();
         screensaver_tick();
+        metrics_tick();
+        profiler_tick();
+        recorder_tick();
+        trace_tick();
+        usb_msc_export_tick();
     }
 }
@@ -1,6 +1,10 @@
 /**
  * DayZ Server Tracker - Alert Manager Implementation
  *
+ * Each server owns a small fixed rule table with per-rule hysteresis and
+ * cooldown state. Samples from the main and secondary fetch tasks are fed
+ * through alert_process_sample(), which does constant work per sample.
+ *
  * This is the SERVICE layer - handles alert LOGIC only.
  * UI rendering is delegated to ui/ui_alerts.c
  */
@@ -8,50 +12,303 @@
 #include "alert_manager.h"
 #include "config.h"
 #include "app_state.h"
+#include "restart_manager.h"
 #include "drivers/buzzer.h"
 #include "ui/ui_alerts.h"
 #include "esp_timer.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
 
 static const char *TAG = "alert_manager";
 
 // Alert colors (hex values, no LVGL dependency)
 #define ALERT_COLOR_RED    0xFF4444
 #define ALERT_COLOR_ORANGE 0xFF8800
+#define ALERT_COLOR_GREEN  0x44BB44
+#define ALERT_COLOR_BLUE   0x4488FF
 
-void alert_check(void) {
-    app_state_t *state = app_state_get();
-    server_config_t *srv = app_state_get_active_server();
+// Runtime state per rule
+typedef struct {
+    bool armed;                     // Ready to fire on the next crossing
+    int64_t last_fire_sec;          // Monotonic time of last firing (0 = never)
+} alert_rule_state_t;
 
-    if (!srv || !srv->alerts_enabled) return;
+// Per-server engine context (fixed size, no allocation)
+typedef struct {
+    alert_rule_t rules[ALERT_MAX_RULES];
+    alert_rule_state_t rule_state[ALERT_MAX_RULES];
+    uint8_t rule_count;
+    bool have_sample;
+    int16_t last_players;
+    int64_t last_sample_sec;
+    float rate_per_hour;            // EWMA of player change rate
+    bool was_full;                  // Seen at capacity since last slot alert
+} alert_server_ctx_t;
 
-    int players = state->runtime.current_players;
-    int max_p = state->runtime.max_players;
+static alert_server_ctx_t s_ctx[MAX_SERVERS];
+static SemaphoreHandle_t s_mutex = NULL;
 
-    // Check server full condition
-    if (players >= max_p) {
-        if (!state->ui.alert_active) {
-            buzzer_alert_threshold();
-            ESP_LOGI(TAG, "Server full alert triggered: %d/%d", players, max_p);
+// Which server/rule owns the banner, so only its re-arm hides it
+static int s_banner_server = -1;
+static int s_banner_rule = -1;
+
+static const alert_rule_t s_default_rules[] = {
+    // Priority order: the first rule that fires owns the banner
+    { ALERT_RULE_THRESHOLD, ALERT_VALUE_SERVER_MAX, ALERT_HYSTERESIS_PLAYERS,
+      ALERT_THRESHOLD_COOLDOWN_SEC, ALERT_COLOR_RED, true },
+    { ALERT_RULE_THRESHOLD, ALERT_VALUE_SERVER_THRESHOLD, ALERT_HYSTERESIS_PLAYERS,
+      ALERT_THRESHOLD_COOLDOWN_SEC, ALERT_COLOR_ORANGE, true },
+    { ALERT_RULE_SLOT_AVAILABLE, 1, 0,
+      ALERT_SLOT_COOLDOWN_SEC, ALERT_COLOR_GREEN, true },
+    { ALERT_RULE_PREDICTED_RESTART, ALERT_RESTART_LEAD_SEC, 60,
+      ALERT_RESTART_COOLDOWN_SEC, ALERT_COLOR_BLUE, true },
+    { ALERT_RULE_RATE_RISING, ALERT_RATE_PER_HOUR, ALERT_RATE_PER_HOUR / 2,
+      ALERT_RATE_COOLDOWN_SEC, ALERT_COLOR_ORANGE, true },
+    { ALERT_RULE_RATE_FALLING, ALERT_RATE_PER_HOUR, ALERT_RATE_PER_HOUR / 2,
+      ALERT_RATE_COOLDOWN_SEC, ALERT_COLOR_ORANGE, false },
+};
+
+static int64_t alert_now_sec(void) {
+    return esp_timer_get_time() / 1000000;
+}
+
+static void ctx_reset(alert_server_ctx_t *ctx, const alert_rule_t *rules, int count) {
+    memset(ctx, 0, sizeof(*ctx));
+    if (count > ALERT_MAX_RULES) count = ALERT_MAX_RULES;
+    memcpy(ctx->rules, rules, count * sizeof(alert_rule_t));
+    ctx->rule_count = count;
+    for (int i = 0; i < count; i++) {
+        ctx->rule_state[i].armed = true;
+    }
+}
+
+void alert_init(void) {
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+    for (int i = 0; i < MAX_SERVERS; i++) {
+        ctx_reset(&s_ctx[i], s_default_rules,
+                  sizeof(s_default_rules) / sizeof(s_default_rules[0]));
+    }
+    ESP_LOGI(TAG, "Alert engine initialized (%d default rules)",
+             (int)(sizeof(s_default_rules) / sizeof(s_default_rules[0])));
+}
+
+void alert_set_rules(int server_idx, const alert_rule_t *rules, int count) {
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || !rules || !s_mutex) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    ctx_reset(&s_ctx[server_idx], rules, count);
+    if (s_banner_server == server_idx) {
+        s_banner_server = -1;
+        s_banner_rule = -1;
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+void alert_reset_server(int server_idx) {
+    alert_set_rules(server_idx, s_default_rules,
+                    sizeof(s_default_rules) / sizeof(s_default_rules[0]));
+}
+
+/**
+ * Edge-triggered hysteresis: fire once when level crosses up through
+ * trigger, re-arm only after it falls back to rearm_level.
+ * Cooldown suppresses the firing but still consumes the crossing.
+ * @return true if the rule fired
+ */
+static bool rule_cross_up(alert_rule_state_t *st, const alert_rule_t *rule,
+                          float level, float trigger, float rearm_level, int64_t now) {
+    if (st->armed) {
+        if (level >= trigger) {
+            st->armed = false;
+            if (st->last_fire_sec == 0 || now - st->last_fire_sec >= rule->cooldown_sec) {
+                st->last_fire_sec = now;
+                return true;
+            }
         }
-        alert_show("SERVER FULL!", ALERT_COLOR_RED);
-        return;
+    } else if (level <= rearm_level) {
+        st->armed = true;
     }
+    return false;
+}
 
-    // Check threshold condition
-    if (srv->alert_threshold > 0 && players >= srv->alert_threshold) {
-        if (!state->ui.alert_active) {
-            buzzer_alert_threshold();
-            ESP_LOGI(TAG, "Threshold alert triggered: %d >= %d", players, srv->alert_threshold);
+/**
+ * Evaluate one rule against the latest sample
+ * @param msg Filled with the banner text when the rule fires
+ * @return true if the rule fired
+ */
+static bool rule_evaluate(alert_server_ctx_t *ctx, int rule_idx, const server_config_t *srv,
+                          int players, int max_players, int64_t now,
+                          char *msg, size_t msg_size) {
+    const alert_rule_t *rule = &ctx->rules[rule_idx];
+    alert_rule_state_t *st = &ctx->rule_state[rule_idx];
+
+    switch (rule->type) {
+        case ALERT_RULE_THRESHOLD: {
+            int level = rule->value;
+            if (level == ALERT_VALUE_SERVER_MAX) level = max_players;
+            else if (level == ALERT_VALUE_SERVER_THRESHOLD) level = srv->alert_threshold;
+            if (level <= 0) return false;
+
+            if (!rule_cross_up(st, rule, players, level, level - rule->hysteresis, now)) {
+                return false;
+            }
+            if (level == max_players) {
+                snprintf(msg, msg_size, "SERVER FULL!");
+            } else {
+                snprintf(msg, msg_size, "ALERT: %d+ players!", level);
+            }
+            ESP_LOGI(TAG, "Threshold alert: %d >= %d", players, level);
+            return true;
+        }
+
+        case ALERT_RULE_RATE_RISING:
+        case ALERT_RULE_RATE_FALLING: {
+            if (!ctx->have_sample) return false;
+            // Falling is the mirror image of rising
+            float rate = (rule->type == ALERT_RULE_RATE_RISING) ? ctx->rate_per_hour
+                                                                : -ctx->rate_per_hour;
+            if (!rule_cross_up(st, rule, rate, rule->value, rule->value - rule->hysteresis, now)) {
+                return false;
+            }
+            snprintf(msg, msg_size, "%s fast: %+d/h", rule->type == ALERT_RULE_RATE_RISING
+                     ? "Filling" : "Emptying", (int)ctx->rate_per_hour);
+            ESP_LOGI(TAG, "Rate alert: %.1f players/h", ctx->rate_per_hour);
+            return true;
         }
-        char msg[64];
-        snprintf(msg, sizeof(msg), "ALERT: %d+ players!", srv->alert_threshold);
-        alert_show(msg, ALERT_COLOR_ORANGE);
+
+        case ALERT_RULE_SLOT_AVAILABLE: {
+            // Armed only while the server has been seen full
+            if (max_players <= 0) return false;
+            if (players >= max_players) {
+                st->armed = true;
+                return false;
+            }
+            if (!st->armed || max_players - players < rule->value) return false;
+            st->armed = false;
+            if (st->last_fire_sec != 0 && now - st->last_fire_sec < rule->cooldown_sec) {
+                return false;
+            }
+            st->last_fire_sec = now;
+            snprintf(msg, msg_size, "Slot open: %d/%d", players, max_players);
+            ESP_LOGI(TAG, "Slot available alert: %d/%d", players, max_players);
+            return true;
+        }
+
+        case ALERT_RULE_PREDICTED_RESTART: {
+            int countdown = restart_get_countdown((server_config_t *)srv);
+            if (countdown <= 0) {
+                // Unknown or overdue - wait for a fresh prediction
+                if (countdown < 0) st->armed = true;
+                return false;
+            }
+            // Countdown shrinks towards the trigger, so flip the sign
+            if (!rule_cross_up(st, rule, -countdown, -rule->value,
+                               -(rule->value + rule->hysteresis), now)) {
+                return false;
+            }
+            snprintf(msg, msg_size, "Restart in ~%d min", (countdown + 59) / 60);
+            ESP_LOGI(TAG, "Predicted restart alert: %d sec", countdown);
+            return true;
+        }
+    }
+    return false;
+}
+
+// Update the smoothed player rate - O(1), one previous sample kept
+static void ctx_update_rate(alert_server_ctx_t *ctx, int players, int64_t now) {
+    if (ctx->have_sample) {
+        int64_t dt = now - ctx->last_sample_sec;
+        if (dt > ALERT_RATE_MAX_GAP_SEC) {
+            ctx->rate_per_hour = 0.0f;
+        } else if (dt > 0) {
+            float inst = (float)(players - ctx->last_players) * 3600.0f / (float)dt;
+            ctx->rate_per_hour += ALERT_RATE_EWMA_ALPHA * (inst - ctx->rate_per_hour);
+        }
+    }
+    ctx->have_sample = true;
+    ctx->last_players = players;
+    ctx->last_sample_sec = now;
+}
+
+void alert_process_sample(int server_idx, int players, int max_players) {
+    app_state_t *state = app_state_get();
+
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || players < 0 || !s_mutex) return;
+    if (server_idx >= state->settings.server_count) return;
+
+    const server_config_t *srv = &state->settings.servers[server_idx];
+    int64_t now = alert_now_sec();
+
+    char msg[64] = {0};
+    uint32_t color = 0;
+    int fired_rule = -1;
+    alert_rule_type_t fired_type = ALERT_RULE_THRESHOLD;
+    bool hide_banner = false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    alert_server_ctx_t *ctx = &s_ctx[server_idx];
+
+    if (!srv->alerts_enabled) {
+        // Keep the rate estimate warm so re-enabling does not misfire
+        ctx_update_rate(ctx, players, now);
+        xSemaphoreGive(s_mutex);
         return;
     }
 
-    // No alert condition - hide if currently showing
-    if (state->ui.alert_active) {
+    // Rate rules read the previous sample, so evaluate after updating it
+    ctx_update_rate(ctx, players, now);
+
+    for (int i = 0; i < ctx->rule_count; i++) {
+        if (!ctx->rules[i].enabled) continue;
+
+        char rule_msg[48];
+        bool was_armed = ctx->rule_state[i].armed;
+        bool fired = rule_evaluate(ctx, i, srv, players, max_players, now,
+                                   rule_msg, sizeof(rule_msg));
+
+        if (fired && fired_rule < 0) {
+            fired_rule = i;
+            color = ctx->rules[i].color_hex;
+            if (server_idx == state->settings.active_server_index) {
+                snprintf(msg, sizeof(msg), "%s", rule_msg);
+            } else {
+                // Secondary servers: prefix the (shortened) server name
+                snprintf(msg, sizeof(msg), "%.14s: %s", srv->display_name, rule_msg);
+            }
+        }
+
+        // Owning rule re-armed -> condition cleared, drop its banner
+        if (!was_armed && ctx->rule_state[i].armed &&
+            s_banner_server == server_idx && s_banner_rule == i) {
+            hide_banner = true;
+            s_banner_server = -1;
+            s_banner_rule = -1;
+        }
+    }
+
+    if (fired_rule >= 0) {
+        s_banner_server = server_idx;
+        s_banner_rule = fired_rule;
+        fired_type = ctx->rules[fired_rule].type;   // Rules may change once unlocked
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    // Side effects outside the engine lock
+    if (fired_rule >= 0) {
+        if (fired_type == ALERT_RULE_PREDICTED_RESTART) {
+            buzzer_alert_restart();
+        } else {
+            buzzer_alert_threshold();
+        }
+        alert_show(msg, color);
+    } else if (hide_banner && state->ui.alert_active) {
         alert_hide();
     }
 }
@@ -1,6 +1,6 @@
 /**
  * DayZ Server Tracker - Alert Manager
- * Handles player threshold alerts and visual notifications
+ * Rule-based alert engine evaluated per server as samples arrive
  *
  * This is the SERVICE layer - contains alert LOGIC only.
  * No LVGL dependencies - UI rendering is handled by ui/ui_alerts.c
@@ -12,11 +12,58 @@
 #include <stdbool.h>
 #include <stdint.h>
 
+// Rule types
+typedef enum {
+    ALERT_RULE_THRESHOLD = 0,       // Players >= value, re-arm below value - hysteresis
+    ALERT_RULE_RATE_RISING,         // Smoothed growth >= value players/hour
+    ALERT_RULE_RATE_FALLING,        // Smoothed decline >= value players/hour
+    ALERT_RULE_SLOT_AVAILABLE,      // Server was full, now >= value free slots
+    ALERT_RULE_PREDICTED_RESTART    // Predicted restart within value seconds
+} alert_rule_type_t;
+
+// Special THRESHOLD values resolved against the server at evaluation time
+#define ALERT_VALUE_SERVER_THRESHOLD    0   // Use server_config_t.alert_threshold
+#define ALERT_VALUE_SERVER_MAX          -1  // Use current max players (server full)
+
+// Alert rule definition
+typedef struct {
+    alert_rule_type_t type;
+    int32_t value;                  // Meaning depends on type (see above)
+    int32_t hysteresis;             // Distance back past value before re-arming
+    uint16_t cooldown_sec;          // Minimum time between two firings
+    uint32_t color_hex;             // Banner color
+    bool enabled;
+} alert_rule_t;
+
+/**
+ * Initialize alert engine (default rules for every server slot)
+ * Call once at startup before any fetch task runs
+ */
+void alert_init(void);
+
+/**
+ * Feed a new player sample for a server and evaluate its rules
+ * Safe to call from any task; O(1) per sample.
+ * @param server_idx Index into settings.servers
+ * @param players Current player count
+ * @param max_players Current server capacity
+ */
+void alert_process_sample(int server_idx, int players, int max_players);
+
+/**
+ * Replace the rule set of a server (resets its rule state)
+ * @param server_idx Index into settings.servers
+ * @param rules Rules in priority order (first firing rule owns the banner)
+ * @param count Number of rules (clamped to ALERT_MAX_RULES)
+ */
+void alert_set_rules(int server_idx, const alert_rule_t *rules, int count);
+
 /**
- * Check current player count against thresholds and show alerts if needed
- * Should be called after each server query
+ * Reset a server's rules to defaults and clear its runtime state
+ * Call when a server slot is reassigned
+ * @param server_idx Index into settings.servers
  */
-void alert_check(void);
+void alert_reset_server(int server_idx);
 
 /**
  * Show an alert banner at the top of the screen
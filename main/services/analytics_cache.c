@@ -0,0 +1,278 @@
+/**
+ * DayZ Server Tracker - Analytics Cache Implementation
+ *
+ * The 2h trend uses a ring of 10-minute slots (last sample per slot), so
+ * memory is fixed per server regardless of poll interval. Forecast peak
+ * and restart ETA are recomputed on ingest, the render path only copies.
+ */
+
+#include "analytics_cache.h"
+#include "config.h"
+#include "app_state.h"
+#include "forecast.h"
+#include "restart_manager.h"
+#include "storage_config.h"
+#include "storage_paths.h"
+#include "drivers/sd_card.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "analytics";
+
+#define TREND_SLOTS     (ANALYTICS_TREND_WINDOW_SEC / ANALYTICS_TREND_SLOT_SEC + 1)
+
+// Per-server cache entry
+typedef struct {
+    analytics_summary_t summary;
+    uint32_t slot_key[TREND_SLOTS];     // ts / ANALYTICS_TREND_SLOT_SEC (0 = empty)
+    int16_t slot_players[TREND_SLOTS];
+} analytics_entry_t;
+
+// Snapshot file record (matched by server ID on load)
+typedef struct {
+    char server_id[32];
+    analytics_summary_t summary;
+} analytics_snapshot_rec_t;
+
+typedef struct {
+    uint32_t magic;
+    uint16_t count;
+    uint16_t rec_size;
+} analytics_snapshot_hdr_t;
+
+static analytics_entry_t s_entries[MAX_SERVERS];
+static SemaphoreHandle_t s_mutex = NULL;
+static uint32_t s_last_snapshot_ts = 0;
+static bool s_snapshot_busy = false;
+
+void analytics_cache_init(void) {
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+    memset(s_entries, 0, sizeof(s_entries));
+    ESP_LOGI(TAG, "Analytics cache initialized (%d bytes)", (int)sizeof(s_entries));
+}
+
+void analytics_cache_load_snapshot(void) {
+    if (!s_mutex || !sd_card_is_mounted() || !sd_card_lease()) return;
+
+    char path[STORAGE_PATH_MAX_LEN];
+    storage_path_analytics(path, sizeof(path));
+
+    FILE *f = fopen(path, "rb");
+    if (!f) {
+        sd_card_release();
+        return;
+    }
+
+    analytics_snapshot_hdr_t hdr;
+    analytics_snapshot_rec_t recs[MAX_SERVERS];
+    int n = 0;
+    if (fread(&hdr, sizeof(hdr), 1, f) == 1 &&
+        hdr.magic == STORAGE_ANALYTICS_MAGIC &&
+        hdr.rec_size == sizeof(analytics_snapshot_rec_t)) {
+        int want = hdr.count < MAX_SERVERS ? hdr.count : MAX_SERVERS;
+        n = (int)fread(recs, sizeof(analytics_snapshot_rec_t), want, f);
+    }
+    fclose(f);
+    sd_card_release();
+
+    app_state_t *state = app_state_get();
+    int restored = 0;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < n; i++) {
+        recs[i].server_id[sizeof(recs[i].server_id) - 1] = '\0';
+        if (!recs[i].summary.valid) continue;
+
+        for (int s = 0; s < state->settings.server_count; s++) {
+            if (strcmp(state->settings.servers[s].server_id, recs[i].server_id) == 0 &&
+                !s_entries[s].summary.valid) {
+                s_entries[s].summary = recs[i].summary;
+                s_entries[s].summary.stale = true;
+                restored++;
+                break;
+            }
+        }
+    }
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "Restored %d server summaries from snapshot", restored);
+}
+
+/**
+ * Write all summaries to SD (runs on the fetch task that hit the interval)
+ */
+static void analytics_save_snapshot(void) {
+    app_state_t *state = app_state_get();
+    analytics_snapshot_hdr_t hdr = {
+        .magic = STORAGE_ANALYTICS_MAGIC,
+        .count = 0,
+        .rec_size = sizeof(analytics_snapshot_rec_t),
+    };
+    analytics_snapshot_rec_t recs[MAX_SERVERS];
+    memset(recs, 0, sizeof(recs));
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    for (int i = 0; i < state->settings.server_count && i < MAX_SERVERS; i++) {
+        strncpy(recs[i].server_id, state->settings.servers[i].server_id,
+                sizeof(recs[i].server_id) - 1);
+        recs[i].summary = s_entries[i].summary;
+        hdr.count++;
+    }
+    xSemaphoreGive(s_mutex);
+
+    char path[STORAGE_PATH_MAX_LEN];
+    storage_path_analytics(path, sizeof(path));
+
+    if (!sd_card_lease()) return;
+    FILE *f = fopen(path, "wb");
+    if (!f) {
+        ESP_LOGW(TAG, "Failed to open snapshot for writing: %s", path);
+        sd_card_release();
+        return;
+    }
+    fwrite(&hdr, sizeof(hdr), 1, f);
+    fwrite(recs, sizeof(analytics_snapshot_rec_t), hdr.count, f);
+    fclose(f);
+    sd_card_release();
+}
+
+/**
+ * Record a sample in the trend ring and return the 2h delta
+ * @return true if a sample from ~2h ago exists
+ */
+static bool entry_update_trend(analytics_entry_t *e, uint32_t ts, int players, int16_t *delta) {
+    uint32_t key = ts / ANALYTICS_TREND_SLOT_SEC;
+    int idx = key % TREND_SLOTS;
+    e->slot_key[idx] = key;
+    e->slot_players[idx] = (int16_t)players;
+
+    // Slot exactly 2h back, else one slot newer (irregular polling)
+    uint32_t back = ANALYTICS_TREND_WINDOW_SEC / ANALYTICS_TREND_SLOT_SEC;
+    for (uint32_t k = back; k >= back - 1; k--) {
+        int j = (key - k) % TREND_SLOTS;
+        if (e->slot_key[j] == key - k) {
+            *delta = (int16_t)(players - e->slot_players[j]);
+            return true;
+        }
+    }
+    return false;
+}
+
+void analytics_cache_process_sample(int server_idx, uint32_t ts, int players,
+                                    int max_players, bool online) {
+    app_state_t *state = app_state_get();
+
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || players < 0 || !s_mutex) return;
+    if (server_idx >= state->settings.server_count) return;
+    if (ts < STORAGE_TIMESTAMP_MIN_VALID) return;
+
+    server_config_t *srv = &state->settings.servers[server_idx];
+
+    // Derived metrics from other services, gathered before taking our lock
+    uint32_t peak_ts = 0;
+    int peak_players = 0;
+    bool has_peak = forecast_get_peak(server_idx, ts, &peak_ts, &peak_players);
+    int countdown = restart_get_countdown(srv);
+    int confidence = restart_get_confidence(srv);
+
+    bool save_snapshot = false;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    analytics_entry_t *e = &s_entries[server_idx];
+    analytics_summary_t *s = &e->summary;
+
+    int16_t delta = 0;
+    s->has_trend = entry_update_trend(e, ts, players, &delta);
+    s->trend_2h = delta;
+
+    s->valid = true;
+    s->stale = false;
+    s->online = online;
+    s->updated_ts = ts;
+    s->players = (int16_t)players;
+    s->max_players = (int16_t)max_players;
+    s->has_peak = has_peak;
+    s->peak_players = has_peak ? (int16_t)peak_players : 0;
+    s->peak_ts = has_peak ? peak_ts : 0;
+    s->next_restart_ts = countdown >= 0 ? ts + (uint32_t)countdown : 0;
+    s->restart_confidence = (uint8_t)confidence;
+
+    if (!s_snapshot_busy && ts - s_last_snapshot_ts >= ANALYTICS_SNAPSHOT_INTERVAL_SEC) {
+        s_snapshot_busy = true;
+        s_last_snapshot_ts = ts;
+        save_snapshot = true;
+    }
+
+    xSemaphoreGive(s_mutex);
+
+    if (save_snapshot) {
+        if (sd_card_is_mounted()) {
+            analytics_save_snapshot();
+        }
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_snapshot_busy = false;
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+bool analytics_cache_get(int server_idx, analytics_summary_t *out) {
+    if (!out) return false;
+    memset(out, 0, sizeof(*out));
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || !s_mutex) return false;
+
+    // Called from the UI with LVGL locked - never wait on a writer
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+    *out = s_entries[server_idx].summary;
+    xSemaphoreGive(s_mutex);
+    return out->valid;
+}
+
+static int rank_score(const analytics_summary_t *s) {
+    if (!s->valid) return -2;
+    if (!s->online) return -1;
+    return s->players;
+}
+
+int analytics_cache_get_ranking(int *order, int max) {
+    app_state_t *state = app_state_get();
+    if (!order || max <= 0 || !s_mutex) return 0;
+
+    int n = state->settings.server_count;
+    if (n > max) n = max;
+    if (n > MAX_SERVERS) n = MAX_SERVERS;
+
+    int score[MAX_SERVERS];
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(10)) == pdTRUE) {
+        for (int i = 0; i < n; i++) {
+            score[i] = rank_score(&s_entries[i].summary);
+        }
+        xSemaphoreGive(s_mutex);
+    } else {
+        memset(score, 0, sizeof(score));
+    }
+
+    // Insertion sort - at most MAX_SERVERS entries, stable for ties
+    for (int i = 0; i < n; i++) {
+        int j = i;
+        while (j > 0 && score[order[j - 1]] < score[i]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = i;
+    }
+    return n;
+}
+
+void analytics_cache_reset_server(int server_idx) {
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || !s_mutex) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memset(&s_entries[server_idx], 0, sizeof(analytics_entry_t));
+    xSemaphoreGive(s_mutex);
+}
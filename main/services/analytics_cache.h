@@ -0,0 +1,83 @@
+/**
+ * DayZ Server Tracker - Analytics Cache
+ * Per-server summary metrics kept up to date on ingest
+ *
+ * Both fetch tasks push every sample through analytics_cache_process_sample(),
+ * which refreshes current players, 2h trend, forecast peak and restart ETA.
+ * Readers (comparison screen) only copy from RAM - never touch storage.
+ * A small snapshot on SD lets the cache show last-known values right
+ * after boot, before the first fetch completes.
+ */
+
+#ifndef ANALYTICS_CACHE_H
+#define ANALYTICS_CACHE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Summary of one server
+typedef struct {
+    bool valid;                     // Has at least one sample
+    bool stale;                     // Restored from snapshot, not refreshed yet
+    bool online;
+    uint32_t updated_ts;            // Unix time of last sample
+    int16_t players;
+    int16_t max_players;
+    bool has_trend;
+    int16_t trend_2h;               // Players now minus ~2h ago
+    bool has_peak;
+    int16_t peak_players;           // Expected peak in next 24h
+    uint32_t peak_ts;               // Start of the peak hour (Unix)
+    uint32_t next_restart_ts;       // Predicted next restart (0 = unknown)
+    uint8_t restart_confidence;     // 0-100
+} analytics_summary_t;
+
+/**
+ * Initialize analytics cache
+ * Call once at startup before any fetch task runs
+ */
+void analytics_cache_init(void);
+
+/**
+ * Restore last-known summaries from the SD snapshot
+ * Call once after the SD card is mounted; entries are matched by server ID.
+ */
+void analytics_cache_load_snapshot(void);
+
+/**
+ * Refresh a server's summary from a new sample
+ * Call after restart/forecast processing for the same sample.
+ * @param server_idx Index into settings.servers
+ * @param ts Unix timestamp
+ * @param players Current player count
+ * @param max_players Current server capacity
+ * @param online Server online flag
+ */
+void analytics_cache_process_sample(int server_idx, uint32_t ts, int players,
+                                    int max_players, bool online);
+
+/**
+ * Get a copy of one server's summary (non-blocking for UI use)
+ * @param server_idx Index into settings.servers
+ * @param out Output summary
+ * @return true if out->valid
+ */
+bool analytics_cache_get(int server_idx, analytics_summary_t *out);
+
+/**
+ * Get server indices ranked for the comparison view
+ * Online servers with data first, by current players (busiest first).
+ * @param order Output server indices
+ * @param max Size of order
+ * @return Number of indices written (= configured servers)
+ */
+int analytics_cache_get_ranking(int *order, int max);
+
+/**
+ * Clear a server's summary
+ * Call when a server slot is reassigned
+ * @param server_idx Index into settings.servers
+ */
+void analytics_cache_reset_server(int server_idx);
+
+#endif // ANALYTICS_CACHE_H
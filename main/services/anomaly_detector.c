@@ -0,0 +1,258 @@
+/**
+ * DayZ Server Tracker - Anomaly Detector Implementation
+ *
+ * Per sample:
+ *   residual = players - baseline (seasonal profile, else slow EWMA level)
+ *   z        = (residual - mean) / max(stddev, ANOMALY_MIN_STD)
+ * |z| >= ANOMALY_Z_ENTER for ANOMALY_CONFIRM_SAMPLES samples starts an
+ * anomaly, |z| < ANOMALY_Z_EXIT ends it. A large one-sample step down
+ * starts a DROP immediately (DDoS / crash). Samples shortly after a
+ * detected restart are masked, restarts have their own tracking.
+ */
+
+#include "anomaly_detector.h"
+#include "config.h"
+#include "app_state.h"
+#include "forecast.h"
+#include "history_store.h"
+#include "alert_manager.h"
+#include "restart_manager.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "anomaly";
+
+// Banner colors (hex values, no LVGL dependency)
+#define ANOMALY_COLOR_DROP  0xFF4444
+#define ANOMALY_COLOR_SURGE 0x4488FF
+#define ANOMALY_COLOR_FULL  0xFF8800
+
+// Per-server detector state (fixed size, no allocation)
+typedef struct {
+    float level;                    // Fallback baseline: slow EWMA of players
+    float resid_mean;               // EWMA of residual against the baseline
+    float resid_var;                // EWMA of squared deviation
+    uint32_t last_ts;
+    int16_t last_players;
+    uint16_t samples;               // Samples seen (saturates)
+    uint8_t pending;                // Candidate anomaly awaiting confirmation
+    uint8_t pending_count;
+    uint8_t active;                 // anomaly_type_t in progress
+    uint32_t active_since;
+} anomaly_ctx_t;
+
+// Side effect decided under the lock, performed after it
+typedef struct {
+    anomaly_type_t started;
+    anomaly_type_t ended;
+    float expected;
+    float z;
+    uint32_t duration_sec;
+} anomaly_event_t;
+
+static anomaly_ctx_t s_ctx[MAX_SERVERS];
+static SemaphoreHandle_t s_mutex = NULL;
+
+const char* anomaly_type_to_str(anomaly_type_t type) {
+    switch (type) {
+        case ANOMALY_DROP:  return "drop";
+        case ANOMALY_SURGE: return "surge";
+        case ANOMALY_FULL:  return "full";
+        default:            return "none";
+    }
+}
+
+void anomaly_init(void) {
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+    memset(s_ctx, 0, sizeof(s_ctx));
+    ESP_LOGI(TAG, "Anomaly detector initialized (%d bytes/server)", (int)sizeof(anomaly_ctx_t));
+}
+
+/**
+ * One-sample step down that is large in absolute, relative and
+ * statistical terms (consecutive-sample noise is sqrt(2) * sd)
+ */
+static bool is_step_drop(const anomaly_ctx_t *ctx, int players, float sd) {
+    int drop = ctx->last_players - players;
+    return drop >= ANOMALY_STEP_DROP_MIN &&
+           drop * 100 >= ctx->last_players * ANOMALY_STEP_DROP_PCT &&
+           (float)drop >= ANOMALY_Z_ENTER * 1.414f * sd;
+}
+
+/**
+ * Fold a residual into the running statistics
+ * Deviations are clipped to the exit band and the variance is frozen
+ * while a sample is out of the entry band, so an anomaly neither widens
+ * the band nor drags the mean far; a lasting level change is still
+ * absorbed over hours. The first samples use a running average so the
+ * statistics warm up fast.
+ */
+static void ctx_update_stats(anomaly_ctx_t *ctx, float resid, float sd, uint32_t dt) {
+    if (ctx->samples == 0) {
+        ctx->resid_mean = resid;
+        ctx->resid_var = ANOMALY_MIN_STD * ANOMALY_MIN_STD;
+        return;
+    }
+
+    float d = resid - ctx->resid_mean;
+    bool outlier = fabsf(d) >= ANOMALY_Z_ENTER * sd;
+    float lim = ANOMALY_Z_EXIT * sd;
+    if (d > lim) d = lim;
+    if (d < -lim) d = -lim;
+
+    float a = 1.0f - expf(-(float)dt / ANOMALY_BASELINE_TAU_SEC);
+    float warm = 1.0f / (ctx->samples + 1);
+    if (warm > a) a = warm;
+
+    ctx->resid_mean += a * d;
+    if (!outlier || ctx->samples < ANOMALY_WARMUP_SAMPLES) {
+        ctx->resid_var = (1.0f - a) * (ctx->resid_var + a * d * d);
+    }
+}
+
+void anomaly_process_sample(int server_idx, uint32_t ts, int players, int max_players) {
+    app_state_t *state = app_state_get();
+
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || players < 0 || !s_mutex) return;
+    if (server_idx >= state->settings.server_count) return;
+    if (ts < STORAGE_TIMESTAMP_MIN_VALID) return;
+
+    const server_config_t *srv = &state->settings.servers[server_idx];
+
+    // Restarts are expected drops, tracked by restart_manager instead
+    restart_history_t rh;
+    restart_snapshot(srv, &rh);
+    uint32_t last_restart = rh.last_restart_time;
+    bool masked = last_restart != 0 && ts >= last_restart &&
+                  ts - last_restart < ANOMALY_RESTART_MASK_SEC;
+
+    // Baseline lookup takes the forecast lock - do it before ours
+    float seasonal = 0.0f;
+    bool have_season = forecast_get_seasonal(server_idx, ts, &seasonal);
+
+    anomaly_event_t ev = { .started = ANOMALY_NONE, .ended = ANOMALY_NONE };
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+
+    anomaly_ctx_t *ctx = &s_ctx[server_idx];
+    if (ctx->last_ts != 0 && ts <= ctx->last_ts) {
+        xSemaphoreGive(s_mutex);
+        return;
+    }
+
+    uint32_t dt = ctx->last_ts ? ts - ctx->last_ts : 0;
+    bool gap = ctx->last_ts == 0 || dt > ANOMALY_GAP_SEC;
+
+    float baseline = have_season ? seasonal : (ctx->samples ? ctx->level : (float)players);
+    float resid = (float)players - baseline;
+    float sd = sqrtf(ctx->resid_var);
+    if (sd < ANOMALY_MIN_STD) sd = ANOMALY_MIN_STD;
+    float z = (resid - ctx->resid_mean) / sd;
+
+    // Classify this sample
+    anomaly_type_t candidate = ANOMALY_NONE;
+    bool immediate = false;
+    if (ctx->samples >= ANOMALY_WARMUP_SAMPLES && !masked) {
+        if (!gap && z <= -ANOMALY_Z_EXIT && is_step_drop(ctx, players, sd)) {
+            candidate = ANOMALY_DROP;
+            immediate = true;
+        } else if (z <= -ANOMALY_Z_ENTER) {
+            candidate = ANOMALY_DROP;
+        } else if (z >= ANOMALY_Z_ENTER) {
+            candidate = (max_players > 0 && players >= max_players) ? ANOMALY_FULL : ANOMALY_SURGE;
+        }
+    }
+
+    if (ctx->active == ANOMALY_NONE) {
+        if (candidate == ANOMALY_NONE) {
+            ctx->pending = ANOMALY_NONE;
+            ctx->pending_count = 0;
+        } else if (immediate ||
+                   (ctx->pending == candidate && ctx->pending_count + 1 >= ANOMALY_CONFIRM_SAMPLES)) {
+            ctx->active = candidate;
+            ctx->active_since = ts;
+            ctx->pending = ANOMALY_NONE;
+            ctx->pending_count = 0;
+            ev.started = candidate;
+        } else if (ctx->pending == candidate) {
+            ctx->pending_count++;
+        } else {
+            ctx->pending = candidate;
+            ctx->pending_count = 1;
+        }
+    } else if (masked || fabsf(z) < ANOMALY_Z_EXIT) {
+        ev.ended = ctx->active;
+        ev.duration_sec = ts - ctx->active_since;
+        ctx->active = ANOMALY_NONE;
+    }
+
+    ctx_update_stats(ctx, resid, sd, gap ? ANOMALY_GAP_SEC : dt);
+
+    float la = gap ? 1.0f : 1.0f - expf(-(float)dt / ANOMALY_LEVEL_TAU_SEC);
+    ctx->level += la * ((float)players - ctx->level);
+
+    if (ctx->samples < UINT16_MAX) ctx->samples++;
+    ctx->last_ts = ts;
+    ctx->last_players = (int16_t)players;
+
+    ev.expected = baseline + ctx->resid_mean;
+    ev.z = z;
+
+    xSemaphoreGive(s_mutex);
+
+    // Side effects outside the detector lock
+    if (ev.started != ANOMALY_NONE) {
+        const char *kind = anomaly_type_to_str(ev.started);
+        ESP_LOGW(TAG, "Server %d: %s anomaly, %d players (expected ~%.0f, z=%.1f)",
+                 server_idx, kind, players, ev.expected, ev.z);
+
+        if (history_json_writable()) {
+            history_append_annotation_json(server_idx, ts, kind, (int16_t)players, ev.expected, ev.z);
+        }
+
+        if (srv->alerts_enabled) {
+            static const char *titles[] = { "", "Sudden drop", "Player surge", "Full, queue likely" };
+            static const uint32_t colors[] = { 0, ANOMALY_COLOR_DROP, ANOMALY_COLOR_SURGE,
+                                               ANOMALY_COLOR_FULL };
+            char msg[64];
+            if (server_idx == state->settings.active_server_index) {
+                snprintf(msg, sizeof(msg), "%s: %d (usual ~%.0f)",
+                         titles[ev.started], players, ev.expected);
+            } else {
+                snprintf(msg, sizeof(msg), "%.14s: %s %d",
+                         srv->display_name, titles[ev.started], players);
+            }
+            alert_show(msg, colors[ev.started]);
+        }
+    } else if (ev.ended != ANOMALY_NONE) {
+        ESP_LOGI(TAG, "Server %d: %s anomaly ended after %lu s",
+                 server_idx, anomaly_type_to_str(ev.ended), (unsigned long)ev.duration_sec);
+
+        if (history_json_writable()) {
+            history_append_annotation_json(server_idx, ts, "end", (int16_t)players, ev.expected, ev.z);
+        }
+    }
+}
+
+anomaly_type_t anomaly_get_active(int server_idx) {
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || !s_mutex) return ANOMALY_NONE;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    anomaly_type_t active = (anomaly_type_t)s_ctx[server_idx].active;
+    xSemaphoreGive(s_mutex);
+    return active;
+}
+
+void anomaly_reset_server(int server_idx) {
+    if (server_idx < 0 || server_idx >= MAX_SERVERS || !s_mutex) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    memset(&s_ctx[server_idx], 0, sizeof(anomaly_ctx_t));
+    xSemaphoreGive(s_mutex);
+}
@@ -0,0 +1,63 @@
+/**
+ * DayZ Server Tracker - Anomaly Detector
+ * Streaming per-server detection of unusual player counts
+ * (DDoS drops, wipe-day surges, queue buildup at capacity)
+ *
+ * Each sample is compared against the seasonal baseline from the forecast
+ * service (or a slow moving level until that is ready). The residual is
+ * tracked with a winsorized EWMA mean/variance, so an anomaly does not
+ * teach the detector that it is normal. Constant memory per server.
+ */
+
+#ifndef ANOMALY_DETECTOR_H
+#define ANOMALY_DETECTOR_H
+
+#include <stdint.h>
+
+// Anomaly types
+typedef enum {
+    ANOMALY_NONE = 0,
+    ANOMALY_DROP,               // Far below baseline or sudden step down
+    ANOMALY_SURGE,              // Far above baseline
+    ANOMALY_FULL                // Surge that hit capacity (queue building)
+} anomaly_type_t;
+
+/**
+ * Initialize anomaly detector (clears every server)
+ * Call once at startup before any fetch task runs
+ */
+void anomaly_init(void);
+
+/**
+ * Feed a new sample for a server
+ * Call after restart_process_sample() so fresh restarts are masked.
+ * Safe to call from any task; O(1) per sample.
+ * @param server_idx Index into settings.servers
+ * @param ts Unix timestamp
+ * @param players Current player count
+ * @param max_players Current server capacity
+ */
+void anomaly_process_sample(int server_idx, uint32_t ts, int players, int max_players);
+
+/**
+ * Get the anomaly currently in progress for a server
+ * @param server_idx Index into settings.servers
+ * @return Active anomaly type, or ANOMALY_NONE
+ */
+anomaly_type_t anomaly_get_active(int server_idx);
+
+/**
+ * Short name of an anomaly type (used in history annotations)
+ * @param type Anomaly type
+ * @return Static string, e.g. "drop"
+ */
+const char* anomaly_type_to_str(anomaly_type_t type);
+
+/**
+ * Clear a server's detector state
+ * Call when a server slot is reassigned
+ * @param server_idx Index into settings.servers
+ */
+void anomaly_reset_server(int server_idx);
+
+#endif // ANOMALY_DETECTOR_H
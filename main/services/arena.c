@@ -0,0 +1,244 @@
+/**
+ * DayZ Server Tracker - Memory Arenas Implementation
+ *
+ * Each block carries a 16-byte header (arena, origin, size) so
+ * arena_free() needs only the pointer. Accounting uses relaxed atomics;
+ * allocation itself is the ESP-IDF heap, which does its own locking.
+ */
+
+#include "arena.h"
+#include "config.h"
+#include "metrics.h"
+#include "esp_log.h"
+#include "esp_heap_caps.h"
+#include "cJSON.h"
+#include <string.h>
+
+static const char *TAG = "arena";
+
+#define ARENA_MAGIC         0xA7E4A001
+#define ARENA_MAGIC_FREED   0xA7E4DEAD
+
+typedef enum {
+    ORIGIN_HEAP = 0,
+    ORIGIN_RESERVE,         // The arena's boot-time block
+} block_origin_t;
+
+typedef struct {
+    uint32_t magic;
+    uint8_t arena;
+    uint8_t origin;
+    uint16_t reserved;
+    uint32_t size;          // Requested bytes (without header)
+    uint32_t pad;
+} arena_hdr_t;
+
+_Static_assert(sizeof(arena_hdr_t) == 16, "arena header must keep 16-byte spacing");
+
+static const char *s_names[ARENA_COUNT] = { "bulk", "scratch", "dma" };
+
+static arena_stats_t s_stats[ARENA_COUNT];
+
+// Boot-time blocks incl. header room, one holder each (BULK has none)
+static uint8_t *s_reserve[ARENA_COUNT];
+static size_t s_reserve_size[ARENA_COUNT];
+static bool s_reserve_busy[ARENA_COUNT];
+
+// ============== ACCOUNTING ==============
+
+static void account_alloc(arena_id_t arena, uint32_t size, bool spilled, bool overflow) {
+    arena_stats_t *st = &s_stats[arena];
+    uint32_t now = __atomic_add_fetch(&st->in_use, size, __ATOMIC_RELAXED);
+    uint32_t peak = __atomic_load_n(&st->peak, __ATOMIC_RELAXED);
+    while (now > peak &&
+           !__atomic_compare_exchange_n(&st->peak, &peak, now, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+    __atomic_add_fetch(&st->allocs, 1, __ATOMIC_RELAXED);
+    if (overflow) __atomic_add_fetch(&st->overflows, 1, __ATOMIC_RELAXED);
+    if (spilled) {
+        __atomic_add_fetch(&st->spills, 1, __ATOMIC_RELAXED);
+        metrics_count(METRIC_CNT_ARENA_SPILLS);
+    }
+    metrics_gauge_set((metric_gauge_t)(METRIC_G_ARENA_BULK + arena), (int32_t)now);
+}
+
+static void account_free(arena_id_t arena, uint32_t size) {
+    uint32_t now = __atomic_sub_fetch(&s_stats[arena].in_use, size, __ATOMIC_RELAXED);
+    metrics_gauge_set((metric_gauge_t)(METRIC_G_ARENA_BULK + arena), (int32_t)now);
+}
+
+static void account_failure(arena_id_t arena, size_t size, const char *owner) {
+    __atomic_add_fetch(&s_stats[arena].failures, 1, __ATOMIC_RELAXED);
+    metrics_count(METRIC_CNT_ARENA_FAILURES);
+    ESP_LOGE(TAG, "%s: %u bytes for %s failed (PSRAM free %u, internal block %u)",
+             s_names[arena], (unsigned)size, owner ? owner : "?",
+             (unsigned)heap_caps_get_free_size(MALLOC_CAP_SPIRAM),
+             (unsigned)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+}
+
+// ============== PLACEMENT ==============
+
+// Internal RAM only while WiFi/TLS keep a comfortable contiguous block
+static bool internal_has_room(size_t total) {
+    return heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL) >= total + ARENA_INTERNAL_HEADROOM;
+}
+
+// The arena's reserved block if it is free and big enough
+static arena_hdr_t *take_reserve(arena_id_t arena, size_t total) {
+    if (!s_reserve[arena] || total > s_reserve_size[arena]) return NULL;
+    if (__atomic_exchange_n(&s_reserve_busy[arena], true, __ATOMIC_ACQUIRE)) return NULL;
+    return (arena_hdr_t *)s_reserve[arena];
+}
+
+static void *psram_or_spill(size_t total, bool *spilled) {
+    void *p = heap_caps_malloc(total, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (!p && internal_has_room(total)) {
+        p = heap_caps_malloc(total, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+        if (p) *spilled = true;
+    }
+    return p;
+}
+
+void *arena_alloc(arena_id_t arena, size_t size, const char *owner) {
+    if ((unsigned)arena >= ARENA_COUNT || size == 0 || size > UINT32_MAX - sizeof(arena_hdr_t)) {
+        return NULL;
+    }
+
+    size_t total = size + sizeof(arena_hdr_t);
+    arena_hdr_t *hdr = NULL;
+    block_origin_t origin = ORIGIN_HEAP;
+    bool spilled = false;
+    bool overflow = false;
+
+    switch (arena) {
+        case ARENA_SCRATCH:
+            hdr = take_reserve(arena, total);
+            if (hdr) {
+                origin = ORIGIN_RESERVE;
+                break;
+            }
+            // Block taken or too small - PSRAM heap
+            overflow = true;
+            hdr = psram_or_spill(total, &spilled);
+            break;
+
+        case ARENA_BULK:
+            hdr = psram_or_spill(total, &spilled);
+            break;
+
+        case ARENA_DMA:
+            hdr = take_reserve(arena, total);
+            if (hdr) {
+                origin = ORIGIN_RESERVE;
+                break;
+            }
+            overflow = true;
+            hdr = heap_caps_malloc(total, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+            break;
+
+        default:
+            break;
+    }
+
+    if (!hdr) {
+        account_failure(arena, size, owner);
+        return NULL;
+    }
+
+    hdr->magic = ARENA_MAGIC;
+    hdr->arena = (uint8_t)arena;
+    hdr->origin = (uint8_t)origin;
+    hdr->size = (uint32_t)size;
+    account_alloc(arena, (uint32_t)size, spilled, overflow);
+    if (spilled) {
+        ESP_LOGW(TAG, "%s: %u bytes for %s spilled to internal RAM", s_names[arena],
+                 (unsigned)size, owner ? owner : "?");
+    }
+    return hdr + 1;
+}
+
+void *arena_calloc(arena_id_t arena, size_t n, size_t size, const char *owner) {
+    if (size && n > SIZE_MAX / size) return NULL;
+    void *p = arena_alloc(arena, n * size, owner);
+    if (p) memset(p, 0, n * size);
+    return p;
+}
+
+void arena_free(void *ptr) {
+    if (!ptr) return;
+
+    arena_hdr_t *hdr = (arena_hdr_t *)ptr - 1;
+    if (hdr->magic != ARENA_MAGIC || hdr->arena >= ARENA_COUNT) {
+        ESP_LOGE(TAG, "Free of a block not from an arena (%p)", ptr);
+        return;
+    }
+    hdr->magic = ARENA_MAGIC_FREED;
+    account_free((arena_id_t)hdr->arena, hdr->size);
+
+    if (hdr->origin == ORIGIN_RESERVE) {
+        __atomic_store_n(&s_reserve_busy[hdr->arena], false, __ATOMIC_RELEASE);
+    } else {
+        heap_caps_free(hdr);
+    }
+}
+
+// ============== cJSON ==============
+
+// Parse trees are thousands of small nodes - keep them out of internal RAM
+static void *json_malloc(size_t size) {
+    void *p = heap_caps_malloc(size, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    return p ? p : heap_caps_malloc(size, MALLOC_CAP_8BIT);
+}
+
+static void json_free(void *ptr) {
+    heap_caps_free(ptr);
+}
+
+static void reserve(arena_id_t arena, size_t bytes, uint32_t caps) {
+    s_reserve_size[arena] = bytes + sizeof(arena_hdr_t);
+    s_reserve[arena] = heap_caps_malloc(s_reserve_size[arena], caps);
+    if (s_reserve[arena]) {
+        s_stats[arena].reserved = (uint32_t)bytes;
+    } else {
+        s_reserve_size[arena] = 0;
+        ESP_LOGW(TAG, "%s block not reserved, %s uses the heap", s_names[arena], s_names[arena]);
+    }
+}
+
+void arena_init(void) {
+    static bool s_ready = false;
+    if (s_ready) return;
+    s_ready = true;
+
+    // Early, before WiFi and TLS fragment internal RAM
+    reserve(ARENA_SCRATCH, ARENA_SCRATCH_BYTES, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    reserve(ARENA_DMA, ARENA_DMA_BYTES, MALLOC_CAP_DMA | MALLOC_CAP_INTERNAL);
+
+    cJSON_Hooks hooks = { .malloc_fn = json_malloc, .free_fn = json_free };
+    cJSON_InitHooks(&hooks);
+
+    ESP_LOGI(TAG, "Arenas ready (scratch %dKB, dma %dB reserved, internal headroom %dKB)",
+             s_reserve[ARENA_SCRATCH] ? ARENA_SCRATCH_BYTES / 1024 : 0,
+             s_reserve[ARENA_DMA] ? ARENA_DMA_BYTES : 0, ARENA_INTERNAL_HEADROOM / 1024);
+}
+
+void arena_get_stats(arena_id_t arena, arena_stats_t *out) {
+    if (!out) return;
+    if ((unsigned)arena >= ARENA_COUNT) {
+        memset(out, 0, sizeof(*out));
+        return;
+    }
+    const arena_stats_t *st = &s_stats[arena];
+    out->in_use = __atomic_load_n(&st->in_use, __ATOMIC_RELAXED);
+    out->peak = __atomic_load_n(&st->peak, __ATOMIC_RELAXED);
+    out->reserved = st->reserved;
+    out->allocs = __atomic_load_n(&st->allocs, __ATOMIC_RELAXED);
+    out->spills = __atomic_load_n(&st->spills, __ATOMIC_RELAXED);
+    out->overflows = __atomic_load_n(&st->overflows, __ATOMIC_RELAXED);
+    out->failures = __atomic_load_n(&st->failures, __ATOMIC_RELAXED);
+}
+
+const char *arena_name(arena_id_t arena) {
+    return (unsigned)arena < ARENA_COUNT ? s_names[arena] : "?";
+}
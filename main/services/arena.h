@@ -0,0 +1,85 @@
+/**
+ * DayZ Server Tracker - Memory Arenas
+ * Central placement policy for buffers larger than a few hundred bytes
+ *
+ * Every sizeable allocation names the arena it belongs to instead of
+ * picking heap capabilities at the call site:
+ *
+ *   BULK     long-lived data (history rings, HTTP body, trace/profiler
+ *            windows) - PSRAM heap; its owners allocate once from their
+ *            init, so those allocations are the boot-time reservation
+ *   SCRATCH  work buffers freed before the caller returns (heatmap, NVS
+ *            blobs, config file) - a PSRAM block reserved at boot, handed
+ *            to one holder at a time; a second concurrent user or an
+ *            oversize request gets a PSRAM heap block instead
+ *   DMA      buffers a peripheral reads directly - an internal DMA-capable
+ *            block reserved at boot, same one-holder rule as SCRATCH
+ *
+ * Internal RAM is left to WiFi, lwIP and mbedTLS: BULK and SCRATCH only
+ * spill into it while the largest internal block stays above
+ * ARENA_INTERNAL_HEADROOM. cJSON trees are routed to PSRAM as well.
+ *
+ * Usage is accounted per arena (bytes in use, peak, spills, failures);
+ * in-use bytes, spills and failures are also metrics.
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef enum {
+    ARENA_BULK = 0,
+    ARENA_SCRATCH,
+    ARENA_DMA,
+    ARENA_COUNT
+} arena_id_t;
+
+typedef struct {
+    uint32_t in_use;        // Bytes currently allocated
+    uint32_t peak;          // High-water mark of in_use
+    uint32_t reserved;      // Bytes set aside at boot
+    uint32_t allocs;        // Successful allocations
+    uint32_t spills;        // Served from internal RAM instead of PSRAM
+    uint32_t overflows;     // Served by the heap, reserve busy or too small (SCRATCH, DMA)
+    uint32_t failures;
+} arena_stats_t;
+
+/**
+ * Reserve the scratch and DMA blocks and install the cJSON hooks
+ * Call once at startup, before any module allocates through an arena.
+ */
+void arena_init(void);
+
+/**
+ * Allocate from an arena
+ * @param arena Arena the buffer belongs to
+ * @param size Bytes
+ * @param owner Short tag for the log on failure
+ * @return Pointer or NULL
+ */
+void *arena_alloc(arena_id_t arena, size_t size, const char *owner);
+
+/**
+ * Allocate zeroed memory from an arena
+ */
+void *arena_calloc(arena_id_t arena, size_t n, size_t size, const char *owner);
+
+/**
+ * Release a buffer from arena_alloc/arena_calloc (NULL is ignored)
+ */
+void arena_free(void *ptr);
+
+/**
+ * Snapshot of one arena's accounting
+ */
+void arena_get_stats(arena_id_t arena, arena_stats_t *out);
+
+/**
+ * @return Arena name for logs ("bulk", "scratch", "dma")
+ */
+const char *arena_name(arena_id_t arena);
+
+#endif // ARENA_H
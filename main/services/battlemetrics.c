@@ -4,12 +4,17 @@
 
 #include "battlemetrics.h"
 #include "config.h"
+#include "metrics.h"
+#include "recorder.h"
+#include "trace.h"
+#include "arena.h"
 #include <string.h>
 #include <stdlib.h>
+#include <limits.h>
 #include "esp_http_client.h"
 #include "esp_crt_bundle.h"
 #include "esp_log.h"
-#include "esp_heap_caps.h"
+#include "esp_timer.h"
 #include "cJSON.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/semphr.h"
@@ -33,8 +38,7 @@ void battlemetrics_init(void) {
         }
     }
     if (!http_response) {
-        http_response = heap_caps_malloc(HTTP_RESPONSE_BUFFER_SIZE,
-                                         MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+        http_response = arena_alloc(ARENA_BULK, HTTP_RESPONSE_BUFFER_SIZE, "http_body");
         if (!http_response) {
             ESP_LOGE(TAG, "Failed to allocate HTTP response buffer in PSRAM");
         }
@@ -105,6 +109,15 @@ static void parse_server_details(cJSON *details, server_status_t *status) {
     }
 }
 
+// Integral JSON number within [min, max] (valueint saturates, so check valuedouble)
+static bool json_int_in_range(const cJSON *item, int min, int max, int *out) {
+    if (!item || !cJSON_IsNumber(item)) return false;
+    double v = item->valuedouble;
+    if (!(v >= min && v <= max) || v != (double)(int)v) return false;
+    *out = (int)v;
+    return true;
+}
+
 // Parse IP and port from address field
 static void parse_address(cJSON *attributes, server_status_t *status) {
     status->ip_address[0] = '\0';
@@ -116,13 +129,85 @@ static void parse_address(cJSON *attributes, server_status_t *status) {
                 sizeof(status->ip_address) - 1);
     }
 
-    cJSON *port_field = cJSON_GetObjectItem(attributes, "port");
-    if (port_field && cJSON_IsNumber(port_field)) {
-        status->port = (uint16_t)port_field->valueint;
+    int port;
+    if (json_int_in_range(cJSON_GetObjectItem(attributes, "port"), 1, 65535, &port)) {
+        status->port = (uint16_t)port;
     }
 }
 
-esp_err_t battlemetrics_query(const char *server_id, server_status_t *status) {
+static void status_set_defaults(server_status_t *status) {
+    memset(status, 0, sizeof(server_status_t));
+    status->players = -1;
+    status->max_players = DEFAULT_MAX_PLAYERS;
+    status->is_daytime = true;
+}
+
+esp_err_t battlemetrics_parse_response(const char *json, size_t len, server_status_t *status,
+                                       const char **error_msg) {
+    if (!status) return ESP_ERR_INVALID_ARG;
+    status_set_defaults(status);
+
+    // Length-bounded: the buffer need not be NUL terminated
+    cJSON *root = json ? cJSON_ParseWithLength(json, len) : NULL;
+    if (!root) {
+        if (error_msg) *error_msg = "JSON parse failed";
+        ESP_LOGE(TAG, "Failed to parse JSON response");
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    // Navigate to data.attributes
+    cJSON *data = cJSON_GetObjectItem(root, "data");
+    if (!data) {
+        cJSON_Delete(root);
+        if (error_msg) *error_msg = "Missing 'data' in response";
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    cJSON *attributes = cJSON_GetObjectItem(data, "attributes");
+    if (!attributes) {
+        cJSON_Delete(root);
+        if (error_msg) *error_msg = "Missing 'attributes' in response";
+        return ESP_ERR_INVALID_RESPONSE;
+    }
+
+    // Parse player count (missing, non-integer or out of range stays -1 = unknown)
+    json_int_in_range(cJSON_GetObjectItem(attributes, "players"),
+                      0, BATTLEMETRICS_MAX_PLAYERS, &status->players);
+
+    // Parse max players (same checks, else DEFAULT_MAX_PLAYERS)
+    json_int_in_range(cJSON_GetObjectItem(attributes, "maxPlayers"),
+                      1, BATTLEMETRICS_MAX_PLAYERS, &status->max_players);
+
+    // Parse server name
+    cJSON *name = cJSON_GetObjectItem(attributes, "name");
+    if (name && cJSON_IsString(name)) {
+        strncpy(status->server_name, name->valuestring,
+                sizeof(status->server_name) - 1);
+    }
+
+    // Parse online status
+    cJSON *online = cJSON_GetObjectItem(attributes, "status");
+    if (online && cJSON_IsString(online)) {
+        status->online = (strcmp(online->valuestring, "online") == 0);
+    }
+
+    // Parse server rank (lower = more popular, null = unranked)
+    if (!json_int_in_range(cJSON_GetObjectItem(attributes, "rank"), 1, INT_MAX, &status->rank)) {
+        status->rank = 0;  // 0 = unranked
+    }
+
+    // Parse IP and port
+    parse_address(attributes, status);
+
+    // Parse details (contains server time and map)
+    cJSON *details = cJSON_GetObjectItem(attributes, "details");
+    parse_server_details(details, status);
+
+    cJSON_Delete(root);
+    return ESP_OK;
+}
+
+static esp_err_t query_server(const char *server_id, server_status_t *status) {
     if (!server_id || !status) {
         strncpy(last_error, "Invalid parameters", sizeof(last_error) - 1);
         last_query_success = false;
@@ -137,10 +222,7 @@ esp_err_t battlemetrics_query(const char *server_id, server_status_t *status) {
     }
 
     // Initialize status with defaults
-    memset(status, 0, sizeof(server_status_t));
-    status->players = -1;
-    status->max_players = DEFAULT_MAX_PLAYERS;
-    status->is_daytime = true;
+    status_set_defaults(status);
 
     // Prepare request
     http_response_len = 0;
@@ -157,6 +239,10 @@ esp_err_t battlemetrics_query(const char *server_id, server_status_t *status) {
         return ESP_ERR_NO_MEM;
     }
 
+    // Request time includes the retry - that is what the caller waits for
+    metrics_count(METRIC_CNT_HTTP_REQUESTS);
+    int64_t t_start = esp_timer_get_time();
+
     esp_http_client_set_url(client, url);
     esp_err_t err = esp_http_client_perform(client);
 
@@ -180,95 +266,44 @@ esp_err_t battlemetrics_query(const char *server_id, server_status_t *status) {
                 esp_http_client_cleanup(client);
                 s_client = NULL;
             }
+            metrics_observe_since(METRIC_H_HTTP_REQUEST, t_start);
+            trace_record("http", trace_get_context(), t_start, esp_timer_get_time(), NULL);
+            metrics_count(METRIC_CNT_HTTP_ERRORS);
             last_query_success = false;
             if (bm_mutex) xSemaphoreGive(bm_mutex);
             return err;
         }
     }
 
+    metrics_observe_since(METRIC_H_HTTP_REQUEST, t_start);
+    trace_record("http", trace_get_context(), t_start, esp_timer_get_time(), NULL);
+
     int status_code = esp_http_client_get_status_code(client);
-    ESP_LOGI(TAG, "HTTP GET Status = %d, content_length = %lld",
-             status_code, esp_http_client_get_content_length(client));
+    ESP_LOGD(TAG, "HTTP GET Status = %d, content_length = %lld",
+             status_code, (long long)esp_http_client_get_content_length(client));
 
     if (status_code != 200) {
+        metrics_count(METRIC_CNT_HTTP_ERRORS);
         snprintf(last_error, sizeof(last_error), "HTTP status %d", status_code);
         last_query_success = false;
         if (bm_mutex) xSemaphoreGive(bm_mutex);
         return ESP_ERR_HTTP_BASE + status_code;
     }
 
-    // Parse JSON response using cJSON
-    cJSON *root = cJSON_Parse(http_response);
-    if (!root) {
-        strncpy(last_error, "JSON parse failed", sizeof(last_error) - 1);
-        ESP_LOGE(TAG, "Failed to parse JSON response");
-        last_query_success = false;
-        if (bm_mutex) xSemaphoreGive(bm_mutex);
-        return ESP_ERR_INVALID_RESPONSE;
-    }
-
-    // Navigate to data.attributes
-    cJSON *data = cJSON_GetObjectItem(root, "data");
-    if (!data) {
-        cJSON_Delete(root);
-        strncpy(last_error, "Missing 'data' in response", sizeof(last_error) - 1);
-        last_query_success = false;
-        if (bm_mutex) xSemaphoreGive(bm_mutex);
-        return ESP_ERR_INVALID_RESPONSE;
-    }
-
-    cJSON *attributes = cJSON_GetObjectItem(data, "attributes");
-    if (!attributes) {
-        cJSON_Delete(root);
-        strncpy(last_error, "Missing 'attributes' in response", sizeof(last_error) - 1);
+    const char *parse_error = NULL;
+    int64_t t_parse = esp_timer_get_time();
+    err = battlemetrics_parse_response(http_response, http_response_len, status, &parse_error);
+    metrics_observe_since(METRIC_H_BM_PARSE, t_parse);
+    trace_record("parse", trace_get_context(), t_parse, esp_timer_get_time(), NULL);
+    if (err != ESP_OK) {
+        metrics_count(METRIC_CNT_PARSE_ERRORS);
+        strncpy(last_error, parse_error, sizeof(last_error) - 1);
         last_query_success = false;
         if (bm_mutex) xSemaphoreGive(bm_mutex);
-        return ESP_ERR_INVALID_RESPONSE;
-    }
-
-    // Parse player count
-    cJSON *players = cJSON_GetObjectItem(attributes, "players");
-    if (players && cJSON_IsNumber(players)) {
-        status->players = players->valueint;
-    }
-
-    // Parse max players
-    cJSON *max_players = cJSON_GetObjectItem(attributes, "maxPlayers");
-    if (max_players && cJSON_IsNumber(max_players)) {
-        status->max_players = max_players->valueint;
+        return err;
     }
 
-    // Parse server name
-    cJSON *name = cJSON_GetObjectItem(attributes, "name");
-    if (name && cJSON_IsString(name)) {
-        strncpy(status->server_name, name->valuestring,
-                sizeof(status->server_name) - 1);
-    }
-
-    // Parse online status
-    cJSON *online = cJSON_GetObjectItem(attributes, "status");
-    if (online && cJSON_IsString(online)) {
-        status->online = (strcmp(online->valuestring, "online") == 0);
-    }
-
-    // Parse server rank (lower = more popular, null = unranked)
-    cJSON *rank = cJSON_GetObjectItem(attributes, "rank");
-    if (rank && cJSON_IsNumber(rank)) {
-        status->rank = rank->valueint;
-    } else {
-        status->rank = 0;  // 0 = unranked
-    }
-
-    // Parse IP and port
-    parse_address(attributes, status);
-
-    // Parse details (contains server time and map)
-    cJSON *details = cJSON_GetObjectItem(attributes, "details");
-    parse_server_details(details, status);
-
-    cJSON_Delete(root);
-
-    ESP_LOGI(TAG, "Parsed: players=%d/%d, time=%s, online=%d, rank=%d",
+    ESP_LOGD(TAG, "Parsed: players=%d/%d, time=%s, online=%d, rank=%d",
              status->players, status->max_players,
              status->server_time, status->online, status->rank);
 
@@ -278,6 +313,12 @@ esp_err_t battlemetrics_query(const char *server_id, server_status_t *status) {
     return ESP_OK;
 }
 
+esp_err_t battlemetrics_query(const char *server_id, server_status_t *status) {
+    esp_err_t err = query_server(server_id, status);
+    recorder_log_fetch(server_id, err, status);
+    return err;
+}
+
 const char* battlemetrics_get_last_error(void) {
     return last_error;
 }
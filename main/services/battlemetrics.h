@@ -8,6 +8,7 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#include <stddef.h>
 #include "esp_err.h"
 
 // Server status data structure
@@ -39,6 +40,19 @@ void battlemetrics_init(void);
  */
 esp_err_t battlemetrics_query(const char *server_id, server_status_t *status);
 
+/**
+ * Parse a BattleMetrics /servers/{id} response body
+ * The network-facing half of battlemetrics_query(), exposed so host tools
+ * (parse benchmark, fuzzer) run exactly the device code. Reentrant.
+ * @param json Response body (need not be NUL terminated)
+ * @param len Body length in bytes
+ * @param status Output structure (reset to defaults first)
+ * @param error_msg Optional output: static description on failure
+ * @return ESP_OK, or ESP_ERR_INVALID_RESPONSE for malformed/unexpected JSON
+ */
+esp_err_t battlemetrics_parse_response(const char *json, size_t len, server_status_t *status,
+                                       const char **error_msg);
+
 /**
  * Get the last error message (if any)
  */
@@ -0,0 +1,777 @@
+/**
+ * DayZ Server Tracker - Fleet Mode Implementation
+ *
+ * The fleet task owns the receive socket: it joins the group while WiFi
+ * is up, sends HELLOs and applies incoming packets to the peer table and
+ * the result cache. The fetch tasks only read the cache and send RESULTs
+ * on a separate socket, all under one mutex.
+ *
+ * Packet layout (little-endian, strings are u8 length + bytes):
+ *   header  u32 magic, u8 version, u8 type, u32 device, u32 boot,
+ *           u32 seq, u32 sent_at
+ *   HELLO   u8 count, count x { str server_id, u16 interval_sec }
+ *   RESULT  str server_id, u32 fetched_at, then the status fields in
+ *           recorder_log_fetch() order
+ *   BYE     (header only)
+ *   trailer FLEET_MAC_LEN bytes of HMAC-SHA-256 under FLEET_KEY over
+ *           everything before it
+ */
+
+#include "fleet.h"
+#include "config.h"
+#include "metrics.h"
+#include "recorder.h"
+#include "storage_config.h"
+#include "wifi_manager.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_random.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include "mbedtls/md.h"
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <sys/time.h>
+#include <unistd.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "fleet";
+
+#define FLEET_MAGIC             0x4C465A44u     // "DZFL"
+#define FLEET_VERSION           2
+#define FLEET_MAC_LEN           16              // Truncated HMAC-SHA-256 (RFC 2104 allows >= half)
+#define FLEET_PKT_MAX           512
+#define FLEET_ID_LEN            32
+#define FLEET_MAX_INTERESTS     MAX_SERVERS     // Servers one tracker polls
+#define FLEET_RECV_TIMEOUT_MS   500
+#define FLEET_POLL_MS           100             // Cache checks while waiting for a leader
+#define FLEET_LOCK_MS           50
+
+typedef enum {
+    FLEET_PKT_HELLO = 1,
+    FLEET_PKT_RESULT,
+    FLEET_PKT_BYE,
+} fleet_pkt_type_t;
+
+typedef struct {
+    char server_id[FLEET_ID_LEN];
+    uint16_t interval_sec;
+    TickType_t last_used;       // Local interests only
+    bool leader_silent;         // Local: last wait for the leader ran out
+} interest_t;
+
+typedef struct {
+    bool used;
+    uint32_t device;
+    uint32_t boot;              // Sender's boot id; a new one resets last_seq
+    uint32_t last_seq;
+    TickType_t last_heard;
+    uint8_t interest_count;
+    interest_t interests[FLEET_MAX_INTERESTS];
+} peer_t;
+
+typedef struct {
+    char server_id[FLEET_ID_LEN];
+    uint32_t fetched_at;        // 0 = empty slot
+    uint32_t device;
+    server_status_t status;
+} cache_entry_t;
+
+static SemaphoreHandle_t s_mutex = NULL;
+static TaskHandle_t s_task = NULL;
+static volatile bool s_running = false;
+static volatile bool s_hello_due = false;   // New peer heard, answer its HELLO
+
+static int s_rx = -1;                       // Fleet task only
+static int s_tx = -1;                       // Under s_mutex
+static struct sockaddr_in s_group;
+
+static uint32_t s_device = 0;
+static uint32_t s_boot = 0;
+static uint32_t s_seq = 0;
+
+static interest_t s_local[FLEET_MAX_INTERESTS];
+static peer_t s_peers[FLEET_MAX_PEERS];
+static EXT_RAM_BSS_ATTR cache_entry_t s_cache[FLEET_CACHE_SIZE];
+
+// ============== ENCODING ==============
+
+typedef struct {
+    uint8_t data[FLEET_PKT_MAX];
+    size_t len;
+    bool overflow;
+} pkt_t;
+
+static void put_bytes(pkt_t *p, const void *src, size_t n) {
+    if (p->len + n > sizeof(p->data)) {
+        p->overflow = true;
+        return;
+    }
+    memcpy(p->data + p->len, src, n);
+    p->len += n;
+}
+
+static void put_u8(pkt_t *p, uint8_t v) {
+    put_bytes(p, &v, 1);
+}
+
+static void put_u16(pkt_t *p, uint16_t v) {
+    uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+    put_bytes(p, b, 2);
+}
+
+static void put_u32(pkt_t *p, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    put_bytes(p, b, 4);
+}
+
+static void put_str(pkt_t *p, const char *s) {
+    size_t n = s ? strlen(s) : 0;
+    if (n > 255) n = 255;
+    put_u8(p, (uint8_t)n);
+    put_bytes(p, s, n);
+}
+
+typedef struct {
+    const uint8_t *p;
+    size_t len;
+    size_t pos;
+    bool bad;
+} cursor_t;
+
+static const uint8_t* take(cursor_t *c, size_t n) {
+    if (c->pos + n > c->len) {
+        c->bad = true;
+        return NULL;
+    }
+    const uint8_t *r = c->p + c->pos;
+    c->pos += n;
+    return r;
+}
+
+static uint8_t get_u8(cursor_t *c) {
+    const uint8_t *b = take(c, 1);
+    return b ? b[0] : 0;
+}
+
+static uint16_t get_u16(cursor_t *c) {
+    const uint8_t *b = take(c, 2);
+    return b ? (uint16_t)(b[0] | (b[1] << 8)) : 0;
+}
+
+static uint32_t get_u32(cursor_t *c) {
+    const uint8_t *b = take(c, 4);
+    return b ? (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24) : 0;
+}
+
+static void get_str(cursor_t *c, char *dst, size_t dst_size) {
+    uint8_t n = get_u8(c);
+    const uint8_t *b = take(c, n);
+    size_t copy = (b && n < dst_size) ? n : (b ? dst_size - 1 : 0);
+    if (copy) memcpy(dst, b, copy);
+    dst[copy] = '\0';
+}
+
+// ============== HELPERS ==============
+
+static bool lock(uint32_t timeout_ms) {
+    return xSemaphoreTake(s_mutex, pdMS_TO_TICKS(timeout_ms)) == pdTRUE;
+}
+
+static void unlock(void) {
+    xSemaphoreGive(s_mutex);
+}
+
+static bool clock_valid(uint32_t t) {
+    return t >= STORAGE_TIMESTAMP_MIN_VALID;
+}
+
+static bool peer_alive(const peer_t *peer, TickType_t now) {
+    return peer->used &&
+           (now - peer->last_heard) < pdMS_TO_TICKS(FLEET_PEER_TIMEOUT_SEC * 1000);
+}
+
+/**
+ * Rendezvous (highest random weight) score of a device for a server
+ * FNV-1a over both, finished with the murmur3 mixer
+ */
+static uint32_t hrw_score(uint32_t device, const char *server_id) {
+    uint32_t h = 2166136261u;
+    for (int i = 0; i < 4; i++) {
+        h ^= (device >> (8 * i)) & 0xFF;
+        h *= 16777619u;
+    }
+    for (const char *s = server_id; *s; s++) {
+        h ^= (uint8_t)*s;
+        h *= 16777619u;
+    }
+    h ^= h >> 16;
+    h *= 0x85EBCA6Bu;
+    h ^= h >> 13;
+    h *= 0xC2B2AE35u;
+    h ^= h >> 16;
+    return h;
+}
+
+/**
+ * Whether a live peer rather than this tracker leads a server (under s_mutex)
+ * Shortest interval wins so everyone else finds its results fresh enough.
+ */
+static bool peer_leads(const char *server_id, uint32_t interval_sec) {
+    TickType_t now = xTaskGetTickCount();
+    uint32_t best_iv = interval_sec;
+    uint32_t best_score = hrw_score(s_device, server_id);
+    bool peer = false;
+
+    for (int i = 0; i < FLEET_MAX_PEERS; i++) {
+        const peer_t *p = &s_peers[i];
+        if (!peer_alive(p, now)) continue;
+        for (int j = 0; j < p->interest_count; j++) {
+            if (strcmp(p->interests[j].server_id, server_id) != 0) continue;
+            uint32_t iv = p->interests[j].interval_sec;
+            uint32_t score = hrw_score(p->device, server_id);
+            if (iv < best_iv || (iv == best_iv && score > best_score)) {
+                best_iv = iv;
+                best_score = score;
+                peer = true;
+            }
+            break;
+        }
+    }
+    return peer;
+}
+
+static interest_t* note_interest(const char *server_id, uint32_t interval_sec) {
+    interest_t *slot = NULL;
+    for (int i = 0; i < FLEET_MAX_INTERESTS && !slot; i++) {
+        if (strcmp(s_local[i].server_id, server_id) == 0) slot = &s_local[i];
+    }
+    // Else an empty slot, else the one used longest ago
+    for (int i = 0; i < FLEET_MAX_INTERESTS && !slot; i++) {
+        if (s_local[i].server_id[0] == '\0') slot = &s_local[i];
+    }
+    if (!slot) {
+        slot = &s_local[0];
+        for (int i = 1; i < FLEET_MAX_INTERESTS; i++) {
+            if ((int32_t)(s_local[i].last_used - slot->last_used) < 0) slot = &s_local[i];
+        }
+    }
+    if (strcmp(slot->server_id, server_id) != 0) {
+        slot->leader_silent = false;
+    }
+    strncpy(slot->server_id, server_id, FLEET_ID_LEN - 1);
+    slot->server_id[FLEET_ID_LEN - 1] = '\0';
+    slot->interval_sec = interval_sec > UINT16_MAX ? UINT16_MAX : (uint16_t)interval_sec;
+    slot->last_used = xTaskGetTickCount();
+    return slot;
+}
+
+// A server nobody has asked for in two intervals is no longer polled here
+static bool interest_live(const interest_t *it, TickType_t now) {
+    return it->server_id[0] != '\0' &&
+           (now - it->last_used) < pdMS_TO_TICKS((2 * it->interval_sec + FLEET_PEER_TIMEOUT_SEC) * 1000);
+}
+
+static bool cache_fresh(const char *server_id, uint32_t now, uint32_t interval_sec,
+                        server_status_t *out) {
+    for (int i = 0; i < FLEET_CACHE_SIZE; i++) {
+        const cache_entry_t *e = &s_cache[i];
+        if (e->fetched_at == 0 || strcmp(e->server_id, server_id) != 0) continue;
+        uint32_t age = now > e->fetched_at ? now - e->fetched_at : 0;
+        if (age > interval_sec + FLEET_FRESH_GRACE_SEC) return false;
+        *out = e->status;
+        return true;
+    }
+    return false;
+}
+
+// The newest result is a whole interval past fresh: the leader missed a cycle
+static bool cache_overdue(const char *server_id, uint32_t now, uint32_t interval_sec) {
+    for (int i = 0; i < FLEET_CACHE_SIZE; i++) {
+        const cache_entry_t *e = &s_cache[i];
+        if (e->fetched_at == 0 || strcmp(e->server_id, server_id) != 0) continue;
+        uint32_t age = now > e->fetched_at ? now - e->fetched_at : 0;
+        return age > 2 * interval_sec + FLEET_FRESH_GRACE_SEC;
+    }
+    return false;
+}
+
+// Keep the newest result per server; false if an equal or newer one is held
+static bool cache_store(const char *server_id, uint32_t fetched_at, uint32_t device,
+                        const server_status_t *status) {
+    cache_entry_t *slot = NULL;
+    for (int i = 0; i < FLEET_CACHE_SIZE; i++) {
+        cache_entry_t *e = &s_cache[i];
+        if (e->fetched_at != 0 && strcmp(e->server_id, server_id) == 0) {
+            if (fetched_at <= e->fetched_at) return false;
+            slot = e;
+            break;
+        }
+        if (!slot || e->fetched_at < slot->fetched_at) slot = e;
+    }
+    strncpy(slot->server_id, server_id, FLEET_ID_LEN - 1);
+    slot->server_id[FLEET_ID_LEN - 1] = '\0';
+    slot->fetched_at = fetched_at;
+    slot->device = device;
+    slot->status = *status;
+    return true;
+}
+
+/**
+ * Packet MAC: HMAC-SHA-256 under the shared FLEET_KEY, truncated
+ * Only trackers holding the key can announce interests or results.
+ */
+static bool packet_mac(const uint8_t *data, size_t len, uint8_t mac[FLEET_MAC_LEN]) {
+    uint8_t full[32];
+    const mbedtls_md_info_t *md = mbedtls_md_info_from_type(MBEDTLS_MD_SHA256);
+    if (mbedtls_md_hmac(md, (const unsigned char *)FLEET_KEY, strlen(FLEET_KEY),
+                        data, len, full) != 0) {
+        return false;
+    }
+    memcpy(mac, full, FLEET_MAC_LEN);
+    return true;
+}
+
+// Constant time, so a forger learns nothing from how long a reject takes
+static bool packet_authentic(const uint8_t *data, size_t len) {
+    uint8_t mac[FLEET_MAC_LEN];
+    if (len < FLEET_MAC_LEN || !packet_mac(data, len - FLEET_MAC_LEN, mac)) return false;
+    uint8_t diff = 0;
+    for (int i = 0; i < FLEET_MAC_LEN; i++) {
+        diff |= mac[i] ^ data[len - FLEET_MAC_LEN + i];
+    }
+    return diff == 0;
+}
+
+// ============== SOCKETS ==============
+
+static void pkt_begin(pkt_t *p, fleet_pkt_type_t type) {
+    p->len = 0;
+    p->overflow = false;
+    put_u32(p, FLEET_MAGIC);
+    put_u8(p, FLEET_VERSION);
+    put_u8(p, (uint8_t)type);
+    put_u32(p, s_device);
+    put_u32(p, s_boot);
+    put_u32(p, ++s_seq);
+    put_u32(p, (uint32_t)time(NULL));
+}
+
+// Under s_mutex. Appends the MAC, so nothing can be added after sending
+static bool pkt_send(pkt_t *p) {
+    uint8_t mac[FLEET_MAC_LEN];
+    if (s_tx < 0 || !packet_mac(p->data, p->len, mac)) return false;
+    put_bytes(p, mac, sizeof(mac));
+    if (p->overflow) return false;
+    return sendto(s_tx, p->data, p->len, 0, (const struct sockaddr *)&s_group,
+                  sizeof(s_group)) == (int)p->len;
+}
+
+static void close_sockets(void) {
+    if (s_rx >= 0) {
+        close(s_rx);
+        s_rx = -1;
+    }
+    if (lock(portMAX_DELAY)) {
+        if (s_tx >= 0) {
+            close(s_tx);
+            s_tx = -1;
+        }
+        unlock();
+    }
+}
+
+static esp_err_t open_sockets(void) {
+    int rx = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    int tx = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (rx < 0 || tx < 0) goto fail;
+
+    int one = 1;
+    setsockopt(rx, SOL_SOCKET, SO_REUSEADDR, &one, sizeof(one));
+
+    struct sockaddr_in addr = {
+        .sin_family = AF_INET,
+        .sin_port = htons(FLEET_PORT),
+        .sin_addr.s_addr = htonl(INADDR_ANY),
+    };
+    if (bind(rx, (struct sockaddr *)&addr, sizeof(addr)) < 0) goto fail;
+
+    struct ip_mreq mreq = {
+        .imr_multiaddr = s_group.sin_addr,
+        .imr_interface.s_addr = htonl(INADDR_ANY),
+    };
+    if (setsockopt(rx, IPPROTO_IP, IP_ADD_MEMBERSHIP, &mreq, sizeof(mreq)) < 0) goto fail;
+
+    struct timeval tv = { .tv_sec = 0, .tv_usec = FLEET_RECV_TIMEOUT_MS * 1000 };
+    setsockopt(rx, SOL_SOCKET, SO_RCVTIMEO, &tv, sizeof(tv));
+
+    // Loopback on, so several host instances on one machine hear each other
+    uint8_t ttl = FLEET_TTL;
+    uint8_t loop = 1;
+    setsockopt(tx, IPPROTO_IP, IP_MULTICAST_TTL, &ttl, sizeof(ttl));
+    setsockopt(tx, IPPROTO_IP, IP_MULTICAST_LOOP, &loop, sizeof(loop));
+
+    s_rx = rx;
+    if (lock(portMAX_DELAY)) {
+        s_tx = tx;
+        unlock();
+    }
+    ESP_LOGI(TAG, "Joined %s:%d", FLEET_GROUP_ADDR, FLEET_PORT);
+    return ESP_OK;
+
+fail:
+    ESP_LOGW(TAG, "Could not join %s:%d", FLEET_GROUP_ADDR, FLEET_PORT);
+    if (rx >= 0) close(rx);
+    if (tx >= 0) close(tx);
+    return ESP_FAIL;
+}
+
+static void send_hello(void) {
+    if (!lock(FLEET_LOCK_MS)) return;
+
+    TickType_t now = xTaskGetTickCount();
+    uint8_t count = 0;
+    for (int i = 0; i < FLEET_MAX_INTERESTS; i++) {
+        if (interest_live(&s_local[i], now)) count++;
+    }
+
+    pkt_t p;
+    pkt_begin(&p, FLEET_PKT_HELLO);
+    put_u8(&p, count);
+    for (int i = 0; i < FLEET_MAX_INTERESTS; i++) {
+        if (!interest_live(&s_local[i], now)) continue;
+        put_str(&p, s_local[i].server_id);
+        put_u16(&p, s_local[i].interval_sec);
+    }
+    pkt_send(&p);
+    unlock();
+}
+
+static void send_bye(void) {
+    if (!lock(FLEET_LOCK_MS)) return;
+    pkt_t p;
+    pkt_begin(&p, FLEET_PKT_BYE);
+    pkt_send(&p);
+    unlock();
+}
+
+static void share_result(const char *server_id, const server_status_t *st, uint32_t fetched_at) {
+    if (!lock(FLEET_LOCK_MS)) return;
+
+    pkt_t p;
+    pkt_begin(&p, FLEET_PKT_RESULT);
+    put_str(&p, server_id);
+    put_u32(&p, fetched_at);
+    put_u16(&p, (uint16_t)(int16_t)st->players);
+    put_u16(&p, (uint16_t)(int16_t)st->max_players);
+    put_u8(&p, (st->online ? 0x01 : 0) | (st->is_daytime ? 0x02 : 0));
+    put_u32(&p, (uint32_t)st->rank);
+    put_u16(&p, st->port);
+    put_str(&p, st->server_time);
+    put_str(&p, st->map_name);
+    put_str(&p, st->ip_address);
+    put_str(&p, st->server_name);
+    if (pkt_send(&p)) {
+        metrics_count(METRIC_CNT_FLEET_SHARED);
+    }
+    unlock();
+}
+
+// ============== RECEIVING ==============
+
+// Under s_mutex. Finds or takes a slot (the one heard from longest ago)
+static peer_t* peer_get(uint32_t device, uint32_t boot, bool *is_new) {
+    peer_t *slot = NULL;
+    for (int i = 0; i < FLEET_MAX_PEERS; i++) {
+        peer_t *p = &s_peers[i];
+        if (p->used && p->device == device) {
+            slot = p;
+            break;
+        }
+        if (!slot || !p->used || (slot->used && (int32_t)(p->last_heard - slot->last_heard) < 0)) {
+            slot = p;
+        }
+    }
+
+    *is_new = !slot->used || slot->device != device;
+    if (*is_new || slot->boot != boot) {
+        memset(slot, 0, sizeof(*slot));
+        slot->used = true;
+        slot->device = device;
+        slot->boot = boot;
+    }
+    return slot;
+}
+
+static void handle_packet(const uint8_t *data, size_t len) {
+    // Forged or from a tracker with another key: ignore before parsing
+    if (!packet_authentic(data, len)) {
+        metrics_count(METRIC_CNT_FLEET_REJECTED);
+        return;
+    }
+    cursor_t c = { data, len - FLEET_MAC_LEN, 0, false };
+    uint32_t magic = get_u32(&c);
+    uint8_t version = get_u8(&c);
+    uint8_t type = get_u8(&c);
+    uint32_t device = get_u32(&c);
+    uint32_t boot = get_u32(&c);
+    uint32_t seq = get_u32(&c);
+    uint32_t sent_at = get_u32(&c);
+
+    if (c.bad || magic != FLEET_MAGIC || version != FLEET_VERSION) {
+        metrics_count(METRIC_CNT_FLEET_REJECTED);
+        return;
+    }
+    if (device == s_device) return;     // Our own, looped back
+
+    // Freshness is judged on wall clocks, so both sides must agree on them
+    uint32_t now = (uint32_t)time(NULL);
+    uint32_t skew = now > sent_at ? now - sent_at : sent_at - now;
+    if (!clock_valid(now) || !clock_valid(sent_at) || skew > FLEET_MAX_SKEW_SEC) {
+        metrics_count(METRIC_CNT_FLEET_REJECTED);
+        return;
+    }
+
+    if (!lock(FLEET_LOCK_MS)) return;
+
+    bool is_new;
+    peer_t *peer = peer_get(device, boot, &is_new);
+    if (seq <= peer->last_seq) {
+        // Duplicate or reordered
+        unlock();
+        metrics_count(METRIC_CNT_FLEET_REJECTED);
+        return;
+    }
+    peer->last_seq = seq;
+    peer->last_heard = xTaskGetTickCount();
+    if (is_new) {
+        ESP_LOGI(TAG, "Peer %08lx joined", (unsigned long)device);
+        s_hello_due = true;
+    }
+
+    bool accepted = true;
+    switch (type) {
+        case FLEET_PKT_HELLO: {
+            uint8_t count = get_u8(&c);
+            peer->interest_count = 0;
+            for (int i = 0; i < count && !c.bad; i++) {
+                interest_t it = {0};
+                get_str(&c, it.server_id, sizeof(it.server_id));
+                it.interval_sec = get_u16(&c);
+                if (c.bad || it.server_id[0] == '\0' || it.interval_sec == 0 ||
+                    peer->interest_count >= FLEET_MAX_INTERESTS) {
+                    continue;
+                }
+                peer->interests[peer->interest_count++] = it;
+            }
+            accepted = !c.bad;
+            break;
+        }
+        case FLEET_PKT_RESULT: {
+            char server_id[FLEET_ID_LEN];
+            server_status_t st = {0};
+            get_str(&c, server_id, sizeof(server_id));
+            uint32_t fetched_at = get_u32(&c);
+            st.players = (int16_t)get_u16(&c);
+            st.max_players = (int16_t)get_u16(&c);
+            uint8_t flags = get_u8(&c);
+            st.online = (flags & 0x01) != 0;
+            st.is_daytime = (flags & 0x02) != 0;
+            st.rank = (int32_t)get_u32(&c);
+            st.port = get_u16(&c);
+            get_str(&c, st.server_time, sizeof(st.server_time));
+            get_str(&c, st.map_name, sizeof(st.map_name));
+            get_str(&c, st.ip_address, sizeof(st.ip_address));
+            get_str(&c, st.server_name, sizeof(st.server_name));
+            accepted = !c.bad && server_id[0] != '\0' && clock_valid(fetched_at) &&
+                       fetched_at <= now + FLEET_MAX_SKEW_SEC &&
+                       cache_store(server_id, fetched_at, device, &st);
+            if (accepted) metrics_count(METRIC_CNT_FLEET_RECEIVED);
+            break;
+        }
+        case FLEET_PKT_BYE:
+            ESP_LOGI(TAG, "Peer %08lx left", (unsigned long)device);
+            peer->used = false;
+            break;
+        default:
+            accepted = false;
+            break;
+    }
+    unlock();
+
+    if (!accepted) metrics_count(METRIC_CNT_FLEET_REJECTED);
+}
+
+// ============== TASK ==============
+
+static void fleet_task(void *arg) {
+    static uint8_t buf[FLEET_PKT_MAX];
+    TickType_t last_hello = 0;
+
+    while (s_running) {
+        if (!wifi_manager_is_connected()) {
+            if (s_rx >= 0) {
+                close_sockets();
+                ESP_LOGI(TAG, "Link down, left the group");
+            }
+            vTaskDelay(pdMS_TO_TICKS(1000));
+            continue;
+        }
+        if (s_rx < 0) {
+            if (open_sockets() != ESP_OK) {
+                vTaskDelay(pdMS_TO_TICKS(5000));
+                continue;
+            }
+            s_hello_due = true;
+        }
+
+        TickType_t now = xTaskGetTickCount();
+        if (s_hello_due || (now - last_hello) >= pdMS_TO_TICKS(FLEET_HELLO_SEC * 1000)) {
+            s_hello_due = false;
+            last_hello = now;
+            send_hello();
+        }
+
+        struct sockaddr_in from;
+        socklen_t from_len = sizeof(from);
+        int n = recvfrom(s_rx, buf, sizeof(buf), 0, (struct sockaddr *)&from, &from_len);
+        if (n > 0) {
+            handle_packet(buf, (size_t)n);
+        }
+        metrics_gauge_set(METRIC_G_FLEET_PEERS, fleet_peer_count());
+    }
+
+    send_bye();
+    close_sockets();
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============== PUBLIC API ==============
+
+esp_err_t fleet_start(void) {
+    if (s_running) return ESP_OK;
+    if (!FLEET_ENABLED) return ESP_ERR_NOT_SUPPORTED;
+    if (FLEET_KEY[0] == '\0') {
+        ESP_LOGW(TAG, "FLEET_KEY not set, fleet mode stays off");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) return ESP_ERR_NO_MEM;
+    }
+
+    // Device id from the low 4 bytes of the MAC; boot id tells restarts apart
+    char mac[18] = "";
+    unsigned int b[6] = {0};
+    wifi_manager_get_mac_str(mac, sizeof(mac));
+    sscanf(mac, "%x:%x:%x:%x:%x:%x", &b[0], &b[1], &b[2], &b[3], &b[4], &b[5]);
+    s_device = ((uint32_t)b[2] << 24) | ((uint32_t)b[3] << 16) | ((uint32_t)b[4] << 8) | b[5];
+    // Random, not clock-based: this runs before SNTP, when every boot
+    // would start from the same time
+    s_boot = esp_random();
+    s_seq = 0;
+
+    memset(s_local, 0, sizeof(s_local));
+    memset(s_peers, 0, sizeof(s_peers));
+    memset(s_cache, 0, sizeof(s_cache));
+
+    memset(&s_group, 0, sizeof(s_group));
+    s_group.sin_family = AF_INET;
+    s_group.sin_port = htons(FLEET_PORT);
+    s_group.sin_addr.s_addr = inet_addr(FLEET_GROUP_ADDR);
+
+    s_running = true;
+    if (xTaskCreate(fleet_task, "fleet", FLEET_TASK_STACK, NULL,
+                    FLEET_TASK_PRIORITY, &s_task) != pdPASS) {
+        s_running = false;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Fleet mode on as %08lx", (unsigned long)s_device);
+    return ESP_OK;
+}
+
+void fleet_stop(void) {
+    if (!s_running) return;
+
+    s_running = false;
+    while (s_task) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+    ESP_LOGI(TAG, "Fleet mode off");
+}
+
+esp_err_t fleet_query(const char *server_id, uint32_t interval_sec, server_status_t *status) {
+    // Freshness needs a synced clock; until then every tracker polls
+    uint32_t now = (uint32_t)time(NULL);
+    if (!s_running || !server_id || !clock_valid(now) || !lock(FLEET_LOCK_MS)) {
+        return battlemetrics_query(server_id, status);
+    }
+
+    // The leader always polls, so a peer's fallback result never stands
+    // in for it (that peer would keep falling back)
+    interest_t *it = note_interest(server_id, interval_sec);
+    bool follower = peer_leads(server_id, interval_sec);
+    bool hit = follower && cache_fresh(server_id, now, interval_sec, status);
+    // Wait for a leader that is merely a moment late, not one that has
+    // already missed a cycle: those waits would stack across the servers
+    // a fetch task walks through
+    bool wait = follower && !hit && !it->leader_silent &&
+                !cache_overdue(server_id, now, interval_sec);
+    if (hit) it->leader_silent = false;
+    unlock();
+
+    if (wait) {
+        // The leader's cycle may run a moment behind ours
+        TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(FLEET_LEADER_WAIT_MS);
+        while (!hit && s_running && (int32_t)(xTaskGetTickCount() - deadline) < 0) {
+            vTaskDelay(pdMS_TO_TICKS(FLEET_POLL_MS));
+            if (lock(FLEET_LOCK_MS)) {
+                hit = cache_fresh(server_id, (uint32_t)time(NULL), interval_sec, status);
+                unlock();
+            }
+        }
+        if (lock(FLEET_LOCK_MS)) {
+            // Looked up again: the slot may have changed hands meanwhile
+            for (int i = 0; i < FLEET_MAX_INTERESTS; i++) {
+                if (strcmp(s_local[i].server_id, server_id) == 0) {
+                    s_local[i].leader_silent = !hit;
+                }
+            }
+            unlock();
+        }
+    }
+    if (follower && !hit) {
+        metrics_count(METRIC_CNT_FLEET_FALLBACKS);
+        ESP_LOGW(TAG, "No result for %s from its leader, polling directly", server_id);
+    }
+
+    if (hit) {
+        metrics_count(METRIC_CNT_FLEET_SERVED);
+        recorder_log_fetch(server_id, ESP_OK, status);
+        return ESP_OK;
+    }
+
+    esp_err_t err = battlemetrics_query(server_id, status);
+    if (err == ESP_OK) {
+        share_result(server_id, status, now);
+    }
+    return err;
+}
+
+int fleet_peer_count(void) {
+    if (!s_mutex || !lock(FLEET_LOCK_MS)) return 0;
+    TickType_t now = xTaskGetTickCount();
+    int count = 0;
+    for (int i = 0; i < FLEET_MAX_PEERS; i++) {
+        if (peer_alive(&s_peers[i], now)) count++;
+    }
+    unlock();
+    return count;
+}
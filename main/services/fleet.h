@@ -0,0 +1,74 @@
+/**
+ * DayZ Server Tracker - Fleet Mode
+ * Share fetched server status between trackers on the same LAN
+ *
+ * Every tracker joins a UDP multicast group (FLEET_GROUP_ADDR:FLEET_PORT)
+ * and announces, in a HELLO every FLEET_HELLO_SEC, which servers it polls
+ * and how often. Each server gets one leader among the live peers that
+ * poll it: the one with the shortest interval, ties broken by rendezvous
+ * hash of (device, server), so the load spreads across the fleet. After a
+ * successful direct fetch a tracker multicasts the result (RESULT, with
+ * the sender's sequence number and the fetch timestamp).
+ *
+ * fleet_query() is the fetch tasks' data source. The leader polls
+ * BattleMetrics and shares the result. A follower uses the newest peer
+ * result if it is no older than the follower's interval
+ * (+FLEET_FRESH_GRACE_SEC), else waits up to FLEET_LEADER_WAIT_MS for one
+ * and then polls directly (and shares) itself. API calls therefore scale
+ * with distinct servers. Once a wait runs out, or the newest result is a
+ * whole interval overdue, followers poll directly without waiting until
+ * the leader delivers again, so a silent leader costs each server one
+ * wait, not one per cycle. A new leader is chosen after
+ * FLEET_PEER_TIMEOUT_SEC.
+ *
+ * Off by default: it needs FLEET_ENABLED and a FLEET_KEY shared by every
+ * tracker. Each packet carries an HMAC-SHA-256 under that key over header
+ * and body; packets that fail it are dropped before parsing, so a host on
+ * the LAN without the key cannot inject results or claim leadership.
+ *
+ * Packets are little-endian, versioned and ignored unless both clocks are
+ * SNTP-synced and agree within FLEET_MAX_SKEW_SEC. Duplicate or reordered
+ * packets (sequence number not above the sender's last) are dropped; a
+ * new boot id resets the sender's sequence.
+ */
+
+#ifndef FLEET_H
+#define FLEET_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+#include "battlemetrics.h"
+
+/**
+ * Start fleet mode (no-op if already running)
+ * Safe to call before WiFi connects - the group is joined once it is up.
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if FLEET_ENABLED is 0 or FLEET_KEY
+ *         is empty, ESP_ERR_NO_MEM
+ */
+esp_err_t fleet_start(void);
+
+/**
+ * Stop fleet mode (tells peers, so they take over right away)
+ */
+void fleet_stop(void);
+
+/**
+ * Get a server's status from the fleet or, failing that, BattleMetrics
+ * Drop-in for battlemetrics_query() in the fetch tasks; with fleet mode off
+ * it is exactly that. Results served from a peer are recorded like fetches.
+ * May block up to FLEET_LEADER_WAIT_MS plus the API request, the wait
+ * only while this server's leader has been delivering on time.
+ * @param server_id BattleMetrics server ID
+ * @param interval_sec How often the caller polls this server
+ * @param status Output structure to fill
+ * @return ESP_OK on success, battlemetrics_query() error otherwise
+ */
+esp_err_t fleet_query(const char *server_id, uint32_t interval_sec, server_status_t *status);
+
+/**
+ * Number of peers heard from within FLEET_PEER_TIMEOUT_SEC
+ */
+int fleet_peer_count(void);
+
+#endif // FLEET_H
@@ -0,0 +1,227 @@
+/**
+ * DayZ Server Tracker - Forecast Service Implementation
+ */
+
+#include "forecast.h"
+#include "forecast_model.h"
+#include "history_store.h"
+#include "config.h"
+#include "metrics.h"
+#include "drivers/sd_card.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/queue.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "forecast";
+
+static EXT_RAM_BSS_ATTR forecast_model_t s_models[MAX_SERVERS];     // PSRAM .bss
+static bool s_seeded[MAX_SERVERS];
+static SemaphoreHandle_t s_mutex = NULL;
+
+// Seeding runs on its own task; live samples wait in a backlog meanwhile
+typedef struct {
+    uint32_t ts;
+    int16_t players;
+} seed_sample_t;
+
+typedef struct {
+    bool pending;                   // History still loading
+    uint32_t until;                 // First live sample; history ends before it
+    uint32_t gen;                   // Bumped by forecast_reset_server()
+    int backlog_count;
+    seed_sample_t backlog[FORECAST_SEED_BACKLOG];
+} seed_state_t;
+
+static EXT_RAM_BSS_ATTR seed_state_t s_seed[MAX_SERVERS];
+static EXT_RAM_BSS_ATTR forecast_model_t s_seed_model;     // Built by the (single) seed task
+static QueueHandle_t s_seed_queue = NULL;   // Server indexes to seed
+
+static bool seed_entry(const history_entry_t *entry, void *ctx) {
+    forecast_model_update(ctx, entry->timestamp, entry->player_count);
+    return true;
+}
+
+/**
+ * Replay recent SD history into a fresh model, then swap it in and apply
+ * the live samples that arrived meanwhile. Streamed a line at a time, so
+ * every sample in the window counts, in date order. Built outside the
+ * lock so UI reads never wait on SD I/O.
+ */
+static void forecast_seed_from_history(int server_index, uint32_t until, uint32_t gen) {
+    forecast_model_t *model = &s_seed_model;
+    forecast_model_reset(model);
+    int total = history_stream_range_json(server_index, until - FORECAST_SEED_DAYS * 86400U,
+                                          until - 1, seed_entry, model);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    seed_state_t *seed = &s_seed[server_index];
+    if (seed->pending && seed->gen == gen) {
+        if (total > 0) {
+            s_models[server_index] = *model;
+        }
+        for (int i = 0; i < seed->backlog_count; i++) {
+            forecast_model_update(&s_models[server_index], seed->backlog[i].ts, seed->backlog[i].players);
+        }
+        seed->backlog_count = 0;
+        seed->pending = false;
+    }
+    xSemaphoreGive(s_mutex);
+
+    ESP_LOGI(TAG, "Server %d: seeded forecast from %d samples (%lu profile hours)",
+             server_index, total, (unsigned long)s_models[server_index].total_hours);
+}
+
+static void seed_task(void *arg) {
+    (void)arg;
+    int server_index;
+    for (;;) {
+        if (xQueueReceive(s_seed_queue, &server_index, portMAX_DELAY) != pdTRUE) continue;
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        bool pending = s_seed[server_index].pending;
+        uint32_t until = s_seed[server_index].until;
+        uint32_t gen = s_seed[server_index].gen;
+        xSemaphoreGive(s_mutex);
+
+        if (pending) {
+            forecast_seed_from_history(server_index, until, gen);
+        }
+    }
+}
+
+void forecast_init(void) {
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+    if (!s_seed_queue) {
+        // A server is queued again only after a reset, so two slots each
+        s_seed_queue = xQueueCreate(2 * MAX_SERVERS, sizeof(int));
+        if (s_seed_queue && xTaskCreate(seed_task, "forecast_seed", FORECAST_SEED_TASK_STACK, NULL,
+                                        FORECAST_SEED_TASK_PRIORITY, NULL) != pdPASS) {
+            vQueueDelete(s_seed_queue);
+            s_seed_queue = NULL;
+        }
+    }
+    for (int i = 0; i < MAX_SERVERS; i++) {
+        forecast_model_reset(&s_models[i]);
+        s_seeded[i] = false;
+        s_seed[i].pending = false;
+        s_seed[i].backlog_count = 0;
+        s_seed[i].gen++;
+    }
+    ESP_LOGI(TAG, "Forecast service initialized (%d bytes/server)", (int)sizeof(forecast_model_t));
+}
+
+void forecast_process_sample(int server_index, uint32_t ts, int players) {
+    if (server_index < 0 || server_index >= MAX_SERVERS || !s_mutex) return;
+    if (ts < STORAGE_TIMESTAMP_MIN_VALID || players < 0) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    seed_state_t *seed = &s_seed[server_index];
+    if (!s_seeded[server_index]) {
+        // First sample: history up to it is loaded off the fetch path
+        s_seeded[server_index] = true;
+        if (s_seed_queue && sd_card_is_mounted()) {
+            seed->pending = true;
+            seed->until = ts;
+            seed->backlog_count = 0;
+            seed->pending = xQueueSend(s_seed_queue, &server_index, 0) == pdTRUE;
+        }
+    }
+
+    if (seed->pending) {
+        // Backlog full (seeding is slow): drop the oldest, never wait on SD here
+        if (seed->backlog_count >= FORECAST_SEED_BACKLOG) {
+            memmove(&seed->backlog[0], &seed->backlog[1],
+                    (FORECAST_SEED_BACKLOG - 1) * sizeof(seed->backlog[0]));
+            seed->backlog_count = FORECAST_SEED_BACKLOG - 1;
+            metrics_count(METRIC_CNT_FORECAST_SEED_DROPS);
+        }
+        seed->backlog[seed->backlog_count].ts = ts;
+        seed->backlog[seed->backlog_count].players = (int16_t)players;
+        seed->backlog_count++;
+    } else {
+        forecast_model_update(&s_models[server_index], ts, players);
+    }
+    xSemaphoreGive(s_mutex);
+}
+
+bool forecast_get_summary(int server_index, int max_players, forecast_summary_t *out) {
+    if (!out) return false;
+    out->valid = false;
+    out->has_best_join = false;
+
+    if (server_index < 0 || server_index >= MAX_SERVERS || !s_mutex) return false;
+
+    time_t now;
+    time(&now);
+    if (now < STORAGE_TIMESTAMP_MIN_VALID) return false;
+
+    // Called from the UI with LVGL locked - never block on the seeding task
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(10)) != pdTRUE) return false;
+
+    const forecast_model_t *m = &s_models[server_index];
+    if (forecast_model_ready(m)) {
+        out->valid = true;
+        out->expected_1h = (int)(forecast_model_predict(m, (uint32_t)now, 3600) + 0.5f);
+        out->expected_3h = (int)(forecast_model_predict(m, (uint32_t)now, 3 * 3600) + 0.5f);
+
+        float expected;
+        out->has_best_join = forecast_model_best_join(m, (uint32_t)now, max_players,
+                                                      &out->best_join_ts, &expected);
+        out->best_join_players = (int)(expected + 0.5f);
+    }
+
+    xSemaphoreGive(s_mutex);
+    return out->valid;
+}
+
+bool forecast_get_peak(int server_index, uint32_t now, uint32_t *peak_ts, int *peak_players) {
+    if (server_index < 0 || server_index >= MAX_SERVERS || !s_mutex) return false;
+    if (!peak_ts || !peak_players) return false;
+
+    float expected = 0.0f;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    bool ok = forecast_model_peak(&s_models[server_index], now, peak_ts, &expected);
+    xSemaphoreGive(s_mutex);
+
+    if (ok) {
+        *peak_players = (int)(expected + 0.5f);
+    }
+    return ok;
+}
+
+bool forecast_get_seasonal(int server_index, uint32_t ts, float *out) {
+    if (server_index < 0 || server_index >= MAX_SERVERS || !s_mutex || !out) return false;
+
+    bool ok = false;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    const forecast_model_t *m = &s_models[server_index];
+    if (forecast_model_ready(m)) {
+        float season = forecast_model_seasonal(m, ts);
+        if (season >= 0.0f) {
+            *out = season;
+            ok = true;
+        }
+    }
+    xSemaphoreGive(s_mutex);
+    return ok;
+}
+
+void forecast_reset_server(int server_index) {
+    if (server_index < 0 || server_index >= MAX_SERVERS || !s_mutex) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    forecast_model_reset(&s_models[server_index]);
+    s_seeded[server_index] = false;
+    s_seed[server_index].pending = false;
+    s_seed[server_index].backlog_count = 0;
+    s_seed[server_index].gen++;
+    xSemaphoreGive(s_mutex);
+}
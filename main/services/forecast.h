@@ -0,0 +1,77 @@
+/**
+ * DayZ Server Tracker - Forecast Service
+ * Per-server player forecasts ("expected in 1h / 3h", "best time to join")
+ *
+ * Owns one forecast_model_t per server slot. Models are seeded once from
+ * the SD card JSON history (streamed on a background task), then updated
+ * with every fetched sample.
+ */
+
+#ifndef FORECAST_H
+#define FORECAST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Forecast summary for display
+typedef struct {
+    bool valid;                     // Enough history to forecast
+    int expected_1h;                // Expected players in 1 hour
+    int expected_3h;                // Expected players in 3 hours
+    bool has_best_join;
+    uint32_t best_join_ts;          // Start of recommended hour (Unix)
+    int best_join_players;          // Expected players at that hour
+} forecast_summary_t;
+
+/**
+ * Initialize forecast service
+ */
+void forecast_init(void);
+
+/**
+ * Feed a new sample for a server
+ * The first call per server queues a seed from the last FORECAST_SEED_DAYS
+ * of SD history; samples arriving meanwhile are held and applied once it
+ * is in, in order. Never blocks on the seed: past FORECAST_SEED_BACKLOG
+ * held samples the oldest is dropped (counted in the metrics).
+ * @param server_index Index into settings.servers
+ * @param ts Unix timestamp
+ * @param players Player count
+ */
+void forecast_process_sample(int server_index, uint32_t ts, int players);
+
+/**
+ * Compute the current forecast summary (cheap, safe to call every UI update)
+ * @param server_index Index into settings.servers
+ * @param max_players Server capacity (for best join time)
+ * @param out Output summary
+ * @return true if out->valid
+ */
+bool forecast_get_summary(int server_index, int max_players, forecast_summary_t *out);
+
+/**
+ * Get the expected peak within the next 24 hours
+ * @param server_index Index into settings.servers
+ * @param now Current Unix timestamp
+ * @param peak_ts Output: start of the busiest hour (Unix)
+ * @param peak_players Output: expected players at that hour
+ * @return true if the model is ready
+ */
+bool forecast_get_peak(int server_index, uint32_t now, uint32_t *peak_ts, int *peak_players);
+
+/**
+ * Get the seasonal baseline (typical players for this weekday/hour)
+ * @param server_index Index into settings.servers
+ * @param ts Unix timestamp
+ * @param out Output baseline
+ * @return true if the model is ready and out was set
+ */
+bool forecast_get_seasonal(int server_index, uint32_t ts, float *out);
+
+/**
+ * Drop the model of a server slot (server deleted or replaced)
+ * @param server_index Index into settings.servers
+ */
+void forecast_reset_server(int server_index);
+
+#endif // FORECAST_H
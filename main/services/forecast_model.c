@@ -0,0 +1,180 @@
+/**
+ * DayZ Server Tracker - Forecast Model Implementation
+ *
+ * Samples are averaged per clock hour and folded into a (weekday, hour)
+ * profile with a capped running mean, so each bucket tracks roughly the
+ * last FORECAST_SEASON_MAX_N weeks. On top of that an exponentially
+ * smoothed residual (level + slope, corrected for irregular sample gaps)
+ * captures today's deviation; it is damped towards zero with the horizon.
+ */
+
+#include "forecast_model.h"
+#include "time_util.h"
+#include <math.h>
+#include <string.h>
+
+static void bucket_of(uint32_t ts, uint8_t *dow, uint8_t *hod) {
+    time_util_bucket(ts, dow, hod);
+}
+
+/**
+ * Seasonal estimate with fallbacks for empty buckets:
+ * same hour on other weekdays, then the overall mean, then -1.
+ */
+static float seasonal_estimate(const forecast_model_t *m, uint8_t dow, uint8_t hod) {
+    if (m->season_n[dow][hod] > 0) {
+        return m->season[dow][hod];
+    }
+
+    float sum = 0.0f;
+    int n = 0;
+    for (int d = 0; d < 7; d++) {
+        if (m->season_n[d][hod] > 0) {
+            sum += m->season[d][hod];
+            n++;
+        }
+    }
+    if (n > 0) return sum / n;
+
+    for (int d = 0; d < 7; d++) {
+        for (int h = 0; h < 24; h++) {
+            if (m->season_n[d][h] > 0) {
+                sum += m->season[d][h];
+                n++;
+            }
+        }
+    }
+    return n > 0 ? sum / n : -1.0f;
+}
+
+static void fold_hour(forecast_model_t *m) {
+    if (m->hour_key == 0 || m->hour_samples == 0) return;
+
+    float mean = m->hour_sum / m->hour_samples;
+    uint16_t *n = &m->season_n[m->hour_dow][m->hour_hod];
+    float *s = &m->season[m->hour_dow][m->hour_hod];
+
+    if (*n < FORECAST_SEASON_MAX_N) (*n)++;
+    *s += (mean - *s) / *n;
+    m->total_hours++;
+}
+
+void forecast_model_reset(forecast_model_t *m) {
+    memset(m, 0, sizeof(*m));
+}
+
+void forecast_model_update(forecast_model_t *m, uint32_t ts, int players) {
+    if (players < 0 || ts == 0) return;
+    if (m->last_ts != 0 && ts <= m->last_ts) return;  // Out of order
+
+    // Close the previous clock hour into the profile
+    uint32_t key = ts / 3600;
+    if (key != m->hour_key) {
+        fold_hour(m);
+        m->hour_key = key;
+        bucket_of(ts, &m->hour_dow, &m->hour_hod);
+        m->hour_sum = 0.0f;
+        m->hour_samples = 0;
+    }
+    m->hour_sum += players;
+    m->hour_samples++;
+
+    // Residual against the profile (zero until the profile has data)
+    float season = seasonal_estimate(m, m->hour_dow, m->hour_hod);
+    float resid = season >= 0.0f ? (float)players - season : 0.0f;
+
+    uint32_t dt = m->last_ts ? ts - m->last_ts : 0;
+    if (m->last_ts == 0 || dt > FORECAST_GAP_RESET_SEC) {
+        m->resid_level = resid;
+        m->resid_slope = 0.0f;
+    } else {
+        // Time-aware smoothing handles 30 s and 2 min poll intervals alike
+        float a = 1.0f - expf(-(float)dt / FORECAST_LEVEL_TAU_SEC);
+        float b = 1.0f - expf(-(float)dt / FORECAST_SLOPE_TAU_SEC);
+        float prev = m->resid_level;
+        m->resid_level += a * (resid - m->resid_level);
+        float inst_slope = (m->resid_level - prev) * 3600.0f / (float)dt;
+        m->resid_slope += b * (inst_slope - m->resid_slope);
+    }
+
+    m->last_ts = ts;
+    m->last_value = (float)players;
+}
+
+bool forecast_model_ready(const forecast_model_t *m) {
+    return m->total_hours >= FORECAST_MIN_HOURS;
+}
+
+float forecast_model_seasonal(const forecast_model_t *m, uint32_t ts) {
+    uint8_t dow, hod;
+    bucket_of(ts, &dow, &hod);
+    return seasonal_estimate(m, dow, hod);
+}
+
+float forecast_model_predict(const forecast_model_t *m, uint32_t now, uint32_t horizon_sec) {
+    uint8_t dow, hod;
+    bucket_of(now + horizon_sec, &dow, &hod);
+
+    float season = seasonal_estimate(m, dow, hod);
+    if (season < 0.0f) {
+        return m->last_value;   // No profile yet: persistence
+    }
+
+    // Project the slope at most one hour, then damp the whole residual
+    float h_hours = horizon_sec / 3600.0f;
+    float resid = m->resid_level + m->resid_slope * (h_hours < 1.0f ? h_hours : 1.0f);
+    resid *= expf(-(float)horizon_sec / FORECAST_RESID_DECAY_SEC);
+
+    float value = season + resid;
+    return value > 0.0f ? value : 0.0f;
+}
+
+bool forecast_model_peak(const forecast_model_t *m, uint32_t now,
+                         uint32_t *peak_ts, float *expected) {
+    if (!forecast_model_ready(m)) return false;
+
+    uint32_t first_hour = (now / 3600 + 1) * 3600;
+    *peak_ts = first_hour;
+    *expected = -1.0f;
+
+    for (int k = 0; k < 24; k++) {
+        uint32_t t = first_hour + k * 3600;
+        float e = forecast_model_predict(m, now, t - now);
+        if (e > *expected) {
+            *peak_ts = t;
+            *expected = e;
+        }
+    }
+    return true;
+}
+
+bool forecast_model_best_join(const forecast_model_t *m, uint32_t now, int max_players,
+                              uint32_t *best_ts, float *expected) {
+    if (!forecast_model_ready(m) || max_players <= 0) return false;
+
+    float limit = (float)(max_players - FORECAST_JOIN_FREE_SLOTS);
+    uint32_t first_hour = (now / 3600 + 1) * 3600;
+
+    int best_fit = -1;
+    float best_fit_val = -1.0f;
+    int quietest = 0;
+    float quietest_val = 1e9f;
+
+    for (int k = 0; k < 24; k++) {
+        uint32_t t = first_hour + k * 3600;
+        float e = forecast_model_predict(m, now, t - now);
+        if (e <= limit && e > best_fit_val) {
+            best_fit = k;
+            best_fit_val = e;
+        }
+        if (e < quietest_val) {
+            quietest = k;
+            quietest_val = e;
+        }
+    }
+
+    int pick = best_fit >= 0 ? best_fit : quietest;
+    *best_ts = first_hour + pick * 3600;
+    *expected = best_fit >= 0 ? best_fit_val : quietest_val;
+    return true;
+}
@@ -0,0 +1,109 @@
+/**
+ * DayZ Server Tracker - Forecast Model
+ * Seasonal (weekday x hour) player profile plus a damped recent-trend term
+ *
+ * Pure C with no ESP-IDF dependencies so the same code runs in the host
+ * accuracy benchmark (host/forecast_bench.c). Fixed memory per model,
+ * O(1) update per sample.
+ */
+
+#ifndef FORECAST_MODEL_H
+#define FORECAST_MODEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// ============== MODEL TUNING ==============
+#define FORECAST_SEASON_MAX_N       8       // Bucket averages over the last ~8 weeks
+#define FORECAST_LEVEL_TAU_SEC      1800    // Residual level smoothing
+#define FORECAST_SLOPE_TAU_SEC      3600    // Residual slope smoothing
+#define FORECAST_RESID_DECAY_SEC    7200    // Residual fades into the profile over ~2h
+#define FORECAST_GAP_RESET_SEC      21600   // Restart trend after a 6h data gap
+#define FORECAST_MIN_HOURS          24      // Profile hours needed before forecasting
+#define FORECAST_JOIN_FREE_SLOTS    3       // "Best time to join" keeps this many slots free
+
+// Model state for one server
+typedef struct {
+    float season[7][24];            // Mean players per (weekday, local hour)
+    uint16_t season_n[7][24];       // Hours folded into each bucket (capped)
+    uint32_t total_hours;           // Hours folded in total
+
+    // Accumulator for the hour in progress
+    uint32_t hour_key;              // ts / 3600 of current hour (0 = none)
+    uint8_t hour_dow;
+    uint8_t hour_hod;
+    float hour_sum;
+    uint16_t hour_samples;
+
+    // Recent-trend component: residual against the seasonal profile
+    float resid_level;
+    float resid_slope;              // Players per hour
+    uint32_t last_ts;
+    float last_value;
+} forecast_model_t;
+
+/**
+ * Clear a model
+ * @param m Model
+ */
+void forecast_model_reset(forecast_model_t *m);
+
+/**
+ * Fold one sample into the model
+ * @param m Model
+ * @param ts Unix timestamp (samples must arrive in time order)
+ * @param players Player count
+ */
+void forecast_model_update(forecast_model_t *m, uint32_t ts, int players);
+
+/**
+ * Check if the model has seen enough data to forecast
+ * @param m Model
+ * @return true once FORECAST_MIN_HOURS have been folded in
+ */
+bool forecast_model_ready(const forecast_model_t *m);
+
+/**
+ * Seasonal profile value alone (no recent-trend term)
+ * Used as the baseline for anomaly detection.
+ * @param m Model
+ * @param ts Unix timestamp
+ * @return Profile players at ts, or -1 if the profile is empty
+ */
+float forecast_model_seasonal(const forecast_model_t *m, uint32_t ts);
+
+/**
+ * Predict player count
+ * @param m Model
+ * @param now Current Unix timestamp
+ * @param horizon_sec Seconds ahead of now
+ * @return Expected players (>= 0)
+ */
+float forecast_model_predict(const forecast_model_t *m, uint32_t now, uint32_t horizon_sec);
+
+/**
+ * Find the busiest hour within the next 24 hours
+ * @param m Model
+ * @param now Current Unix timestamp
+ * @param peak_ts Output: start of the busiest hour (Unix)
+ * @param expected Output: expected players at that hour
+ * @return true if the model is ready
+ */
+bool forecast_model_peak(const forecast_model_t *m, uint32_t now,
+                         uint32_t *peak_ts, float *expected);
+
+/**
+ * Find the best hour to join within the next 24 hours
+ * Busiest hour that still leaves FORECAST_JOIN_FREE_SLOTS free slots,
+ * or the quietest hour if every hour is expected to be full.
+ * @param m Model
+ * @param now Current Unix timestamp
+ * @param max_players Server capacity
+ * @param best_ts Output: start of the best hour (Unix)
+ * @param expected Output: expected players at that hour
+ * @return true if a recommendation is available
+ */
+bool forecast_model_best_join(const forecast_model_t *m, uint32_t now, int max_players,
+                              uint32_t *best_ts, float *expected);
+
+#endif // FORECAST_MODEL_H
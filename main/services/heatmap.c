@@ -0,0 +1,87 @@
+/**
+ * DayZ Server Tracker - Heatmap Data Implementation
+ */
+
+#include "heatmap.h"
+#include "history_store.h"
+#include "time_util.h"
+#include "esp_log.h"
+#include "arena.h"
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "heatmap";
+
+void heatmap_calculate(int server_index, heatmap_data_t *heatmap) {
+    ESP_LOGI(TAG, "Calculating heatmap for server %d", server_index);
+
+    memset(heatmap, 0, sizeof(heatmap_data_t));
+
+    time_t now;
+    time(&now);
+    uint32_t end_time = (uint32_t)now;
+    uint32_t start_time = end_time - (28 * 86400);  // 28 days back
+
+    // Allocate buffer for history entries in PSRAM
+    // 28 days of hourly JSON samples ~= 672, generous cap at 2000
+    int max_entries = 2000;
+    history_entry_t *entries = arena_alloc(ARENA_SCRATCH, max_entries * sizeof(history_entry_t),
+                                           "heatmap");
+
+    if (!entries) {
+        ESP_LOGE(TAG, "Failed to allocate entry buffer");
+        return;
+    }
+
+    int count = history_load_range_json(server_index, start_time, end_time,
+                                         entries, max_entries);
+
+    ESP_LOGI(TAG, "Loaded %d history entries", count);
+
+    if (count <= 0) {
+        arena_free(entries);
+        return;
+    }
+
+    // Bucket entries into period/day slots (4-hour periods, local time)
+    for (int i = 0; i < count; i++) {
+        uint8_t wday, hour;
+        time_util_bucket(entries[i].timestamp, &wday, &hour);
+
+        // Convert to Monday=0 format (wday has Sunday=0)
+        int day = (wday + 6) % 7;
+        int period = hour / 4;  // 0-5 for 6 periods
+
+        if (period >= HEATMAP_PERIODS) period = HEATMAP_PERIODS - 1;
+
+        // Accumulate (with overflow protection)
+        if (heatmap->cells[day][period].count < 255) {
+            heatmap->cells[day][period].sum += entries[i].player_count;
+            heatmap->cells[day][period].count++;
+        }
+    }
+
+    arena_free(entries);
+
+    // Calculate min/max averages for normalization
+    heatmap->min_avg = INT16_MAX;
+    heatmap->max_avg = 0;
+
+    for (int d = 0; d < HEATMAP_DAYS; d++) {
+        for (int p = 0; p < HEATMAP_PERIODS; p++) {
+            if (heatmap->cells[d][p].count > 0) {
+                int avg = heatmap->cells[d][p].sum / heatmap->cells[d][p].count;
+                if (avg < heatmap->min_avg) heatmap->min_avg = avg;
+                if (avg > heatmap->max_avg) heatmap->max_avg = avg;
+            }
+        }
+    }
+
+    if (heatmap->min_avg == INT16_MAX) {
+        heatmap->min_avg = 0;
+        heatmap->max_avg = 60;
+    }
+
+    heatmap->valid = true;
+    ESP_LOGI(TAG, "Heatmap calculated: min=%d, max=%d", heatmap->min_avg, heatmap->max_avg);
+}
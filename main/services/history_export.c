@@ -0,0 +1,603 @@
+/**
+ * DayZ Server Tracker - History Exporter Implementation
+ */
+
+#include "history_export.h"
+#include "history_store.h"
+#include "storage_paths.h"
+#include "storage_config.h"
+#include "time_util.h"
+#include "arena.h"
+#include "config.h"
+#include "app_state.h"
+#include "drivers/sd_card.h"
+#include <string.h>
+#include <stdlib.h>
+#include <time.h>
+#include <sys/stat.h>
+#include <dirent.h>
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+
+static const char *TAG = "history_export";
+
+static SemaphoreHandle_t s_mutex = NULL;
+static export_status_t s_status = { 0 };
+static export_request_t s_request;          // Owned by the task while busy
+
+// ============== OUTPUT BUFFER ==============
+
+typedef struct {
+    FILE *f;
+    uint8_t *buf;                   // EXPORT_WRITE_BUF_SIZE, PSRAM
+    size_t used;
+    uint32_t bytes;                 // Written to f so far
+    esp_err_t err;
+} out_t;
+
+static void out_flush(out_t *o) {
+    if (o->used == 0 || o->err != ESP_OK) {
+        o->used = 0;
+        return;
+    }
+    if (fwrite(o->buf, 1, o->used, o->f) != o->used) {
+        ESP_LOGE(TAG, "Write failed after %lu bytes", (unsigned long)o->bytes);
+        o->err = ESP_FAIL;
+    }
+    o->bytes += o->used;
+    o->used = 0;
+}
+
+static inline void out_byte(out_t *o, uint8_t b) {
+    if (o->used == EXPORT_WRITE_BUF_SIZE) out_flush(o);
+    o->buf[o->used++] = b;
+}
+
+static void out_bytes(out_t *o, const void *data, size_t len) {
+    const uint8_t *p = data;
+    while (len > 0) {
+        if (o->used == EXPORT_WRITE_BUF_SIZE) out_flush(o);
+        size_t n = EXPORT_WRITE_BUF_SIZE - o->used;
+        if (n > len) n = len;
+        memcpy(o->buf + o->used, p, n);
+        o->used += n;
+        p += n;
+        len -= n;
+    }
+}
+
+static void out_str(out_t *o, const char *s) {
+    out_bytes(o, s, strlen(s));
+}
+
+// Decimal without printf - CSV rows are the hot path
+static void out_int(out_t *o, int32_t v) {
+    char tmp[12];
+    int i = sizeof(tmp);
+    uint32_t u = v < 0 ? (uint32_t)0 - (uint32_t)v : (uint32_t)v;
+    do {
+        tmp[--i] = (char)('0' + u % 10);
+        u /= 10;
+    } while (u);
+    if (v < 0) tmp[--i] = '-';
+    out_bytes(o, tmp + i, sizeof(tmp) - i);
+}
+
+static void out_uint(out_t *o, uint32_t v) {
+    char tmp[10];
+    int i = sizeof(tmp);
+    do {
+        tmp[--i] = (char)('0' + v % 10);
+        v /= 10;
+    } while (v);
+    out_bytes(o, tmp + i, sizeof(tmp) - i);
+}
+
+// ============== VARINTS ==============
+
+static inline uint32_t zigzag(int32_t v) {
+    return ((uint32_t)v << 1) ^ (uint32_t)(v >> 31);
+}
+
+static inline int32_t unzigzag(uint32_t v) {
+    return (int32_t)(v >> 1) ^ -(int32_t)(v & 1);
+}
+
+static inline int varint_len(uint32_t v) {
+    int n = 1;
+    while (v >= 0x80) {
+        v >>= 7;
+        n++;
+    }
+    return n;
+}
+
+static inline void out_varint(out_t *o, uint32_t v) {
+    while (v >= 0x80) {
+        out_byte(o, (uint8_t)(v | 0x80));
+        v >>= 7;
+    }
+    out_byte(o, (uint8_t)v);
+}
+
+// Column c, row i as the value its varint encodes
+static inline uint32_t column_code(int32_t *const cols[], int c, int i) {
+    const int32_t *col = cols[c];
+    if (c == EXPORT_COL_TIME) {
+        // Times: change of the gap. Unsigned math wraps the same way on both ends.
+        uint32_t delta = i > 0 ? (uint32_t)col[i] - (uint32_t)col[i - 1] : 0;
+        uint32_t prev = i > 1 ? (uint32_t)col[i - 1] - (uint32_t)col[i - 2] : 0;
+        return zigzag((int32_t)(delta - prev));
+    }
+    return zigzag(col[i] - (i > 0 ? col[i - 1] : 0));
+}
+
+// ============== JOB ==============
+
+typedef struct {
+    const export_request_t *req;
+    out_t out;
+    int32_t *cols[EXPORT_DZC_MAX_COLUMNS];  // Open DZC group
+    int ncols;
+    int rows;                       // In the open group
+    uint32_t total_rows;
+    uint32_t groups;
+    // Open bucket (step > 0)
+    uint32_t bucket;
+    int n;
+    int min;
+    int max;
+    int32_t sum;
+} job_t;
+
+static void flush_group(job_t *job) {
+    if (job->rows == 0) return;
+
+    export_dzc_group_t group = {
+        .rows = (uint32_t)job->rows,
+        .first_ts = (uint32_t)job->cols[EXPORT_COL_TIME][0],
+        .last_ts = (uint32_t)job->cols[EXPORT_COL_TIME][job->rows - 1],
+        .bytes = 0,
+    };
+    for (int c = 0; c < job->ncols; c++) {
+        for (int i = 0; i < job->rows; i++) {
+            group.bytes += varint_len(column_code(job->cols, c, i));
+        }
+    }
+
+    out_bytes(&job->out, &group, sizeof(group));
+    for (int c = 0; c < job->ncols; c++) {
+        for (int i = 0; i < job->rows; i++) {
+            out_varint(&job->out, column_code(job->cols, c, i));
+        }
+    }
+    job->groups++;
+    job->rows = 0;
+}
+
+static void emit_row(job_t *job, uint32_t t, int players, int min, int max, int n) {
+    job->total_rows++;
+
+    if (job->req->format == EXPORT_FORMAT_CSV) {
+        out_t *o = &job->out;
+        out_uint(o, t);
+        out_byte(o, ',');
+        out_int(o, players);
+        if (job->req->step_sec) {
+            out_byte(o, ',');
+            out_int(o, min);
+            out_byte(o, ',');
+            out_int(o, max);
+            out_byte(o, ',');
+            out_int(o, n);
+        }
+        out_byte(o, '\n');
+        return;
+    }
+
+    int i = job->rows++;
+    job->cols[EXPORT_COL_TIME][i] = (int32_t)t;
+    job->cols[EXPORT_COL_PLAYERS][i] = players;
+    if (job->req->step_sec) {
+        job->cols[EXPORT_COL_MIN][i] = min;
+        job->cols[EXPORT_COL_MAX][i] = max;
+        job->cols[EXPORT_COL_SAMPLES][i] = n;
+    }
+    if (job->rows == EXPORT_GROUP_ROWS) {
+        flush_group(job);
+    }
+}
+
+static void emit_bucket(job_t *job) {
+    if (job->n == 0) return;
+    emit_row(job, job->bucket, (int)((job->sum + job->n / 2) / job->n), job->min, job->max, job->n);
+    job->n = 0;
+}
+
+static bool on_entry(const history_entry_t *entry, void *ctx) {
+    job_t *job = ctx;
+    int p = entry->player_count;
+    if (p < 0) return true;
+
+    uint32_t step = job->req->step_sec;
+    if (step == 0) {
+        emit_row(job, entry->timestamp, p, p, p, 1);
+    } else {
+        uint32_t bucket = entry->timestamp - entry->timestamp % step;
+        if (job->n > 0 && bucket != job->bucket) {
+            emit_bucket(job);
+        }
+        if (job->n == 0) {
+            job->bucket = bucket;
+            job->min = p;
+            job->max = p;
+            job->sum = 0;
+        }
+        job->n++;
+        job->sum += p;
+        if (p < job->min) job->min = p;
+        if (p > job->max) job->max = p;
+    }
+    return job->out.err == ESP_OK;
+}
+
+// ============== STATUS ==============
+
+static void status_update(const char *path, int files, uint32_t rows, uint32_t bytes, int64_t t_start) {
+    if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (path) {
+        strncpy(s_status.path, path, sizeof(s_status.path) - 1);
+        s_status.path[sizeof(s_status.path) - 1] = '\0';
+    }
+    s_status.files = files;
+    s_status.rows = rows;
+    s_status.bytes = bytes;
+    s_status.elapsed_ms = (uint32_t)((esp_timer_get_time() - t_start) / 1000);
+    if (s_mutex) xSemaphoreGive(s_mutex);
+}
+
+void history_export_get_status(export_status_t *out) {
+    if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY);
+    *out = s_status;
+    if (s_mutex) xSemaphoreGive(s_mutex);
+}
+
+const char *history_export_format_name(export_format_t format) {
+    return format == EXPORT_FORMAT_DZC ? "dzc" : "csv";
+}
+
+// ============== RUN ==============
+
+static void build_export_path(const export_request_t *req, int server_index, char *path, size_t size) {
+    struct tm from_tm, to_tm;
+    time_util_to_tm(req->start_time, &from_tm);
+    time_util_to_tm(req->end_time, &to_tm);
+
+    char step[16] = "";
+    if (req->step_sec) {
+        snprintf(step, sizeof(step), "_%lus", (unsigned long)req->step_sec);
+    }
+
+    char name[64];
+    snprintf(name, sizeof(name), "s%d_%04d%02d%02d-%04d%02d%02d%s.%s", server_index,
+             from_tm.tm_year + 1900, from_tm.tm_mon + 1, from_tm.tm_mday,
+             to_tm.tm_year + 1900, to_tm.tm_mon + 1, to_tm.tm_mday,
+             step, history_export_format_name(req->format));
+    storage_path_export(name, path, size);
+}
+
+static esp_err_t export_server(job_t *job, int server_index, int files, uint32_t *rows,
+                               uint32_t *bytes, int64_t t_start) {
+    const export_request_t *req = job->req;
+    char path[80];
+    build_export_path(req, server_index, path, sizeof(path));
+    status_update(path, files, *rows, *bytes, t_start);
+
+    job->out.f = fopen(path, "wb");
+    if (!job->out.f) {
+        ESP_LOGE(TAG, "Cannot create %s", path);
+        return ESP_FAIL;
+    }
+    // The buffer already batches writes; let them reach FATFS whole
+    setvbuf(job->out.f, NULL, _IONBF, 0);
+
+    job->out.used = 0;
+    job->out.bytes = 0;
+    job->out.err = ESP_OK;
+    job->rows = 0;
+    job->total_rows = 0;
+    job->groups = 0;
+    job->n = 0;
+
+    if (req->format == EXPORT_FORMAT_DZC) {
+        export_dzc_header_t header = {
+            .magic = EXPORT_DZC_MAGIC,
+            .version = EXPORT_DZC_VERSION,
+            .columns = (uint8_t)job->ncols,
+            .server_index = (uint8_t)server_index,
+            .step_sec = req->step_sec,
+            .start_time = req->start_time,
+            .end_time = req->end_time,
+        };
+        app_state_t *state = app_state_get();
+        if (app_state_lock(100)) {
+            strncpy(header.server_id, state->settings.servers[server_index].server_id,
+                    sizeof(header.server_id) - 1);
+            app_state_unlock();
+        }
+        out_bytes(&job->out, &header, sizeof(header));
+    } else {
+        out_str(&job->out, req->step_sec ? "time,avg,min,max,samples\n" : "time,players\n");
+    }
+
+    int streamed = history_stream_range_json(server_index, req->start_time, req->end_time,
+                                             on_entry, job);
+    emit_bucket(job);
+
+    if (req->format == EXPORT_FORMAT_DZC) {
+        flush_group(job);
+        export_dzc_footer_t footer = {
+            .groups = job->groups,
+            .rows = job->total_rows,
+            .magic = EXPORT_DZC_MAGIC,
+        };
+        out_bytes(&job->out, &footer, sizeof(footer));
+    }
+    out_flush(&job->out);
+
+    esp_err_t err = job->out.err;
+    if (fclose(job->out.f) != 0 && err == ESP_OK) {
+        err = ESP_FAIL;
+    }
+    job->out.f = NULL;
+    if (streamed < 0 && err == ESP_OK) {
+        err = ESP_ERR_INVALID_STATE;    // SD went away
+    }
+    if (err != ESP_OK) {
+        remove(path);
+        return err;
+    }
+
+    *rows += job->total_rows;
+    *bytes += job->out.bytes;
+    ESP_LOGI(TAG, "%s: %d samples -> %lu rows, %lu bytes", path, streamed,
+             (unsigned long)job->total_rows, (unsigned long)job->out.bytes);
+    return ESP_OK;
+}
+
+static bool server_exportable(int index) {
+    app_state_t *state = app_state_get();
+    return index >= 0 && index < state->settings.server_count &&
+           state->settings.servers[index].active;
+}
+
+/**
+ * Make room for an export: delete the oldest files (by mtime) until at most
+ * EXPORT_KEEP_FILES remain once `incoming` more are written
+ * Exports otherwise pile up, one set per distinct range asked for.
+ */
+static void prune_export_dir(const char *dir_path, int incoming) {
+    char path[STORAGE_PATH_MAX_LEN];
+    for (;;) {
+        DIR *dir = opendir(dir_path);
+        if (!dir) return;
+
+        int count = 0;
+        time_t oldest_mtime = 0;
+        char oldest[STORAGE_PATH_MAX_LEN] = "";
+        struct dirent *entry;
+        while ((entry = readdir(dir)) != NULL) {
+            struct stat st;
+            storage_path_export(entry->d_name, path, sizeof(path));
+            if (stat(path, &st) != 0 || !S_ISREG(st.st_mode)) continue;
+            count++;
+            if (oldest[0] == '\0' || st.st_mtime < oldest_mtime) {
+                oldest_mtime = st.st_mtime;
+                strncpy(oldest, path, sizeof(oldest) - 1);
+                oldest[sizeof(oldest) - 1] = '\0';
+            }
+        }
+        closedir(dir);
+
+        if (count + incoming <= EXPORT_KEEP_FILES || oldest[0] == '\0') return;
+        if (remove(oldest) != 0) {
+            ESP_LOGW(TAG, "Cannot delete old export %s", oldest);
+            return;
+        }
+        ESP_LOGI(TAG, "Deleted old export %s", oldest);
+    }
+}
+
+esp_err_t history_export_run(const export_request_t *req) {
+    // One lease for the whole run; the card is not lent out mid-file
+    if (!sd_card_is_mounted() || !sd_card_lease()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    int64_t t_start = esp_timer_get_time();
+    job_t job = {
+        .req = req,
+        .ncols = req->step_sec ? EXPORT_DZC_MAX_COLUMNS : 2,
+    };
+
+    job.out.buf = arena_alloc(ARENA_BULK, EXPORT_WRITE_BUF_SIZE, "export_buf");
+    bool ok = job.out.buf != NULL;
+    if (req->format == EXPORT_FORMAT_DZC) {
+        for (int c = 0; c < job.ncols && ok; c++) {
+            job.cols[c] = arena_alloc(ARENA_BULK, EXPORT_GROUP_ROWS * sizeof(int32_t), "export_col");
+            ok = job.cols[c] != NULL;
+        }
+    }
+
+    esp_err_t err = ok ? ESP_OK : ESP_ERR_NO_MEM;
+    app_state_t *state = app_state_get();
+    if (ok) {
+        int incoming = 0;
+        for (int i = 0; i < state->settings.server_count; i++) {
+            if (req->server_index >= 0 && i != req->server_index) continue;
+            if (server_exportable(i)) incoming++;
+        }
+        char dir[64];
+        storage_path_export_dir(dir, sizeof(dir));
+        mkdir(dir, 0755);
+        prune_export_dir(dir, incoming);
+    }
+
+    int files = 0;
+    uint32_t rows = 0;
+    uint32_t bytes = 0;
+    for (int i = 0; err == ESP_OK && i < state->settings.server_count; i++) {
+        if (req->server_index >= 0 && i != req->server_index) continue;
+        if (!server_exportable(i)) continue;
+        err = export_server(&job, i, files, &rows, &bytes, t_start);
+        if (err == ESP_OK) files++;
+    }
+
+    arena_free(job.out.buf);
+    for (int c = 0; c < EXPORT_DZC_MAX_COLUMNS; c++) {
+        arena_free(job.cols[c]);
+    }
+
+    sd_card_release();
+    status_update(NULL, files, rows, bytes, t_start);
+    ESP_LOGI(TAG, "Export %s: %d files, %lu rows, %lu bytes in %lld ms",
+             err == ESP_OK ? "done" : esp_err_to_name(err), files, (unsigned long)rows,
+             (unsigned long)bytes, (long long)((esp_timer_get_time() - t_start) / 1000));
+    return err;
+}
+
+static void export_task(void *arg) {
+    (void)arg;
+    esp_err_t err = history_export_run(&s_request);
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_status.result = err;
+    s_status.busy = false;
+    xSemaphoreGive(s_mutex);
+
+    vTaskDelete(NULL);
+}
+
+esp_err_t history_export_start(const export_request_t *req) {
+    if (!req || req->start_time > req->end_time ||
+        req->end_time - req->start_time > EXPORT_MAX_RANGE_DAYS * 86400U ||
+        req->step_sec > 86400 ||
+        (req->format != EXPORT_FORMAT_CSV && req->format != EXPORT_FORMAT_DZC) ||
+        (req->server_index >= 0 && !server_exportable(req->server_index))) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (!sd_card_is_mounted()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) return ESP_ERR_NO_MEM;
+    }
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    if (s_status.busy) {
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_INVALID_STATE;
+    }
+    memset(&s_status, 0, sizeof(s_status));
+    s_status.busy = true;
+    s_request = *req;
+    xSemaphoreGive(s_mutex);
+
+    if (xTaskCreate(export_task, "hist_export", EXPORT_TASK_STACK, NULL,
+                    EXPORT_TASK_PRIORITY, NULL) != pdPASS) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        s_status.busy = false;
+        s_status.result = ESP_ERR_NO_MEM;
+        xSemaphoreGive(s_mutex);
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Export queued: server %d, %lu..%lu, %s, step %lus", req->server_index,
+             (unsigned long)req->start_time, (unsigned long)req->end_time,
+             history_export_format_name(req->format), (unsigned long)req->step_sec);
+    return ESP_OK;
+}
+
+// ============== READING ==============
+
+esp_err_t export_dzc_open(export_dzc_reader_t *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if (!r->f) return ESP_ERR_NOT_FOUND;
+
+    if (fread(&r->header, sizeof(r->header), 1, r->f) != 1 ||
+        r->header.magic != EXPORT_DZC_MAGIC || r->header.version != EXPORT_DZC_VERSION ||
+        r->header.columns < 2 || r->header.columns > EXPORT_DZC_MAX_COLUMNS) {
+        fclose(r->f);
+        r->f = NULL;
+        return ESP_ERR_INVALID_VERSION;
+    }
+    return ESP_OK;
+}
+
+int export_dzc_next(export_dzc_reader_t *r, export_dzc_group_t *group, int32_t *cols[]) {
+    // A group header and the footer differ in size; read the footer's worth first
+    uint8_t head[sizeof(export_dzc_group_t)];
+    if (fread(head, sizeof(export_dzc_footer_t), 1, r->f) != 1) return -1;
+
+    export_dzc_footer_t footer;
+    memcpy(&footer, head, sizeof(footer));
+    if (footer.magic == EXPORT_DZC_MAGIC) {
+        return 0;
+    }
+
+    if (fread(head + sizeof(export_dzc_footer_t),
+              sizeof(head) - sizeof(export_dzc_footer_t), 1, r->f) != 1) {
+        return -1;
+    }
+    memcpy(group, head, sizeof(*group));
+    if (group->rows == 0 || group->rows > EXPORT_GROUP_ROWS ||
+        group->bytes > group->rows * 5U * r->header.columns) {
+        return -1;
+    }
+
+    if (group->bytes > r->buf_size) {
+        uint8_t *buf = realloc(r->buf, group->bytes);
+        if (!buf) return -1;
+        r->buf = buf;
+        r->buf_size = group->bytes;
+    }
+    if (fread(r->buf, 1, group->bytes, r->f) != group->bytes) return -1;
+
+    const uint8_t *p = r->buf;
+    const uint8_t *end = r->buf + group->bytes;
+    for (int c = 0; c < r->header.columns; c++) {
+        int32_t prev = 0;
+        uint32_t delta = 0;
+        for (uint32_t i = 0; i < group->rows; i++) {
+            uint32_t v = 0;
+            int shift = 0;
+            do {
+                if (p >= end || shift > 28) return -1;
+                v |= (uint32_t)(*p & 0x7F) << shift;
+                shift += 7;
+            } while (*p++ & 0x80);
+
+            if (c == EXPORT_COL_TIME) {
+                delta += (uint32_t)unzigzag(v);
+                prev = (int32_t)(i == 0 ? group->first_ts : (uint32_t)prev + delta);
+            } else {
+                prev += unzigzag(v);
+            }
+            cols[c][i] = prev;
+        }
+    }
+    return p == end ? (int)group->rows : -1;
+}
+
+void export_dzc_close(export_dzc_reader_t *r) {
+    if (r->f) fclose(r->f);
+    free(r->buf);
+    r->f = NULL;
+    r->buf = NULL;
+}
@@ -0,0 +1,142 @@
+/**
+ * DayZ Server Tracker - History Exporter
+ * Streams history out of the daily JSONL files into CSV or a compact
+ * columnar file, optionally rolled up, on a background task
+ *
+ * Output goes to /sdcard/export/s<server>_<YYYYMMDD>-<YYYYMMDD>[_<step>s]
+ * with .csv or .dzc, one file per server. Rows are built in a PSRAM
+ * buffer and written EXPORT_WRITE_BUF_SIZE at a time.
+ *
+ * CSV:    "time,players" per sample, or "time,avg,min,max,samples" per
+ *         step-second bucket (time = bucket start, Unix seconds)
+ *
+ * DZC (columnar, all little-endian):
+ *   File:   export_dzc_header_t
+ *   Group:  export_dzc_group_t, then each column in turn as varints:
+ *             time     zigzag(delta - previous delta), first from first_ts
+ *             others   zigzag(value - previous value), first from 0
+ *           Up to EXPORT_GROUP_ROWS rows; first/last_ts let a reader skip
+ *           groups outside its range without decoding them
+ *   Footer: export_dzc_footer_t
+ * A 30 s sample costs ~2 bytes (two 1-byte varints) against ~25 in JSONL.
+ *
+ * The reader half lives here so host tools share the format definition.
+ */
+
+#ifndef HISTORY_EXPORT_H
+#define HISTORY_EXPORT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "esp_err.h"
+
+#define EXPORT_DZC_MAGIC        0x31435A44  // "DZC1"
+#define EXPORT_DZC_VERSION      1
+#define EXPORT_DZC_MAX_COLUMNS  5
+#define EXPORT_ID_LEN           32          // server_config_t.server_id
+
+typedef enum {
+    EXPORT_FORMAT_CSV = 0,
+    EXPORT_FORMAT_DZC,
+} export_format_t;
+
+// Column order in a DZC group (raw files carry the first two)
+typedef enum {
+    EXPORT_COL_TIME = 0,
+    EXPORT_COL_PLAYERS,             // Sample, or bucket average (rounded)
+    EXPORT_COL_MIN,
+    EXPORT_COL_MAX,
+    EXPORT_COL_SAMPLES,
+} export_column_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t magic;
+    uint16_t version;
+    uint8_t columns;                // 2 raw, 5 rolled up
+    uint8_t server_index;
+    uint32_t step_sec;              // 0 = raw samples
+    uint32_t start_time;            // Requested range (Unix seconds)
+    uint32_t end_time;
+    char server_id[EXPORT_ID_LEN];
+} export_dzc_header_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t rows;
+    uint32_t first_ts;
+    uint32_t last_ts;
+    uint32_t bytes;                 // Encoded columns that follow
+} export_dzc_group_t;
+
+typedef struct __attribute__((packed)) {
+    uint32_t groups;
+    uint32_t rows;
+    uint32_t magic;                 // EXPORT_DZC_MAGIC again, marks a complete file
+} export_dzc_footer_t;
+
+typedef struct {
+    int server_index;               // -1 = every configured server
+    uint32_t start_time;            // Unix seconds, inclusive
+    uint32_t end_time;
+    export_format_t format;
+    uint32_t step_sec;              // 0 = raw, else bucket size (e.g. 300, 3600)
+} export_request_t;
+
+typedef struct {
+    bool busy;
+    esp_err_t result;               // Of the last finished job
+    int files;                      // Written by the current/last job
+    uint32_t rows;
+    uint32_t bytes;
+    uint32_t elapsed_ms;
+    char path[80];                  // Current/last file
+} export_status_t;
+
+// ============== EXPORT (device) ==============
+
+/**
+ * Queue an export on its own background task
+ * @return ESP_OK, ESP_ERR_INVALID_STATE if busy or no SD card,
+ *         ESP_ERR_INVALID_ARG for a bad server/range/step
+ */
+esp_err_t history_export_start(const export_request_t *req);
+
+/**
+ * Run an export on the calling task (what the background task runs)
+ * Deletes the oldest exports first so at most EXPORT_KEEP_FILES remain.
+ * @return ESP_OK or the first error
+ */
+esp_err_t history_export_run(const export_request_t *req);
+
+/**
+ * Snapshot of the current or last job
+ */
+void history_export_get_status(export_status_t *out);
+
+const char *history_export_format_name(export_format_t format);
+
+// ============== READING (host tools) ==============
+
+typedef struct {
+    FILE *f;
+    export_dzc_header_t header;
+    uint8_t *buf;                   // Encoded group
+    size_t buf_size;
+} export_dzc_reader_t;
+
+/**
+ * Open a DZC file and check its header
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, or ESP_ERR_INVALID_VERSION for a foreign file
+ */
+esp_err_t export_dzc_open(export_dzc_reader_t *r, const char *path);
+
+/**
+ * Decode the next group into per-column arrays of EXPORT_GROUP_ROWS
+ * @param cols cols[c] receives column c (header.columns of them)
+ * @return Rows decoded, 0 at the footer, -1 truncated/corrupt
+ */
+int export_dzc_next(export_dzc_reader_t *r, export_dzc_group_t *group, int32_t *cols[]);
+
+void export_dzc_close(export_dzc_reader_t *r);
+
+#endif // HISTORY_EXPORT_H
@@ -0,0 +1,134 @@
+/**
+ * DayZ Server Tracker - Packed History Ring Implementation
+ */
+
+#include "history_ring.h"
+#include "config.h"
+#include <string.h>
+
+#define BLOCK_MASK          (HISTORY_BLOCK_SIZE - 1)
+#define OFFSET_MAX          UINT16_MAX
+
+_Static_assert((HISTORY_BLOCK_SIZE & BLOCK_MASK) == 0, "history block size must be a power of two");
+_Static_assert(MAX_HISTORY_ENTRIES % HISTORY_BLOCK_SIZE == 0, "history ring must hold whole blocks");
+_Static_assert(MAX_HISTORY_ENTRIES <= UINT16_MAX, "history ring indexes are 16-bit");
+
+static inline int block_of(int slot) {
+    return slot / HISTORY_BLOCK_SIZE;
+}
+
+static inline int oldest_slot(const history_ring_t *ring) {
+    return (ring->head + ring->capacity - ring->count) % ring->capacity;
+}
+
+size_t history_ring_bytes(uint16_t capacity) {
+    return (size_t)capacity * (sizeof(int16_t) + sizeof(uint16_t)) +
+           (size_t)(capacity / HISTORY_BLOCK_SIZE) * sizeof(uint32_t);
+}
+
+void history_ring_bind(history_ring_t *ring, void *mem, uint16_t capacity) {
+    uint8_t *p = mem;
+    ring->players = (int16_t *)p;
+    ring->ts_offset = (uint16_t *)(p + (size_t)capacity * sizeof(int16_t));
+    ring->ts_base = (uint32_t *)(p + (size_t)capacity * (sizeof(int16_t) + sizeof(uint16_t)));
+    ring->capacity = capacity;
+    ring->head = 0;
+    ring->count = 0;
+}
+
+void history_ring_reset(history_ring_t *ring) {
+    ring->head = 0;
+    ring->count = 0;
+    if (ring->players) {
+        memset(ring->players, 0, history_ring_bytes(ring->capacity));
+    }
+}
+
+static void put(history_ring_t *ring, uint16_t offset, int16_t players) {
+    ring->players[ring->head] = players;
+    ring->ts_offset[ring->head] = offset;
+    ring->head = (ring->head + 1) % ring->capacity;
+    if (ring->count < ring->capacity) {
+        ring->count++;
+    }
+}
+
+void history_ring_append(history_ring_t *ring, uint32_t ts, int16_t players) {
+    if (!ring->players || ring->capacity == 0) return;
+
+    if (ring->head & BLOCK_MASK) {
+        uint32_t base = ring->ts_base[block_of(ring->head)];
+        if (ts < base || ts - base > OFFSET_MAX) {
+            // Doesn't fit this block: fill it with unknowns at the last time seen
+            uint16_t last = ring->ts_offset[ring->head - 1];
+            while (ring->head & BLOCK_MASK) {
+                put(ring, last, -1);
+            }
+        }
+    }
+
+    if ((ring->head & BLOCK_MASK) == 0) {
+        // Opening a block overwrites it whole - retire what is left of it
+        if (ring->count > ring->capacity - HISTORY_BLOCK_SIZE) {
+            ring->count = ring->capacity - HISTORY_BLOCK_SIZE;
+        }
+        ring->ts_base[block_of(ring->head)] = ts;
+    }
+
+    put(ring, (uint16_t)(ts - ring->ts_base[block_of(ring->head)]), players);
+}
+
+bool history_ring_get(const history_ring_t *ring, int index, history_entry_t *out) {
+    if (!ring->players || index < 0 || index >= ring->count) return false;
+
+    int slot = (oldest_slot(ring) + index) % ring->capacity;
+    out->timestamp = ring->ts_base[block_of(slot)] + ring->ts_offset[slot];
+    out->player_count = ring->players[slot];
+    return true;
+}
+
+void history_ring_stats(const history_ring_t *ring, uint32_t since, history_stats_t *out) {
+    int count = 0;
+    int min = INT16_MAX;
+    int max = INT16_MIN;
+    int32_t sum = 0;
+
+    int slot = ring->players ? oldest_slot(ring) : 0;
+    int remaining = ring->players ? ring->count : 0;
+
+    while (remaining > 0) {
+        int end = (slot | BLOCK_MASK) + 1;
+        if (end - slot > remaining) end = slot + remaining;
+        remaining -= end - slot;
+
+        uint32_t base = ring->ts_base[block_of(slot)];
+        if (since <= base || since - base <= OFFSET_MAX) {
+            uint16_t threshold = since > base ? (uint16_t)(since - base) : 0;
+            const int16_t *pl = ring->players;
+            const uint16_t *off = ring->ts_offset;
+
+            for (int i = slot; i < end; i++) {
+                int v = pl[i];
+                if (v >= 0 && off[i] >= threshold) {
+                    count++;
+                    sum += v;
+                    min = v < min ? v : min;
+                    max = v > max ? v : max;
+                }
+            }
+        }
+        slot = end % ring->capacity;
+    }
+
+    out->count = count;
+    out->min = count ? (int16_t)min : 0;
+    out->max = count ? (int16_t)max : 0;
+    out->sum = sum;
+}
+
+bool history_ring_valid(const history_pack_header_t *hdr, uint16_t capacity) {
+    return hdr->capacity == capacity &&
+           hdr->block_size == HISTORY_BLOCK_SIZE &&
+           hdr->head < capacity &&
+           hdr->count <= capacity;
+}
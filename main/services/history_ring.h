@@ -0,0 +1,75 @@
+/**
+ * DayZ Server Tracker - Packed History Ring
+ * Structure-of-arrays player history, ~4 bytes per sample
+ *
+ * A ring lives in one block: players[capacity], ts_offset[capacity],
+ * ts_base[capacity / HISTORY_BLOCK_SIZE]. A block's base is the timestamp
+ * of its first sample; later samples store seconds since it. A sample too
+ * far from the base (long outage, clock step) pads the rest of the block
+ * with unknown (-1) samples and opens a new block. When the ring is full,
+ * opening a block drops that whole block, so a full ring holds between
+ * capacity - HISTORY_BLOCK_SIZE + 1 and capacity samples.
+ *
+ * The block is written to SD and NVS as-is after a history_pack_header_t.
+ * No locking here - callers hold the state lock for the live ring.
+ */
+
+#ifndef HISTORY_RING_H
+#define HISTORY_RING_H
+
+#include "app_state.h"
+#include <stddef.h>
+#include <stdbool.h>
+
+// Summary of the known samples at or after a cutoff
+typedef struct {
+    int count;                      // Samples with a known player count
+    int16_t min;
+    int16_t max;
+    int32_t sum;
+} history_stats_t;
+
+/**
+ * Bytes of the backing block for a ring
+ * @param capacity Slots, multiple of HISTORY_BLOCK_SIZE
+ */
+size_t history_ring_bytes(uint16_t capacity);
+
+/**
+ * Lay a ring out over a block of history_ring_bytes(capacity)
+ * The ring starts empty; the block is not cleared, so a ring read from
+ * storage can be bound and given its header's head/count.
+ */
+void history_ring_bind(history_ring_t *ring, void *mem, uint16_t capacity);
+
+/**
+ * Drop all samples and zero the block
+ */
+void history_ring_reset(history_ring_t *ring);
+
+/**
+ * Append a sample
+ * @param ts Unix timestamp
+ * @param players Player count (-1 if unknown)
+ */
+void history_ring_append(history_ring_t *ring, uint32_t ts, int16_t players);
+
+/**
+ * Read a sample by age
+ * @param index 0 = oldest
+ * @return false if index is out of range
+ */
+bool history_ring_get(const history_ring_t *ring, int index, history_entry_t *out);
+
+/**
+ * Min/max/sum of known player counts with timestamp >= since
+ * Runs block by block over the contiguous count and offset arrays.
+ */
+void history_ring_stats(const history_ring_t *ring, uint32_t since, history_stats_t *out);
+
+/**
+ * Check a ring read from storage against its header (bounds of head/count)
+ */
+bool history_ring_valid(const history_pack_header_t *hdr, uint16_t capacity);
+
+#endif // HISTORY_RING_H
@@ -8,7 +8,11 @@
 #include "storage_config.h"
 #include "nvs_keys.h"
 #include "path_validator.h"
+#include "time_util.h"
 #include "config.h"
+#include "metrics.h"
+#include "arena.h"
+#include "history_ring.h"
 #include "drivers/sd_card.h"
 #include <string.h>
 #include <stdio.h>
@@ -19,9 +23,11 @@
 #include <errno.h>
 #include "nvs.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include "cJSON.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
+#include "freertos/semphr.h"
 #include <unistd.h>
 
 static const char *TAG = "history_store";
@@ -30,9 +36,66 @@ static const char *TAG = "history_store";
 static bool g_history_dir_created = false;
 
 // Cached file handle for JSON append (avoids open/close per entry)
+// Appends come from the query, secondary fetch and main tasks; s_json_mutex
+// serializes them and the journal below.
+#define JSON_WAIT_MS        2000
 static FILE *s_json_file = NULL;
 static char s_json_file_path[80] = {0};
 static int s_json_write_count = 0;  // Entries since last flush
+static SemaphoreHandle_t s_json_mutex = NULL;
+
+// Journal: while the SD card is lent out (USB export), JSON lines are
+// kept in PSRAM in arrival order and written out when it comes back;
+// binary saves are skipped until then
+typedef struct {
+    uint32_t ts;
+    int16_t players;
+    uint8_t server_index;
+    char kind[9];                   // Annotation kind, "" for a sample
+    float expected;
+    float score;
+} journal_line_t;
+
+static struct {
+    journal_line_t *lines;          // NULL = not journaling
+    int count;
+    int dropped;
+} s_journal = { 0 };
+
+static bool json_lock(void) {
+    return !s_json_mutex || xSemaphoreTake(s_json_mutex, pdMS_TO_TICKS(JSON_WAIT_MS)) == pdTRUE;
+}
+
+static void json_unlock(void) {
+    if (s_json_mutex) xSemaphoreGive(s_json_mutex);
+}
+
+// Caller holds the JSON lock
+static void json_close(void) {
+    if (s_json_file) {
+        fflush(s_json_file);
+        fclose(s_json_file);
+        s_json_file = NULL;
+        sd_card_release();      // Taken when it was opened
+        s_json_file_path[0] = '\0';
+        s_json_write_count = 0;
+    }
+}
+
+// Scratch arena: a spare ring-sized PSRAM block, bump-allocated. Loads
+// decode straight into it and swap it with the live ring (the old ring
+// becomes the scratch); NVS saves borrow it for their packed copy.
+// One user at a time - saves run on the query task, loads on the main loop.
+#define SCRATCH_WAIT_MS     2000
+static history_ring_t s_scratch = { 0 };
+static size_t s_scratch_used = 0;           // Bump offset (bytes)
+static SemaphoreHandle_t s_scratch_mutex = NULL;
+
+// NVS keeps the newest NVS_HISTORY_MAX samples; the spare block covers the
+// one a full ring retires
+#define NVS_PACK_CAPACITY   (((NVS_HISTORY_MAX + HISTORY_BLOCK_SIZE - 1) / HISTORY_BLOCK_SIZE) \
+                             * HISTORY_BLOCK_SIZE + HISTORY_BLOCK_SIZE)
+#define LEGACY_CHUNK        64              // Entries per read when migrating v2 data
 
 // Use storage_paths module for path building - wrapper functions for compatibility
 static void build_history_file_path(int server_index, char *path, size_t path_size) {
@@ -56,12 +119,114 @@ static void timestamp_to_date_str(uint32_t ts, char *buf, size_t buf_size) {
     storage_timestamp_to_date(ts, buf, buf_size);
 }
 
+// ============== SCRATCH ARENA ==============
+
+static bool scratch_begin(void) {
+    if (!s_scratch_mutex || !s_scratch.players) return false;
+    if (xSemaphoreTake(s_scratch_mutex, pdMS_TO_TICKS(SCRATCH_WAIT_MS)) != pdTRUE) {
+        ESP_LOGW(TAG, "History scratch busy");
+        return false;
+    }
+    s_scratch_used = 0;
+    return true;
+}
+
+static void *scratch_alloc(size_t bytes) {
+    size_t offset = (s_scratch_used + 7) & ~(size_t)7;
+    if (offset + bytes > history_ring_bytes(MAX_HISTORY_ENTRIES)) return NULL;
+    s_scratch_used = offset + bytes;
+    return (uint8_t *)s_scratch.players + offset;
+}
+
+static void scratch_end(void) {
+    xSemaphoreGive(s_scratch_mutex);
+}
+
+/**
+ * The whole scratch block as an empty ring to decode into (between
+ * scratch_begin and scratch_commit_ring/scratch_end)
+ */
+static history_ring_t *scratch_ring(void) {
+    s_scratch_used = history_ring_bytes(MAX_HISTORY_ENTRIES);
+    s_scratch.head = 0;
+    s_scratch.count = 0;
+    return &s_scratch;
+}
+
+/**
+ * Make the decoded scratch ring live and end the scratch session
+ * @return false if the state lock timed out (ring unchanged)
+ */
+static bool scratch_commit_ring(void) {
+    app_state_t *state = app_state_get();
+    bool swapped = false;
+
+    if (app_state_lock(100)) {
+        history_ring_t old = state->history.ring;
+        state->history.ring = s_scratch;
+        s_scratch = old;
+        app_state_unlock();
+        swapped = true;
+    }
+    scratch_end();
+    return swapped;
+}
+
+typedef struct {
+    history_ring_t *ring;
+    uint32_t last_ts;
+    int appended;
+    int skipped;                    // Behind the newest sample (clock stepped back)
+} scratch_json_ctx_t;
+
+static bool scratch_append_entry(const history_entry_t *entry, void *ctx) {
+    scratch_json_ctx_t *c = ctx;
+    if (c->appended > 0 && entry->timestamp < c->last_ts) {
+        c->skipped++;
+        return true;
+    }
+    history_ring_append(c->ring, entry->timestamp, entry->player_count);
+    c->last_ts = entry->timestamp;
+    c->appended++;
+    return true;
+}
+
+/**
+ * Decode a JSON time range straight into the scratch ring
+ * The daily files are streamed in date order and each is in append order,
+ * so the merge is already sorted; a sample older than the one before it
+ * is dropped rather than buffering the range to sort it.
+ * @return Entries decoded, <= 0 if none
+ */
+static int scratch_load_json(int server_index, uint32_t start_time, uint32_t end_time) {
+    scratch_json_ctx_t ctx = { .ring = scratch_ring() };
+
+    int n = history_stream_range_json(server_index, start_time, end_time, scratch_append_entry, &ctx);
+    if (n < 0) return n;
+    if (ctx.skipped > 0) {
+        ESP_LOGW(TAG, "Skipped %d out-of-order JSON entries for server %d", ctx.skipped, server_index);
+    }
+    return ctx.appended;
+}
+
 void history_init(void) {
-    // History buffer is allocated in app_state_init
+    // Live ring is allocated in app_state_init, the scratch ring here
+    if (!s_scratch_mutex) {
+        s_scratch_mutex = xSemaphoreCreateMutex();
+    }
+    if (!s_json_mutex) {
+        s_json_mutex = xSemaphoreCreateMutex();
+    }
+    if (!s_scratch.players) {
+        void *mem = arena_alloc(ARENA_BULK, history_ring_bytes(MAX_HISTORY_ENTRIES), "history_scratch");
+        if (mem) {
+            history_ring_bind(&s_scratch, mem, MAX_HISTORY_ENTRIES);
+        }
+    }
     ESP_LOGI(TAG, "History store initialized");
 
     // Pre-create the history directory structure if SD card is available
-    if (sd_card_is_mounted()) {
+    if (sd_card_is_mounted() && sd_card_lease()) {
         // Create root history directory
         if (mkdir(HISTORY_JSON_DIR, 0755) == 0) {
             g_history_dir_created = true;
@@ -89,6 +254,7 @@ void history_init(void) {
                 }
             }
         }
+        sd_card_release();
     }
 }
 
@@ -97,7 +263,7 @@ void history_init(void) {
 void history_add_entry(int player_count) {
     app_state_t *state = app_state_get();
 
-    if (!state->history.entries) return;
+    if (!state->history.ring.players) return;
 
     if (!app_state_lock(100)) return;
 
@@ -105,26 +271,20 @@ void history_add_entry(int player_count) {
     time(&now);
     uint32_t timestamp = (uint32_t)now;
 
-    state->history.entries[state->history.head].timestamp = timestamp;
-    state->history.entries[state->history.head].player_count = (int16_t)player_count;
-
-    state->history.head = (state->history.head + 1) % MAX_HISTORY_ENTRIES;
-    if (state->history.count < MAX_HISTORY_ENTRIES) {
-        state->history.count++;
-    }
+    history_ring_append(&state->history.ring, timestamp, (int16_t)player_count);
 
     state->history.unsaved_count++;
     int server_idx = state->settings.active_server_index;
-    int current_count = state->history.count;
+    int current_count = state->history.ring.count;
     int unsaved = state->history.unsaved_count;
 
     app_state_unlock();
 
-    ESP_LOGI(TAG, "History entry added: players=%d, total=%d, unsaved=%d",
+    ESP_LOGD(TAG, "History entry added: players=%d, total=%d, unsaved=%d",
              player_count, current_count, unsaved);
 
     // Try SD card first (if working)
-    if (sd_card_is_mounted()) {
+    if (history_json_writable()) {
         history_append_entry_json(server_idx, timestamp, (int16_t)player_count);
     }
 
@@ -141,92 +301,147 @@ void history_add_entry(int player_count) {
 
 int history_get_entry(int index, history_entry_t *entry) {
     app_state_t *state = app_state_get();
-
-    if (!state->history.entries || index >= state->history.count) {
-        return -1;
-    }
-
-    int actual_index;
-    if (state->history.count < MAX_HISTORY_ENTRIES) {
-        actual_index = index;
-    } else {
-        actual_index = (state->history.head + index) % MAX_HISTORY_ENTRIES;
-    }
-
-    *entry = state->history.entries[actual_index];
-    return 0;
+    return history_ring_get(&state->history.ring, index, entry) ? 0 : -1;
 }
 
 int history_get_count(void) {
     app_state_t *state = app_state_get();
-    return state->history.count;
+    return state->history.ring.count;
 }
 
-int history_count_in_range(uint32_t range_seconds) {
+void history_get_stats(uint32_t range_seconds, history_stats_t *stats) {
     app_state_t *state = app_state_get();
 
     time_t now;
     time(&now);
     uint32_t cutoff_time = (uint32_t)now - range_seconds;
 
-    int count = 0;
-    for (int i = 0; i < state->history.count; i++) {
-        history_entry_t entry;
-        if (history_get_entry(i, &entry) == 0 && entry.timestamp >= cutoff_time) {
-            count++;
-        }
+    memset(stats, 0, sizeof(*stats));
+    if (app_state_lock(100)) {
+        history_ring_stats(&state->history.ring, cutoff_time, stats);
+        app_state_unlock();
     }
+}
 
-    return count;
+int history_count_in_range(uint32_t range_seconds) {
+    history_stats_t stats;
+    history_get_stats(range_seconds, &stats);
+    return stats.count;
 }
 
 void history_save_to_sd(int server_index) {
     app_state_t *state = app_state_get();
 
-    if (!sd_card_is_mounted() || !state->history.entries) {
+    if (!sd_card_is_mounted() || !state->history.ring.players) {
         ESP_LOGD(TAG, "Cannot save: SD not mounted or no history");
         return;
     }
 
-    // Flush cached JSON handle before binary write
-    history_flush_json();
+    // The scratch session keeps a history load from swapping the ring out
+    // from under us; the ring itself is copied into it under the state
+    // lock, so appends can't tear the block while it is written
+    if (!scratch_begin()) return;
+    const history_ring_t *ring = &state->history.ring;
+    size_t ring_bytes = history_ring_bytes(ring->capacity);
+    void *copy = scratch_alloc(ring_bytes);
+    history_pack_header_t header = {
+        .magic = HISTORY_FILE_MAGIC,
+        .capacity = ring->capacity,
+        .block_size = HISTORY_BLOCK_SIZE,
+    };
+    if (!copy || !app_state_lock(100)) {
+        scratch_end();
+        return;
+    }
+    header.head = ring->head;
+    header.count = ring->count;
+    memcpy(copy, ring->players, ring_bytes);
+    app_state_unlock();
+
+    // Flush cached JSON handle before binary write. The JSON lock is held
+    // throughout, so the card can't be handed to USB mid-write.
+    if (!json_lock()) {
+        scratch_end();
+        return;
+    }
+    json_close();
+    if (s_journal.lines || !sd_card_lease()) {
+        json_unlock();
+        scratch_end();
+        return;
+    }
 
     char file_path[64];
     build_history_file_path(server_index, file_path, sizeof(file_path));
 
     // CS stays active permanently after mount - no toggling needed
 
+    int64_t t_start = esp_timer_get_time();
     FILE *f = fopen(file_path, "wb");
     if (!f) {
         ESP_LOGE(TAG, "Failed to open history file for writing: %s", file_path);
-            return;
+        metrics_count(METRIC_CNT_SD_ERRORS);
+        sd_card_release();
+        json_unlock();
+        scratch_end();
+        return;
     }
 
-    // Write header
-    history_file_header_t header = {
-        .magic = HISTORY_FILE_MAGIC,
-        .head = state->history.head,
-        .count = state->history.count
-    };
+    // Header, then the ring block as it was in memory
     fwrite(&header, sizeof(header), 1, f);
-
-    // Write history entries
-    if (state->history.count > 0) {
-        int entries_to_write = (state->history.count < MAX_HISTORY_ENTRIES)
-                               ? state->history.count : MAX_HISTORY_ENTRIES;
-        fwrite(state->history.entries, sizeof(history_entry_t), entries_to_write, f);
-    }
+    fwrite(copy, ring_bytes, 1, f);
 
     fclose(f);
+    sd_card_release();
+    json_unlock();
+    scratch_end();
+    metrics_observe_since(METRIC_H_SD_OP, t_start);
 
     state->history.unsaved_count = 0;
-    ESP_LOGI(TAG, "History saved to SD for server %d (%d entries)", server_index, state->history.count);
+    ESP_LOGI(TAG, "History saved to SD for server %d (%d entries)", server_index, header.count);
 }
 
-void history_load_from_sd(int server_index) {
+/**
+ * Append a run of v2 entries (file order) to a ring
+ * @return Entries read
+ */
+static int append_legacy_entries(FILE *f, long offset, int n, history_ring_t *ring) {
+    history_entry_t chunk[LEGACY_CHUNK];
+    int done = 0;
+
+    if (n <= 0 || fseek(f, offset, SEEK_SET) != 0) return 0;
+    while (done < n) {
+        int want = n - done < LEGACY_CHUNK ? n - done : LEGACY_CHUNK;
+        int got = (int)fread(chunk, sizeof(history_entry_t), want, f);
+        for (int i = 0; i < got; i++) {
+            history_ring_append(ring, chunk[i].timestamp, chunk[i].player_count);
+        }
+        done += got;
+        if (got < want) break;
+    }
+    return done;
+}
+
+/**
+ * Read a v2 file (history_entry_t ring) into a ring, oldest first
+ */
+static int load_legacy_sd(FILE *f, history_ring_t *ring) {
+    history_file_header_t header;
+    if (fseek(f, 0, SEEK_SET) != 0 || fread(&header, sizeof(header), 1, f) != 1) return 0;
+
+    // v2 rings were linear (head == count) until full, then oldest at head
+    long data = sizeof(header);
+    int head = header.head < header.count ? header.head : 0;
+    int n = append_legacy_entries(f, data + (long)head * sizeof(history_entry_t),
+                                  header.count - head, ring);
+    n += append_legacy_entries(f, data, head, ring);
+    return n;
+}
+
+static void history_load_from_sd_leased(int server_index) {
     app_state_t *state = app_state_get();
 
-    if (!sd_card_is_mounted() || !state->history.entries) {
+    if (!sd_card_is_mounted() || !state->history.ring.players) {
         ESP_LOGD(TAG, "Cannot load: SD not mounted or no history buffer");
         return;
     }
@@ -236,51 +451,69 @@ void history_load_from_sd(int server_index) {
 
     // CS stays active permanently after mount - no toggling needed
 
+    int64_t t_start = esp_timer_get_time();
     FILE *f = fopen(file_path, "rb");
     if (!f) {
         ESP_LOGI(TAG, "No history file found for server %d", server_index);
             return;
     }
 
-    // Read header
-    history_file_header_t header;
-    if (fread(&header, sizeof(header), 1, f) != 1 || header.magic != HISTORY_FILE_MAGIC) {
+    // Read header (the v2 header is a prefix of it)
+    history_pack_header_t header;
+    size_t hdr_read = fread(&header, 1, sizeof(header), f);
+    bool legacy = hdr_read >= sizeof(history_file_header_t) && header.magic == HISTORY_FILE_MAGIC_V2;
+    if (!legacy && (hdr_read != sizeof(header) || header.magic != HISTORY_FILE_MAGIC ||
+                    !history_ring_valid(&header, MAX_HISTORY_ENTRIES))) {
         ESP_LOGW(TAG, "Invalid history file header for server %d", server_index);
         fclose(f);
             return;
     }
 
-    // Read entries
-    if (app_state_lock(100)) {
-        state->history.head = header.head;
-        state->history.count = header.count;
-
-        if (state->history.count > MAX_HISTORY_ENTRIES) {
-            state->history.count = MAX_HISTORY_ENTRIES;
+    // Read into the scratch ring, then swap it in (no lock held during I/O)
+    bool loaded = false;
+    if (scratch_begin()) {
+        history_ring_t *ring = scratch_ring();
+
+        if (legacy) {
+            int n = load_legacy_sd(f, ring);
+            ESP_LOGI(TAG, "Migrating v2 history file for server %d (%d entries)", server_index, n);
+            loaded = true;
+        } else if (fread(ring->players, history_ring_bytes(ring->capacity), 1, f) == 1) {
+            ring->head = header.head;
+            ring->count = header.count;
+            loaded = true;
+        } else {
+            ESP_LOGW(TAG, "Partial history read for server %d", server_index);
         }
 
-        int entries_to_read = (state->history.count < MAX_HISTORY_ENTRIES)
-                              ? state->history.count : MAX_HISTORY_ENTRIES;
-        size_t read_count = fread(state->history.entries, sizeof(history_entry_t),
-                                   entries_to_read, f);
-
-        if (read_count != entries_to_read) {
-            ESP_LOGW(TAG, "Partial history read: %d/%d", (int)read_count, entries_to_read);
-            state->history.count = read_count;
+        if (loaded) {
+            loaded = scratch_commit_ring();
+        } else {
+            scratch_end();
         }
-
-        app_state_unlock();
     }
 
     fclose(f);
+    metrics_observe_since(METRIC_H_SD_OP, t_start);
+
+    // Rewrite a v2 file in the packed format right away
+    if (loaded && legacy) {
+        history_save_to_sd(server_index);
+    }
 
-    ESP_LOGI(TAG, "History loaded from SD for server %d (%d entries)", server_index, state->history.count);
+    ESP_LOGI(TAG, "History loaded from SD for server %d (%d entries)", server_index, state->history.ring.count);
+}
+
+void history_load_from_sd(int server_index) {
+    if (!sd_card_lease()) return;
+    history_load_from_sd_leased(server_index);
+    sd_card_release();
 }
 
 void history_save_to_nvs(int server_index) {
     app_state_t *state = app_state_get();
 
-    if (!state->history.entries || state->history.count == 0) return;
+    if (!state->history.ring.players || state->history.ring.count == 0) return;
 
     nvs_handle_t nvs;
     if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs) != ESP_OK) {
@@ -288,32 +521,42 @@ void history_save_to_nvs(int server_index) {
         return;
     }
 
-    char key_meta[16], key_data[16];
-    build_nvs_key(server_index, "meta", key_meta, sizeof(key_meta));
-    build_nvs_key(server_index, "data", key_data, sizeof(key_data));
-
-    // Save metadata (head, count)
-    uint32_t meta = ((uint32_t)state->history.head << 16) |
-                    (state->history.count & 0xFFFF);
-    nvs_set_u32(nvs, key_meta, meta);
+    char key_pack[16], key_meta[16], key_data[16];
+    build_nvs_key(server_index, NVS_SUFFIX_PACK, key_pack, sizeof(key_pack));
+    build_nvs_key(server_index, NVS_SUFFIX_META, key_meta, sizeof(key_meta));
+    build_nvs_key(server_index, NVS_SUFFIX_DATA, key_data, sizeof(key_data));
 
     // Save most recent entries (up to NVS_HISTORY_MAX)
-    int entries_to_save = (state->history.count < NVS_HISTORY_MAX)
-                          ? state->history.count : NVS_HISTORY_MAX;
-    int start_idx = (state->history.count > NVS_HISTORY_MAX)
-                    ? (state->history.count - NVS_HISTORY_MAX) : 0;
-
-    // Create temporary buffer with recent entries in order
-    history_entry_t *temp = malloc(entries_to_save * sizeof(history_entry_t));
-    if (temp) {
-        for (int i = 0; i < entries_to_save; i++) {
-            history_entry_t entry;
-            if (history_get_entry(start_idx + i, &entry) == 0) {
-                temp[i] = entry;
+    int count = state->history.ring.count;
+    int entries_to_save = (count < NVS_HISTORY_MAX) ? count : NVS_HISTORY_MAX;
+    int start_idx = count - entries_to_save;
+
+    // Recent entries re-packed into a small ring, laid out in the scratch arena
+    if (scratch_begin()) {
+        size_t blob_size = sizeof(history_pack_header_t) + history_ring_bytes(NVS_PACK_CAPACITY);
+        history_pack_header_t *header = scratch_alloc(blob_size);
+        if (header) {
+            history_ring_t ring;
+            history_ring_bind(&ring, header + 1, NVS_PACK_CAPACITY);
+            for (int i = 0; i < entries_to_save; i++) {
+                history_entry_t entry;
+                if (history_get_entry(start_idx + i, &entry) == 0) {
+                    history_ring_append(&ring, entry.timestamp, entry.player_count);
+                }
+            }
+
+            header->magic = HISTORY_FILE_MAGIC;
+            header->capacity = ring.capacity;
+            header->block_size = HISTORY_BLOCK_SIZE;
+            header->head = ring.head;
+            header->count = ring.count;
+            if (nvs_set_blob(nvs, key_pack, header, blob_size) == ESP_OK) {
+                // The v2 backup is superseded once the packed one is written
+                nvs_erase_key(nvs, key_meta);
+                nvs_erase_key(nvs, key_data);
             }
         }
-        nvs_set_blob(nvs, key_data, temp, entries_to_save * sizeof(history_entry_t));
-        free(temp);
+        scratch_end();
     }
 
     nvs_commit(nvs);
@@ -323,10 +566,35 @@ void history_save_to_nvs(int server_index) {
     ESP_LOGI(TAG, "History backed up to NVS for server %d (%d entries)", server_index, entries_to_save);
 }
 
+/**
+ * Copy a packed NVS blob into a ring
+ * @return Entries copied, -1 if the blob is malformed
+ */
+static int decode_nvs_pack(const void *blob, size_t size, history_ring_t *ring) {
+    const history_pack_header_t *header = blob;
+    if (size < sizeof(*header) || header->magic != HISTORY_FILE_MAGIC ||
+        header->capacity == 0 || header->capacity % HISTORY_BLOCK_SIZE != 0 ||
+        size != sizeof(*header) + history_ring_bytes(header->capacity) ||
+        !history_ring_valid(header, header->capacity)) {
+        return -1;
+    }
+
+    history_ring_t src;
+    history_ring_bind(&src, (void *)(header + 1), header->capacity);
+    src.head = header->head;
+    src.count = header->count;
+
+    history_entry_t entry;
+    for (int i = 0; history_ring_get(&src, i, &entry); i++) {
+        history_ring_append(ring, entry.timestamp, entry.player_count);
+    }
+    return src.count;
+}
+
 void history_load_from_nvs(int server_index) {
     app_state_t *state = app_state_get();
 
-    if (!state->history.entries) return;
+    if (!state->history.ring.players) return;
 
     nvs_handle_t nvs;
     if (nvs_open(NVS_NAMESPACE, NVS_READONLY, &nvs) != ESP_OK) {
@@ -334,55 +602,65 @@ void history_load_from_nvs(int server_index) {
         return;
     }
 
-    char key_meta[16], key_data[16];
-    build_nvs_key(server_index, "meta", key_meta, sizeof(key_meta));
-    build_nvs_key(server_index, "data", key_data, sizeof(key_data));
+    char key_pack[16], key_data[16];
+    build_nvs_key(server_index, NVS_SUFFIX_PACK, key_pack, sizeof(key_pack));
+    build_nvs_key(server_index, NVS_SUFFIX_DATA, key_data, sizeof(key_data));
 
-    // Load metadata
-    uint32_t meta = 0;
-    if (nvs_get_u32(nvs, key_meta, &meta) != ESP_OK) {
-        nvs_close(nvs);
-        return;
-    }
-
-    // Load entries
+    // Packed backup first, else a v2 entry blob (oldest first) to migrate
+    const char *key = key_pack;
     size_t required_size = 0;
-    if (nvs_get_blob(nvs, key_data, NULL, &required_size) != ESP_OK ||
-        required_size == 0) {
-        nvs_close(nvs);
-        return;
+    if (nvs_get_blob(nvs, key_pack, NULL, &required_size) != ESP_OK || required_size == 0) {
+        key = key_data;
+        if (nvs_get_blob(nvs, key_data, NULL, &required_size) != ESP_OK || required_size == 0) {
+            nvs_close(nvs);
+            return;
+        }
     }
-
-    history_entry_t *temp = malloc(required_size);
-    if (temp && nvs_get_blob(nvs, key_data, temp, &required_size) == ESP_OK) {
-        if (app_state_lock(100)) {
-            int loaded_count = required_size / sizeof(history_entry_t);
-            for (int i = 0; i < loaded_count && i < MAX_HISTORY_ENTRIES; i++) {
-                state->history.entries[i] = temp[i];
+    bool legacy = (key == key_data);
+
+    int loaded_count = -1;
+    void *blob = arena_alloc(ARENA_SCRATCH, required_size, "history_nvs");
+    if (blob && nvs_get_blob(nvs, key, blob, &required_size) == ESP_OK && scratch_begin()) {
+        history_ring_t *ring = scratch_ring();
+
+        if (legacy) {
+            const history_entry_t *entries = blob;
+            loaded_count = required_size / sizeof(history_entry_t);
+            for (int i = 0; i < loaded_count; i++) {
+                history_ring_append(ring, entries[i].timestamp, entries[i].player_count);
             }
-            state->history.count = loaded_count;
-            state->history.head = loaded_count % MAX_HISTORY_ENTRIES;
-            app_state_unlock();
+        } else {
+            loaded_count = decode_nvs_pack(blob, required_size, ring);
         }
-        ESP_LOGI(TAG, "History restored from NVS for server %d (%d entries)",
-                 server_index, (int)(required_size / sizeof(history_entry_t)));
-    }
-    if (temp) free(temp);
 
+        if (loaded_count < 0) {
+            ESP_LOGW(TAG, "Invalid NVS history backup for server %d", server_index);
+        }
+        if (loaded_count > 0) {
+            if (!scratch_commit_ring()) loaded_count = -1;
+        } else {
+            scratch_end();
+        }
+    }
+    if (loaded_count > 0) {
+        ESP_LOGI(TAG, "History restored from NVS for server %d (%d entries%s)",
+                 server_index, loaded_count, legacy ? ", migrating" : "");
+    }
+    arena_free(blob);
     nvs_close(nvs);
+
+    // Rewrite a v2 backup in the packed format right away
+    if (legacy && loaded_count > 0) {
+        history_save_to_nvs(server_index);
+    }
 }
 
 void history_clear(void) {
     app_state_t *state = app_state_get();
 
     if (app_state_lock(100)) {
-        state->history.head = 0;
-        state->history.count = 0;
+        history_ring_reset(&state->history.ring);
         state->history.unsaved_count = 0;
-        if (state->history.entries) {
-            memset(state->history.entries, 0,
-                   MAX_HISTORY_ENTRIES * sizeof(history_entry_t));
-        }
         app_state_unlock();
     }
 
@@ -398,8 +676,8 @@ void history_switch_server(int old_server_index, int new_server_index) {
     history_flush_json();
 
     // ALWAYS save current server's history to NVS first (most reliable)
-    if (old_server_index >= 0 && state->history.count > 0) {
-        ESP_LOGI(TAG, "Saving %d entries for server %d before switch", state->history.count, old_server_index);
+    if (old_server_index >= 0 && state->history.ring.count > 0) {
+        ESP_LOGI(TAG, "Saving %d entries for server %d before switch", state->history.ring.count, old_server_index);
         history_save_to_nvs(old_server_index);  // NVS first - most reliable
 
         // Also try SD if available
@@ -414,14 +692,14 @@ void history_switch_server(int old_server_index, int new_server_index) {
     // Load new server's history - NVS FIRST (more reliable than SD)
     ESP_LOGI(TAG, "Loading history for server %d from NVS...", new_server_index);
     history_load_from_nvs(new_server_index);
-    int nvs_count = state->history.count;
+    int nvs_count = state->history.ring.count;
     ESP_LOGI(TAG, "Loaded %d entries from NVS", nvs_count);
 
     // If NVS is empty, try SD binary backup
     if (nvs_count == 0 && sd_card_is_mounted()) {
         ESP_LOGI(TAG, "NVS empty, trying SD binary backup...");
         history_load_from_sd(new_server_index);
-        ESP_LOGI(TAG, "Loaded %d entries from SD binary", state->history.count);
+        ESP_LOGI(TAG, "Loaded %d entries from SD binary", state->history.ring.count);
     }
 
     // Try to load JSON data from SD (primary source for secondary servers)
@@ -434,40 +712,25 @@ void history_switch_server(int old_server_index, int new_server_index) {
         ESP_LOGI(TAG, "Loading JSON history for server %d (time range: %lu to %lu)",
                  new_server_index, (unsigned long)start_time, (unsigned long)end_time);
 
-        // Allocate temp buffer for JSON entries
-        history_entry_t *json_entries = malloc(MAX_HISTORY_ENTRIES * sizeof(history_entry_t));
-        if (json_entries) {
-            int json_count = history_load_range_json(new_server_index, start_time, end_time,
-                                                      json_entries, MAX_HISTORY_ENTRIES);
+        // Stream into the scratch ring (oldest-first = ring order)
+        if (scratch_begin()) {
+            int json_count = scratch_load_json(new_server_index, start_time, end_time);
             ESP_LOGI(TAG, "JSON load returned %d entries", json_count);
 
-            if (json_count > 0) {
-                // Clear buffer and use JSON as primary source (it has complete history)
-                // JSON files are the authoritative source - NVS is just a backup
-                if (app_state_lock(100)) {
-                    state->history.head = 0;
-                    state->history.count = 0;
-
-                    // Load ALL JSON entries (already sorted oldest-first)
-                    for (int i = 0; i < json_count && state->history.count < MAX_HISTORY_ENTRIES; i++) {
-                        state->history.entries[state->history.head] = json_entries[i];
-                        state->history.head = (state->history.head + 1) % MAX_HISTORY_ENTRIES;
-                        state->history.count++;
-                    }
-                    app_state_unlock();
-
-                    ESP_LOGI(TAG, "Loaded %d entries from JSON history", json_count);
-                }
+            // JSON files are the authoritative source (complete history) - NVS is just a backup
+            if (json_count > 0 && scratch_commit_ring()) {
+                ESP_LOGI(TAG, "Loaded %d entries from JSON history", json_count);
+            } else if (json_count <= 0) {
+                scratch_end();
             }
-            free(json_entries);
         } else {
-            ESP_LOGE(TAG, "Failed to allocate memory for JSON entries buffer");
+            ESP_LOGE(TAG, "No scratch ring for JSON history");
         }
     } else {
         ESP_LOGW(TAG, "SD card not mounted - skipping JSON history load");
     }
 
-    ESP_LOGI(TAG, "History switched to server %d (%d entries)", new_server_index, state->history.count);
+    ESP_LOGI(TAG, "History switched to server %d (%d entries)", new_server_index, state->history.ring.count);
 }
 
 void history_load_json_for_server(int server_index) {
@@ -485,36 +748,23 @@ void history_load_json_for_server(int server_index) {
 
     ESP_LOGI(TAG, "Loading JSON history for server %d on boot", server_index);
 
-    // Allocate temp buffer for JSON entries
-    history_entry_t *json_entries = malloc(MAX_HISTORY_ENTRIES * sizeof(history_entry_t));
-    if (!json_entries) {
-        ESP_LOGE(TAG, "Failed to allocate memory for JSON entries buffer");
+    // Stream into the scratch ring (oldest-first = ring order)
+    if (!scratch_begin()) {
+        ESP_LOGE(TAG, "No scratch ring for JSON history");
         return;
     }
 
-    int json_count = history_load_range_json(server_index, start_time, end_time,
-                                              json_entries, MAX_HISTORY_ENTRIES);
+    int json_count = scratch_load_json(server_index, start_time, end_time);
     ESP_LOGI(TAG, "JSON load returned %d entries", json_count);
 
+    // JSON replaces the NVS/SD backup as the primary source
     if (json_count > 0) {
-        // Clear buffer and load JSON as primary source
-        if (app_state_lock(100)) {
-            state->history.head = 0;
-            state->history.count = 0;
-
-            // Load ALL JSON entries (already sorted oldest-first)
-            for (int i = 0; i < json_count && state->history.count < MAX_HISTORY_ENTRIES; i++) {
-                state->history.entries[state->history.head] = json_entries[i];
-                state->history.head = (state->history.head + 1) % MAX_HISTORY_ENTRIES;
-                state->history.count++;
-            }
-            app_state_unlock();
-
-            ESP_LOGI(TAG, "Loaded %d entries from JSON history", state->history.count);
+        if (scratch_commit_ring()) {
+            ESP_LOGI(TAG, "Loaded %d entries from JSON history", state->history.ring.count);
         }
+    } else {
+        scratch_end();
     }
-
-    free(json_entries);
 }
 
 uint32_t history_range_to_seconds(history_range_t range) {
@@ -573,7 +823,7 @@ static esp_err_t ensure_directory(const char *path) {
     return ESP_FAIL;
 }
 
-esp_err_t history_init_json_dir(int server_index) {
+static esp_err_t history_init_json_dir_leased(int server_index) {
     if (!sd_card_is_mounted()) {
         return ESP_ERR_INVALID_STATE;
     }
@@ -600,27 +850,21 @@ esp_err_t history_init_json_dir(int server_index) {
     return ensure_directory(server_dir);
 }
 
-void history_flush_json(void) {
-    if (s_json_file) {
-        fflush(s_json_file);
-        fclose(s_json_file);
-        s_json_file = NULL;
-        s_json_file_path[0] = '\0';
-        s_json_write_count = 0;
-    }
+esp_err_t history_init_json_dir(int server_index) {
+    if (!sd_card_lease()) return ESP_ERR_INVALID_STATE;
+    esp_err_t ret = history_init_json_dir_leased(server_index);
+    sd_card_release();
+    return ret;
 }
 
-esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t players) {
-    if (!sd_card_is_mounted()) {
-        return ESP_ERR_INVALID_STATE;
-    }
-
-    // Skip entries with invalid timestamp (SNTP not synced yet)
-    if (ts < STORAGE_TIMESTAMP_MIN_VALID) {
-        ESP_LOGW(TAG, "Skipping entry with invalid timestamp: %lu", (unsigned long)ts);
-        return ESP_OK;
-    }
+void history_flush_json(void) {
+    if (!json_lock()) return;
+    json_close();
+    json_unlock();
+}
 
+// The cached handle holds its own lease until json_close()
+static esp_err_t json_open_for_leased(int server_index, uint32_t ts) {
     // Ensure directories exist (only once)
     if (!g_history_dir_created) {
         mkdir(HISTORY_JSON_DIR, 0755);
@@ -638,12 +882,16 @@ esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t playe
 
     // Reopen if path changed (new day or different server)
     if (strcmp(file_path, s_json_file_path) != 0) {
-        history_flush_json();  // close old handle
+        json_close();  // close old handle
 
         bool file_exists = (access(file_path, F_OK) == 0);
-        s_json_file = fopen(file_path, "a");
+        if (sd_card_lease()) {
+            s_json_file = fopen(file_path, "a");
+            if (!s_json_file) sd_card_release();
+        }
         if (!s_json_file) {
             ESP_LOGE(TAG, "Failed to open: %s (errno=%d)", file_path, errno);
+            metrics_count(METRIC_CNT_SD_ERRORS);
             return ESP_FAIL;
         }
         strncpy(s_json_file_path, file_path, sizeof(s_json_file_path) - 1);
@@ -658,11 +906,36 @@ esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t playe
         }
     }
 
+    return ESP_OK;
+}
+
+/**
+ * Make s_json_file the daily file of (server_index, ts), creating it
+ * with a header line if needed. ts must already be validated.
+ * Caller holds the JSON lock.
+ */
+static esp_err_t json_open_for(int server_index, uint32_t ts) {
+    if (!sd_card_is_mounted() || !sd_card_lease()) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    esp_err_t ret = json_open_for_leased(server_index, ts);
+    sd_card_release();
+    return ret;
+}
+
+// Caller holds the JSON lock
+static esp_err_t json_write_entry(int server_index, uint32_t ts, int16_t players) {
+    esp_err_t ret = json_open_for(server_index, ts);
+    if (ret != ESP_OK) {
+        return ret;
+    }
+
     // Append data entry (compact format)
     int written = fprintf(s_json_file, "{\"t\":%lu,\"p\":%d}\n", (unsigned long)ts, (int)players);
     if (written <= 0) {
         ESP_LOGE(TAG, "fprintf FAILED! ret=%d errno=%d", written, errno);
-        history_flush_json();
+        metrics_count(METRIC_CNT_SD_ERRORS);
+        json_close();
         return ESP_FAIL;
     }
 
@@ -672,10 +945,187 @@ esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t playe
         fflush(s_json_file);
         s_json_write_count = 0;
     }
+    return ESP_OK;
+}
+
+// Caller holds the JSON lock
+static esp_err_t json_write_annotation(int server_index, uint32_t ts, const char *kind,
+                                       int16_t players, float expected, float score) {
+    esp_err_t ret = json_open_for(server_index, ts);
+    if (ret != ESP_OK) {
+        return ret;
+    }
 
+    // Annotation line: has "a" instead of "p" in second position, so the
+    // {"t":..,"p":..} fast path of the loaders skips it
+    int written = fprintf(s_json_file, "{\"t\":%lu,\"a\":\"%s\",\"p\":%d,\"e\":%.1f,\"z\":%.1f}\n",
+                          (unsigned long)ts, kind, (int)players, expected, score);
+    if (written <= 0) {
+        ESP_LOGE(TAG, "fprintf FAILED! ret=%d errno=%d", written, errno);
+        json_close();
+        return ESP_FAIL;
+    }
+
+    // Rare and worth keeping - flush right away
+    fflush(s_json_file);
     return ESP_OK;
 }
 
+// Caller holds the JSON lock
+static void journal_push(int server_index, uint32_t ts, const char *kind,
+                         int16_t players, float expected, float score) {
+    if (s_journal.count >= STORAGE_JOURNAL_MAX_LINES) {
+        s_journal.dropped++;
+        return;
+    }
+    journal_line_t *line = &s_journal.lines[s_journal.count++];
+    line->ts = ts;
+    line->players = players;
+    line->server_index = (uint8_t)server_index;
+    strncpy(line->kind, kind ? kind : "", sizeof(line->kind) - 1);
+    line->kind[sizeof(line->kind) - 1] = '\0';
+    line->expected = expected;
+    line->score = score;
+}
+
+esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t players) {
+    // Skip entries with invalid timestamp (SNTP not synced yet)
+    if (ts < STORAGE_TIMESTAMP_MIN_VALID) {
+        ESP_LOGW(TAG, "Skipping entry with invalid timestamp: %lu", (unsigned long)ts);
+        return ESP_OK;
+    }
+
+    int64_t t_start = esp_timer_get_time();
+    if (!json_lock()) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (s_journal.lines) {
+        journal_push(server_index, ts, NULL, players, 0, 0);
+    } else {
+        ret = json_write_entry(server_index, ts, players);
+    }
+    json_unlock();
+
+    if (ret == ESP_OK) {
+        metrics_count(METRIC_CNT_HISTORY_APPENDS);
+        metrics_observe_since(METRIC_H_HISTORY_APPEND, t_start);
+    }
+    return ret;
+}
+
+esp_err_t history_append_annotation_json(int server_index, uint32_t ts, const char *kind,
+                                         int16_t players, float expected, float score) {
+    if (!kind || ts < STORAGE_TIMESTAMP_MIN_VALID) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    if (!json_lock()) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (s_journal.lines) {
+        journal_push(server_index, ts, kind, players, expected, score);
+    } else {
+        ret = json_write_annotation(server_index, ts, kind, players, expected, score);
+    }
+    json_unlock();
+    return ret;
+}
+
+bool history_json_writable(void) {
+    return s_journal.lines != NULL || sd_card_is_mounted();
+}
+
+esp_err_t history_journal_begin(void) {
+    if (!json_lock()) {
+        return ESP_ERR_TIMEOUT;
+    }
+
+    esp_err_t ret = ESP_OK;
+    if (!s_journal.lines) {
+        s_journal.lines = arena_alloc(ARENA_BULK, STORAGE_JOURNAL_MAX_LINES * sizeof(journal_line_t),
+                                      "history_journal");
+        if (s_journal.lines) {
+            s_journal.count = 0;
+            s_journal.dropped = 0;
+            json_close();   // Nothing may hold a file once the card is released
+            ESP_LOGI(TAG, "Journaling JSON history (%d lines max)", STORAGE_JOURNAL_MAX_LINES);
+        } else {
+            ret = ESP_ERR_NO_MEM;
+        }
+    }
+
+    json_unlock();
+    return ret;
+}
+
+int history_journal_end(void) {
+    if (!s_journal.lines) {
+        return 0;
+    }
+
+    // Hold the lock for the whole replay so new lines land after the journal
+    if (s_json_mutex) xSemaphoreTake(s_json_mutex, portMAX_DELAY);
+
+    int written = 0;
+    for (int i = 0; i < s_journal.count; i++) {
+        const journal_line_t *line = &s_journal.lines[i];
+        esp_err_t ret = line->kind[0]
+            ? json_write_annotation(line->server_index, line->ts, line->kind,
+                                    line->players, line->expected, line->score)
+            : json_write_entry(line->server_index, line->ts, line->players);
+        if (ret == ESP_OK) {
+            written++;
+        }
+    }
+    json_close();
+
+    if (written < s_journal.count || s_journal.dropped) {
+        ESP_LOGW(TAG, "Journal replay: %d of %d lines written, %d dropped when full",
+                 written, s_journal.count, s_journal.dropped);
+    } else {
+        ESP_LOGI(TAG, "Journal replay: %d lines written", written);
+    }
+
+    arena_free(s_journal.lines);
+    s_journal.lines = NULL;
+    s_journal.count = 0;
+    json_unlock();
+    return written;
+}
+
+/**
+ * Parse a {"t":N,"p":N} sample line (what sscanf would accept, without
+ * its per-call cost - exports read a line per sample)
+ * @return false for headers, annotations and malformed lines
+ */
+static bool parse_sample_line(const char *line, history_entry_t *out) {
+    static const char T_KEY[] = "{\"t\":";
+    static const char P_KEY[] = ",\"p\":";
+    if (strncmp(line, T_KEY, sizeof(T_KEY) - 1) != 0) return false;
+    const char *p = line + sizeof(T_KEY) - 1;
+
+    uint32_t ts = 0;
+    const char *digits = p;
+    while (*p >= '0' && *p <= '9') ts = ts * 10 + (uint32_t)(*p++ - '0');
+    if (p == digits || strncmp(p, P_KEY, sizeof(P_KEY) - 1) != 0) return false;
+    p += sizeof(P_KEY) - 1;
+
+    bool neg = (*p == '-');
+    if (neg) p++;
+    int players = 0;
+    digits = p;
+    while (*p >= '0' && *p <= '9') players = players * 10 + (*p++ - '0');
+    if (p == digits || (*p != '}' && *p != ',')) return false;
+
+    out->timestamp = ts;
+    out->player_count = (int16_t)(neg ? -players : players);
+    return true;
+}
+
 static int history_entry_compare(const void *a, const void *b) {
     uint32_t ta = ((const history_entry_t *)a)->timestamp;
     uint32_t tb = ((const history_entry_t *)b)->timestamp;
@@ -684,12 +1134,15 @@ static int history_entry_compare(const void *a, const void *b) {
     return 0;
 }
 
-int history_load_range_json(int server_index, uint32_t start_time, uint32_t end_time,
-                            history_entry_t *entries, int max_entries) {
+static int history_load_range_json_leased(int server_index, uint32_t start_time, uint32_t end_time,
+                                          history_entry_t *entries, int max_entries) {
     if (!sd_card_is_mounted() || !entries || max_entries <= 0) {
         return -1;
     }
 
+    int64_t t_start = esp_timer_get_time();
+    metrics_count(METRIC_CNT_HISTORY_LOADS);
+
     char server_dir[64];
     build_json_dir_path(server_index, server_dir, sizeof(server_dir));
 
@@ -714,14 +1167,12 @@ int history_load_range_json(int server_index, uint32_t start_time, uint32_t end_
             continue;
         }
 
-        // Skip files outside date range by parsing filename
+        // Skip files outside date range by parsing filename (local days, 23-25h on DST changes)
         {
-            struct tm file_tm = {0};
-            if (sscanf(entry->d_name, "%d-%d-%d", &file_tm.tm_year, &file_tm.tm_mon, &file_tm.tm_mday) == 3) {
-                file_tm.tm_year -= 1900;
-                file_tm.tm_mon -= 1;
-                uint32_t file_day_start = (uint32_t)mktime(&file_tm);
-                uint32_t file_day_end = file_day_start + 86400;
+            int year, mon, mday;
+            if (sscanf(entry->d_name, "%d-%d-%d", &year, &mon, &mday) == 3) {
+                uint32_t file_day_start = time_util_local_to_utc(year, mon, mday, 0);
+                uint32_t file_day_end = time_util_local_to_utc(year, mon, mday + 1, 0);
                 if (file_day_end < start_time || file_day_start > end_time) {
                     continue;
                 }
@@ -733,19 +1184,12 @@ int history_load_range_json(int server_index, uint32_t start_time, uint32_t end_
         FILE *f = fopen(file_path, "r");
         if (!f) continue;
 
-        // Read line by line - fast sscanf parsing (no malloc)
+        // Read line by line - fast {"t":NUM,"p":NUM} parsing (no malloc)
         while (fgets(line_buf, sizeof(line_buf), f) && loaded < max_entries) {
-            unsigned long ts_val;
-            int p_val;
-            // Fast path: parse {"t":NUM,"p":NUM} directly
-            if (sscanf(line_buf, "{\"t\":%lu,\"p\":%d}", &ts_val, &p_val) == 2) {
-                uint32_t ts = (uint32_t)ts_val;
-                if (ts >= start_time && ts <= end_time) {
-                    entries[loaded].timestamp = ts;
-                    entries[loaded].player_count = (int16_t)p_val;
-                    loaded++;
-                }
-                continue;
+            history_entry_t sample;
+            if (parse_sample_line(line_buf, &sample) &&
+                sample.timestamp >= start_time && sample.timestamp <= end_time) {
+                entries[loaded++] = sample;
             }
             // Header/invalid lines - skip silently
         }
@@ -760,11 +1204,75 @@ int history_load_range_json(int server_index, uint32_t start_time, uint32_t end_
         qsort(entries, loaded, sizeof(history_entry_t), history_entry_compare);
     }
 
-    ESP_LOGI(TAG, "Loaded %d JSON entries for server %d", loaded, server_index);
+    metrics_observe_since(METRIC_H_HISTORY_LOAD, t_start);
+    ESP_LOGD(TAG, "Loaded %d JSON entries for server %d", loaded, server_index);
     return loaded;
 }
 
-int history_cleanup_old_files(int server_index, int days_to_keep) {
+int history_load_range_json(int server_index, uint32_t start_time, uint32_t end_time,
+                            history_entry_t *entries, int max_entries) {
+    if (!sd_card_lease()) return -1;
+    int ret = history_load_range_json_leased(server_index, start_time, end_time, entries, max_entries);
+    sd_card_release();
+    return ret;
+}
+
+static int history_stream_range_json_leased(int server_index, uint32_t start_time, uint32_t end_time,
+                                            history_entry_cb_t cb, void *ctx) {
+    if (!sd_card_is_mounted() || !cb || start_time > end_time) {
+        return -1;
+    }
+
+    int64_t t_start = esp_timer_get_time();
+    metrics_count(METRIC_CNT_HISTORY_LOADS);
+
+    int delivered = 0;
+    bool stop = false;
+    char line_buf[128];
+    char date_str[STORAGE_DATE_STR_LEN];
+    char file_path[128];
+
+    // Daily files in date order; lines within a file are already in append order
+    uint32_t day = time_util_day_start(start_time);
+    while (!stop && day <= end_time) {
+        timestamp_to_date_str(day, date_str, sizeof(date_str));
+        build_json_file_path(server_index, date_str, file_path, sizeof(file_path));
+
+        FILE *f = fopen(file_path, "r");
+        if (f) {
+            // Whole-file sequential read: bigger stdio buffer, fewer FATFS calls
+            setvbuf(f, NULL, _IOFBF, STORAGE_STREAM_BUF_SIZE);
+            while (!stop && fgets(line_buf, sizeof(line_buf), f)) {
+                history_entry_t entry;
+                if (!parse_sample_line(line_buf, &entry)) {
+                    continue;   // Header/annotation line
+                }
+                if (entry.timestamp < start_time || entry.timestamp > end_time) continue;
+
+                delivered++;
+                stop = !cb(&entry, ctx);
+            }
+            fclose(f);
+        }
+
+        struct tm tm_day;
+        time_util_to_tm(day, &tm_day);
+        day = time_util_local_to_utc(tm_day.tm_year + 1900, tm_day.tm_mon + 1, tm_day.tm_mday + 1, 0);
+    }
+
+    metrics_observe_since(METRIC_H_HISTORY_LOAD, t_start);
+    return delivered;
+}
+
+int history_stream_range_json(int server_index, uint32_t start_time, uint32_t end_time,
+                              history_entry_cb_t cb, void *ctx) {
+    if (!sd_card_lease()) return -1;
+    int ret = history_stream_range_json_leased(server_index, start_time, end_time, cb, ctx);
+    sd_card_release();
+    return ret;
+}
+
+static int history_cleanup_old_files_leased(int server_index, int days_to_keep) {
     if (!sd_card_is_mounted() || days_to_keep <= 0) {
         return 0;
     }
@@ -778,8 +1286,7 @@ int history_cleanup_old_files(int server_index, int days_to_keep) {
     time_t cutoff = now - (days_to_keep * 86400);
 
     char cutoff_date[12];
-    struct tm *tm_info = localtime(&cutoff);
-    strftime(cutoff_date, sizeof(cutoff_date), "%Y-%m-%d", tm_info);
+    time_util_format_date((uint32_t)cutoff, cutoff_date, sizeof(cutoff_date));
 
     // CS stays active permanently after mount - no toggling needed
 
@@ -824,7 +1331,14 @@ int history_cleanup_old_files(int server_index, int days_to_keep) {
     return deleted;
 }
 
-int history_get_json_file_count(int server_index) {
+int history_cleanup_old_files(int server_index, int days_to_keep) {
+    if (!sd_card_lease()) return 0;
+    int ret = history_cleanup_old_files_leased(server_index, days_to_keep);
+    sd_card_release();
+    return ret;
+}
+
+static int history_get_json_file_count_leased(int server_index) {
     if (!sd_card_is_mounted()) {
         return -1;
     }
@@ -854,6 +1368,13 @@ int history_get_json_file_count(int server_index) {
     return count;
 }
 
+int history_get_json_file_count(int server_index) {
+    if (!sd_card_lease()) return -1;
+    int ret = history_get_json_file_count_leased(server_index);
+    sd_card_release();
+    return ret;
+}
+
 void history_clear_all_storage(void) {
     ESP_LOGW(TAG, "=== CLEARING ALL HISTORY DATA ===");
 
@@ -864,11 +1385,13 @@ void history_clear_all_storage(void) {
     nvs_handle_t nvs;
     if (nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs) == ESP_OK) {
         for (int i = 0; i < 5; i++) {  // Up to 5 servers
-            char key_meta[16], key_data[16];
-            build_nvs_key(i, "meta", key_meta, sizeof(key_meta));
-            build_nvs_key(i, "data", key_data, sizeof(key_data));
+            char key_meta[16], key_data[16], key_pack[16];
+            build_nvs_key(i, NVS_SUFFIX_META, key_meta, sizeof(key_meta));
+            build_nvs_key(i, NVS_SUFFIX_DATA, key_data, sizeof(key_data));
+            build_nvs_key(i, NVS_SUFFIX_PACK, key_pack, sizeof(key_pack));
             nvs_erase_key(nvs, key_meta);
             nvs_erase_key(nvs, key_data);
+            nvs_erase_key(nvs, key_pack);
         }
         nvs_commit(nvs);
         nvs_close(nvs);
@@ -876,7 +1399,7 @@ void history_clear_all_storage(void) {
     }
 
     // Delete all JSON files from SD card
-    if (sd_card_is_mounted()) {
+    if (sd_card_is_mounted() && sd_card_lease()) {
         for (int server_idx = 0; server_idx < 5; server_idx++) {
             char server_dir[64];
             build_json_dir_path(server_idx, server_dir, sizeof(server_dir));
@@ -906,12 +1429,13 @@ void history_clear_all_storage(void) {
         }
 
         // Also delete binary history files
-        remove("/sdcard/hist_0.bin");
-        remove("/sdcard/hist_1.bin");
-        remove("/sdcard/hist_2.bin");
-        remove("/sdcard/hist_3.bin");
-        remove("/sdcard/hist_4.bin");
+        for (int i = 0; i < MAX_SERVERS; i++) {
+            char bin_path[STORAGE_PATH_MAX_LEN];
+            storage_path_history_bin(i, bin_path, sizeof(bin_path));
+            remove(bin_path);
+        }
         ESP_LOGI(TAG, "Binary history files deleted");
+        sd_card_release();
     }
 
     ESP_LOGW(TAG, "=== ALL HISTORY DATA CLEARED ===");
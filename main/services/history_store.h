@@ -7,6 +7,7 @@
 #define HISTORY_STORE_H
 
 #include "app_state.h"
+#include "history_ring.h"
 #include "esp_err.h"
 
 /**
@@ -36,10 +37,18 @@ int history_get_count(void);
 /**
  * Get entries within a time range
  * @param range_seconds Seconds to look back from now
- * @return Number of entries in range
+ * @return Number of entries in range with a known player count
  */
 int history_count_in_range(uint32_t range_seconds);
 
+/**
+ * Count, min, max and sum of known player counts within a time range
+ * One pass over the packed count array (no per-entry unpacking).
+ * @param range_seconds Seconds to look back from now
+ * @param stats Output (zeroed if the state lock times out)
+ */
+void history_get_stats(uint32_t range_seconds, history_stats_t *stats);
+
 /**
  * Save history to SD card for a specific server
  * @param server_index Server index to save history for
@@ -104,6 +113,21 @@ const char* history_range_to_label(history_range_t range);
  */
 esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t players);
 
+/**
+ * Append an annotation (e.g. detected anomaly) to the daily JSON file
+ * Written as {"t":ts,"a":kind,"p":players,"e":expected,"z":score};
+ * entry loaders skip these lines.
+ * @param server_index Server index
+ * @param ts Unix timestamp
+ * @param kind Short annotation type (e.g. "drop")
+ * @param players Player count at ts
+ * @param expected Expected players at ts
+ * @param score Deviation score (e.g. z-score)
+ * @return ESP_OK on success
+ */
+esp_err_t history_append_annotation_json(int server_index, uint32_t ts, const char *kind,
+                                         int16_t players, float expected, float score);
+
 /**
  * Load history entries from JSON files within a time range
  * Loads into provided buffer, sorted by timestamp (oldest first)
@@ -117,6 +141,27 @@ esp_err_t history_append_entry_json(int server_index, uint32_t ts, int16_t playe
 int history_load_range_json(int server_index, uint32_t start_time, uint32_t end_time,
                             history_entry_t *entries, int max_entries);
 
+/**
+ * Called for each streamed history entry
+ * @return false to stop the stream
+ */
+typedef bool (*history_entry_cb_t)(const history_entry_t *entry, void *ctx);
+
+/**
+ * Stream history entries from JSON files within a time range
+ * Reads the daily files in date order, one line at a time, so no range
+ * is ever held in RAM. Entries come in file order (oldest first unless
+ * the clock stepped back); the current day reflects the last flush.
+ * @param server_index Server index
+ * @param start_time Start timestamp (inclusive)
+ * @param end_time End timestamp (inclusive)
+ * @param cb Called per entry
+ * @param ctx Passed to cb
+ * @return Number of entries delivered, or -1 on error
+ */
+int history_stream_range_json(int server_index, uint32_t start_time, uint32_t end_time,
+                              history_entry_cb_t cb, void *ctx);
+
 /**
  * Cleanup old history files beyond retention period
  * @param server_index Server index
@@ -145,6 +190,27 @@ int history_get_json_file_count(int server_index);
  */
 void history_flush_json(void);
 
+/**
+ * Check whether JSON appends will be kept (SD mounted or journal open)
+ */
+bool history_json_writable(void);
+
+/**
+ * Start holding JSON appends in a PSRAM journal instead of the SD card
+ * Closes the cached file handle so the card can be unmounted. Holds up to
+ * STORAGE_JOURNAL_MAX_LINES lines; later ones are dropped and counted.
+ * @return ESP_OK, or ESP_ERR_NO_MEM if the journal can't be allocated
+ */
+esp_err_t history_journal_begin(void);
+
+/**
+ * Write the journal to the daily JSON files and resume direct appends
+ * Call once the SD card is mounted again. Appends made meanwhile wait,
+ * so files keep arrival order.
+ * @return Number of journal lines written
+ */
+int history_journal_end(void);
+
 /**
  * Clear ALL history storage (RAM, NVS, and SD card JSON files)
  * Use this to start fresh with clean data
@@ -0,0 +1,543 @@
+/**
+ * DayZ Server Tracker - HTTP API Implementation
+ */
+
+#include "http_api.h"
+#include "config.h"
+#include "app_state.h"
+#include "history_store.h"
+#include "history_export.h"
+#include "heatmap.h"
+#include "metrics.h"
+#include "wifi_manager.h"
+#include "drivers/sd_card.h"
+#include "esp_http_server.h"
+#include "esp_attr.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "http_api";
+
+static httpd_handle_t s_server = NULL;
+
+static void copy_str(char *dst, const char *src, size_t size) {
+    strncpy(dst, src, size - 1);
+    dst[size - 1] = '\0';
+}
+
+// ============== CHUNKED WRITER ==============
+
+// Response body in fixed chunks; stops writing once the client is gone
+typedef struct {
+    httpd_req_t *req;
+    size_t len;
+    esp_err_t err;
+    char buf[HTTP_API_CHUNK_SIZE];
+} chunk_writer_t;
+
+// Handlers run one at a time on the server task, so one writer serves all
+static EXT_RAM_BSS_ATTR chunk_writer_t s_writer;
+static EXT_RAM_BSS_ATTR heatmap_data_t s_heatmap;
+static EXT_RAM_BSS_ATTR history_entry_t s_ram_chunk[HTTP_API_RAM_CHUNK];
+
+/**
+ * Start a JSON response
+ * @param cross_origin Let dashboards on other origins read it (read-only
+ *        data only; /export is never shared with other sites)
+ */
+static void cw_begin(chunk_writer_t *w, httpd_req_t *req, bool cross_origin) {
+    w->req = req;
+    w->len = 0;
+    w->err = ESP_OK;
+    httpd_resp_set_type(req, "application/json");
+    if (cross_origin) {
+        httpd_resp_set_hdr(req, "Access-Control-Allow-Origin", "*");
+    }
+    httpd_resp_set_hdr(req, "Cache-Control", "no-store");
+}
+
+static void cw_flush(chunk_writer_t *w) {
+    if (w->err == ESP_OK && w->len > 0) {
+        w->err = httpd_resp_send_chunk(w->req, w->buf, w->len);
+    }
+    w->len = 0;
+}
+
+static void cw_printf(chunk_writer_t *w, const char *fmt, ...) {
+    // Pieces are a few dozen bytes: if one doesn't fit, flush and retry once
+    for (int attempt = 0; attempt < 2 && w->err == ESP_OK; attempt++) {
+        size_t room = sizeof(w->buf) - w->len;
+        va_list ap;
+        va_start(ap, fmt);
+        int n = vsnprintf(w->buf + w->len, room, fmt, ap);
+        va_end(ap);
+
+        if (n < 0) return;
+        if ((size_t)n < room) {
+            w->len += n;
+            return;
+        }
+        cw_flush(w);
+    }
+}
+
+static void cw_json_str(chunk_writer_t *w, const char *s) {
+    char out[2 * 64 + 3];
+    size_t o = 0;
+    out[o++] = '"';
+    for (; *s && o < sizeof(out) - 3; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            out[o++] = '\\';
+            out[o++] = c;
+        } else if (c >= 0x20) {
+            out[o++] = c;
+        }
+    }
+    out[o++] = '"';
+    out[o] = '\0';
+    cw_printf(w, "%s", out);
+}
+
+/**
+ * Send what is buffered and close the chunked body
+ */
+static esp_err_t cw_end(chunk_writer_t *w, int64_t t_start) {
+    cw_flush(w);
+    if (w->err == ESP_OK) {
+        w->err = httpd_resp_send_chunk(w->req, NULL, 0);
+    }
+    metrics_count(METRIC_CNT_API_REQUESTS);
+    metrics_observe_since(METRIC_H_API_REQUEST, t_start);
+    if (w->err != ESP_OK) {
+        ESP_LOGD(TAG, "%s: client went away (%s)", w->req->uri, esp_err_to_name(w->err));
+    }
+    return w->err;
+}
+
+// ============== QUERY HELPERS ==============
+
+static bool query_u32(httpd_req_t *req, const char *key, uint32_t *out) {
+    char query[128];
+    char val[16];
+    if (httpd_req_get_url_query_str(req, query, sizeof(query)) != ESP_OK ||
+        httpd_query_key_value(query, key, val, sizeof(val)) != ESP_OK) {
+        return false;
+    }
+    char *end = NULL;
+    unsigned long v = strtoul(val, &end, 10);
+    if (end == val || *end != '\0') return false;
+    *out = (uint32_t)v;
+    return true;
+}
+
+static bool query_str(httpd_req_t *req, const char *key, char *out, size_t size) {
+    char query[128];
+    return httpd_req_get_url_query_str(req, query, sizeof(query)) == ESP_OK &&
+           httpd_query_key_value(query, key, out, size) == ESP_OK;
+}
+
+static bool server_index_valid(int index) {
+    app_state_t *state = app_state_get();
+    return index >= 0 && index < state->settings.server_count &&
+           state->settings.servers[index].active;
+}
+
+// ============== /status ==============
+
+typedef struct {
+    char name[64];
+    char server_id[32];
+    char map[32];
+    int players;                    // -1 = not fetched yet
+    int max_players;
+} server_snapshot_t;
+
+static esp_err_t status_handler(httpd_req_t *req) {
+    int64_t t_start = esp_timer_get_time();
+    app_state_t *state = app_state_get();
+
+    // Copy under the lock, write without it
+    server_snapshot_t servers[MAX_SERVERS];
+    int server_count = 0;
+    int active = 0;
+    char last_update[32] = "";
+    char server_time[16] = "";
+    bool daytime = false;
+    int rank = 0;
+
+    if (!app_state_lock(100)) {
+        return httpd_resp_send_err(req, HTTPD_500_INTERNAL_SERVER_ERROR, "State busy");
+    }
+    server_count = state->settings.server_count;
+    if (server_count > MAX_SERVERS) server_count = MAX_SERVERS;
+    active = state->settings.active_server_index;
+    for (int i = 0; i < server_count; i++) {
+        const server_config_t *srv = &state->settings.servers[i];
+        server_snapshot_t *snap = &servers[i];
+        copy_str(snap->name, srv->display_name, sizeof(snap->name));
+        copy_str(snap->server_id, srv->server_id, sizeof(snap->server_id));
+        copy_str(snap->map, srv->map_name, sizeof(snap->map));
+        snap->players = -1;
+        snap->max_players = srv->max_players;
+    }
+    if (active < server_count) {
+        servers[active].players = state->runtime.current_players;
+        if (state->runtime.max_players > 0) servers[active].max_players = state->runtime.max_players;
+    }
+    for (int s = 0; s < state->runtime.secondary_count && s < MAX_SECONDARY_SERVERS; s++) {
+        const secondary_server_status_t *sec = &state->runtime.secondary[s];
+        int idx = state->runtime.secondary_server_indices[s];
+        if (sec->valid && idx < server_count && idx != active) {
+            servers[idx].players = sec->player_count;
+            if (sec->max_players > 0) servers[idx].max_players = sec->max_players;
+        }
+    }
+    copy_str(last_update, state->runtime.last_update, sizeof(last_update));
+    copy_str(server_time, state->runtime.server_time, sizeof(server_time));
+    daytime = state->runtime.is_daytime;
+    rank = state->runtime.server_rank;
+    app_state_unlock();
+
+    chunk_writer_t *w = &s_writer;
+    cw_begin(w, req, true);
+
+    cw_printf(w, "{\"time\":%lu,\"uptime_s\":%lu,\"wifi\":%s,\"rssi\":%d,\"sd\":%s,"
+                 "\"history_entries\":%d,\"active\":%d,\"last_update\":",
+              (unsigned long)time(NULL), (unsigned long)(esp_timer_get_time() / 1000000),
+              wifi_manager_is_connected() ? "true" : "false", wifi_manager_get_rssi(),
+              sd_card_is_mounted() ? "true" : "false", history_get_count(), active);
+    cw_json_str(w, last_update);
+    cw_printf(w, ",\"server_time\":");
+    cw_json_str(w, server_time);
+    cw_printf(w, ",\"daytime\":%s,\"rank\":%d,\"servers\":[", daytime ? "true" : "false", rank);
+
+    for (int i = 0; i < server_count; i++) {
+        cw_printf(w, "%s{\"index\":%d,\"name\":", i ? "," : "", i);
+        cw_json_str(w, servers[i].name);
+        cw_printf(w, ",\"id\":");
+        cw_json_str(w, servers[i].server_id);
+        cw_printf(w, ",\"map\":");
+        cw_json_str(w, servers[i].map);
+        if (servers[i].players >= 0) {
+            cw_printf(w, ",\"players\":%d", servers[i].players);
+        } else {
+            cw_printf(w, ",\"players\":null");
+        }
+        cw_printf(w, ",\"max_players\":%d}", servers[i].max_players);
+    }
+    cw_printf(w, "]}");
+
+    return cw_end(w, t_start);
+}
+
+// ============== /servers/{i}/history ==============
+
+typedef struct {
+    chunk_writer_t *w;
+    uint32_t step;                  // 0 = raw samples
+    int points;
+    // Open bucket (step > 0)
+    uint32_t bucket;
+    int n;
+    int min;
+    int max;
+    int32_t sum;
+} history_emit_t;
+
+static void emit_bucket(history_emit_t *e) {
+    if (e->n == 0) return;
+    cw_printf(e->w, "%s[%lu,%d,%d,%d]", e->points++ ? "," : "", (unsigned long)e->bucket,
+              (int)((e->sum + e->n / 2) / e->n), e->min, e->max);
+    e->n = 0;
+}
+
+static bool emit_entry(const history_entry_t *entry, void *ctx) {
+    history_emit_t *e = ctx;
+    int p = entry->player_count;
+    if (p < 0) return true;
+
+    if (e->step == 0) {
+        cw_printf(e->w, "%s[%lu,%d]", e->points++ ? "," : "", (unsigned long)entry->timestamp, p);
+    } else {
+        uint32_t bucket = entry->timestamp - entry->timestamp % e->step;
+        if (e->n > 0 && bucket != e->bucket) {
+            emit_bucket(e);
+        }
+        if (e->n == 0) {
+            e->bucket = bucket;
+            e->min = p;
+            e->max = p;
+            e->sum = 0;
+        }
+        e->n++;
+        e->sum += p;
+        if (p < e->min) e->min = p;
+        if (p > e->max) e->max = p;
+    }
+    return e->w->err == ESP_OK;
+}
+
+/**
+ * RAM ring fallback (active server only)
+ * Copied out under the state lock HTTP_API_RAM_CHUNK entries at a time, so
+ * the lock isn't held while sending. Each chunk seeks by timestamp, since
+ * appends to a full ring shift the indices in between.
+ */
+static void emit_ram(int index, uint32_t from, uint32_t to, history_emit_t *e) {
+    uint32_t next = from;
+    for (;;) {
+        int n = 0;
+        if (!app_state_lock(100)) return;
+        if (app_state_get()->settings.active_server_index == index) {
+            // Ring is oldest first: first entry at or after next
+            int lo = 0;
+            int hi = history_get_count();
+            while (lo < hi) {
+                int mid = lo + (hi - lo) / 2;
+                history_entry_t entry;
+                if (history_get_entry(mid, &entry) == 0 && entry.timestamp < next) {
+                    lo = mid + 1;
+                } else {
+                    hi = mid;
+                }
+            }
+            for (int i = lo; n < HTTP_API_RAM_CHUNK && history_get_entry(i, &s_ram_chunk[n]) == 0; i++) {
+                if (s_ram_chunk[n].timestamp > to) break;
+                n++;
+            }
+        }
+        app_state_unlock();
+
+        for (int i = 0; i < n; i++) {
+            if (!emit_entry(&s_ram_chunk[i], e)) return;
+        }
+        if (n < HTTP_API_RAM_CHUNK) return;
+        next = s_ram_chunk[n - 1].timestamp + 1;
+    }
+}
+
+static esp_err_t history_handler(httpd_req_t *req) {
+    int64_t t_start = esp_timer_get_time();
+
+    int index = -1;
+    int consumed = 0;
+    if (sscanf(req->uri, "/servers/%d/history%n", &index, &consumed) != 1 || consumed == 0 ||
+        (req->uri[consumed] != '\0' && req->uri[consumed] != '?')) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "Unknown endpoint");
+    }
+    if (!server_index_valid(index)) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No such server");
+    }
+
+    uint32_t to = (uint32_t)time(NULL);
+    uint32_t from = 0;
+    uint32_t step = 0;
+    query_u32(req, "to", &to);
+    if (!query_u32(req, "from", &from)) {
+        from = to > HTTP_API_DEFAULT_RANGE_SEC ? to - HTTP_API_DEFAULT_RANGE_SEC : 0;
+    }
+    query_u32(req, "step", &step);
+    if (from > to || to - from > HTTP_API_MAX_RANGE_DAYS * 86400U || step > 86400) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad from/to/step");
+    }
+
+    chunk_writer_t *w = &s_writer;
+    cw_begin(w, req, true);
+
+    // SD files cover every server; the RAM ring only the active one
+    bool from_sd = sd_card_is_mounted();
+    cw_printf(w, "{\"server\":%d,\"from\":%lu,\"to\":%lu,\"step\":%lu,\"source\":\"%s\","
+                 "\"fields\":%s,\"points\":[",
+              index, (unsigned long)from, (unsigned long)to, (unsigned long)step,
+              from_sd ? "sd" : "ram", step ? "[\"t\",\"avg\",\"min\",\"max\"]" : "[\"t\",\"p\"]");
+
+    history_emit_t emit = { .w = w, .step = step };
+    if (from_sd) {
+        history_stream_range_json(index, from, to, emit_entry, &emit);
+    } else {
+        emit_ram(index, from, to, &emit);
+    }
+    emit_bucket(&emit);
+    cw_printf(w, "],\"count\":%d}", emit.points);
+
+    return cw_end(w, t_start);
+}
+
+// ============== /heatmap ==============
+
+static esp_err_t heatmap_handler(httpd_req_t *req) {
+    static const char *days[HEATMAP_DAYS] = { "Mon", "Tue", "Wed", "Thu", "Fri", "Sat", "Sun" };
+    int64_t t_start = esp_timer_get_time();
+
+    uint32_t server = app_state_get()->settings.active_server_index;
+    query_u32(req, "server", &server);
+    if (!server_index_valid((int)server)) {
+        return httpd_resp_send_err(req, HTTPD_404_NOT_FOUND, "No such server");
+    }
+
+    heatmap_data_t *hm = &s_heatmap;
+    heatmap_calculate((int)server, hm);
+
+    chunk_writer_t *w = &s_writer;
+    cw_begin(w, req, true);
+    cw_printf(w, "{\"server\":%lu,\"valid\":%s,\"period_hours\":%d,\"min_avg\":%d,\"max_avg\":%d,\"days\":[",
+              (unsigned long)server, hm->valid ? "true" : "false", 24 / HEATMAP_PERIODS,
+              hm->min_avg, hm->max_avg);
+
+    for (int d = 0; d < HEATMAP_DAYS; d++) {
+        cw_printf(w, "%s{\"day\":\"%s\",\"avg\":[", d ? "," : "", days[d]);
+        for (int p = 0; p < HEATMAP_PERIODS; p++) {
+            const heatmap_cell_t *cell = &hm->cells[d][p];
+            if (cell->count > 0) {
+                cw_printf(w, "%s%d", p ? "," : "", cell->sum / cell->count);
+            } else {
+                cw_printf(w, "%snull", p ? "," : "");
+            }
+        }
+        cw_printf(w, "],\"samples\":[");
+        for (int p = 0; p < HEATMAP_PERIODS; p++) {
+            cw_printf(w, "%s%d", p ? "," : "", hm->cells[d][p].count);
+        }
+        cw_printf(w, "]}");
+    }
+    cw_printf(w, "]}");
+
+    return cw_end(w, t_start);
+}
+
+// ============== /export ==============
+
+static void write_export_status(chunk_writer_t *w) {
+    export_status_t st;
+    history_export_get_status(&st);
+    cw_printf(w, "{\"busy\":%s,\"result\":", st.busy ? "true" : "false");
+    cw_json_str(w, esp_err_to_name(st.result));
+    cw_printf(w, ",\"files\":%d,\"rows\":%lu,\"bytes\":%lu,\"elapsed_ms\":%lu,\"path\":",
+              st.files, (unsigned long)st.rows, (unsigned long)st.bytes, (unsigned long)st.elapsed_ms);
+    cw_json_str(w, st.path);
+    cw_printf(w, "}");
+}
+
+static esp_err_t export_status_handler(httpd_req_t *req) {
+    int64_t t_start = esp_timer_get_time();
+    chunk_writer_t *w = &s_writer;
+    cw_begin(w, req, false);
+    write_export_status(w);
+    return cw_end(w, t_start);
+}
+
+/**
+ * POST /export writes to the card, so it needs HTTP_API_EXPORT_TOKEN as
+ * "Authorization: Bearer <token>"; with no token configured it is off
+ */
+static bool export_authorized(httpd_req_t *req) {
+    static const char token[] = HTTP_API_EXPORT_TOKEN;
+    char auth[sizeof("Bearer ") + sizeof(token)];
+    if (token[0] == '\0' ||
+        httpd_req_get_hdr_value_str(req, "Authorization", auth, sizeof(auth)) != ESP_OK ||
+        strncmp(auth, "Bearer ", 7) != 0 || strlen(auth + 7) != sizeof(token) - 1) {
+        return false;
+    }
+    // Constant time, so the token can't be guessed byte by byte
+    uint8_t diff = 0;
+    for (size_t i = 0; i < sizeof(token) - 1; i++) {
+        diff |= (uint8_t)(auth[7 + i] ^ token[i]);
+    }
+    return diff == 0;
+}
+
+static esp_err_t export_start_handler(httpd_req_t *req) {
+    int64_t t_start = esp_timer_get_time();
+
+    if (HTTP_API_EXPORT_TOKEN[0] == '\0') {
+        return httpd_resp_send_err(req, HTTPD_403_FORBIDDEN, "Export disabled (HTTP_API_EXPORT_TOKEN)");
+    }
+    if (!export_authorized(req)) {
+        return httpd_resp_send_err(req, HTTPD_401_UNAUTHORIZED, "Bad or missing token");
+    }
+
+    uint32_t server = UINT32_MAX;           // Absent = every server
+    export_request_t er = { .end_time = (uint32_t)time(NULL) };
+    query_u32(req, "server", &server);
+    query_u32(req, "to", &er.end_time);
+    if (!query_u32(req, "from", &er.start_time)) {
+        er.start_time = er.end_time > HTTP_API_DEFAULT_RANGE_SEC ? er.end_time - HTTP_API_DEFAULT_RANGE_SEC : 0;
+    }
+    query_u32(req, "step", &er.step_sec);
+    er.server_index = server == UINT32_MAX ? -1 : (int)server;
+
+    char format[8] = "csv";
+    query_str(req, "format", format, sizeof(format));
+    if (strcmp(format, "dzc") == 0) {
+        er.format = EXPORT_FORMAT_DZC;
+    } else if (strcmp(format, "csv") != 0) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "format is csv or dzc");
+    }
+
+    esp_err_t err = history_export_start(&er);
+    if (err == ESP_ERR_INVALID_ARG) {
+        return httpd_resp_send_err(req, HTTPD_400_BAD_REQUEST, "Bad server/from/to/step");
+    }
+    if (err != ESP_OK) {
+        httpd_resp_set_status(req, "409 Conflict");
+    } else {
+        httpd_resp_set_status(req, "202 Accepted");
+    }
+
+    chunk_writer_t *w = &s_writer;
+    cw_begin(w, req, false);
+    write_export_status(w);
+    return cw_end(w, t_start);
+}
+
+// ============== SERVER ==============
+
+esp_err_t http_api_start(void) {
+#if HTTP_API_ENABLED
+    if (s_server) return ESP_OK;
+
+    httpd_config_t config = HTTPD_DEFAULT_CONFIG();
+    config.server_port = HTTP_API_PORT;
+    config.task_priority = HTTP_API_TASK_PRIORITY;
+    config.stack_size = HTTP_API_TASK_STACK;
+    config.max_open_sockets = HTTP_API_MAX_SOCKETS;
+    config.lru_purge_enable = true;
+    config.uri_match_fn = httpd_uri_match_wildcard;
+
+    esp_err_t err = httpd_start(&s_server, &config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to start HTTP server: %s", esp_err_to_name(err));
+        s_server = NULL;
+        return err;
+    }
+
+    static const httpd_uri_t uris[] = {
+        { .uri = "/status",     .method = HTTP_GET, .handler = status_handler },
+        { .uri = "/servers/*",  .method = HTTP_GET, .handler = history_handler },
+        { .uri = "/heatmap",    .method = HTTP_GET, .handler = heatmap_handler },
+        { .uri = "/export",     .method = HTTP_GET, .handler = export_status_handler },
+        { .uri = "/export",     .method = HTTP_POST, .handler = export_start_handler },
+    };
+    for (size_t i = 0; i < sizeof(uris) / sizeof(uris[0]); i++) {
+        httpd_register_uri_handler(s_server, &uris[i]);
+    }
+
+    ESP_LOGI(TAG, "HTTP API listening on port %d", HTTP_API_PORT);
+    return ESP_OK;
+#else
+    return ESP_OK;
+#endif
+}
+
+void http_api_stop(void) {
+    if (s_server) {
+        httpd_stop(s_server);
+        s_server = NULL;
+    }
+}
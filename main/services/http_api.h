@@ -0,0 +1,41 @@
+/**
+ * DayZ Server Tracker - HTTP API
+ * Read-only JSON endpoints for dashboards, served while tracking runs
+ *
+ *   GET /status                              Servers, live players, uptime
+ *   GET /servers/{i}/history?from=&to=&step= Samples (step=0) or per-step
+ *                                            [t, avg, min, max] buckets
+ *   GET /heatmap?server=                     Day x 4h-period averages
+ *   POST /export?server=&from=&to=&format=&step=
+ *                                            Start a CSV/DZC file export to
+ *                                            SD (history_export.h); 202 or
+ *                                            409 if one is running. Needs
+ *                                            HTTP_API_EXPORT_TOKEN as a
+ *                                            Bearer token (403 if unset)
+ *   GET /export                              Progress of the last export
+ *
+ * from/to are Unix seconds (default: the last HTTP_API_DEFAULT_RANGE_SEC).
+ * Bodies are written with chunked encoding from a fixed HTTP_API_CHUNK_SIZE
+ * buffer; history is streamed line by line from the daily JSON files, so
+ * no range is held in RAM. Without an SD card the active server's RAM
+ * ring is served instead. The server task runs below the fetch tasks.
+ * Read-only endpoints allow any origin (CORS); /export does not.
+ */
+
+#ifndef HTTP_API_H
+#define HTTP_API_H
+
+#include "esp_err.h"
+
+/**
+ * Start the HTTP server (no-op if HTTP_API_ENABLED is 0 or already running)
+ * Safe to call before WiFi connects - it listens on all interfaces.
+ */
+esp_err_t http_api_start(void);
+
+/**
+ * Stop the HTTP server
+ */
+void http_api_stop(void);
+
+#endif // HTTP_API_H
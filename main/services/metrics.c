@@ -0,0 +1,257 @@
+/**
+ * DayZ Server Tracker - Runtime Metrics Implementation
+ *
+ * Each core owns a slot of counters and histogram buckets. A task may
+ * migrate between reading its core ID and the add, so slots are still
+ * updated with atomics - uncontended, which on the S3 is one S32C1I.
+ */
+
+#include "metrics.h"
+#include "config.h"
+#include "storage_backend.h"
+#include "storage_config.h"
+#include "storage_paths.h"
+#include "drivers/sd_card.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "metrics";
+
+// Upper bounds (us) of all but the last (overflow) bucket
+static const uint32_t s_bucket_bounds[METRICS_HIST_BUCKETS - 1] = {
+    50, 100, 250, 500, 1000, 2500, 5000, 10000,
+    25000, 50000, 100000, 250000, 500000, 1000000, 2500000,
+};
+
+static const char *s_counter_names[METRIC_COUNTER_COUNT] = {
+    "http_req", "http_err", "parse_err", "hist_append", "hist_load",
+    "sd_err", "evt_posted", "evt_dropped", "lvgl_timeout", "arena_spill",
+    "arena_fail", "api_req", "mqtt_pub", "mqtt_drop", "mqtt_conn",
+    "fleet_tx", "fleet_rx", "fleet_hit", "fleet_fallback", "fleet_reject",
+    "fc_seed_drop",
+};
+
+static const char *s_gauge_names[METRIC_GAUGE_COUNT] = {
+    "evt_depth", "evt_peak", "heap_free", "heap_min", "heap_largest",
+    "psram_free", "psram_min", "arena_bulk", "arena_scratch", "arena_dma",
+    "mqtt_queue", "fleet_peers",
+};
+
+static const char *s_hist_names[METRIC_HIST_COUNT] = {
+    "http", "bm_parse", "hist_append", "hist_load", "sd_op", "lvgl_lock",
+    "fetch_e2e", "api",
+};
+
+typedef struct {
+    uint32_t counters[METRIC_COUNTER_COUNT];
+    uint32_t buckets[METRIC_HIST_COUNT][METRICS_HIST_BUCKETS];
+    uint32_t max_us[METRIC_HIST_COUNT];
+} metrics_core_t;
+
+static metrics_core_t s_cores[portNUM_PROCESSORS];
+static int32_t s_gauges[METRIC_GAUGE_COUNT];
+
+static int64_t s_last_sample_us = 0;
+static int64_t s_last_dump_us = 0;
+
+static inline metrics_core_t* core_slot(void) {
+    return &s_cores[xPortGetCoreID() % portNUM_PROCESSORS];
+}
+
+static void atomic_max_u32(uint32_t *p, uint32_t v) {
+    uint32_t cur = __atomic_load_n(p, __ATOMIC_RELAXED);
+    while (v > cur &&
+           !__atomic_compare_exchange_n(p, &cur, v, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void metrics_init(void) {
+    memset(s_cores, 0, sizeof(s_cores));
+    memset(s_gauges, 0, sizeof(s_gauges));
+    s_last_sample_us = 0;
+    s_last_dump_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Metrics initialized (%d bytes)", (int)(sizeof(s_cores) + sizeof(s_gauges)));
+}
+
+void metrics_count_add(metric_counter_t id, uint32_t n) {
+    if ((unsigned)id >= METRIC_COUNTER_COUNT) return;
+    __atomic_fetch_add(&core_slot()->counters[id], n, __ATOMIC_RELAXED);
+}
+
+void metrics_gauge_set(metric_gauge_t id, int32_t value) {
+    if ((unsigned)id >= METRIC_GAUGE_COUNT) return;
+    __atomic_store_n(&s_gauges[id], value, __ATOMIC_RELAXED);
+}
+
+void metrics_gauge_max(metric_gauge_t id, int32_t value) {
+    if ((unsigned)id >= METRIC_GAUGE_COUNT) return;
+    int32_t cur = __atomic_load_n(&s_gauges[id], __ATOMIC_RELAXED);
+    while (value > cur &&
+           !__atomic_compare_exchange_n(&s_gauges[id], &cur, value, true,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+}
+
+void metrics_observe_us(metric_hist_t id, uint32_t us) {
+    if ((unsigned)id >= METRIC_HIST_COUNT) return;
+
+    int b = 0;
+    while (b < METRICS_HIST_BUCKETS - 1 && us > s_bucket_bounds[b]) {
+        b++;
+    }
+
+    metrics_core_t *c = core_slot();
+    __atomic_fetch_add(&c->buckets[id][b], 1, __ATOMIC_RELAXED);
+    atomic_max_u32(&c->max_us[id], us);
+}
+
+void metrics_observe_since(metric_hist_t id, int64_t start_us) {
+    int64_t d = esp_timer_get_time() - start_us;
+    if (d < 0) d = 0;
+    if (d > UINT32_MAX) d = UINT32_MAX;
+    metrics_observe_us(id, (uint32_t)d);
+}
+
+void metrics_snapshot(metrics_snapshot_t *out) {
+    if (!out) return;
+    memset(out, 0, sizeof(*out));
+    out->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+
+    for (int core = 0; core < portNUM_PROCESSORS; core++) {
+        const metrics_core_t *c = &s_cores[core];
+        for (int i = 0; i < METRIC_COUNTER_COUNT; i++) {
+            out->counters[i] += __atomic_load_n(&c->counters[i], __ATOMIC_RELAXED);
+        }
+        for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+            metrics_hist_snapshot_t *hs = &out->hist[h];
+            for (int b = 0; b < METRICS_HIST_BUCKETS; b++) {
+                uint32_t n = __atomic_load_n(&c->buckets[h][b], __ATOMIC_RELAXED);
+                hs->buckets[b] += n;
+                hs->count += n;
+            }
+            uint32_t m = __atomic_load_n(&c->max_us[h], __ATOMIC_RELAXED);
+            if (m > hs->max_us) hs->max_us = m;
+        }
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT; i++) {
+        out->gauges[i] = __atomic_load_n(&s_gauges[i], __ATOMIC_RELAXED);
+    }
+}
+
+uint32_t metrics_hist_percentile(const metrics_hist_snapshot_t *h, int pct) {
+    if (!h || h->count == 0) return 0;
+    if (pct < 1) pct = 1;
+    if (pct > 100) pct = 100;
+
+    // Rank of the sample at the percentile (1-based, rounded up)
+    uint32_t rank = (uint32_t)(((uint64_t)h->count * pct + 99) / 100);
+    uint32_t seen = 0;
+    for (int b = 0; b < METRICS_HIST_BUCKETS - 1; b++) {
+        seen += h->buckets[b];
+        if (seen >= rank) {
+            // Never report more than the slowest sample seen
+            return s_bucket_bounds[b] < h->max_us ? s_bucket_bounds[b] : h->max_us;
+        }
+    }
+    return h->max_us;
+}
+
+const char* metrics_counter_name(metric_counter_t id) {
+    return (unsigned)id < METRIC_COUNTER_COUNT ? s_counter_names[id] : "?";
+}
+
+const char* metrics_gauge_name(metric_gauge_t id) {
+    return (unsigned)id < METRIC_GAUGE_COUNT ? s_gauge_names[id] : "?";
+}
+
+const char* metrics_hist_name(metric_hist_t id) {
+    return (unsigned)id < METRIC_HIST_COUNT ? s_hist_names[id] : "?";
+}
+
+static void sample_system(void) {
+    metrics_gauge_set(METRIC_G_HEAP_INTERNAL_FREE,
+                      (int32_t)heap_caps_get_free_size(MALLOC_CAP_INTERNAL));
+    metrics_gauge_set(METRIC_G_HEAP_INTERNAL_MIN,
+                      (int32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL));
+    metrics_gauge_set(METRIC_G_HEAP_INTERNAL_LARGEST,
+                      (int32_t)heap_caps_get_largest_free_block(MALLOC_CAP_INTERNAL));
+    metrics_gauge_set(METRIC_G_PSRAM_FREE,
+                      (int32_t)heap_caps_get_free_size(MALLOC_CAP_SPIRAM));
+    metrics_gauge_set(METRIC_G_PSRAM_MIN,
+                      (int32_t)heap_caps_get_minimum_free_size(MALLOC_CAP_SPIRAM));
+}
+
+bool metrics_dump_to_sd(void) {
+    if (!sd_card_is_mounted()) return false;
+
+    // Main loop only - keep the ~1KB line off its stack
+    static metrics_snapshot_t snap;
+    static char line[1024];
+    metrics_snapshot(&snap);
+
+    time_t now;
+    time(&now);
+    int len = snprintf(line, sizeof(line), "{\"up\":%lu,\"t\":%lu,\"c\":{",
+                       (unsigned long)snap.uptime_s,
+                       (unsigned long)(now >= STORAGE_TIMESTAMP_MIN_VALID ? now : 0));
+
+    for (int i = 0; i < METRIC_COUNTER_COUNT && len < (int)sizeof(line); i++) {
+        len += snprintf(line + len, sizeof(line) - len, "%s\"%s\":%lu", i ? "," : "",
+                        s_counter_names[i], (unsigned long)snap.counters[i]);
+    }
+    if (len < (int)sizeof(line)) {
+        len += snprintf(line + len, sizeof(line) - len, "},\"g\":{");
+    }
+    for (int i = 0; i < METRIC_GAUGE_COUNT && len < (int)sizeof(line); i++) {
+        len += snprintf(line + len, sizeof(line) - len, "%s\"%s\":%ld", i ? "," : "",
+                        s_gauge_names[i], (long)snap.gauges[i]);
+    }
+    // Histograms as [count, p50, p95, p99, max] in us
+    if (len < (int)sizeof(line)) {
+        len += snprintf(line + len, sizeof(line) - len, "},\"h\":{");
+    }
+    for (int i = 0; i < METRIC_HIST_COUNT && len < (int)sizeof(line); i++) {
+        const metrics_hist_snapshot_t *h = &snap.hist[i];
+        len += snprintf(line + len, sizeof(line) - len, "%s\"%s\":[%lu,%lu,%lu,%lu,%lu]",
+                        i ? "," : "", s_hist_names[i], (unsigned long)h->count,
+                        (unsigned long)metrics_hist_percentile(h, 50),
+                        (unsigned long)metrics_hist_percentile(h, 95),
+                        (unsigned long)metrics_hist_percentile(h, 99),
+                        (unsigned long)h->max_us);
+    }
+    if (len < (int)sizeof(line)) {
+        len += snprintf(line + len, sizeof(line) - len, "}}");
+    }
+    if (len >= (int)sizeof(line)) {
+        ESP_LOGW(TAG, "Snapshot line truncated");
+        return false;
+    }
+
+    char path[STORAGE_PATH_MAX_LEN];
+    char old_path[STORAGE_PATH_MAX_LEN];
+    storage_path_metrics(path, sizeof(path));
+    storage_path_metrics_old(old_path, sizeof(old_path));
+    storage_rotate(path, old_path, METRICS_FILE_MAX_BYTES);
+
+    // storage_append_line() counts its own failures
+    return storage_append_line(path, line) == STORAGE_OK;
+}
+
+void metrics_tick(void) {
+    int64_t now = esp_timer_get_time();
+
+    if (now - s_last_sample_us >= (int64_t)METRICS_SAMPLE_INTERVAL_MS * 1000) {
+        s_last_sample_us = now;
+        sample_system();
+    }
+
+    if (now - s_last_dump_us >= (int64_t)METRICS_DUMP_INTERVAL_SEC * 1000000) {
+        s_last_dump_us = now;
+        metrics_dump_to_sd();
+    }
+}
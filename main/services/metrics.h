@@ -0,0 +1,166 @@
+/**
+ * DayZ Server Tracker - Runtime Metrics
+ * Counters, gauges and latency histograms for field diagnostics
+ *
+ * The metric set is fixed at compile time (enums below), so recording is
+ * an array index plus one relaxed atomic add on the calling core's slot -
+ * no locks, no allocation, safe from any task. Readers sum the per-core
+ * slots into a snapshot. metrics_tick() from the main loop samples heap
+ * watermarks and appends a snapshot line to a rotating SD file.
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Monotonic counters (since boot)
+typedef enum {
+    METRIC_CNT_HTTP_REQUESTS = 0,
+    METRIC_CNT_HTTP_ERRORS,         // Connect/transport failure or non-200
+    METRIC_CNT_PARSE_ERRORS,
+    METRIC_CNT_HISTORY_APPENDS,
+    METRIC_CNT_HISTORY_LOADS,
+    METRIC_CNT_SD_ERRORS,
+    METRIC_CNT_EVENTS_POSTED,
+    METRIC_CNT_EVENTS_DROPPED,      // Queue full
+    METRIC_CNT_LVGL_LOCK_TIMEOUTS,
+    METRIC_CNT_ARENA_SPILLS,        // Arena served from a fallback place (arena.h)
+    METRIC_CNT_ARENA_FAILURES,
+    METRIC_CNT_API_REQUESTS,        // Served by the on-device HTTP API
+    METRIC_CNT_MQTT_PUBLISHED,
+    METRIC_CNT_MQTT_DROPPED,        // Queue overflow, or expired unacked in the outbox
+    METRIC_CNT_MQTT_CONNECTS,
+    METRIC_CNT_FLEET_SHARED,        // Results sent to the fleet
+    METRIC_CNT_FLEET_RECEIVED,      // Peer results taken into the cache
+    METRIC_CNT_FLEET_SERVED,        // Fetches answered by a peer result (API calls saved)
+    METRIC_CNT_FLEET_FALLBACKS,     // Leader's result did not arrive, polled directly
+    METRIC_CNT_FLEET_REJECTED,      // Malformed, duplicate, reordered or clock-skewed packets
+    METRIC_CNT_FORECAST_SEED_DROPS, // Live samples dropped from a full seed backlog
+    METRIC_COUNTER_COUNT
+} metric_counter_t;
+
+// Last-value gauges
+typedef enum {
+    METRIC_G_EVENT_QUEUE_DEPTH = 0,
+    METRIC_G_EVENT_QUEUE_PEAK,
+    METRIC_G_HEAP_INTERNAL_FREE,
+    METRIC_G_HEAP_INTERNAL_MIN,     // Low watermark since boot
+    METRIC_G_HEAP_INTERNAL_LARGEST, // Largest free block (fragmentation)
+    METRIC_G_PSRAM_FREE,
+    METRIC_G_PSRAM_MIN,
+    METRIC_G_ARENA_BULK,            // Bytes in use per arena, in arena_id_t order
+    METRIC_G_ARENA_SCRATCH,
+    METRIC_G_ARENA_DMA,
+    METRIC_G_MQTT_QUEUED,           // Samples and events waiting for the broker
+    METRIC_G_FLEET_PEERS,           // Live fleet peers
+    METRIC_GAUGE_COUNT
+} metric_gauge_t;
+
+// Latency histograms (microseconds)
+typedef enum {
+    METRIC_H_HTTP_REQUEST = 0,
+    METRIC_H_BM_PARSE,
+    METRIC_H_HISTORY_APPEND,
+    METRIC_H_HISTORY_LOAD,
+    METRIC_H_SD_OP,
+    METRIC_H_LVGL_LOCK_WAIT,
+    METRIC_H_FETCH_E2E,         // Fetch start to frame on screen (trace.h)
+    METRIC_H_API_REQUEST,       // HTTP API request, first byte to last chunk
+    METRIC_HIST_COUNT
+} metric_hist_t;
+
+// Fixed buckets: <=50us, 100us, 250us ... 2.5s, then overflow
+#define METRICS_HIST_BUCKETS    16
+
+typedef struct {
+    uint32_t count;
+    uint32_t max_us;
+    uint32_t buckets[METRICS_HIST_BUCKETS];
+} metrics_hist_snapshot_t;
+
+typedef struct {
+    uint32_t uptime_s;
+    uint32_t counters[METRIC_COUNTER_COUNT];
+    int32_t gauges[METRIC_GAUGE_COUNT];
+    metrics_hist_snapshot_t hist[METRIC_HIST_COUNT];
+} metrics_snapshot_t;
+
+/**
+ * Initialize metrics (call once at startup, before any recording)
+ */
+void metrics_init(void);
+
+/**
+ * Add to a counter
+ * @param id Counter
+ * @param n Amount
+ */
+void metrics_count_add(metric_counter_t id, uint32_t n);
+
+/**
+ * Increment a counter by one
+ */
+static inline void metrics_count(metric_counter_t id) {
+    metrics_count_add(id, 1);
+}
+
+/**
+ * Set a gauge
+ */
+void metrics_gauge_set(metric_gauge_t id, int32_t value);
+
+/**
+ * Raise a gauge to value if higher (peak tracking)
+ */
+void metrics_gauge_max(metric_gauge_t id, int32_t value);
+
+/**
+ * Record one latency sample
+ * @param id Histogram
+ * @param us Duration in microseconds
+ */
+void metrics_observe_us(metric_hist_t id, uint32_t us);
+
+/**
+ * Record the time elapsed since start_us (esp_timer_get_time() value)
+ */
+void metrics_observe_since(metric_hist_t id, int64_t start_us);
+
+/**
+ * Sum all cores into a consistent-enough copy (counters may move while copying)
+ * @param out Output snapshot
+ */
+void metrics_snapshot(metrics_snapshot_t *out);
+
+/**
+ * Percentile estimate from a histogram snapshot
+ * @param h Histogram snapshot
+ * @param pct Percentile 1-100
+ * @return Upper bound of the bucket holding the percentile (us), 0 if empty,
+ *         max_us for the overflow bucket
+ */
+uint32_t metrics_hist_percentile(const metrics_hist_snapshot_t *h, int pct);
+
+/**
+ * Short names for display and the SD file
+ */
+const char* metrics_counter_name(metric_counter_t id);
+const char* metrics_gauge_name(metric_gauge_t id);
+const char* metrics_hist_name(metric_hist_t id);
+
+/**
+ * Periodic work: heap watermarks every METRICS_SAMPLE_INTERVAL_MS, SD
+ * snapshot every METRICS_DUMP_INTERVAL_SEC. Call from the main loop.
+ */
+void metrics_tick(void);
+
+/**
+ * Append one snapshot line to the metrics file now (rotates when full)
+ * @return true if written
+ */
+bool metrics_dump_to_sd(void);
+
+#endif // METRICS_H
@@ -0,0 +1,606 @@
+/**
+ * DayZ Server Tracker - MQTT Publisher Implementation
+ *
+ * Producers (fetch tasks) and the publisher task share the rings under one
+ * mutex; producers never wait for it more than a few ms. The ring head is
+ * a sequence number, so a batch copied out before publishing is retired
+ * correctly even if producers dropped old samples meanwhile.
+ *
+ * The connection is driven from the publisher task: esp-mqtt's own
+ * reconnect is pushed out to MQTT_BACKOFF_MAX_MS, and on a disconnect the
+ * task stops the client and starts it again after its own backoff. The
+ * QoS 1 outbox survives the stop/start and is retransmitted on connect.
+ */
+
+#include "mqtt_publisher.h"
+#include "config.h"
+#include "app_state.h"
+#include "analytics_cache.h"
+#include "arena.h"
+#include "metrics.h"
+#include "wifi_manager.h"
+#include "mqtt_client.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include "freertos/semphr.h"
+#include <limits.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+static const char *TAG = "mqtt_pub";
+
+#define MQTT_POLL_MS            1000    // Batch age / retry checks while idle
+#define MQTT_CONNECT_TIMEOUT_MS 30000   // Give up on a connect attempt after this
+#define MQTT_PRODUCER_WAIT_MS   20
+#define MQTT_TOPIC_LEN          96
+
+typedef struct {
+    uint32_t ts;
+    int16_t players;
+    int16_t max_players;
+} mqtt_sample_t;
+
+// Newest MQTT_QUEUE_SAMPLES of one server
+typedef struct {
+    mqtt_sample_t *buf;
+    uint32_t head;              // Sequence number of the oldest sample
+    uint32_t count;
+} sample_ring_t;
+
+typedef enum {
+    MQTT_EVENT_TYPE_RESTART = 0,
+} mqtt_event_type_t;
+
+typedef struct {
+    uint32_t ts;
+    uint8_t server_idx;
+    uint8_t type;
+} mqtt_event_rec_t;
+
+typedef enum {
+    LINK_IDLE = 0,              // Stopped, start when retry_at passes
+    LINK_CONNECTING,
+    LINK_CONNECTED,
+} link_state_t;
+
+static SemaphoreHandle_t s_mutex = NULL;
+static TaskHandle_t s_task = NULL;
+static esp_mqtt_client_handle_t s_client = NULL;
+
+static sample_ring_t s_rings[MAX_SERVERS];
+static mqtt_sample_t *s_ring_mem = NULL;
+static mqtt_event_rec_t s_events[MQTT_QUEUE_EVENTS];
+static uint32_t s_event_head = 0;
+static uint32_t s_event_count = 0;
+
+static volatile bool s_running = false;
+static volatile bool s_flush = false;
+static volatile link_state_t s_link = LINK_IDLE;
+static volatile bool s_link_lost = false;   // Set by the event handler
+static TickType_t s_connect_start = 0;
+static TickType_t s_retry_at = 0;
+static uint32_t s_backoff_ms = MQTT_BACKOFF_MIN_MS;
+
+static char s_device[16];
+static char s_status_topic[MQTT_TOPIC_LEN];
+static char s_payload[MQTT_PAYLOAD_SIZE];   // Publisher task only
+
+static const char *s_event_names[] = { "restart" };
+
+// ============== PAYLOAD ==============
+
+typedef struct {
+    char *buf;
+    size_t size;
+    size_t len;
+    bool overflow;
+} payload_t;
+
+static void pl_printf(payload_t *p, const char *fmt, ...) {
+    if (p->overflow) return;
+    va_list ap;
+    va_start(ap, fmt);
+    int n = vsnprintf(p->buf + p->len, p->size - p->len, fmt, ap);
+    va_end(ap);
+    if (n < 0 || (size_t)n >= p->size - p->len) {
+        p->overflow = true;
+        return;
+    }
+    p->len += n;
+}
+
+static void pl_json_str(payload_t *p, const char *s) {
+    pl_printf(p, "\"");
+    for (; *s; s++) {
+        unsigned char c = (unsigned char)*s;
+        if (c == '"' || c == '\\') {
+            pl_printf(p, "\\%c", c);
+        } else if (c >= 0x20) {
+            pl_printf(p, "%c", c);
+        }
+    }
+    pl_printf(p, "\"");
+}
+
+/**
+ * Copy a server's BattleMetrics ID (topic key) and name
+ * @return 1, 0 if the slot is empty, -1 if the state lock timed out
+ */
+static int server_identity(int server_idx, char *id, size_t id_size, char *name, size_t name_size) {
+    app_state_t *state = app_state_get();
+    int found = 0;
+    if (!app_state_lock(1000)) return -1;
+    if (server_idx < state->settings.server_count) {
+        server_config_t *srv = &state->settings.servers[server_idx];
+        snprintf(id, id_size, "%s", srv->server_id);
+        if (name) snprintf(name, name_size, "%s", srv->display_name);
+        found = id[0] != '\0';
+    }
+    app_state_unlock();
+    return found;
+}
+
+static void wake_task(void) {
+    TaskHandle_t task = s_task;
+    if (task) {
+        xTaskNotifyGive(task);
+    }
+}
+
+// ============== QUEUES ==============
+
+static void update_queue_gauge(void) {
+    int32_t queued = (int32_t)s_event_count;
+    for (int i = 0; i < MAX_SERVERS; i++) {
+        queued += (int32_t)s_rings[i].count;
+    }
+    metrics_gauge_set(METRIC_G_MQTT_QUEUED, queued);
+}
+
+void mqtt_publisher_process_sample(int server_idx, uint32_t ts, int players, int max_players) {
+    if (!s_running || server_idx < 0 || server_idx >= MAX_SERVERS || players < 0) return;
+
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(MQTT_PRODUCER_WAIT_MS)) != pdTRUE) {
+        metrics_count(METRIC_CNT_MQTT_DROPPED);
+        return;
+    }
+    sample_ring_t *r = &s_rings[server_idx];
+    if (r->count == MQTT_QUEUE_SAMPLES) {
+        // Offline too long - keep the newest
+        r->head++;
+        r->count--;
+        metrics_count(METRIC_CNT_MQTT_DROPPED);
+    }
+    mqtt_sample_t *s = &r->buf[(r->head + r->count) % MQTT_QUEUE_SAMPLES];
+    s->ts = ts;
+    s->players = (int16_t)players;
+    s->max_players = (int16_t)max_players;
+    r->count++;
+    bool batch_ready = r->count >= MQTT_BATCH_SAMPLES;
+    update_queue_gauge();
+    xSemaphoreGive(s_mutex);
+
+    if (batch_ready) {
+        wake_task();
+    }
+}
+
+void mqtt_publisher_post_restart(int server_idx, uint32_t ts) {
+    if (!s_running || server_idx < 0 || server_idx >= MAX_SERVERS) return;
+
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(MQTT_PRODUCER_WAIT_MS)) != pdTRUE) {
+        metrics_count(METRIC_CNT_MQTT_DROPPED);
+        return;
+    }
+    if (s_event_count == MQTT_QUEUE_EVENTS) {
+        s_event_head++;
+        s_event_count--;
+        metrics_count(METRIC_CNT_MQTT_DROPPED);
+    }
+    mqtt_event_rec_t *e = &s_events[(s_event_head + s_event_count) % MQTT_QUEUE_EVENTS];
+    e->ts = ts;
+    e->server_idx = (uint8_t)server_idx;
+    e->type = MQTT_EVENT_TYPE_RESTART;
+    s_event_count++;
+    update_queue_gauge();
+    xSemaphoreGive(s_mutex);
+
+    wake_task();
+}
+
+void mqtt_publisher_reset_server(int server_idx) {
+    if (!s_running || server_idx < 0 || server_idx >= MAX_SERVERS) return;
+
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    s_rings[server_idx].head += s_rings[server_idx].count;
+    s_rings[server_idx].count = 0;
+    update_queue_gauge();
+    xSemaphoreGive(s_mutex);
+}
+
+/**
+ * Retire up to n entries starting at sequence seq (some may have been
+ * dropped as overflow while they were being published)
+ */
+static void retire(uint32_t *head, uint32_t *count, uint32_t seq, uint32_t n) {
+    uint32_t end = seq + n;
+    if ((int32_t)(end - *head) <= 0) return;
+    uint32_t k = end - *head;
+    if (k > *count) k = *count;
+    *head += k;
+    *count -= k;
+}
+
+// ============== PUBLISHING ==============
+
+static bool outbox_has_room(void) {
+    return esp_mqtt_client_get_outbox_size(s_client) < MQTT_OUTBOX_MAX_BYTES;
+}
+
+static bool publish(const char *topic, const payload_t *p, int qos, int retain) {
+    int msg_id = esp_mqtt_client_publish(s_client, topic, p->buf, (int)p->len, qos, retain);
+    if (msg_id < 0) {
+        ESP_LOGW(TAG, "Publish to %s failed", topic);
+        return false;
+    }
+    metrics_count(METRIC_CNT_MQTT_PUBLISHED);
+    return true;
+}
+
+/**
+ * Send queued events oldest first
+ * @return false if the outbox is full or a publish failed
+ */
+static bool publish_events(void) {
+    char topic[MQTT_TOPIC_LEN];
+    char id[32];
+
+    for (;;) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        bool have = s_event_count > 0;
+        uint32_t seq = s_event_head;
+        mqtt_event_rec_t e = s_events[seq % MQTT_QUEUE_EVENTS];
+        xSemaphoreGive(s_mutex);
+        if (!have) return true;
+        if (!outbox_has_room()) return false;
+
+        int found = server_identity(e.server_idx, id, sizeof(id), NULL, 0);
+        if (found < 0) return false;
+        if (found) {
+            payload_t p = { .buf = s_payload, .size = sizeof(s_payload) };
+            pl_printf(&p, "{\"t\":%lu,\"type\":\"%s\"}", (unsigned long)e.ts,
+                      s_event_names[e.type]);
+            snprintf(topic, sizeof(topic), "%s/%s/%s/event", MQTT_TOPIC_PREFIX, s_device, id);
+            if (!publish(topic, &p, 1, 0)) return false;
+        }
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        retire(&s_event_head, &s_event_count, seq, 1);
+        update_queue_gauge();
+        xSemaphoreGive(s_mutex);
+    }
+}
+
+/**
+ * Latest analytics summary for a server (retained, QoS 0)
+ */
+static void publish_trend(int server_idx, const char *id, const char *name) {
+    analytics_summary_t a;
+    if (!analytics_cache_get(server_idx, &a)) return;
+
+    payload_t p = { .buf = s_payload, .size = sizeof(s_payload) };
+    pl_printf(&p, "{\"name\":");
+    pl_json_str(&p, name);
+    pl_printf(&p, ",\"t\":%lu,\"online\":%s,\"players\":%d,\"max\":%d",
+              (unsigned long)a.updated_ts, a.online ? "true" : "false",
+              a.players, a.max_players);
+    if (a.has_trend) {
+        pl_printf(&p, ",\"trend_2h\":%d", a.trend_2h);
+    }
+    if (a.has_peak) {
+        pl_printf(&p, ",\"peak\":%d,\"peak_t\":%lu", a.peak_players, (unsigned long)a.peak_ts);
+    }
+    if (a.next_restart_ts) {
+        pl_printf(&p, ",\"next_restart\":%lu,\"restart_confidence\":%u",
+                  (unsigned long)a.next_restart_ts, a.restart_confidence);
+    }
+    pl_printf(&p, "}");
+    if (p.overflow) return;
+
+    char topic[MQTT_TOPIC_LEN];
+    snprintf(topic, sizeof(topic), "%s/%s/%s/trend", MQTT_TOPIC_PREFIX, s_device, id);
+    publish(topic, &p, 0, 1);
+}
+
+/**
+ * Send full batches of a server, and the partial one if it is old enough
+ * @return false if the outbox is full or a publish failed
+ */
+static bool publish_samples(int server_idx, bool force) {
+    mqtt_sample_t batch[MQTT_BATCH_SAMPLES];
+    char topic[MQTT_TOPIC_LEN];
+    char id[32];
+    char name[64];
+    bool sent = false;
+    bool ok = true;
+
+    int found = server_identity(server_idx, id, sizeof(id), name, sizeof(name));
+    if (found < 0) return false;
+    if (!found) {
+        // Slot emptied - nothing to attribute these to
+        mqtt_publisher_reset_server(server_idx);
+        return true;
+    }
+    snprintf(topic, sizeof(topic), "%s/%s/%s/samples", MQTT_TOPIC_PREFIX, s_device, id);
+
+    sample_ring_t *r = &s_rings[server_idx];
+    for (;;) {
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        uint32_t seq = r->head;
+        uint32_t n = r->count < MQTT_BATCH_SAMPLES ? r->count : MQTT_BATCH_SAMPLES;
+        for (uint32_t i = 0; i < n; i++) {
+            batch[i] = r->buf[(seq + i) % MQTT_QUEUE_SAMPLES];
+        }
+        xSemaphoreGive(s_mutex);
+
+        if (n == 0) break;
+        if (n < MQTT_BATCH_SAMPLES && !force &&
+            (uint32_t)time(NULL) - batch[0].ts < MQTT_BATCH_MAX_AGE_SEC) {
+            break;
+        }
+        if (!outbox_has_room()) {
+            ok = false;
+            break;
+        }
+
+        payload_t p = { .buf = s_payload, .size = sizeof(s_payload) };
+        pl_printf(&p, "{\"s\":[");
+        for (uint32_t i = 0; i < n; i++) {
+            pl_printf(&p, "%s[%lu,%d,%d]", i ? "," : "", (unsigned long)batch[i].ts,
+                      batch[i].players, batch[i].max_players);
+        }
+        pl_printf(&p, "]}");
+        if (!p.overflow && !publish(topic, &p, 1, 0)) {
+            ok = false;
+            break;
+        }
+
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        retire(&r->head, &r->count, seq, n);
+        update_queue_gauge();
+        xSemaphoreGive(s_mutex);
+        sent = true;
+    }
+
+    if (sent) {
+        publish_trend(server_idx, id, name);
+    }
+    return ok;
+}
+
+static bool queues_empty(void) {
+    bool empty = true;
+    xSemaphoreTake(s_mutex, portMAX_DELAY);
+    empty = s_event_count == 0;
+    for (int i = 0; i < MAX_SERVERS && empty; i++) {
+        empty = s_rings[i].count == 0;
+    }
+    xSemaphoreGive(s_mutex);
+    return empty;
+}
+
+// ============== CONNECTION ==============
+
+static void mqtt_event_handler(void *arg, esp_event_base_t base, int32_t event_id, void *event_data) {
+    switch ((esp_mqtt_event_id_t)event_id) {
+        case MQTT_EVENT_CONNECTED:
+            s_link = LINK_CONNECTED;
+            s_backoff_ms = MQTT_BACKOFF_MIN_MS;
+            esp_mqtt_client_publish(s_client, s_status_topic, "online", 0, 1, 1);
+            metrics_count(METRIC_CNT_MQTT_CONNECTS);
+            ESP_LOGI(TAG, "Connected as %s", s_device);
+            break;
+        case MQTT_EVENT_DISCONNECTED:
+            if (s_link != LINK_IDLE) {
+                s_link_lost = true;
+            }
+            break;
+        case MQTT_EVENT_DELETED:
+            // QoS 1 message expired in the outbox without an ack
+            metrics_count(METRIC_CNT_MQTT_DROPPED);
+            break;
+        default:
+            break;
+    }
+    wake_task();
+}
+
+/**
+ * Stop the client and schedule the next attempt with jittered backoff
+ */
+static void link_backoff(void) {
+    esp_mqtt_client_stop(s_client);
+    s_link = LINK_IDLE;
+    s_link_lost = false;
+
+    // Half fixed, half spread so a building full of trackers doesn't reconnect in step
+    uint32_t jitter = (uint32_t)esp_timer_get_time() % (s_backoff_ms / 2 + 1);
+    uint32_t delay_ms = s_backoff_ms / 2 + jitter;
+    s_retry_at = xTaskGetTickCount() + pdMS_TO_TICKS(delay_ms);
+    ESP_LOGW(TAG, "Broker connection lost, retry in %lu ms", (unsigned long)delay_ms);
+
+    s_backoff_ms = s_backoff_ms * 2 > MQTT_BACKOFF_MAX_MS ? MQTT_BACKOFF_MAX_MS : s_backoff_ms * 2;
+}
+
+static void link_service(void) {
+    TickType_t now = xTaskGetTickCount();
+    bool timed_out = s_link == LINK_CONNECTING &&
+                     now - s_connect_start > pdMS_TO_TICKS(MQTT_CONNECT_TIMEOUT_MS);
+
+    // A connect that completed just now wins over the timeout
+    if (s_link_lost || (timed_out && s_link != LINK_CONNECTED)) {
+        link_backoff();
+        return;
+    }
+    if (s_link == LINK_IDLE && (int32_t)(now - s_retry_at) >= 0 && wifi_manager_is_connected()) {
+        s_link = LINK_CONNECTING;
+        s_connect_start = now;
+        if (esp_mqtt_client_start(s_client) != ESP_OK) {
+            s_link_lost = true;
+        }
+    }
+}
+
+static void mqtt_task(void *arg) {
+    ESP_LOGI(TAG, "Publisher task started");
+
+    while (s_running) {
+        xTaskNotifyWait(0, ULONG_MAX, NULL, pdMS_TO_TICKS(MQTT_POLL_MS));
+        if (!s_running) break;
+
+        link_service();
+        if (s_link != LINK_CONNECTED) continue;
+
+        bool force = s_flush;
+        if (!publish_events()) continue;
+        for (int i = 0; i < MAX_SERVERS; i++) {
+            if (!publish_samples(i, force)) break;
+        }
+    }
+
+    s_task = NULL;
+    vTaskDelete(NULL);
+}
+
+// ============== LIFECYCLE ==============
+
+esp_err_t mqtt_publisher_start(const char *uri) {
+    if (s_running) return ESP_OK;
+    if (!uri) uri = MQTT_BROKER_URI;
+    if (uri[0] == '\0') {
+        ESP_LOGI(TAG, "No broker configured, MQTT off");
+        return ESP_ERR_NOT_SUPPORTED;
+    }
+
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) return ESP_ERR_NO_MEM;
+    }
+    if (!s_ring_mem) {
+        s_ring_mem = arena_calloc(ARENA_BULK, (size_t)MAX_SERVERS * MQTT_QUEUE_SAMPLES,
+                                  sizeof(mqtt_sample_t), "mqtt_queue");
+        if (!s_ring_mem) return ESP_ERR_NO_MEM;
+    }
+    memset(s_rings, 0, sizeof(s_rings));
+    for (int i = 0; i < MAX_SERVERS; i++) {
+        s_rings[i].buf = s_ring_mem + (size_t)i * MQTT_QUEUE_SAMPLES;
+    }
+    s_event_head = 0;
+    s_event_count = 0;
+
+    // Device name from the MAC, stable across reboots and unique per board
+    char mac[18] = "";
+    wifi_manager_get_mac_str(mac, sizeof(mac));
+    size_t mlen = strlen(mac);
+    if (mlen >= 8) {
+        snprintf(s_device, sizeof(s_device), "dzt-%c%c%c%c%c%c", mac[mlen - 8], mac[mlen - 7],
+                 mac[mlen - 5], mac[mlen - 4], mac[mlen - 2], mac[mlen - 1]);
+    } else {
+        snprintf(s_device, sizeof(s_device), "dzt-000000");
+    }
+    for (char *c = s_device; *c; c++) {
+        if (*c >= 'A' && *c <= 'F') *c += 'a' - 'A';
+    }
+    snprintf(s_status_topic, sizeof(s_status_topic), "%s/%s/status", MQTT_TOPIC_PREFIX, s_device);
+
+    esp_mqtt_client_config_t cfg = {
+        .broker.address.uri = uri,
+        .credentials.client_id = s_device,
+        .session = {
+            .keepalive = MQTT_KEEPALIVE_SEC,
+            .last_will = {
+                .topic = s_status_topic,
+                .msg = "offline",
+                .qos = 1,
+                .retain = 1,
+            },
+        },
+        // The task reconnects with its own backoff; this is only a fallback
+        .network.reconnect_timeout_ms = MQTT_BACKOFF_MAX_MS,
+        .task = {
+            .priority = MQTT_TASK_PRIORITY,
+            .stack_size = MQTT_TASK_STACK,
+        },
+        .buffer.size = MQTT_PAYLOAD_SIZE + MQTT_TOPIC_LEN + 16,
+    };
+    s_client = esp_mqtt_client_init(&cfg);
+    if (!s_client) return ESP_ERR_NO_MEM;
+    esp_mqtt_client_register_event(s_client, MQTT_EVENT_ANY, mqtt_event_handler, NULL);
+
+    s_link = LINK_IDLE;
+    s_link_lost = false;
+    s_flush = false;
+    s_backoff_ms = MQTT_BACKOFF_MIN_MS;
+    s_retry_at = xTaskGetTickCount();
+    s_running = true;
+
+    if (xTaskCreate(mqtt_task, "mqtt_pub", MQTT_TASK_STACK, NULL,
+                    MQTT_TASK_PRIORITY, &s_task) != pdPASS) {
+        s_running = false;
+        esp_mqtt_client_destroy(s_client);
+        s_client = NULL;
+        return ESP_ERR_NO_MEM;
+    }
+
+    ESP_LOGI(TAG, "Publishing to %s as %s/%s", uri, MQTT_TOPIC_PREFIX, s_device);
+    return ESP_OK;
+}
+
+void mqtt_publisher_stop(void) {
+    if (!s_running) return;
+
+    s_running = false;
+    wake_task();
+    while (s_task) {
+        vTaskDelay(pdMS_TO_TICKS(10));
+    }
+
+    if (s_link == LINK_CONNECTED) {
+        esp_mqtt_client_publish(s_client, s_status_topic, "offline", 0, 1, 1);
+    }
+    esp_mqtt_client_stop(s_client);
+    esp_mqtt_client_destroy(s_client);
+    s_client = NULL;
+    s_link = LINK_IDLE;
+    ESP_LOGI(TAG, "Publisher stopped");
+}
+
+bool mqtt_publisher_flush(uint32_t timeout_ms) {
+    if (!s_running) return true;
+
+    TickType_t deadline = xTaskGetTickCount() + pdMS_TO_TICKS(timeout_ms);
+    bool done = false;
+    s_flush = true;
+    while (!done) {
+        // Retry at the shortest interval rather than sit out a long backoff
+        TickType_t soon = xTaskGetTickCount() + pdMS_TO_TICKS(MQTT_BACKOFF_MIN_MS);
+        if (s_link == LINK_IDLE && (int32_t)(s_retry_at - soon) > 0) {
+            s_retry_at = soon;
+        }
+        wake_task();
+        vTaskDelay(pdMS_TO_TICKS(50));
+        done = s_link == LINK_CONNECTED && queues_empty() &&
+               esp_mqtt_client_get_outbox_size(s_client) == 0;
+        if ((int32_t)(xTaskGetTickCount() - deadline) >= 0) break;
+    }
+    s_flush = false;
+    return done;
+}
+
+bool mqtt_publisher_is_connected(void) {
+    return s_link == LINK_CONNECTED;
+}
@@ -0,0 +1,85 @@
+/**
+ * DayZ Server Tracker - MQTT Publisher
+ * Per-server samples, trend and restart events to a local broker
+ *
+ * Topics (<device> is "dzt-" plus the last 3 bytes of the WiFi MAC):
+ *   <prefix>/<device>/status              "online" / "offline" (retained,
+ *                                         offline is also the last will)
+ *   <prefix>/<device>/<server_id>/samples QoS 1, batched:
+ *                                         {"s":[[t,players,max],...]}
+ *   <prefix>/<device>/<server_id>/trend   QoS 0 retained, analytics summary
+ *                                         after each batch (latest wins)
+ *   <prefix>/<device>/<server_id>/event   QoS 1, {"t":ts,"type":"restart"}
+ *
+ * The fetch tasks only append to bounded per-server rings in PSRAM and
+ * wake the publisher task, which batches MQTT_BATCH_SAMPLES per message
+ * (or sends what it has once the oldest sample is MQTT_BATCH_MAX_AGE_SEC
+ * old). While the broker is unreachable the rings keep the newest
+ * MQTT_QUEUE_SAMPLES per server and drop the oldest. Samples leave the
+ * ring once esp-mqtt holds them in its QoS 1 outbox, which retransmits
+ * across reconnects; new batches wait while the outbox is above
+ * MQTT_OUTBOX_MAX_BYTES. Reconnects back off exponentially with jitter
+ * from MQTT_BACKOFF_MIN_MS to MQTT_BACKOFF_MAX_MS.
+ *
+ * Watch it from a dev machine with:
+ *   mosquitto_sub -h <broker> -t 'dayz/#' -v
+ */
+
+#ifndef MQTT_PUBLISHER_H
+#define MQTT_PUBLISHER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "esp_err.h"
+
+/**
+ * Start the publisher (no-op if already running)
+ * Safe to call before WiFi connects - it waits for the link.
+ * @param uri Broker URI, NULL for MQTT_BROKER_URI; empty leaves MQTT off
+ * @return ESP_OK, ESP_ERR_NOT_SUPPORTED if no broker is configured,
+ *         ESP_ERR_NO_MEM
+ */
+esp_err_t mqtt_publisher_start(const char *uri);
+
+/**
+ * Stop the publisher (publishes "offline", queued samples are discarded)
+ */
+void mqtt_publisher_stop(void);
+
+/**
+ * Queue a sample for a server (never blocks on the network)
+ * @param server_idx Index into settings.servers
+ * @param ts Unix timestamp
+ * @param players Current player count
+ * @param max_players Current server capacity
+ */
+void mqtt_publisher_process_sample(int server_idx, uint32_t ts, int players, int max_players);
+
+/**
+ * Queue a restart event for a server
+ * @param server_idx Index into settings.servers
+ * @param ts Unix timestamp of the restart
+ */
+void mqtt_publisher_post_restart(int server_idx, uint32_t ts);
+
+/**
+ * Drop a server's queued samples
+ * Call when a server slot is reassigned
+ * @param server_idx Index into settings.servers
+ */
+void mqtt_publisher_reset_server(int server_idx);
+
+/**
+ * Send partial batches now and wait until the broker has acknowledged
+ * everything queued
+ * @param timeout_ms Longest wait
+ * @return true if nothing is left queued or unacknowledged
+ */
+bool mqtt_publisher_flush(uint32_t timeout_ms);
+
+/**
+ * Check whether the broker connection is up
+ */
+bool mqtt_publisher_is_connected(void);
+
+#endif // MQTT_PUBLISHER_H
@@ -20,17 +20,19 @@
 #define NVS_SUFFIX_ALERT    "alert"     // Alert threshold
 #define NVS_SUFFIX_ALEN     "alen"      // Alerts enabled
 #define NVS_SUFFIX_RCNT     "rcnt"      // Restart count
-#define NVS_SUFFIX_RAVG     "ravg"      // Restart avg interval
+#define NVS_SUFFIX_RHEAD    "rhead"     // Restart ring buffer head
 #define NVS_SUFFIX_RLAST    "rlast"     // Last restart time
 #define NVS_SUFFIX_RTIMES   "rtimes"    // Restart times blob
 #define NVS_SUFFIX_RHR      "rhr"       // Restart hour
 #define NVS_SUFFIX_RMIN     "rmin"      // Restart minute
 #define NVS_SUFFIX_RINT     "rint"      // Restart interval hours
 #define NVS_SUFFIX_RMAN     "rman"      // Manual restart set
+#define NVS_SUFFIX_RAVG     "ravg"      // Legacy restart avg interval (erased on save)
 
 // History keys
 #define NVS_SUFFIX_META     "meta"      // History metadata
-#define NVS_SUFFIX_DATA     "data"      // History data blob
+#define NVS_SUFFIX_DATA     "data"      // Legacy history entry blob (migrated)
+#define NVS_SUFFIX_PACK     "pack"      // Packed history blob
 
 /**
  * Generate a server-specific NVS key
@@ -0,0 +1,301 @@
+/**
+ * DayZ Server Tracker - Task Profiler Implementation
+ *
+ * CPU load is the change in each task's run-time counter between two
+ * samples over the change in total run time, so the first sample only
+ * primes the counters. Sampling and summaries run on the main loop.
+ */
+
+#include "profiler.h"
+#include "config.h"
+#include "arena.h"
+#include "storage_backend.h"
+#include "storage_config.h"
+#include "storage_paths.h"
+#include "drivers/sd_card.h"
+#include "sdkconfig.h"
+#include "esp_log.h"
+#include "esp_timer.h"
+#include "esp_heap_caps.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#if CONFIG_HEAP_TASK_TRACKING
+#include "esp_heap_task_info.h"
+#endif
+
+static const char *TAG = "profiler";
+
+#if CONFIG_FREERTOS_USE_TRACE_FACILITY && CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS
+#define PROFILER_SUPPORTED  1
+#else
+#define PROFILER_SUPPORTED  0
+#endif
+
+typedef struct {
+    uint32_t task_number;           // xTaskNumber - unique per task lifetime
+    char name[PROFILER_TASK_NAME_LEN];
+    uint8_t priority;
+    uint16_t cpu_permille;
+    uint32_t stack_free;
+    int32_t heap_internal;
+    int32_t heap_psram;
+} task_sample_t;
+
+typedef struct {
+    uint32_t uptime_s;
+    uint8_t count;
+    task_sample_t tasks[PROFILER_MAX_TASKS];
+} window_sample_t;
+
+static window_sample_t *s_window = NULL;    // PSRAM ring, PROFILER_WINDOW_SAMPLES
+static int s_head = 0;
+static int s_count = 0;
+
+#if PROFILER_SUPPORTED
+static int64_t s_last_sample_us = 0;
+static int64_t s_last_log_us = 0;
+
+static TaskStatus_t s_status[PROFILER_MAX_TASKS];
+
+// Run-time counters from the previous sample, by task number
+static struct {
+    uint32_t task_number;
+    configRUN_TIME_COUNTER_TYPE runtime;
+} s_prev[PROFILER_MAX_TASKS];
+static int s_prev_count = 0;
+static configRUN_TIME_COUNTER_TYPE s_prev_total = 0;
+static bool s_overflow_warned = false;
+#endif
+
+#if PROFILER_SUPPORTED && CONFIG_HEAP_TASK_TRACKING
+static heap_task_totals_t s_heap_totals[PROFILER_MAX_TASKS];
+
+static void sample_task_heap(window_sample_t *w) {
+    size_t num_totals = 0;
+    heap_task_info_params_t params = {0};
+    params.caps[0] = MALLOC_CAP_INTERNAL;
+    params.mask[0] = MALLOC_CAP_INTERNAL;
+    params.caps[1] = MALLOC_CAP_SPIRAM;
+    params.mask[1] = MALLOC_CAP_SPIRAM;
+    params.totals = s_heap_totals;
+    params.num_totals = &num_totals;
+    params.max_totals = PROFILER_MAX_TASKS;
+    heap_caps_get_per_task_info(&params);
+
+    for (int i = 0; i < w->count; i++) {
+        w->tasks[i].heap_internal = 0;
+        w->tasks[i].heap_psram = 0;
+        for (size_t j = 0; j < num_totals; j++) {
+            if (s_heap_totals[j].task == s_status[i].xHandle) {
+                w->tasks[i].heap_internal = (int32_t)s_heap_totals[j].size[0];
+                w->tasks[i].heap_psram = (int32_t)s_heap_totals[j].size[1];
+                break;
+            }
+        }
+    }
+}
+#endif
+
+#if PROFILER_SUPPORTED
+static void take_sample(void) {
+    configRUN_TIME_COUNTER_TYPE total = 0;
+    UBaseType_t n = uxTaskGetSystemState(s_status, PROFILER_MAX_TASKS, &total);
+    if (n == 0) {
+        // Array too small - FreeRTOS fills nothing rather than truncating
+        if (!s_overflow_warned) {
+            ESP_LOGW(TAG, "More than %d tasks, raise PROFILER_MAX_TASKS", PROFILER_MAX_TASKS);
+            s_overflow_warned = true;
+        }
+        return;
+    }
+
+    configRUN_TIME_COUNTER_TYPE total_delta = total - s_prev_total;
+    bool have_prev = s_prev_count > 0 && total_delta > 0;
+
+    window_sample_t *w = &s_window[s_head];
+    w->uptime_s = (uint32_t)(esp_timer_get_time() / 1000000);
+    w->count = (uint8_t)n;
+
+    for (int i = 0; i < (int)n; i++) {
+        const TaskStatus_t *st = &s_status[i];
+        task_sample_t *t = &w->tasks[i];
+
+        t->task_number = st->xTaskNumber;
+        strncpy(t->name, st->pcTaskName, sizeof(t->name) - 1);
+        t->name[sizeof(t->name) - 1] = '\0';
+        t->priority = (uint8_t)st->uxCurrentPriority;
+        t->stack_free = st->usStackHighWaterMark;   // Bytes on ESP-IDF
+        t->heap_internal = -1;
+        t->heap_psram = -1;
+        t->cpu_permille = 0;
+
+        for (int p = 0; have_prev && p < s_prev_count; p++) {
+            if (s_prev[p].task_number == st->xTaskNumber) {
+                uint64_t delta = (configRUN_TIME_COUNTER_TYPE)(st->ulRunTimeCounter - s_prev[p].runtime);
+                uint64_t pm = delta * 1000 / total_delta;
+                t->cpu_permille = (uint16_t)(pm > 1000 ? 1000 : pm);
+                break;
+            }
+        }
+    }
+
+#if CONFIG_HEAP_TASK_TRACKING
+    sample_task_heap(w);
+#endif
+
+    for (int i = 0; i < (int)n; i++) {
+        s_prev[i].task_number = s_status[i].xTaskNumber;
+        s_prev[i].runtime = s_status[i].ulRunTimeCounter;
+    }
+    s_prev_count = (int)n;
+    s_prev_total = total;
+
+    // The priming sample has no CPU figures - keep it out of the window
+    if (!have_prev) return;
+
+    s_head = (s_head + 1) % PROFILER_WINDOW_SAMPLES;
+    if (s_count < PROFILER_WINDOW_SAMPLES) s_count++;
+}
+#endif
+
+void profiler_init(void) {
+#if PROFILER_SUPPORTED
+    s_window = arena_calloc(ARENA_BULK, PROFILER_WINDOW_SAMPLES, sizeof(window_sample_t), "profiler");
+    if (!s_window) {
+        ESP_LOGW(TAG, "No PSRAM for the sample window, profiler disabled");
+        return;
+    }
+    s_head = 0;
+    s_count = 0;
+    s_last_log_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Task profiler initialized (%d samples, %d bytes PSRAM)",
+             PROFILER_WINDOW_SAMPLES, (int)(PROFILER_WINDOW_SAMPLES * sizeof(window_sample_t)));
+#else
+    ESP_LOGI(TAG, "Task profiler disabled (needs CONFIG_FREERTOS_GENERATE_RUN_TIME_STATS)");
+#endif
+}
+
+bool profiler_is_enabled(void) {
+    return s_window != NULL;
+}
+
+static int cmp_cpu_desc(const void *a, const void *b) {
+    const profiler_task_summary_t *ta = a;
+    const profiler_task_summary_t *tb = b;
+    return (int)tb->cpu_avg_permille - (int)ta->cpu_avg_permille;
+}
+
+int profiler_get_summary(profiler_task_summary_t *out, int max, uint32_t *window_sec) {
+    if (window_sec) *window_sec = 0;
+    if (!s_window || s_count == 0 || !out || max <= 0) return 0;
+
+    static profiler_task_summary_t all[PROFILER_MAX_TASKS];
+    int newest = (s_head - 1 + PROFILER_WINDOW_SAMPLES) % PROFILER_WINDOW_SAMPLES;
+    int oldest = (s_head - s_count + PROFILER_WINDOW_SAMPLES) % PROFILER_WINDOW_SAMPLES;
+    const window_sample_t *latest = &s_window[newest];
+
+    // Tasks alive in the newest sample, aggregated over every sample they appear in
+    for (int i = 0; i < latest->count; i++) {
+        const task_sample_t *t = &latest->tasks[i];
+        profiler_task_summary_t *sum = &all[i];
+
+        memcpy(sum->name, t->name, sizeof(sum->name));
+        sum->priority = t->priority;
+        sum->heap_internal = t->heap_internal;
+        sum->heap_psram = t->heap_psram;
+        sum->stack_free_min = t->stack_free;
+        sum->cpu_peak_permille = 0;
+
+        uint32_t cpu_total = 0;
+        int seen = 0;
+        for (int k = 0; k < s_count; k++) {
+            const window_sample_t *w = &s_window[(oldest + k) % PROFILER_WINDOW_SAMPLES];
+            for (int j = 0; j < w->count; j++) {
+                const task_sample_t *ws = &w->tasks[j];
+                if (ws->task_number != t->task_number) continue;
+                cpu_total += ws->cpu_permille;
+                seen++;
+                if (ws->cpu_permille > sum->cpu_peak_permille) sum->cpu_peak_permille = ws->cpu_permille;
+                if (ws->stack_free < sum->stack_free_min) sum->stack_free_min = ws->stack_free;
+                break;
+            }
+        }
+        sum->cpu_avg_permille = seen ? (uint16_t)(cpu_total / seen) : 0;
+    }
+
+    qsort(all, latest->count, sizeof(all[0]), cmp_cpu_desc);
+
+    int n = latest->count < max ? latest->count : max;
+    memcpy(out, all, n * sizeof(out[0]));
+
+    if (window_sec) {
+        *window_sec = latest->uptime_s - s_window[oldest].uptime_s + PROFILER_SAMPLE_INTERVAL_SEC;
+    }
+    return n;
+}
+
+#if PROFILER_SUPPORTED
+static void log_summary_to_sd(void) {
+    if (!sd_card_is_mounted()) return;
+
+    // Main loop only - keep these off its stack
+    static profiler_task_summary_t tasks[PROFILER_MAX_TASKS];
+    static char line[2048];
+
+    uint32_t window_sec = 0;
+    int n = profiler_get_summary(tasks, PROFILER_MAX_TASKS, &window_sec);
+    if (n == 0) return;
+
+    time_t now;
+    time(&now);
+    int len = snprintf(line, sizeof(line), "{\"up\":%lu,\"t\":%lu,\"win\":%lu,\"tasks\":[",
+                       (unsigned long)(esp_timer_get_time() / 1000000),
+                       (unsigned long)(now >= STORAGE_TIMESTAMP_MIN_VALID ? now : 0),
+                       (unsigned long)window_sec);
+
+    // [name, priority, cpu avg, cpu peak, stack free min, heap internal, heap psram]
+    for (int i = 0; i < n && len < (int)sizeof(line); i++) {
+        const profiler_task_summary_t *t = &tasks[i];
+        len += snprintf(line + len, sizeof(line) - len, "%s[\"%s\",%u,%u,%u,%lu,%ld,%ld]",
+                        i ? "," : "", t->name, t->priority, t->cpu_avg_permille,
+                        t->cpu_peak_permille, (unsigned long)t->stack_free_min,
+                        (long)t->heap_internal, (long)t->heap_psram);
+    }
+    if (len < (int)sizeof(line)) {
+        len += snprintf(line + len, sizeof(line) - len, "]}");
+    }
+    if (len >= (int)sizeof(line)) {
+        ESP_LOGW(TAG, "Summary line truncated");
+        return;
+    }
+
+    char path[STORAGE_PATH_MAX_LEN];
+    char old_path[STORAGE_PATH_MAX_LEN];
+    storage_path_profile(path, sizeof(path));
+    storage_path_profile_old(old_path, sizeof(old_path));
+    storage_rotate(path, old_path, PROFILER_FILE_MAX_BYTES);
+    storage_append_line(path, line);
+}
+#endif
+
+void profiler_tick(void) {
+#if PROFILER_SUPPORTED
+    if (!s_window) return;
+
+    int64_t now = esp_timer_get_time();
+
+    if (now - s_last_sample_us >= (int64_t)PROFILER_SAMPLE_INTERVAL_SEC * 1000000) {
+        s_last_sample_us = now;
+        take_sample();
+    }
+
+    if (now - s_last_log_us >= (int64_t)PROFILER_LOG_INTERVAL_SEC * 1000000) {
+        s_last_log_us = now;
+        log_summary_to_sd();
+    }
+#endif
+}
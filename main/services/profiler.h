@@ -0,0 +1,56 @@
+/**
+ * DayZ Server Tracker - Task Profiler
+ * Per-task CPU load, stack high-water mark and heap usage
+ *
+ * profiler_tick() from the main loop samples FreeRTOS task stats every
+ * PROFILER_SAMPLE_INTERVAL_SEC into a rolling window in PSRAM. Summaries
+ * over the window feed the hidden Tasks screen (long-press the
+ * Diagnostics title) and a periodic line in /sdcard/profile.jsonl.
+ */
+
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PROFILER_TASK_NAME_LEN  16
+
+// Per-task summary over the rolling window
+typedef struct {
+    char name[PROFILER_TASK_NAME_LEN];
+    uint8_t priority;
+    uint16_t cpu_avg_permille;      // 1000 = one core fully busy
+    uint16_t cpu_peak_permille;     // Busiest single interval
+    uint32_t stack_free_min;        // Lowest stack headroom seen (bytes)
+    int32_t heap_internal;          // Bytes held now, -1 if not tracked
+    int32_t heap_psram;             // Bytes held now, -1 if not tracked
+} profiler_task_summary_t;
+
+/**
+ * Allocate the sample window (PSRAM). Without runtime stats support in
+ * sdkconfig the profiler stays disabled and summaries are empty.
+ */
+void profiler_init(void);
+
+/**
+ * @return true if sampling is available and the window was allocated
+ */
+bool profiler_is_enabled(void);
+
+/**
+ * Periodic work: sample every PROFILER_SAMPLE_INTERVAL_SEC, SD summary
+ * every PROFILER_LOG_INTERVAL_SEC. Call from the main loop.
+ */
+void profiler_tick(void);
+
+/**
+ * Summarize the window, busiest task first
+ * @param out Output array
+ * @param max Capacity of out
+ * @param window_sec Output: time span covered (may be NULL)
+ * @return Number of tasks written
+ */
+int profiler_get_summary(profiler_task_summary_t *out, int max, uint32_t *window_sec);
+
+#endif // PROFILER_H
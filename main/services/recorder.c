@@ -0,0 +1,449 @@
+/**
+ * DayZ Server Tracker - Field Recorder Implementation
+ *
+ * Callers are the fetch tasks, the LVGL task and the WiFi event task, so
+ * records are encoded straight into a shared RAM buffer under a mutex
+ * and only reach the SD card from recorder_tick() (or when the buffer
+ * fills up, or the day rolls over).
+ */
+
+#include "recorder.h"
+#include "app_state.h"
+#include "storage_backend.h"
+#include "storage_config.h"
+#include "storage_paths.h"
+#include "time_util.h"
+#include "drivers/sd_card.h"
+#include "esp_log.h"
+#include "esp_attr.h"
+#include "esp_timer.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <dirent.h>
+#include <string.h>
+#include <time.h>
+#include <sys/time.h>
+
+static const char *TAG = "recorder";
+
+#define RECORD_HEADER_SIZE  8
+#define FILE_HEADER_SIZE    12
+#define RECORD_MAX_PAYLOAD  255
+
+static SemaphoreHandle_t s_mutex = NULL;
+static bool s_recording = false;
+static EXT_RAM_BSS_ATTR uint8_t s_buf[RECORDER_BUFFER_SIZE];   // PSRAM .bss
+static size_t s_len = 0;
+static char s_date[STORAGE_DATE_STR_LEN] = "";     // Day the buffered records belong to
+static uint32_t s_config_sig = 0;                   // Server list last written, 0 = none yet
+static int64_t s_last_flush_us = 0;
+static bool s_cleanup_pending = false;
+
+// ============== ENCODING ==============
+
+typedef struct {
+    uint8_t data[RECORD_MAX_PAYLOAD];
+    size_t len;
+    bool overflow;
+} payload_t;
+
+static void put_bytes(payload_t *p, const void *src, size_t n) {
+    if (p->len + n > sizeof(p->data)) {
+        p->overflow = true;
+        return;
+    }
+    memcpy(p->data + p->len, src, n);
+    p->len += n;
+}
+
+static void put_u8(payload_t *p, uint8_t v) {
+    put_bytes(p, &v, 1);
+}
+
+static void put_u16(payload_t *p, uint16_t v) {
+    uint8_t b[2] = { (uint8_t)v, (uint8_t)(v >> 8) };
+    put_bytes(p, b, 2);
+}
+
+static void put_u32(payload_t *p, uint32_t v) {
+    uint8_t b[4] = { (uint8_t)v, (uint8_t)(v >> 8), (uint8_t)(v >> 16), (uint8_t)(v >> 24) };
+    put_bytes(p, b, 4);
+}
+
+static void put_str(payload_t *p, const char *s) {
+    size_t n = s ? strlen(s) : 0;
+    if (n > 255) n = 255;
+    put_u8(p, (uint8_t)n);
+    put_bytes(p, s, n);
+}
+
+static uint32_t config_signature(const app_state_t *state) {
+    // FNV-1a over what a replay needs to rebuild the server list
+    uint32_t h = 2166136261u;
+    uint8_t count = state->settings.server_count;
+    uint8_t active = state->settings.active_server_index;
+    h = (h ^ count) * 16777619u;
+    h = (h ^ active) * 16777619u;
+    for (int i = 0; i < count && i < MAX_SERVERS; i++) {
+        const char *id = state->settings.servers[i].server_id;
+        for (size_t k = 0; k < sizeof(state->settings.servers[i].server_id) && id[k]; k++) {
+            h = (h ^ (uint8_t)id[k]) * 16777619u;
+        }
+        h = (h ^ 0xFF) * 16777619u;
+    }
+    return h ? h : 1;
+}
+
+// ============== BUFFER / FILE (mutex held) ==============
+
+static void flush_locked(void) {
+    if (s_len == 0 || s_date[0] == '\0') return;
+    if (!sd_card_is_mounted() || !sd_card_lease()) {
+        s_len = 0;
+        return;
+    }
+
+    char path[STORAGE_PATH_MAX_LEN];
+    storage_path_replay(s_date, path, sizeof(path));
+
+    if (!storage_file_exists(path)) {
+        char dir[STORAGE_PATH_MAX_LEN];
+        storage_path_replay_dir(dir, sizeof(dir));
+        storage_mkdir_p(dir);
+
+        payload_t hdr = {0};
+        time_t now;
+        time(&now);
+        put_u32(&hdr, RECORDER_MAGIC);
+        put_u16(&hdr, RECORDER_VERSION);
+        put_u16(&hdr, FILE_HEADER_SIZE);
+        put_u32(&hdr, (uint32_t)now);
+        if (storage_append(path, hdr.data, hdr.len) != STORAGE_OK) {
+            s_len = 0;
+            sd_card_release();
+            return;
+        }
+    }
+
+    // A failed append loses the batch; the next one still lands whole
+    storage_append(path, s_buf, s_len);
+    s_len = 0;
+    sd_card_release();
+}
+
+static void append_locked(uint8_t type, uint32_t ts, uint16_t ms, const payload_t *p) {
+    size_t need = RECORD_HEADER_SIZE + p->len;
+    if (s_len + need > sizeof(s_buf)) {
+        flush_locked();
+    }
+
+    uint8_t *h = s_buf + s_len;
+    h[0] = type;
+    h[1] = (uint8_t)p->len;
+    h[2] = (uint8_t)ms;
+    h[3] = (uint8_t)(ms >> 8);
+    h[4] = (uint8_t)ts;
+    h[5] = (uint8_t)(ts >> 8);
+    h[6] = (uint8_t)(ts >> 16);
+    h[7] = (uint8_t)(ts >> 24);
+    memcpy(h + RECORD_HEADER_SIZE, p->data, p->len);
+    s_len += need;
+}
+
+// Switch files at local midnight and make sure the current one opens with the server list
+static void prepare_locked(uint32_t ts, uint16_t ms) {
+    char date[STORAGE_DATE_STR_LEN];
+    time_util_format_date(ts, date, sizeof(date));
+    if (strcmp(date, s_date) != 0) {
+        flush_locked();
+        strncpy(s_date, date, sizeof(s_date) - 1);
+        s_date[sizeof(s_date) - 1] = '\0';
+        s_config_sig = 0;
+        s_cleanup_pending = true;
+    }
+
+    const app_state_t *state = app_state_get();
+    uint32_t sig = config_signature(state);
+    if (sig == s_config_sig) return;
+
+    payload_t p = {0};
+    uint8_t count = state->settings.server_count;
+    if (count > MAX_SERVERS) count = MAX_SERVERS;
+    put_u8(&p, count);
+    put_u8(&p, state->settings.active_server_index);
+    for (int i = 0; i < count; i++) {
+        put_str(&p, state->settings.servers[i].server_id);
+    }
+    if (p.overflow) return;
+
+    append_locked(RECORDER_REC_CONFIG, ts, ms, &p);
+    s_config_sig = sig;
+}
+
+static void record(uint8_t type, const payload_t *p) {
+    if (!s_recording || p->overflow) return;
+
+    struct timeval tv;
+    gettimeofday(&tv, NULL);
+    if (tv.tv_sec < STORAGE_TIMESTAMP_MIN_VALID) return;     // No SNTP yet
+    uint32_t ts = (uint32_t)tv.tv_sec;
+    uint16_t ms = (uint16_t)(tv.tv_usec / 1000);
+
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(50)) != pdTRUE) return;
+    prepare_locked(ts, ms);
+    append_locked(type, ts, ms, p);
+    xSemaphoreGive(s_mutex);
+}
+
+static void cleanup_old_files(void) {
+    char dir_path[STORAGE_PATH_MAX_LEN];
+    storage_path_replay_dir(dir_path, sizeof(dir_path));
+
+    time_t now;
+    time(&now);
+    char cutoff[STORAGE_DATE_STR_LEN];
+    time_util_format_date((uint32_t)(now - RECORDER_RETENTION_DAYS * 86400), cutoff, sizeof(cutoff));
+
+    if (!sd_card_lease()) return;
+    DIR *dir = opendir(dir_path);
+    if (!dir) {
+        sd_card_release();
+        return;
+    }
+
+    struct dirent *entry;
+    char path[STORAGE_PATH_MAX_LEN + 16];
+    while ((entry = readdir(dir)) != NULL) {
+        // YYYY-MM-DD.trc only - names sort by date
+        if (strlen(entry->d_name) != 14 || strcmp(entry->d_name + 10, ".trc") != 0) continue;
+        if (strncmp(entry->d_name, cutoff, 10) >= 0) continue;
+
+        snprintf(path, sizeof(path), "%s/%.14s", dir_path, entry->d_name);
+        if (storage_delete(path) == STORAGE_OK) {
+            ESP_LOGI(TAG, "Deleted old trace: %s", entry->d_name);
+        }
+    }
+    closedir(dir);
+    sd_card_release();
+}
+
+// ============== RECORDING API ==============
+
+void recorder_init(void) {
+#if RECORDER_ENABLED
+    if (!sd_card_is_mounted()) {
+        ESP_LOGI(TAG, "No SD card, field recorder off");
+        return;
+    }
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+        if (!s_mutex) {
+            ESP_LOGE(TAG, "Failed to create mutex");
+            return;
+        }
+    }
+    s_len = 0;
+    s_date[0] = '\0';
+    s_config_sig = 0;
+    s_last_flush_us = esp_timer_get_time();
+    s_recording = true;
+    ESP_LOGI(TAG, "Field recorder on (%s)", STORAGE_REPLAY_DIR);
+#endif
+}
+
+bool recorder_is_recording(void) {
+    return s_recording;
+}
+
+void recorder_log_fetch(const char *server_id, esp_err_t err, const server_status_t *status) {
+    if (!s_recording || !server_id) return;
+
+    payload_t p = {0};
+    put_str(&p, server_id);
+    put_u32(&p, (uint32_t)err);
+    if (err == ESP_OK && status) {
+        put_u16(&p, (uint16_t)(int16_t)status->players);
+        put_u16(&p, (uint16_t)(int16_t)status->max_players);
+        put_u8(&p, (status->online ? 0x01 : 0) | (status->is_daytime ? 0x02 : 0));
+        put_u32(&p, (uint32_t)status->rank);
+        put_u16(&p, status->port);
+        put_str(&p, status->server_time);
+        put_str(&p, status->map_name);
+        put_str(&p, status->ip_address);
+        put_str(&p, status->server_name);
+    }
+    record(RECORDER_REC_FETCH, &p);
+}
+
+void recorder_log_event(int type, int arg) {
+    if (!s_recording) return;
+
+    payload_t p = {0};
+    put_u8(&p, (uint8_t)type);
+    put_u16(&p, (uint16_t)(int16_t)arg);
+    record(RECORDER_REC_EVENT, &p);
+}
+
+void recorder_log_wifi(bool connected) {
+    if (!s_recording) return;
+
+    payload_t p = {0};
+    put_u8(&p, connected ? 1 : 0);
+    record(RECORDER_REC_WIFI, &p);
+}
+
+void recorder_flush(void) {
+    if (!s_recording) return;
+    if (xSemaphoreTake(s_mutex, pdMS_TO_TICKS(1000)) != pdTRUE) return;
+    flush_locked();
+    s_last_flush_us = esp_timer_get_time();
+    xSemaphoreGive(s_mutex);
+}
+
+void recorder_tick(void) {
+    if (!s_recording) return;
+
+    if (esp_timer_get_time() - s_last_flush_us >= (int64_t)RECORDER_FLUSH_INTERVAL_SEC * 1000000) {
+        recorder_flush();
+    }
+
+    if (s_cleanup_pending) {
+        s_cleanup_pending = false;
+        cleanup_old_files();
+    }
+}
+
+// ============== READING ==============
+
+typedef struct {
+    const uint8_t *p;
+    size_t len;
+    size_t pos;
+    bool bad;
+} cursor_t;
+
+static const uint8_t* take(cursor_t *c, size_t n) {
+    if (c->pos + n > c->len) {
+        c->bad = true;
+        return NULL;
+    }
+    const uint8_t *r = c->p + c->pos;
+    c->pos += n;
+    return r;
+}
+
+static uint8_t get_u8(cursor_t *c) {
+    const uint8_t *b = take(c, 1);
+    return b ? b[0] : 0;
+}
+
+static uint16_t get_u16(cursor_t *c) {
+    const uint8_t *b = take(c, 2);
+    return b ? (uint16_t)(b[0] | (b[1] << 8)) : 0;
+}
+
+static uint32_t get_u32(cursor_t *c) {
+    const uint8_t *b = take(c, 4);
+    return b ? (uint32_t)b[0] | ((uint32_t)b[1] << 8) | ((uint32_t)b[2] << 16) | ((uint32_t)b[3] << 24) : 0;
+}
+
+static void get_str(cursor_t *c, char *dst, size_t dst_size) {
+    uint8_t n = get_u8(c);
+    const uint8_t *b = take(c, n);
+    size_t copy = (b && n < dst_size) ? n : (b ? dst_size - 1 : 0);
+    if (copy) memcpy(dst, b, copy);
+    dst[copy] = '\0';
+}
+
+esp_err_t recorder_reader_open(recorder_reader_t *r, const char *path) {
+    memset(r, 0, sizeof(*r));
+    r->f = fopen(path, "rb");
+    if (!r->f) return ESP_ERR_NOT_FOUND;
+
+    uint8_t hdr[FILE_HEADER_SIZE];
+    cursor_t c = { hdr, sizeof(hdr), 0, false };
+    if (fread(hdr, 1, sizeof(hdr), r->f) != sizeof(hdr) || get_u32(&c) != RECORDER_MAGIC) {
+        recorder_reader_close(r);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    r->version = get_u16(&c);
+    uint16_t hdr_len = get_u16(&c);
+    r->created = get_u32(&c);
+    if (r->version != RECORDER_VERSION || hdr_len < FILE_HEADER_SIZE) {
+        recorder_reader_close(r);
+        return ESP_ERR_INVALID_VERSION;
+    }
+    fseek(r->f, hdr_len, SEEK_SET);
+    return ESP_OK;
+}
+
+int recorder_reader_next(recorder_reader_t *r, recorder_record_t *rec) {
+    if (!r->f) return 0;
+
+    uint8_t hdr[RECORD_HEADER_SIZE];
+    uint8_t payload[RECORD_MAX_PAYLOAD];
+    for (;;) {
+        size_t n = fread(hdr, 1, sizeof(hdr), r->f);
+        if (n == 0) return 0;
+        if (n != sizeof(hdr)) return -1;
+        if (fread(payload, 1, hdr[1], r->f) != hdr[1]) return -1;
+
+        memset(rec, 0, sizeof(*rec));
+        rec->type = hdr[0];
+        rec->ms = (uint16_t)(hdr[2] | (hdr[3] << 8));
+        rec->ts = (uint32_t)hdr[4] | ((uint32_t)hdr[5] << 8) |
+                  ((uint32_t)hdr[6] << 16) | ((uint32_t)hdr[7] << 24);
+        cursor_t c = { payload, hdr[1], 0, false };
+
+        switch (rec->type) {
+            case RECORDER_REC_CONFIG:
+                rec->config.server_count = get_u8(&c);
+                rec->config.active_index = get_u8(&c);
+                if (rec->config.server_count > MAX_SERVERS) return -1;
+                for (int i = 0; i < rec->config.server_count; i++) {
+                    get_str(&c, rec->config.server_ids[i], RECORDER_ID_LEN);
+                }
+                break;
+
+            case RECORDER_REC_FETCH: {
+                server_status_t *st = &rec->fetch.status;
+                get_str(&c, rec->fetch.server_id, sizeof(rec->fetch.server_id));
+                rec->fetch.err = (int32_t)get_u32(&c);
+                st->players = -1;
+                st->is_daytime = true;
+                if (rec->fetch.err == ESP_OK) {
+                    st->players = (int16_t)get_u16(&c);
+                    st->max_players = (int16_t)get_u16(&c);
+                    uint8_t flags = get_u8(&c);
+                    st->online = (flags & 0x01) != 0;
+                    st->is_daytime = (flags & 0x02) != 0;
+                    st->rank = (int32_t)get_u32(&c);
+                    st->port = get_u16(&c);
+                    get_str(&c, st->server_time, sizeof(st->server_time));
+                    get_str(&c, st->map_name, sizeof(st->map_name));
+                    get_str(&c, st->ip_address, sizeof(st->ip_address));
+                    get_str(&c, st->server_name, sizeof(st->server_name));
+                }
+                break;
+            }
+
+            case RECORDER_REC_EVENT:
+                rec->event.type = get_u8(&c);
+                rec->event.arg = (int16_t)get_u16(&c);
+                break;
+
+            case RECORDER_REC_WIFI:
+                rec->wifi.connected = get_u8(&c) != 0;
+                break;
+
+            default:
+                continue;   // Newer record type - skip by length
+        }
+        return c.bad ? -1 : 1;
+    }
+}
+
+void recorder_reader_close(recorder_reader_t *r) {
+    if (r->f) fclose(r->f);
+    r->f = NULL;
+}
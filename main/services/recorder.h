@@ -0,0 +1,132 @@
+/**
+ * DayZ Server Tracker - Field Recorder
+ * Compact binary trace of pipeline inputs for host replay
+ *
+ * Records what drives the data pipeline: every BattleMetrics fetch
+ * result (parsed, not the raw body), touch-originated UI events, WiFi
+ * link changes, and the server list whenever it changes. Records are
+ * buffered in RAM and appended to /sdcard/replay/YYYY-MM-DD.trc, one file
+ * per local day, each self-contained (starts with a config record).
+ *
+ * host/replay.c feeds a trace back through server_query_execute() and
+ * secondary_fetch_slot() on a virtual clock. The reader half lives here
+ * so both sides share one format definition.
+ *
+ * File:   u32 magic, u16 version, u16 header size, u32 created (Unix)
+ * Record: u8 type, u8 payload length, u16 ms, u32 Unix time, payload
+ * All little-endian; strings are u8 length + bytes. Readers skip
+ * unknown record types by length.
+ */
+
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "esp_err.h"
+#include "config.h"
+#include "battlemetrics.h"
+
+#define RECORDER_MAGIC          0x50525A44  // "DZRP"
+#define RECORDER_VERSION        1
+#define RECORDER_ID_LEN         32          // server_config_t.server_id
+
+typedef enum {
+    RECORDER_REC_CONFIG = 1,    // Server list + active index
+    RECORDER_REC_FETCH,         // battlemetrics_query() result
+    RECORDER_REC_EVENT,         // Touch-originated app event
+    RECORDER_REC_WIFI,          // Link up/down
+} recorder_rec_type_t;
+
+// Decoded record (reader side)
+typedef struct {
+    uint8_t type;
+    uint32_t ts;                // Unix time
+    uint16_t ms;
+    union {
+        struct {
+            uint8_t server_count;
+            uint8_t active_index;
+            char server_ids[MAX_SERVERS][RECORDER_ID_LEN];
+        } config;
+        struct {
+            char server_id[RECORDER_ID_LEN];
+            int32_t err;        // esp_err_t from battlemetrics_query()
+            server_status_t status;
+        } fetch;
+        struct {
+            uint8_t type;       // event_type_t
+            int16_t arg;        // Screen / slot, 0 if none
+        } event;
+        struct {
+            bool connected;
+        } wifi;
+    };
+} recorder_record_t;
+
+// ============== RECORDING (device) ==============
+
+/**
+ * Start recording if RECORDER_ENABLED and the SD card is mounted
+ * Call after sd_card_init()
+ */
+void recorder_init(void);
+
+/**
+ * @return true if records are being captured
+ */
+bool recorder_is_recording(void);
+
+/**
+ * Record a fetch result (called by battlemetrics_query)
+ * Emits a config record first if the server list changed.
+ */
+void recorder_log_fetch(const char *server_id, esp_err_t err, const server_status_t *status);
+
+/**
+ * Record a touch-originated event (called by events_post)
+ * @param type event_type_t
+ * @param arg Screen or slot, 0 if none
+ */
+void recorder_log_event(int type, int arg);
+
+/**
+ * Record a WiFi link change (called by app_state_set_wifi_connected)
+ */
+void recorder_log_wifi(bool connected);
+
+/**
+ * Flush buffered records every RECORDER_FLUSH_INTERVAL_SEC
+ * Call from the main loop.
+ */
+void recorder_tick(void);
+
+/**
+ * Write buffered records to SD now
+ */
+void recorder_flush(void);
+
+// ============== READING (host replay) ==============
+
+typedef struct {
+    FILE *f;
+    uint16_t version;
+    uint32_t created;
+} recorder_reader_t;
+
+/**
+ * Open a trace file and check its header
+ * @return ESP_OK, ESP_ERR_NOT_FOUND, or ESP_ERR_INVALID_VERSION for a foreign file
+ */
+esp_err_t recorder_reader_open(recorder_reader_t *r, const char *path);
+
+/**
+ * Read the next known record
+ * @return 1 record read, 0 end of file, -1 truncated/corrupt
+ */
+int recorder_reader_next(recorder_reader_t *r, recorder_record_t *rec);
+
+void recorder_reader_close(recorder_reader_t *r);
+
+#endif // RECORDER_H
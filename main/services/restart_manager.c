@@ -1,83 +1,329 @@
 /**
  * DayZ Server Tracker - Restart Manager Implementation
+ *
+ * Restarts are detected from the sample stream (sharp drop to near zero,
+ * or the server reporting offline) and kept in a per-server ring buffer.
+ * Every fetch path feeds its samples in, so secondary servers learn their
+ * own schedules in the background.
+ * The predictor looks for a phase-locked schedule: for each candidate
+ * period it takes every restart's local time-of-day modulo the period and
+ * finds the phase that most restarts agree on within a tolerance (a mode
+ * estimator, so missed or manual restarts do not drag it). The longest
+ * period that explains enough restarts wins. If nothing locks, the median
+ * interval is used instead.
+ *
+ * The schedule is refitted only on the fetch path (restart_record and
+ * restart_process_sample); the getters just read it. One mutex guards
+ * every server's restart_history, held for the fit itself (microseconds)
+ * but not for NVS saves or alerts.
  */
 
 #include "restart_manager.h"
 #include "config.h"
 #include "drivers/buzzer.h"
 #include "settings_store.h"
+#include "mqtt_publisher.h"
+#include "time_util.h"
 #include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include <stdlib.h>
 #include <time.h>
 
 static const char *TAG = "restart_mgr";
 
-void restart_record(server_config_t *srv, uint32_t timestamp) {
+static SemaphoreHandle_t s_mutex = NULL;
+
+static const uint8_t s_candidate_periods_h[] = RESTART_CANDIDATE_PERIODS_H;
+
+static void lock(void) {
+    if (s_mutex) xSemaphoreTake(s_mutex, portMAX_DELAY);
+}
+
+static void unlock(void) {
+    if (s_mutex) xSemaphoreGive(s_mutex);
+}
+
+// Signed distance a - b on a circle of the given period
+static int32_t circular_diff(uint32_t a, uint32_t b, uint32_t period) {
+    int32_t d = (int32_t)(a % period) - (int32_t)(b % period);
+    if (d > (int32_t)period / 2) d -= period;
+    if (d < -(int32_t)period / 2) d += period;
+    return d;
+}
+
+static void sort_i32(int32_t *v, int n) {
+    for (int i = 1; i < n; i++) {
+        int32_t tmp = v[i];
+        int j = i - 1;
+        while (j >= 0 && v[j] > tmp) {
+            v[j + 1] = v[j];
+            j--;
+        }
+        v[j + 1] = tmp;
+    }
+}
+
+static int32_t median_i32(int32_t *v, int n) {
+    sort_i32(v, n);
+    return (n % 2) ? v[n / 2] : (v[n / 2 - 1] + v[n / 2]) / 2;
+}
+
+/**
+ * Copy recent restarts out of the ring, oldest first
+ * @return Number of timestamps written
+ */
+static int collect_recent_restarts(const restart_history_t *rh, uint32_t now, uint32_t *out) {
+    int n = 0;
+    int start = (rh->restart_head + MAX_RESTART_HISTORY - rh->restart_count) % MAX_RESTART_HISTORY;
+    for (int i = 0; i < rh->restart_count; i++) {
+        uint32_t t = rh->restart_times[(start + i) % MAX_RESTART_HISTORY];
+        if (t < STORAGE_TIMESTAMP_MIN_VALID) continue;
+        if (now > t && now - t > RESTART_LEARN_WINDOW_SEC) continue;
+        out[n++] = t;
+    }
+    return n;
+}
+
+/**
+ * Fit one candidate period
+ * @param tod Local time-of-day of each restart
+ * @param phase_out Best phase (median of inlier residuals around the mode)
+ * @param mad_out Median absolute deviation of inliers, seconds
+ * @return Number of inliers
+ */
+static int fit_period(const uint32_t *tod, int n, uint32_t period,
+                      uint32_t *phase_out, int32_t *mad_out) {
+    int best_count = 0;
+    uint32_t best_center = 0;
+
+    // Mode search: the restart phase with the most neighbours within tolerance
+    for (int i = 0; i < n; i++) {
+        int count = 0;
+        for (int j = 0; j < n; j++) {
+            if (abs(circular_diff(tod[j], tod[i], period)) <= RESTART_PHASE_TOL_SEC) {
+                count++;
+            }
+        }
+        if (count > best_count) {
+            best_count = count;
+            best_center = tod[i] % period;
+        }
+    }
+
+    // Refine with the median residual of the inliers
+    int32_t residuals[MAX_RESTART_HISTORY];
+    int m = 0;
+    for (int j = 0; j < n; j++) {
+        int32_t d = circular_diff(tod[j], best_center, period);
+        if (abs(d) <= RESTART_PHASE_TOL_SEC) {
+            residuals[m++] = d;
+        }
+    }
+    int32_t shift = m > 0 ? median_i32(residuals, m) : 0;
+    *phase_out = (best_center + period + shift) % period;
+
+    for (int j = 0; j < m; j++) {
+        residuals[j] = abs(residuals[j] - shift);
+    }
+    *mad_out = m > 0 ? median_i32(residuals, m) : 0;
+
+    return best_count;
+}
+
+/**
+ * Refit the schedule (under s_mutex)
+ * The result is marked valid only once it is complete.
+ */
+static void update_schedule_locked(server_config_t *srv) {
     restart_history_t *rh = &srv->restart_history;
+    time_t now;
+    time(&now);
+
+    // Phases need the real wall clock and TZ, wait for SNTP
+    if (now < STORAGE_TIMESTAMP_MIN_VALID) return;
+
+    rh->schedule_valid = false;
+    rh->period_sec = 0;
+    rh->phase_sec = 0;
+    rh->median_interval_sec = 0;
+    rh->confidence = 0;
+
+    uint32_t times[MAX_RESTART_HISTORY];
+    int n = collect_recent_restarts(rh, (uint32_t)now, times);
+    if (n < 2) {
+        rh->schedule_valid = true;
+        return;
+    }
 
-    if (rh->last_restart_time > 0 &&
+    uint32_t tod[MAX_RESTART_HISTORY];
+    for (int i = 0; i < n; i++) {
+        tod[i] = time_util_time_of_day(times[i]);
+    }
+
+    // Longest period that most restarts agree on
+    for (size_t p = 0; p < sizeof(s_candidate_periods_h); p++) {
+        uint32_t period = s_candidate_periods_h[p] * 3600;
+        uint32_t phase;
+        int32_t mad;
+        int inliers = fit_period(tod, n, period, &phase, &mad);
+
+        if (inliers < RESTART_MIN_INLIERS || inliers * 100 < n * RESTART_MIN_INLIER_PCT) {
+            continue;
+        }
+
+        rh->period_sec = period;
+        rh->phase_sec = phase;
+
+        // Confidence: share of restarts explained, amount of evidence, tightness
+        int evidence = inliers >= 6 ? 100 : inliers * 100 / 6;
+        int tightness = 100 - (mad * 100 / RESTART_PHASE_TOL_SEC);
+        if (tightness < 0) tightness = 0;
+        rh->confidence = (uint8_t)((inliers * 100 / n) * evidence / 100 * tightness / 100);
+
+        ESP_LOGI(TAG, "Learned schedule: every %luh at +%lu:%02lu (%d/%d restarts, MAD %lds, conf %d%%)",
+                 (unsigned long)(period / 3600), (unsigned long)(phase / 3600),
+                 (unsigned long)((phase % 3600) / 60), inliers, n, (long)mad, rh->confidence);
+        rh->schedule_valid = true;
+        return;
+    }
+
+    // No schedule locked - median of plausible intervals
+    int32_t intervals[MAX_RESTART_HISTORY];
+    int m = 0;
+    for (int i = 1; i < n; i++) {
+        uint32_t d = times[i] - times[i - 1];
+        if (d >= MIN_RESTART_INTERVAL_SEC && d <= 86400) {
+            intervals[m++] = (int32_t)d;
+        }
+    }
+    if (m > 0) {
+        rh->median_interval_sec = (uint32_t)median_i32(intervals, m);
+        rh->confidence = m >= 3 ? 30 : 15;
+        ESP_LOGI(TAG, "No schedule lock, median interval %luh %lum",
+                 (unsigned long)(rh->median_interval_sec / 3600),
+                 (unsigned long)((rh->median_interval_sec % 3600) / 60));
+    }
+    rh->schedule_valid = true;
+}
+
+void restart_init(void) {
+    if (!s_mutex) {
+        s_mutex = xSemaphoreCreateMutex();
+    }
+}
+
+void restart_update_schedule(server_config_t *srv) {
+    lock();
+    update_schedule_locked(srv);
+    unlock();
+}
+
+void restart_snapshot(const server_config_t *srv, restart_history_t *out) {
+    lock();
+    *out = srv->restart_history;
+    unlock();
+}
+
+/**
+ * Add a restart to the ring and refit (under s_mutex)
+ * @return false if it was too soon after the last one
+ */
+static bool record_locked(server_config_t *srv, uint32_t timestamp) {
+    restart_history_t *rh = &srv->restart_history;
+
+    if (rh->last_restart_time > 0 && timestamp > rh->last_restart_time &&
         (timestamp - rh->last_restart_time) < MIN_RESTART_INTERVAL_SEC) {
         ESP_LOGW(TAG, "Ignoring restart - too soon after last one");
-        return;
+        return false;
     }
 
+    rh->restart_times[rh->restart_head] = timestamp;
+    rh->restart_head = (rh->restart_head + 1) % MAX_RESTART_HISTORY;
     if (rh->restart_count < MAX_RESTART_HISTORY) {
-        rh->restart_times[rh->restart_count] = timestamp;
         rh->restart_count++;
-    } else {
-        for (int i = 0; i < MAX_RESTART_HISTORY - 1; i++) {
-            rh->restart_times[i] = rh->restart_times[i + 1];
-        }
-        rh->restart_times[MAX_RESTART_HISTORY - 1] = timestamp;
+    }
+    if (timestamp > rh->last_restart_time) {
+        rh->last_restart_time = timestamp;
     }
 
-    rh->last_restart_time = timestamp;
+    ESP_LOGI(TAG, "%s: restart detected at %lu (%d recorded)",
+             srv->display_name, (unsigned long)timestamp, rh->restart_count);
 
-    if (rh->restart_count >= 2) {
-        uint32_t total_interval = 0;
-        for (int i = 1; i < rh->restart_count; i++) {
-            total_interval += rh->restart_times[i] - rh->restart_times[i - 1];
-        }
-        rh->avg_interval_sec = total_interval / (rh->restart_count - 1);
-        ESP_LOGI(TAG, "Server restart detected! Avg interval: %luh %lum",
-                 rh->avg_interval_sec / 3600, (rh->avg_interval_sec % 3600) / 60);
-    } else {
-        ESP_LOGI(TAG, "Server restart detected at %lu", (unsigned long)timestamp);
-    }
+    update_schedule_locked(srv);
+    return true;
+}
 
-    // Save to NVS so restart time persists
-    settings_save();
+// Outside s_mutex: NVS write, MQTT event and beep for a recorded restart
+static void announce_restart(server_config_t *srv, uint32_t timestamp) {
+    // Persist just this server's restart keys, not the whole settings blob
+    app_state_t *state = app_state_get();
+    int server_index = (int)(srv - state->settings.servers);
+    if (server_index >= 0 && server_index < state->settings.server_count) {
+        settings_save_restart_history(server_index);
+        mqtt_publisher_post_restart(server_index, timestamp);
+    }
 
     buzzer_alert_restart();
 }
 
-void restart_check_for_restart(server_config_t *srv, int current_count) {
+void restart_record(server_config_t *srv, uint32_t timestamp) {
+    lock();
+    bool recorded = record_locked(srv, timestamp);
+    unlock();
+    if (recorded) {
+        announce_restart(srv, timestamp);
+    }
+}
+
+void restart_process_sample(server_config_t *srv, int players, bool online, uint32_t timestamp) {
     restart_history_t *rh = &srv->restart_history;
+    bool recorded = false;
+    uint32_t restart_ts = 0;
+
+    lock();
+    bool have_prev = rh->last_known_players >= 0;
+    uint32_t gap = have_prev ? timestamp - rh->last_sample_time : 0;
+
+    if (have_prev && rh->last_online && !online) {
+        // Server reported going offline
+        restart_ts = timestamp;
+        recorded = record_locked(srv, restart_ts);
+    } else if (have_prev && online && rh->last_known_players >= RESTART_DETECT_MIN_PLAYERS &&
+               players <= RESTART_DETECT_NEAR_ZERO && gap <= RESTART_DETECT_MAX_GAP_SEC) {
+        // Sharp drop to near zero between two samples - the restart happened
+        // somewhere in the gap, the midpoint halves the worst-case error
+        restart_ts = timestamp - gap / 2;
+        recorded = record_locked(srv, restart_ts);
+    }
 
-    // Record restart if we see 0 players - the restart_record function
-    // will reject if too soon after last recorded restart
-    if (current_count == RESTART_DETECT_DROP_TO) {
-        time_t now;
-        time(&now);
-        restart_record(srv, (uint32_t)now);
+    // First sample with a valid clock (or after a settings reload)
+    if (!rh->schedule_valid) {
+        update_schedule_locked(srv);
     }
 
-    rh->last_known_players = current_count;
+    rh->last_known_players = players;
+    rh->last_sample_time = timestamp;
+    rh->last_online = online;
+    unlock();
+
+    if (recorded) {
+        announce_restart(srv, restart_ts);
+    }
 }
 
 int restart_get_countdown(server_config_t *srv) {
     time_t now;
     time(&now);
-    struct tm timeinfo;
-    localtime_r(&now, &timeinfo);
 
     if (srv->manual_restart_set && srv->restart_interval_hours > 0) {
         int interval_sec = srv->restart_interval_hours * 3600;
 
-        struct tm restart_tm = timeinfo;
-        restart_tm.tm_hour = srv->restart_hour;
-        restart_tm.tm_min = srv->restart_minute;
-        restart_tm.tm_sec = 0;
-        time_t first_restart_today = mktime(&restart_tm);
+        struct tm timeinfo;
+        time_util_to_tm((uint32_t)now, &timeinfo);
+        time_t first_restart_today = time_util_local_to_utc(
+            timeinfo.tm_year + 1900, timeinfo.tm_mon + 1, timeinfo.tm_mday,
+            srv->restart_hour * 3600 + srv->restart_minute * 60);
 
         time_t next_restart = first_restart_today;
         while (next_restart <= now) {
@@ -91,18 +337,56 @@ int restart_get_countdown(server_config_t *srv) {
         return countdown > 0 ? countdown : 0;
     }
 
-    restart_history_t *rh = &srv->restart_history;
-    if (rh->restart_count >= 2 && rh->avg_interval_sec > 0) {
-        uint32_t predicted_next = rh->last_restart_time + rh->avg_interval_sec;
-        if ((uint32_t)now >= predicted_next) {
+    // Read-only: a schedule not yet fitted on the fetch path is unknown
+    lock();
+    const restart_history_t *rh = &srv->restart_history;
+    bool valid = rh->schedule_valid;
+    uint32_t period = rh->period_sec;
+    uint32_t phase = rh->phase_sec;
+    uint32_t median = rh->median_interval_sec;
+    uint32_t last = rh->last_restart_time;
+    unlock();
+
+    if (!valid) return -1;
+
+    if (period > 0) {
+        uint32_t tod = time_util_time_of_day((uint32_t)now);
+        uint32_t since_slot = (tod % period + period - phase) % period;
+
+        // Slot just passed without a detected restart - it is probably running late
+        if (since_slot < RESTART_OVERDUE_GRACE_SEC &&
+            (uint32_t)now - since_slot > last + RESTART_PHASE_TOL_SEC) {
+            return 0;
+        }
+        return (int)(period - since_slot);
+    }
+
+    if (median > 0 && last > 0) {
+        uint32_t predicted_next = last + median;
+        if ((uint32_t)now < predicted_next) {
+            return predicted_next - (uint32_t)now;
+        }
+        uint32_t late = (uint32_t)now - predicted_next;
+        if (late < RESTART_OVERDUE_GRACE_SEC) {
             return 0;
         }
-        return predicted_next - (uint32_t)now;
+        // Roll forward whole intervals instead of staying "Imminent" forever
+        return median - (late % median);
     }
 
     return -1;
 }
 
+int restart_get_confidence(server_config_t *srv) {
+    if (srv->manual_restart_set && srv->restart_interval_hours > 0) {
+        return 100;
+    }
+    lock();
+    int confidence = srv->restart_history.schedule_valid ? srv->restart_history.confidence : 0;
+    unlock();
+    return confidence;
+}
+
 void restart_format_countdown(int seconds, char *buf, size_t buf_size) {
     if (seconds < 0) {
         snprintf(buf, buf_size, "Unknown");
@@ -120,16 +404,18 @@ void restart_format_countdown(int seconds, char *buf, size_t buf_size) {
 }
 
 int restart_get_time_since_last(server_config_t *srv) {
-    restart_history_t *rh = &srv->restart_history;
+    lock();
+    uint32_t last = srv->restart_history.last_restart_time;
+    unlock();
 
-    if (rh->last_restart_time == 0) {
+    if (last == 0) {
         return -1;
     }
 
     time_t now;
     time(&now);
 
-    return (int)((uint32_t)now - rh->last_restart_time);
+    return (int)((uint32_t)now - last);
 }
 
 void restart_format_time_since(int seconds, char *buf, size_t buf_size) {
@@ -155,42 +441,18 @@ void restart_format_time_since(int seconds, char *buf, size_t buf_size) {
 }
 
 void restart_format_last_time(server_config_t *srv, char *buf, size_t buf_size) {
-    restart_history_t *rh = &srv->restart_history;
+    lock();
+    uint32_t last = srv->restart_history.last_restart_time;
+    unlock();
 
-    if (rh->last_restart_time == 0) {
+    if (last == 0) {
         buf[0] = '\0';
         return;
     }
 
-    time_t restart_time = (time_t)rh->last_restart_time;
     struct tm timeinfo;
-    localtime_r(&restart_time, &timeinfo);
+    time_util_to_tm(last, &timeinfo);
 
-    // Format as HH:MM CET
+    // Format as local HH:MM
     snprintf(buf, buf_size, "%02d:%02d", timeinfo.tm_hour, timeinfo.tm_min);
 }
-
-void restart_check_stale_and_reset(server_config_t *srv) {
-    restart_history_t *rh = &srv->restart_history;
-
-    time_t now;
-    time(&now);
-
-    // If no restart recorded, or last restart is more than 12 hours ago,
-    // reset to current time as baseline
-    #define STALE_THRESHOLD_SEC (12 * 3600)
-
-    if (rh->last_restart_time == 0 ||
-        ((uint32_t)now - rh->last_restart_time) > STALE_THRESHOLD_SEC) {
-
-        ESP_LOGI(TAG, "Restart data stale (>12h), resetting to now");
-
-        // Clear history and start fresh
-        rh->restart_count = 1;
-        rh->restart_times[0] = (uint32_t)now;
-        rh->last_restart_time = (uint32_t)now;
-        rh->avg_interval_sec = 0;
-
-        settings_save();
-    }
-}
@@ -8,8 +8,15 @@
 
 #include <stdint.h>
 #include <stddef.h>
+#include <stdbool.h>
 #include "app_state.h"
 
+/**
+ * Create the lock guarding every server's restart_history
+ * Call once before the fetch tasks start.
+ */
+void restart_init(void);
+
 /**
  * Record a detected server restart
  * @param srv Server configuration with restart history
@@ -18,19 +25,49 @@
 void restart_record(server_config_t *srv, uint32_t timestamp);
 
 /**
- * Check if a restart just happened (player count dropped to 0)
+ * Feed a player sample into restart detection
+ * Detects a sharp drop to near zero or an online -> offline transition.
+ * @param srv Server configuration
+ * @param players Current player count
+ * @param online Online flag reported by the data source
+ * @param timestamp Unix timestamp of the sample
+ */
+void restart_process_sample(server_config_t *srv, int players, bool online, uint32_t timestamp);
+
+/**
+ * Re-learn the restart schedule from the recorded restarts
+ * No-op until the wall clock is valid. restart_record() and the first
+ * restart_process_sample() with a valid clock call it; the getters below
+ * only read the result.
  * @param srv Server configuration
- * @param current_count Current player count
  */
-void restart_check_for_restart(server_config_t *srv, int current_count);
+void restart_update_schedule(server_config_t *srv);
+
+/**
+ * Copy a server's restart history under the restart lock
+ * For readers outside the fetch path (NVS saves, anomaly masking), so a
+ * concurrent restart_process_sample() cannot hand them a torn ring.
+ * @param srv Server configuration
+ * @param out Consistent copy
+ */
+void restart_snapshot(const server_config_t *srv, restart_history_t *out);
 
 /**
  * Get countdown to next predicted restart
+ * Read-only, safe from any task.
  * @param srv Server configuration
- * @return Seconds until restart, 0 if imminent, -1 if unknown
+ * @return Seconds until restart, 0 if imminent, -1 if unknown (or not
+ *         fitted yet)
  */
 int restart_get_countdown(server_config_t *srv);
 
+/**
+ * Get confidence of the restart prediction
+ * @param srv Server configuration
+ * @return 0-100 (100 for a manual schedule, 0 if unknown)
+ */
+int restart_get_confidence(server_config_t *srv);
+
 /**
  * Format countdown seconds into human-readable string
  * @param seconds Countdown value (negative = unknown)
@@ -55,18 +92,11 @@ int restart_get_time_since_last(server_config_t *srv);
 void restart_format_time_since(int seconds, char *buf, size_t buf_size);
 
 /**
- * Format last restart as CET time (HH:MM)
+ * Format last restart as local time (HH:MM)
  * @param srv Server configuration
  * @param buf Output buffer
  * @param buf_size Buffer size
  */
 void restart_format_last_time(server_config_t *srv, char *buf, size_t buf_size);
 
-/**
- * Reset restart tracking if data is stale (>12 hours old)
- * Call this after NTP sync to bootstrap fresh data
- * @param srv Server configuration
- */
-void restart_check_stale_and_reset(server_config_t *srv);
-
 #endif // RESTART_MANAGER_H
@@ -4,11 +4,18 @@
 
 #include "secondary_fetch.h"
 #include "battlemetrics.h"
+#include "fleet.h"
 #include "history_store.h"
+#include "alert_manager.h"
+#include "restart_manager.h"
+#include "forecast.h"
+#include "anomaly_detector.h"
+#include "analytics_cache.h"
+#include "mqtt_publisher.h"
+#include "trace.h"
 #include "app_state.h"
 #include "config.h"
 #include "events.h"
-#include "drivers/sd_card.h"
 #include "esp_log.h"
 #include "freertos/FreeRTOS.h"
 #include "freertos/task.h"
@@ -19,6 +26,69 @@ static const char *TAG = "secondary_fetch";
 static TaskHandle_t fetch_task_handle = NULL;
 static volatile bool fetch_running = false;
 
+esp_err_t secondary_fetch_slot(int slot) {
+    app_state_t *state = app_state_get();
+    if (slot < 0 || slot >= state->runtime.secondary_count) return ESP_ERR_INVALID_ARG;
+
+    uint8_t server_idx = state->runtime.secondary_server_indices[slot];
+    if (server_idx >= state->settings.server_count) return ESP_ERR_INVALID_STATE;
+
+    server_config_t *server = &state->settings.servers[server_idx];
+    if (!server->active || server->server_id[0] == '\0') return ESP_ERR_INVALID_STATE;
+
+    // Mark as fetching
+    if (app_state_lock(100)) {
+        state->runtime.secondary[slot].fetch_pending = true;
+        app_state_unlock();
+    }
+
+    // Query BattleMetrics, or take a fleet peer's result
+    server_status_t status;
+    esp_err_t err = fleet_query(server->server_id, SECONDARY_REFRESH_SEC, &status);
+
+    if (err == ESP_OK) {
+        // Update state
+        app_state_update_secondary_status(slot, status.players, status.max_players,
+                                           status.server_time, status.is_daytime,
+                                           status.map_name);
+        app_state_add_trend_point(slot, status.players);
+
+        time_t now_time;
+        time(&now_time);
+
+        if (status.players >= 0) {
+            // Per-server analytics fed from the same sample
+            restart_process_sample(server, status.players, status.online, (uint32_t)now_time);
+            alert_process_sample(server_idx, status.players, status.max_players);
+            forecast_process_sample(server_idx, (uint32_t)now_time, status.players);
+            anomaly_process_sample(server_idx, (uint32_t)now_time, status.players,
+                                   status.max_players);
+            analytics_cache_process_sample(server_idx, (uint32_t)now_time, status.players,
+                                           status.max_players, status.online);
+            mqtt_publisher_process_sample(server_idx, (uint32_t)now_time, status.players,
+                                          status.max_players);
+        }
+
+        // Record history for secondary server (to SD card JSON)
+        if (history_json_writable() && status.players >= 0) {
+            history_append_entry_json(server_idx, (uint32_t)now_time, (int16_t)status.players);
+        }
+
+        ESP_LOGI(TAG, "Slot %d (%s): %d/%d players, time=%s",
+                 slot, server->display_name, status.players,
+                 status.max_players, status.server_time);
+    } else {
+        // Mark as invalid but don't clear existing data
+        if (app_state_lock(100)) {
+            state->runtime.secondary[slot].fetch_pending = false;
+            app_state_unlock();
+        }
+        ESP_LOGW(TAG, "Failed to fetch slot %d (%s): %s",
+                 slot, server->display_name, battlemetrics_get_last_error());
+    }
+    return err;
+}
+
 static void secondary_fetch_execute(void) {
     // Update secondary indices in case server list changed
     app_state_update_secondary_indices();
@@ -27,59 +97,22 @@ static void secondary_fetch_execute(void) {
     uint8_t count = state->runtime.secondary_count;
 
     ESP_LOGI(TAG, "Fetching %d secondary servers", count);
+    uint32_t trace_id = trace_cycle_begin();
 
     // Fetch each secondary server
     for (int slot = 0; slot < count && fetch_running; slot++) {
-        uint8_t server_idx = state->runtime.secondary_server_indices[slot];
-
-        if (server_idx >= state->settings.server_count) continue;
-
-        server_config_t *server = &state->settings.servers[server_idx];
-        if (!server->active || server->server_id[0] == '\0') continue;
-
-        // Mark as fetching
-        if (app_state_lock(100)) {
-            state->runtime.secondary[slot].fetch_pending = true;
-            app_state_unlock();
-        }
-
-        // Query BattleMetrics
-        server_status_t status;
-        esp_err_t err = battlemetrics_query(server->server_id, &status);
-
-        if (err == ESP_OK) {
-            // Update state
-            app_state_update_secondary_status(slot, status.players, status.max_players,
-                                               status.server_time, status.is_daytime,
-                                               status.map_name);
-            app_state_add_trend_point(slot, status.players);
-
-            // Record history for secondary server (to SD card JSON)
-            if (sd_card_is_mounted() && status.players >= 0) {
-                time_t now_time;
-                time(&now_time);
-                history_append_entry_json(server_idx, (uint32_t)now_time, (int16_t)status.players);
-            }
-
-            ESP_LOGI(TAG, "Slot %d (%s): %d/%d players, time=%s",
-                     slot, server->display_name, status.players,
-                     status.max_players, status.server_time);
-        } else {
-            // Mark as invalid but don't clear existing data
-            if (app_state_lock(100)) {
-                state->runtime.secondary[slot].fetch_pending = false;
-                app_state_unlock();
-            }
-            ESP_LOGW(TAG, "Failed to fetch slot %d (%s): %s",
-                     slot, server->display_name, battlemetrics_get_last_error());
-        }
+        TRACE_BEGIN(sp, "secondary_slot");
+        esp_err_t err = secondary_fetch_slot(slot);
+        TRACE_END(sp);
+        if (err == ESP_ERR_INVALID_STATE) continue;
 
         // Small delay between requests to avoid rate limiting
         vTaskDelay(pdMS_TO_TICKS(500));
     }
 
     // Post event to update UI
-    events_post_simple(EVT_SECONDARY_DATA_UPDATED);
+    trace_set_context(0);
+    events_post_traced(EVT_SECONDARY_DATA_UPDATED, trace_id);
 }
 
 static void secondary_fetch_task(void *arg) {
@@ -6,6 +6,8 @@
 #ifndef SECONDARY_FETCH_H
 #define SECONDARY_FETCH_H
 
+#include "esp_err.h"
+
 /**
  * Initialize the secondary fetch service
  * Creates the background task (but doesn't start fetching)
@@ -30,4 +32,13 @@ void secondary_fetch_stop(void);
  */
 void secondary_fetch_refresh_now(void);
 
+/**
+ * Fetch one secondary slot now and feed the result through history,
+ * alerts, restart detection and analytics (no pacing delay)
+ * Used by the background task and by the host replay tool.
+ * @param slot Secondary slot (0 to secondary_count-1)
+ * @return Fetch result, ESP_ERR_INVALID_STATE if the slot has no server
+ */
+esp_err_t secondary_fetch_slot(int slot);
+
 #endif // SECONDARY_FETCH_H
@@ -13,32 +13,44 @@
 #include "events.h"
 #include "services/wifi_manager.h"
 #include "services/battlemetrics.h"
+#include "services/fleet.h"
 #include "services/history_store.h"
 #include "services/alert_manager.h"
 #include "services/restart_manager.h"
+#include "services/forecast.h"
+#include "services/anomaly_detector.h"
+#include "services/analytics_cache.h"
+#include "services/mqtt_publisher.h"
+#include "services/time_util.h"
+#include "services/trace.h"
 
 static const char *TAG = "server_query";
 
 static TaskHandle_t query_task_handle = NULL;
 static volatile bool task_running = false;
 
-void server_query_execute(void) {
+uint32_t server_query_execute(void) {
     app_state_t *state = app_state_get();
 
     if (!wifi_manager_is_connected()) {
         ESP_LOGW(TAG, "WiFi not connected, skipping query");
-        return;
+        return 0;
     }
 
-    if (state->settings.server_count == 0) return;
+    if (state->settings.server_count == 0) return 0;
 
     server_config_t *srv = app_state_get_active_server();
-    if (!srv) return;
+    if (!srv) return 0;
+
+    uint32_t trace_id = trace_cycle_begin();
 
     server_status_t status;
-    esp_err_t err = battlemetrics_query(srv->server_id, &status);
+    TRACE_BEGIN(sp_query, "bm_query");
+    esp_err_t err = fleet_query(srv->server_id, state->settings.refresh_interval_sec, &status);
+    TRACE_END(sp_query);
 
     if (err == ESP_OK && status.players >= 0) {
+        TRACE_BEGIN(sp_state, "state_update");
         // Update runtime state
         app_state_update_player_data(status.players, status.max_players,
                                       status.server_time, status.is_daytime,
@@ -50,6 +62,7 @@ void server_query_execute(void) {
         }
         if (strlen(status.ip_address) > 0) {
             strncpy(srv->ip_address, status.ip_address, sizeof(srv->ip_address) - 1);
+            srv->ip_address[sizeof(srv->ip_address) - 1] = '\0';
             srv->port = status.port;
         }
         // Store server rank
@@ -59,34 +72,57 @@ void server_query_execute(void) {
         time_t now;
         struct tm timeinfo;
         time(&now);
-        localtime_r(&now, &timeinfo);
+        time_util_to_tm((uint32_t)now, &timeinfo);
         snprintf(state->runtime.last_update, sizeof(state->runtime.last_update),
-                 "%02d:%02d:%02d CET", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec);
+                 "%02d:%02d:%02d %s", timeinfo.tm_hour, timeinfo.tm_min, timeinfo.tm_sec,
+                 time_util_zone_abbr((uint32_t)now));
 
         ESP_LOGI(TAG, "Players: %d/%d", status.players, status.max_players);
+        TRACE_END(sp_state);
 
         // Add to history
+        TRACE_BEGIN(sp_hist, "history_add");
         history_add_entry(status.players);
 
         // Track trend for main server
         app_state_add_main_trend_point(status.players);
+        TRACE_END(sp_hist);
+
+        TRACE_BEGIN(sp_analytics, "analytics");
+
+        // Evaluate alert rules for the active server
+        alert_process_sample(state->settings.active_server_index,
+                             status.players, status.max_players);
 
-        // Check for alerts
-        alert_check();
+        // Feed restart detection (drop to near zero / offline flag)
+        restart_process_sample(srv, status.players, status.online, (uint32_t)now);
 
-        // Check for server restart
-        restart_check_for_restart(srv, status.players);
+        // Update forecast model, then check the sample against its baseline
+        forecast_process_sample(state->settings.active_server_index, (uint32_t)now, status.players);
+        anomaly_process_sample(state->settings.active_server_index, (uint32_t)now,
+                               status.players, status.max_players);
+
+        // Refresh the comparison summary last, it reads the results above
+        analytics_cache_process_sample(state->settings.active_server_index, (uint32_t)now,
+                                       status.players, status.max_players, status.online);
+
+        // Queue for the broker (published from its own task)
+        mqtt_publisher_process_sample(state->settings.active_server_index, (uint32_t)now,
+                                      status.players, status.max_players);
+        TRACE_END(sp_analytics);
     } else {
         ESP_LOGE(TAG, "Query failed: %s", battlemetrics_get_last_error());
     }
+
+    trace_set_context(0);
+    return trace_id;
 }
 
 static void server_query_task(void *arg) {
     ESP_LOGI(TAG, "Server query background task started");
 
     // Initial fetch immediately
-    server_query_execute();
-    events_post_simple(EVT_DATA_UPDATED);
+    events_post_traced(EVT_DATA_UPDATED, server_query_execute());
 
     while (task_running) {
         app_state_t *state = app_state_get();
@@ -99,8 +135,7 @@ static void server_query_task(void *arg) {
 
         if (!task_running) break;
 
-        server_query_execute();
-        events_post_simple(EVT_DATA_UPDATED);
+        events_post_traced(EVT_DATA_UPDATED, server_query_execute());
     }
 
     ESP_LOGI(TAG, "Server query background task stopped");
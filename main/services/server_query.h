@@ -6,11 +6,14 @@
 #ifndef SERVER_QUERY_H
 #define SERVER_QUERY_H
 
+#include <stdint.h>
+
 /**
  * Query the active server status from BattleMetrics API
  * Updates app state, history, alerts, and restart tracking
+ * @return Trace ID of the fetch cycle (trace.h), 0 if skipped or tracing is off
  */
-void server_query_execute(void);
+uint32_t server_query_execute(void);
 
 /**
  * Start the background server query task
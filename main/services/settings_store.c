@@ -4,6 +4,8 @@
 
 #include "settings_store.h"
 #include "history_store.h"
+#include "restart_manager.h"
+#include "arena.h"
 #include "config.h"
 #include "drivers/sd_card.h"
 #include "nvs_keys.h"
@@ -120,17 +122,28 @@ esp_err_t settings_load(void) {
         NVS_KEY_SERVER(key_rcnt, i, NVS_SUFFIX_RCNT);
         nvs_get_u8(nvs, key_rcnt, &srv->restart_history.restart_count);
 
-        NVS_KEY_SERVER(key_ravg, i, NVS_SUFFIX_RAVG);
-        nvs_get_u32(nvs, key_ravg, &srv->restart_history.avg_interval_sec);
-
         NVS_KEY_SERVER(key_rlast, i, NVS_SUFFIX_RLAST);
         nvs_get_u32(nvs, key_rlast, &srv->restart_history.last_restart_time);
 
+        // Older firmware stored a smaller array sorted oldest-first; reading it
+        // into the ring with head = count gives the same ordering
         NVS_KEY_SERVER(key_rtimes, i, NVS_SUFFIX_RTIMES);
         len = sizeof(srv->restart_history.restart_times);
-        nvs_get_blob(nvs, key_rtimes, srv->restart_history.restart_times, &len);
+        if (nvs_get_blob(nvs, key_rtimes, srv->restart_history.restart_times, &len) != ESP_OK) {
+            len = 0;
+        }
+        if (srv->restart_history.restart_count > len / sizeof(uint32_t)) {
+            srv->restart_history.restart_count = len / sizeof(uint32_t);
+        }
+
+        NVS_KEY_SERVER(key_rhead, i, NVS_SUFFIX_RHEAD);
+        if (nvs_get_u8(nvs, key_rhead, &srv->restart_history.restart_head) != ESP_OK ||
+            srv->restart_history.restart_head >= MAX_RESTART_HISTORY) {
+            srv->restart_history.restart_head = srv->restart_history.restart_count % MAX_RESTART_HISTORY;
+        }
 
         srv->restart_history.last_known_players = -1;
+        srv->restart_history.schedule_valid = false;
 
         // Load manual restart schedule
         NVS_KEY_SERVER(key_rhr, i, NVS_SUFFIX_RHR);
@@ -225,19 +238,25 @@ esp_err_t settings_save(void) {
         NVS_KEY_SERVER(key_alen, i, NVS_SUFFIX_ALEN);
         nvs_set_u8(nvs, key_alen, srv->alerts_enabled ? 1 : 0);
 
-        // Save restart history
+        // Save restart history (restart_manager owns it - copy under its lock)
+        restart_history_t rh;
+        restart_snapshot(srv, &rh);
+
         NVS_KEY_SERVER(key_rcnt, i, NVS_SUFFIX_RCNT);
-        nvs_set_u8(nvs, key_rcnt, srv->restart_history.restart_count);
+        nvs_set_u8(nvs, key_rcnt, rh.restart_count);
 
-        NVS_KEY_SERVER(key_ravg, i, NVS_SUFFIX_RAVG);
-        nvs_set_u32(nvs, key_ravg, srv->restart_history.avg_interval_sec);
+        NVS_KEY_SERVER(key_rhead, i, NVS_SUFFIX_RHEAD);
+        nvs_set_u8(nvs, key_rhead, rh.restart_head);
 
         NVS_KEY_SERVER(key_rlast, i, NVS_SUFFIX_RLAST);
-        nvs_set_u32(nvs, key_rlast, srv->restart_history.last_restart_time);
+        nvs_set_u32(nvs, key_rlast, rh.last_restart_time);
 
         NVS_KEY_SERVER(key_rtimes, i, NVS_SUFFIX_RTIMES);
-        nvs_set_blob(nvs, key_rtimes, srv->restart_history.restart_times,
-                     sizeof(srv->restart_history.restart_times));
+        nvs_set_blob(nvs, key_rtimes, rh.restart_times, sizeof(rh.restart_times));
+
+        // Average interval is no longer stored (schedule is refitted from rtimes)
+        NVS_KEY_SERVER(key_ravg, i, NVS_SUFFIX_RAVG);
+        nvs_erase_key(nvs, key_ravg);
 
         // Save manual restart schedule
         NVS_KEY_SERVER(key_rhr, i, NVS_SUFFIX_RHR);
@@ -400,6 +419,41 @@ esp_err_t settings_save_restart_schedule(int server_index, uint8_t hour,
     return settings_save();
 }
 
+esp_err_t settings_save_restart_history(int server_index) {
+    app_state_t *state = app_state_get();
+
+    if (server_index < 0 || server_index >= state->settings.server_count) {
+        return ESP_ERR_INVALID_ARG;
+    }
+
+    nvs_handle_t nvs;
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for restart save: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    // restart_manager owns the ring - copy it under its lock, not the state lock
+    restart_history_t rh;
+    restart_snapshot(&state->settings.servers[server_index], &rh);
+
+    NVS_KEY_SERVER(key_rcnt, server_index, NVS_SUFFIX_RCNT);
+    nvs_set_u8(nvs, key_rcnt, rh.restart_count);
+
+    NVS_KEY_SERVER(key_rhead, server_index, NVS_SUFFIX_RHEAD);
+    nvs_set_u8(nvs, key_rhead, rh.restart_head);
+
+    NVS_KEY_SERVER(key_rlast, server_index, NVS_SUFFIX_RLAST);
+    nvs_set_u32(nvs, key_rlast, rh.last_restart_time);
+
+    NVS_KEY_SERVER(key_rtimes, server_index, NVS_SUFFIX_RTIMES);
+    nvs_set_blob(nvs, key_rtimes, rh.restart_times, sizeof(rh.restart_times));
+
+    err = nvs_commit(nvs);
+    nvs_close(nvs);
+    return err;
+}
+
 // ============== MULTI-WIFI CREDENTIALS ==============
 
 esp_err_t settings_load_wifi_credentials(void) {
@@ -452,6 +506,14 @@ esp_err_t settings_load_wifi_credentials(void) {
 
         len = sizeof(state->wifi_multi.credentials[i].password);
         nvs_get_str(nvs, key_pass, state->wifi_multi.credentials[i].password, &len);
+
+        // Connection cache is optional - discard on size mismatch
+        NVS_KEY_WIFI(key_cache, i, "cache");
+        wifi_conn_cache_t *cache = &state->wifi_multi.credentials[i].cache;
+        len = sizeof(*cache);
+        if (nvs_get_blob(nvs, key_cache, cache, &len) != ESP_OK || len != sizeof(*cache)) {
+            memset(cache, 0, sizeof(*cache));
+        }
     }
 
     app_state_unlock();
@@ -482,16 +544,22 @@ esp_err_t settings_save_wifi_credentials(void) {
         NVS_KEY_WIFI(key_ssid, i, "ssid");
         NVS_KEY_WIFI(key_pass, i, "pass");
 
+        NVS_KEY_WIFI(key_cache, i, "cache");
+
         nvs_set_str(nvs, key_ssid, state->wifi_multi.credentials[i].ssid);
         nvs_set_str(nvs, key_pass, state->wifi_multi.credentials[i].password);
+        nvs_set_blob(nvs, key_cache, &state->wifi_multi.credentials[i].cache,
+                     sizeof(wifi_conn_cache_t));
     }
 
     // Clear any old slots beyond current count
     for (int i = state->wifi_multi.count; i < MAX_WIFI_CREDENTIALS; i++) {
         NVS_KEY_WIFI(key_ssid, i, "ssid");
         NVS_KEY_WIFI(key_pass, i, "pass");
+        NVS_KEY_WIFI(key_cache, i, "cache");
         nvs_erase_key(nvs, key_ssid);
         nvs_erase_key(nvs, key_pass);
+        nvs_erase_key(nvs, key_cache);
     }
 
     app_state_unlock();
@@ -503,6 +571,34 @@ esp_err_t settings_save_wifi_credentials(void) {
     return ESP_OK;
 }
 
+esp_err_t settings_save_wifi_cache(void) {
+    app_state_t *state = app_state_get();
+    nvs_handle_t nvs;
+
+    esp_err_t err = nvs_open(NVS_NAMESPACE, NVS_READWRITE, &nvs);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Failed to open NVS for WiFi cache save: %s", esp_err_to_name(err));
+        return err;
+    }
+
+    if (!app_state_lock(100)) {
+        nvs_close(nvs);
+        return ESP_ERR_TIMEOUT;
+    }
+
+    for (int i = 0; i < state->wifi_multi.count; i++) {
+        NVS_KEY_WIFI(key_cache, i, "cache");
+        nvs_set_blob(nvs, key_cache, &state->wifi_multi.credentials[i].cache,
+                     sizeof(wifi_conn_cache_t));
+    }
+
+    app_state_unlock();
+
+    nvs_commit(nvs);
+    nvs_close(nvs);
+    return ESP_OK;
+}
+
 int settings_add_wifi_credential(const char *ssid, const char *password) {
     if (!ssid || strlen(ssid) == 0) return -1;
 
@@ -536,6 +632,7 @@ int settings_add_wifi_credential(const char *ssid, const char *password) {
     strncpy(state->wifi_multi.credentials[idx].password, password ? password : "",
             sizeof(state->wifi_multi.credentials[idx].password) - 1);
     state->wifi_multi.credentials[idx].password[sizeof(state->wifi_multi.credentials[idx].password) - 1] = '\0';
+    memset(&state->wifi_multi.credentials[idx].cache, 0, sizeof(wifi_conn_cache_t));
     state->wifi_multi.count++;
 
     app_state_unlock();
@@ -672,13 +769,13 @@ esp_err_t settings_export_to_json(void) {
     FILE *f = fopen(CONFIG_JSON_FILE, "w");
     if (!f) {
         ESP_LOGE(TAG, "Failed to open %s for writing", CONFIG_JSON_FILE);
-        free(json_str);
+        cJSON_free(json_str);
         return ESP_FAIL;
     }
 
     fputs(json_str, f);
     fclose(f);
-    free(json_str);
+    cJSON_free(json_str);
 
     ESP_LOGI(TAG, "Settings exported to %s", CONFIG_JSON_FILE);
     return ESP_OK;
@@ -711,7 +808,7 @@ esp_err_t settings_import_from_json(void) {
         return ESP_ERR_INVALID_SIZE;
     }
 
-    char *json_str = malloc(fsize + 1);
+    char *json_str = arena_alloc(ARENA_SCRATCH, fsize + 1, "config_import");
     if (!json_str) {
         fclose(f);
         return ESP_ERR_NO_MEM;
@@ -724,7 +821,7 @@ esp_err_t settings_import_from_json(void) {
 
     // Parse JSON
     cJSON *root = cJSON_Parse(json_str);
-    free(json_str);
+    arena_free(json_str);
 
     if (!root) {
         ESP_LOGE(TAG, "Failed to parse config JSON");
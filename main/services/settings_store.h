@@ -65,6 +65,14 @@ esp_err_t settings_save_restart_schedule(int server_index, uint8_t hour,
                                           uint8_t minute, uint8_t interval_hours,
                                           bool manual_enabled);
 
+/**
+ * Save only the detected restart history of one server
+ * Writes the restart keys of that server instead of the full settings.
+ * @param server_index Server index
+ * @return ESP_OK on success
+ */
+esp_err_t settings_save_restart_history(int server_index);
+
 /**
  * Initialize settings subsystem (call once at startup)
  */
@@ -83,6 +91,12 @@ esp_err_t settings_load_wifi_credentials(void);
  */
 esp_err_t settings_save_wifi_credentials(void);
 
+/**
+ * Save only the per-credential connection caches to NVS
+ * Cheaper than a full credential save; called after each successful connect.
+ */
+esp_err_t settings_save_wifi_cache(void);
+
 /**
  * Add or update a WiFi credential
  * If SSID already exists, updates the password. Otherwise adds new.
@@ -3,8 +3,10 @@
  */
 
 #include "storage_backend.h"
+#include "metrics.h"
 #include "drivers/sd_card.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 #include <stdio.h>
 #include <string.h>
 #include <sys/stat.h>
@@ -13,7 +15,7 @@
 
 static const char *TAG = "storage";
 
-storage_result_t storage_atomic_write(const char *path, const void *data, size_t len) {
+static storage_result_t atomic_write(const char *path, const void *data, size_t len) {
     if (!path || !data || len == 0) {
         return STORAGE_INVALID_PARAM;
     }
@@ -23,9 +25,11 @@ storage_result_t storage_atomic_write(const char *path, const void *data, size_t
     snprintf(tmp_path, sizeof(tmp_path), "%s.tmp", path);
 
     // Write to temp file
+    int64_t t_start = esp_timer_get_time();
     FILE *f = fopen(tmp_path, "wb");
     if (!f) {
         ESP_LOGE(TAG, "Failed to create temp file: %s (errno=%d)", tmp_path, errno);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
@@ -37,6 +41,7 @@ storage_result_t storage_atomic_write(const char *path, const void *data, size_t
     if (written != len) {
         ESP_LOGE(TAG, "Incomplete write: %d/%d bytes", (int)written, (int)len);
         remove(tmp_path);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
@@ -44,9 +49,11 @@ storage_result_t storage_atomic_write(const char *path, const void *data, size_t
     if (rename(tmp_path, path) != 0) {
         ESP_LOGE(TAG, "Failed to rename %s -> %s (errno=%d)", tmp_path, path, errno);
         remove(tmp_path);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
+    metrics_observe_since(METRIC_H_SD_OP, t_start);
     ESP_LOGD(TAG, "Atomic write: %s (%d bytes)", path, (int)len);
     return STORAGE_OK;
 }
@@ -58,14 +65,16 @@ storage_result_t storage_atomic_write_text(const char *path, const char *text) {
     return storage_atomic_write(path, text, strlen(text));
 }
 
-storage_result_t storage_append(const char *path, const void *data, size_t len) {
+static storage_result_t append_file(const char *path, const void *data, size_t len) {
     if (!path || !data || len == 0) {
         return STORAGE_INVALID_PARAM;
     }
 
+    int64_t t_start = esp_timer_get_time();
     FILE *f = fopen(path, "ab");
     if (!f) {
         ESP_LOGE(TAG, "Failed to open for append: %s (errno=%d)", path, errno);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
@@ -76,20 +85,24 @@ storage_result_t storage_append(const char *path, const void *data, size_t len)
 
     if (written != len) {
         ESP_LOGE(TAG, "Incomplete append: %d/%d bytes", (int)written, (int)len);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
+    metrics_observe_since(METRIC_H_SD_OP, t_start);
     return STORAGE_OK;
 }
 
-storage_result_t storage_append_line(const char *path, const char *line) {
+static storage_result_t append_line(const char *path, const char *line) {
     if (!path || !line) {
         return STORAGE_INVALID_PARAM;
     }
 
+    int64_t t_start = esp_timer_get_time();
     FILE *f = fopen(path, "a");
     if (!f) {
         ESP_LOGE(TAG, "Failed to open for append: %s (errno=%d)", path, errno);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
@@ -100,23 +113,27 @@ storage_result_t storage_append_line(const char *path, const char *line) {
 
     if (ret < 0) {
         ESP_LOGE(TAG, "Failed to write line to: %s", path);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
+    metrics_observe_since(METRIC_H_SD_OP, t_start);
     return STORAGE_OK;
 }
 
-storage_result_t storage_read(const char *path, void *data, size_t max_len, size_t *actual_len) {
+static storage_result_t read_file(const char *path, void *data, size_t max_len, size_t *actual_len) {
     if (!path || !data || max_len == 0) {
         return STORAGE_INVALID_PARAM;
     }
 
+    int64_t t_start = esp_timer_get_time();
     FILE *f = fopen(path, "rb");
     if (!f) {
         if (errno == ENOENT) {
             return STORAGE_NOT_FOUND;
         }
         ESP_LOGE(TAG, "Failed to open for read: %s (errno=%d)", path, errno);
+        metrics_count(METRIC_CNT_SD_ERRORS);
         return STORAGE_FAIL;
     }
 
@@ -127,6 +144,7 @@ storage_result_t storage_read(const char *path, void *data, size_t max_len, size
         *actual_len = read_len;
     }
 
+    metrics_observe_since(METRIC_H_SD_OP, t_start);
     return STORAGE_OK;
 }
 
@@ -144,7 +162,7 @@ bool storage_dir_exists(const char *path) {
     return (stat(path, &st) == 0 && S_ISDIR(st.st_mode));
 }
 
-storage_result_t storage_mkdir_p(const char *path) {
+static storage_result_t mkdir_p(const char *path) {
     if (!path) {
         return STORAGE_INVALID_PARAM;
     }
@@ -192,7 +210,7 @@ storage_result_t storage_mkdir_p(const char *path) {
     return STORAGE_OK;
 }
 
-storage_result_t storage_delete(const char *path) {
+static storage_result_t delete_file(const char *path) {
     if (!path) {
         return STORAGE_INVALID_PARAM;
     }
@@ -225,3 +243,77 @@ storage_result_t storage_get_size(const char *path, size_t *size) {
     *size = (size_t)st.st_size;
     return STORAGE_OK;
 }
+
+static storage_result_t rotate_file(const char *path, const char *old_path, size_t max_bytes) {
+    if (!path || !old_path) {
+        return STORAGE_INVALID_PARAM;
+    }
+
+    size_t size = 0;
+    if (storage_get_size(path, &size) != STORAGE_OK || size < max_bytes) {
+        return STORAGE_OK;
+    }
+
+    remove(old_path);
+    if (rename(path, old_path) != 0) {
+        ESP_LOGW(TAG, "Failed to rotate %s (errno=%d)", path, errno);
+        remove(path);
+        return STORAGE_FAIL;
+    }
+
+    ESP_LOGI(TAG, "Rotated %s (%d bytes)", path, (int)size);
+    return STORAGE_OK;
+}
+
+// ============== SD LEASE ==============
+// Public entry points hold a lease for the whole operation, so the card
+// cannot be unmounted between open and close (sd_card_lease)
+
+storage_result_t storage_atomic_write(const char *path, const void *data, size_t len) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = atomic_write(path, data, len);
+    sd_card_release();
+    return ret;
+}
+
+storage_result_t storage_append(const char *path, const void *data, size_t len) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = append_file(path, data, len);
+    sd_card_release();
+    return ret;
+}
+
+storage_result_t storage_append_line(const char *path, const char *line) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = append_line(path, line);
+    sd_card_release();
+    return ret;
+}
+
+storage_result_t storage_read(const char *path, void *data, size_t max_len, size_t *actual_len) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = read_file(path, data, max_len, actual_len);
+    sd_card_release();
+    return ret;
+}
+
+storage_result_t storage_mkdir_p(const char *path) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = mkdir_p(path);
+    sd_card_release();
+    return ret;
+}
+
+storage_result_t storage_delete(const char *path) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = delete_file(path);
+    sd_card_release();
+    return ret;
+}
+
+storage_result_t storage_rotate(const char *path, const char *old_path, size_t max_bytes) {
+    if (!sd_card_lease()) return STORAGE_FAIL;
+    storage_result_t ret = rotate_file(path, old_path, max_bytes);
+    sd_card_release();
+    return ret;
+}
@@ -101,4 +101,13 @@ storage_result_t storage_delete(const char *path);
  */
 storage_result_t storage_get_size(const char *path, size_t *size);
 
+/**
+ * Move a log file aside once it reaches max_bytes (one old generation kept)
+ * @param path Log file path
+ * @param old_path Previous generation path (replaced)
+ * @param max_bytes Size that triggers rotation
+ * @return STORAGE_OK if rotated or still below max_bytes
+ */
+storage_result_t storage_rotate(const char *path, const char *old_path, size_t max_bytes);
+
 #endif // STORAGE_BACKEND_H
@@ -11,29 +11,44 @@
 #define SD_VERIFY_FAIL_THRESHOLD    3       // Consecutive failures before marking unmounted
 #define SD_MAX_TRANSFER_SIZE        4000    // SPI transfer size
 #define SD_MAX_OPEN_FILES           5       // Maximum concurrent open files
+#define SD_LEASE_DRAIN_MS           5000    // Wait for SD users before lending the card out
 #define SD_ALLOCATION_UNIT_SIZE     (16 * 1024)  // FAT allocation unit
 
 // ============== NVS CONFIGURATION ==============
 #define NVS_SAVE_INTERVAL           3       // Save to NVS every N history entries
 #define NVS_KEY_MAX_LEN             15      // NVS key max length (ESP-IDF limit)
-#define NVS_HISTORY_MAX_ENTRIES     500     // Max history entries in NVS backup
+#define NVS_HISTORY_MAX_ENTRIES     1000    // Max history entries in NVS backup (~4KB packed)
 
 // ============== PATH CONFIGURATION ==============
 #define STORAGE_PATH_MAX_LEN        128     // Maximum path length
 #define STORAGE_FILENAME_MAX_LEN    64      // Maximum filename length
 #define STORAGE_DATE_STR_LEN        12      // "YYYY-MM-DD" + null
 
-// Path prefixes and directories
+// Path prefixes and directories (host builds point the mount at a local directory)
+#ifndef SD_MOUNT_POINT
 #define SD_MOUNT_POINT              "/sdcard"
-#define STORAGE_HISTORY_JSON_DIR    "/sdcard/history"
-#define STORAGE_HISTORY_BIN_PREFIX  "/sdcard/hist_"
-#define STORAGE_CONFIG_JSON_FILE    "/sdcard/servers.json"
+#endif
+#define STORAGE_HISTORY_JSON_DIR    SD_MOUNT_POINT "/history"
+#define STORAGE_HISTORY_BIN_PREFIX  SD_MOUNT_POINT "/hist_"
+#define STORAGE_CONFIG_JSON_FILE    SD_MOUNT_POINT "/servers.json"
+#define STORAGE_ANALYTICS_FILE      SD_MOUNT_POINT "/analytics.bin"
+#define STORAGE_METRICS_FILE        SD_MOUNT_POINT "/metrics.jsonl"
+#define STORAGE_METRICS_FILE_OLD    SD_MOUNT_POINT "/metrics.1.jsonl"
+#define STORAGE_PROFILE_FILE        SD_MOUNT_POINT "/profile.jsonl"
+#define STORAGE_PROFILE_FILE_OLD    SD_MOUNT_POINT "/profile.1.jsonl"
+#define STORAGE_REPLAY_DIR          SD_MOUNT_POINT "/replay"
+#define STORAGE_TRACE_FILE          SD_MOUNT_POINT "/trace.json"
+#define STORAGE_EXPORT_DIR          SD_MOUNT_POINT "/export"
 
 // ============== HISTORY STORAGE ==============
-#define STORAGE_HISTORY_FILE_MAGIC  0xDA120002  // Binary history file magic
+#define STORAGE_HISTORY_FILE_MAGIC  0xDA120003  // Binary history file magic (packed ring)
+#define STORAGE_HISTORY_FILE_MAGIC_V2 0xDA120002 // Pre-packed entry ring, migrated on load
+#define STORAGE_ANALYTICS_MAGIC     0xDA130001  // Analytics snapshot magic
 #define STORAGE_HISTORY_RETENTION   365         // Days to keep history
 #define STORAGE_JSON_VERSION        1           // JSON format version
 #define STORAGE_MAX_JSON_SIZE       32768       // 32KB max config file
+#define STORAGE_JOURNAL_MAX_LINES   2048        // JSON lines held while the SD is lent out (~48KB PSRAM)
+#define STORAGE_STREAM_BUF_SIZE     4096        // stdio buffer for sequential history reads
 
 // Minimum valid timestamp (Nov 2023 - for SNTP sync check)
 #define STORAGE_TIMESTAMP_MIN_VALID 1700000000
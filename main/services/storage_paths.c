@@ -5,9 +5,9 @@
 #include "storage_paths.h"
 #include "storage_config.h"
 #include "path_validator.h"
+#include "time_util.h"
 #include "config.h"
 #include <stdio.h>
-#include <time.h>
 
 void storage_path_history_bin(int server_idx, char *buf, size_t buf_size) {
     path_build_safe(buf, buf_size, "%s%d.bin", STORAGE_HISTORY_BIN_PREFIX, server_idx);
@@ -25,6 +25,46 @@ void storage_path_config(char *buf, size_t buf_size) {
     path_build_safe(buf, buf_size, "%s", STORAGE_CONFIG_JSON_FILE);
 }
 
+void storage_path_analytics(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_ANALYTICS_FILE);
+}
+
+void storage_path_metrics(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_METRICS_FILE);
+}
+
+void storage_path_metrics_old(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_METRICS_FILE_OLD);
+}
+
+void storage_path_profile(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_PROFILE_FILE);
+}
+
+void storage_path_profile_old(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_PROFILE_FILE_OLD);
+}
+
+void storage_path_replay(const char *date_str, char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s/%s.trc", STORAGE_REPLAY_DIR, date_str);
+}
+
+void storage_path_replay_dir(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_REPLAY_DIR);
+}
+
+void storage_path_trace(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_TRACE_FILE);
+}
+
+void storage_path_export(const char *name, char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s/%s", STORAGE_EXPORT_DIR, name);
+}
+
+void storage_path_export_dir(char *buf, size_t buf_size) {
+    path_build_safe(buf, buf_size, "%s", STORAGE_EXPORT_DIR);
+}
+
 void storage_path_history_root(char *buf, size_t buf_size) {
     path_build_safe(buf, buf_size, "%s", STORAGE_HISTORY_JSON_DIR);
 }
@@ -34,7 +74,5 @@ void storage_nvs_key(int server_idx, const char *suffix, char *key, size_t key_s
 }
 
 void storage_timestamp_to_date(uint32_t timestamp, char *buf, size_t buf_size) {
-    time_t t = (time_t)timestamp;
-    struct tm *tm_info = localtime(&t);
-    strftime(buf, buf_size, "%Y-%m-%d", tm_info);
+    time_util_format_date(timestamp, buf, buf_size);
 }
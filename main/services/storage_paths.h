@@ -41,6 +41,62 @@ void storage_path_history_json(int server_idx, const char *date_str, char *buf,
  */
 void storage_path_config(char *buf, size_t buf_size);
 
+/**
+ * Get path for the analytics cache snapshot file
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ */
+void storage_path_analytics(char *buf, size_t buf_size);
+
+/**
+ * Get path for the metrics snapshot log (current / previous generation)
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ */
+void storage_path_metrics(char *buf, size_t buf_size);
+void storage_path_metrics_old(char *buf, size_t buf_size);
+
+/**
+ * Get path for the task profiler log (current / previous generation)
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ */
+void storage_path_profile(char *buf, size_t buf_size);
+void storage_path_profile_old(char *buf, size_t buf_size);
+
+/**
+ * Get path for a daily field recorder trace
+ * @param date_str Date string (YYYY-MM-DD)
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ */
+void storage_path_replay(const char *date_str, char *buf, size_t buf_size);
+
+/**
+ * Get the field recorder trace directory
+ */
+void storage_path_replay_dir(char *buf, size_t buf_size);
+
+/**
+ * Get path for the Chrome trace export
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ */
+void storage_path_trace(char *buf, size_t buf_size);
+
+/**
+ * Get path for a history export file
+ * @param name File name within the export directory
+ * @param buf Output buffer
+ * @param buf_size Buffer size
+ */
+void storage_path_export(const char *name, char *buf, size_t buf_size);
+
+/**
+ * Get the history export directory
+ */
+void storage_path_export_dir(char *buf, size_t buf_size);
+
 /**
  * Get root history directory path
  * @param buf Output buffer
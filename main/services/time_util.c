@@ -0,0 +1,266 @@
+/**
+ * DayZ Server Tracker - Time Utilities Implementation
+ *
+ * One table entry per calendar year (UTC span) holds the offset at the
+ * start of the year and up to two transitions, found by probing weekly
+ * and bisecting to the second. Entries are built lazily on first use and
+ * published with an atomic state flag, so lookups from the fetch tasks
+ * and the UI never take a lock. Calendar math uses the days-from-civil
+ * algorithms (proleptic Gregorian), not the C library.
+ *
+ * No ESP-IDF dependencies: also built into the host tools.
+ */
+
+#include "time_util.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define TIME_UTIL_FIRST_YEAR    2020    // Cached range; other years use localtime_r
+#define TIME_UTIL_YEARS         48
+
+#define SECS_PER_DAY    86400
+#define PROBE_STEP_SEC  (7 * SECS_PER_DAY)
+
+enum {
+    YEAR_EMPTY = 0,
+    YEAR_BUILDING,
+    YEAR_READY,
+};
+
+// Offsets for one calendar year: off[i] applies from tr[i-1] on
+typedef struct {
+    uint32_t start;                 // UTC Jan 1 00:00 of the year
+    uint32_t end;                   // UTC Jan 1 00:00 of the next year
+    uint32_t tr[2];                 // Transition instants
+    int32_t off[3];                 // UTC offsets in seconds
+    uint8_t dst[3];                 // DST flag per segment
+    uint8_t n_tr;
+} tz_year_t;
+
+static tz_year_t s_years[TIME_UTIL_YEARS];
+static uint8_t s_state[TIME_UTIL_YEARS];
+
+// Days since 1970-01-01 for a proleptic Gregorian date (month 1-12)
+static int64_t days_from_civil(int64_t y, int m, int d) {
+    // Normalize month so callers can pass mon 0 or 13
+    y += (m - 1) / 12;
+    m = (m - 1) % 12 + 1;
+    if (m < 1) { m += 12; y--; }
+
+    y -= m <= 2;
+    int64_t era = (y >= 0 ? y : y - 399) / 400;
+    int64_t yoe = y - era * 400;
+    int64_t doy = (153 * (m + (m > 2 ? -3 : 9)) + 2) / 5 + d - 1;
+    int64_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;
+    return era * 146097 + doe - 719468;
+}
+
+static void civil_from_days(int64_t z, int *year, int *mon, int *mday) {
+    z += 719468;
+    int64_t era = (z >= 0 ? z : z - 146096) / 146097;
+    int64_t doe = z - era * 146097;
+    int64_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365;
+    int64_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);
+    int64_t mp = (5 * doy + 2) / 153;
+    int m = (int)(mp < 10 ? mp + 3 : mp - 9);
+    *year = (int)(yoe + era * 400 + (m <= 2));
+    *mon = m;
+    *mday = (int)(doy - (153 * mp + 2) / 5 + 1);
+}
+
+/**
+ * Ask the C library for the offset at one instant (slow path only)
+ */
+static int32_t probe_offset(uint32_t ts, uint8_t *dst) {
+    time_t t = (time_t)ts;
+    struct tm tm_buf;
+    localtime_r(&t, &tm_buf);
+
+    int64_t local = days_from_civil(tm_buf.tm_year + 1900, tm_buf.tm_mon + 1, tm_buf.tm_mday) * SECS_PER_DAY +
+                    tm_buf.tm_hour * 3600 + tm_buf.tm_min * 60 + tm_buf.tm_sec;
+    if (dst) *dst = tm_buf.tm_isdst > 0;
+    return (int32_t)(local - (int64_t)ts);
+}
+
+static void year_build(int year, tz_year_t *e) {
+    memset(e, 0, sizeof(*e));
+    e->start = (uint32_t)(days_from_civil(year, 1, 1) * SECS_PER_DAY);
+    e->end = (uint32_t)(days_from_civil(year + 1, 1, 1) * SECS_PER_DAY);
+    e->off[0] = probe_offset(e->start, &e->dst[0]);
+
+    uint32_t prev = e->start;
+    while (prev < e->end - 1) {
+        uint32_t t = prev + PROBE_STEP_SEC;
+        if (t >= e->end) t = e->end - 1;
+
+        uint8_t dst;
+        int32_t off = probe_offset(t, &dst);
+        if (off != e->off[e->n_tr] && e->n_tr < 2) {
+            // Bisect: lo has the old offset, hi the new one
+            uint32_t lo = prev, hi = t;
+            while (hi - lo > 1) {
+                uint32_t mid = lo + (hi - lo) / 2;
+                if (probe_offset(mid, NULL) == e->off[e->n_tr]) {
+                    lo = mid;
+                } else {
+                    hi = mid;
+                }
+            }
+            e->tr[e->n_tr] = hi;
+            e->n_tr++;
+            e->off[e->n_tr] = off;
+            e->dst[e->n_tr] = dst;
+        }
+        prev = t;
+    }
+}
+
+/**
+ * Year entry for a table slot, building it on first use
+ * A task that loses the race to publish uses its own copy in tmp.
+ */
+static const tz_year_t* year_get(int idx, tz_year_t *tmp) {
+    if (__atomic_load_n(&s_state[idx], __ATOMIC_ACQUIRE) == YEAR_READY) {
+        return &s_years[idx];
+    }
+
+    year_build(TIME_UTIL_FIRST_YEAR + idx, tmp);
+
+    uint8_t expected = YEAR_EMPTY;
+    if (__atomic_compare_exchange_n(&s_state[idx], &expected, YEAR_BUILDING, false,
+                                    __ATOMIC_ACQ_REL, __ATOMIC_ACQUIRE)) {
+        s_years[idx] = *tmp;
+        __atomic_store_n(&s_state[idx], YEAR_READY, __ATOMIC_RELEASE);
+    }
+    return tmp;
+}
+
+/**
+ * Offset and DST flag at an instant - table lookup on the hot path
+ */
+static int32_t offset_lookup(uint32_t ts, uint8_t *dst) {
+    // Average Gregorian year, off by at most one near Jan 1
+    int idx = (int)(1970 + ts / 31556952u) - TIME_UTIL_FIRST_YEAR;
+    tz_year_t tmp;
+    const tz_year_t *e = NULL;
+
+    for (int tries = 0; tries < 3; tries++) {
+        if (idx < 0 || idx >= TIME_UTIL_YEARS) {
+            return probe_offset(ts, dst);
+        }
+        e = year_get(idx, &tmp);
+        if (ts < e->start) {
+            idx--;
+        } else if (ts >= e->end) {
+            idx++;
+        } else {
+            break;
+        }
+    }
+
+    int seg = 0;
+    if (e->n_tr > 0 && ts >= e->tr[0]) seg = 1;
+    if (e->n_tr > 1 && ts >= e->tr[1]) seg = 2;
+    if (dst) *dst = e->dst[seg];
+    return e->off[seg];
+}
+
+void time_util_set_timezone(const char *tz) {
+    if (!tz) return;
+
+    setenv("TZ", tz, 1);
+    tzset();
+
+    // Only safe while no other task converts times (startup / settings apply)
+    for (int i = 0; i < TIME_UTIL_YEARS; i++) {
+        __atomic_store_n(&s_state[i], YEAR_EMPTY, __ATOMIC_RELEASE);
+    }
+}
+
+int32_t time_util_utc_offset(uint32_t ts) {
+    return offset_lookup(ts, NULL);
+}
+
+void time_util_bucket(uint32_t ts, uint8_t *wday, uint8_t *hour) {
+    int64_t local = (int64_t)ts + offset_lookup(ts, NULL);
+    int64_t days = local / SECS_PER_DAY;
+
+    // 1970-01-01 was a Thursday
+    if (wday) *wday = (uint8_t)((days + 4) % 7);
+    if (hour) *hour = (uint8_t)((local - days * SECS_PER_DAY) / 3600);
+}
+
+uint32_t time_util_time_of_day(uint32_t ts) {
+    int64_t local = (int64_t)ts + offset_lookup(ts, NULL);
+    return (uint32_t)(local % SECS_PER_DAY);
+}
+
+uint32_t time_util_day_start(uint32_t ts) {
+    int32_t off = offset_lookup(ts, NULL);
+    int64_t local_midnight = ((int64_t)ts + off) / SECS_PER_DAY * SECS_PER_DAY;
+
+    // A transition between midnight and ts changes the offset to use
+    int64_t start = local_midnight - off;
+    int32_t off_start = offset_lookup((uint32_t)start, NULL);
+    if (off_start != off) {
+        start = local_midnight - off_start;
+    }
+    return (uint32_t)start;
+}
+
+uint32_t time_util_local_to_utc(int year, int mon, int mday, uint32_t sec_of_day) {
+    int64_t local = days_from_civil(year, mon, mday) * SECS_PER_DAY + sec_of_day;
+
+    // Offsets before and after any transition near this local time
+    int32_t off_a = offset_lookup((uint32_t)(local - SECS_PER_DAY), NULL);
+    int32_t off_b = offset_lookup((uint32_t)(local + SECS_PER_DAY), NULL);
+    int64_t ta = local - off_a;
+    int64_t tb = local - off_b;
+    bool valid_a = offset_lookup((uint32_t)ta, NULL) == off_a;
+    bool valid_b = offset_lookup((uint32_t)tb, NULL) == off_b;
+
+    if (valid_a && valid_b) {
+        return (uint32_t)(ta < tb ? ta : tb);   // Repeated hour: first occurrence
+    }
+    if (valid_b) {
+        return (uint32_t)tb;
+    }
+    return (uint32_t)ta;                        // Valid, or skipped hour (moves forward)
+}
+
+void time_util_to_tm(uint32_t ts, struct tm *out) {
+    if (!out) return;
+
+    uint8_t dst = 0;
+    int64_t local = (int64_t)ts + offset_lookup(ts, &dst);
+    int64_t days = local / SECS_PER_DAY;
+    uint32_t sod = (uint32_t)(local - days * SECS_PER_DAY);
+
+    int year, mon, mday;
+    civil_from_days(days, &year, &mon, &mday);
+
+    memset(out, 0, sizeof(*out));
+    out->tm_year = year - 1900;
+    out->tm_mon = mon - 1;
+    out->tm_mday = mday;
+    out->tm_hour = sod / 3600;
+    out->tm_min = (sod / 60) % 60;
+    out->tm_sec = sod % 60;
+    out->tm_wday = (int)((days + 4) % 7);
+    out->tm_yday = (int)(days - days_from_civil(year, 1, 1));
+    out->tm_isdst = dst;
+}
+
+void time_util_format_date(uint32_t ts, char *buf, size_t buf_size) {
+    int64_t local = (int64_t)ts + offset_lookup(ts, NULL);
+    int year, mon, mday;
+    civil_from_days(local / SECS_PER_DAY, &year, &mon, &mday);
+    snprintf(buf, buf_size, "%04d-%02d-%02d", year, mon, mday);
+}
+
+const char* time_util_zone_abbr(uint32_t ts) {
+    uint8_t dst = 0;
+    offset_lookup(ts, &dst);
+    return tzname[dst ? 1 : 0];
+}
@@ -0,0 +1,91 @@
+/**
+ * DayZ Server Tracker - Time Utilities
+ * Cached UTC -> local time conversion for the configured time zone
+ *
+ * The UTC offset is piecewise constant with at most two DST transitions
+ * per year, so each year is probed once through the C library and stored
+ * as (transition, offset) pairs. Every later conversion is a table lookup
+ * plus integer arithmetic - no localtime_r/mktime per sample - which keeps
+ * bucketing of large sample sets cheap and correct across DST changes.
+ * Depends only on the C library, so host tools can link it too.
+ */
+
+#ifndef TIME_UTIL_H
+#define TIME_UTIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include <time.h>
+
+/**
+ * Apply a POSIX TZ rule (e.g. "CET-1CEST,M3.5.0,M10.5.0/3") and reset the cache
+ * Call at startup before anything converts timestamps; without it the
+ * C library's default zone is used.
+ * @param tz POSIX TZ string
+ */
+void time_util_set_timezone(const char *tz);
+
+/**
+ * Local UTC offset at a moment
+ * @param ts Unix timestamp
+ * @return Offset in seconds (local = UTC + offset)
+ */
+int32_t time_util_utc_offset(uint32_t ts);
+
+/**
+ * Weekday/hour bucket of a timestamp in local time
+ * @param ts Unix timestamp
+ * @param wday Output weekday (0 = Sunday, as tm_wday)
+ * @param hour Output hour (0-23)
+ */
+void time_util_bucket(uint32_t ts, uint8_t *wday, uint8_t *hour);
+
+/**
+ * Seconds since local midnight
+ * @param ts Unix timestamp
+ */
+uint32_t time_util_time_of_day(uint32_t ts);
+
+/**
+ * Start of the local day containing ts (DST-aware, day may be 23-25h)
+ * @param ts Unix timestamp
+ * @return Unix timestamp of local midnight
+ */
+uint32_t time_util_day_start(uint32_t ts);
+
+/**
+ * Convert local calendar time to a Unix timestamp (mktime replacement)
+ * Out-of-range fields are normalized (mday = 32 is the next month).
+ * Skipped local times (spring forward) move forward by the DST gap,
+ * repeated ones (fall back) resolve to the first occurrence.
+ * @param year Full year (e.g. 2025)
+ * @param mon Month 1-12
+ * @param mday Day of month
+ * @param sec_of_day Seconds since local midnight
+ * @return Unix timestamp
+ */
+uint32_t time_util_local_to_utc(int year, int mon, int mday, uint32_t sec_of_day);
+
+/**
+ * Break a timestamp into local time (localtime_r replacement)
+ * @param ts Unix timestamp
+ * @param out Output broken-down time
+ */
+void time_util_to_tm(uint32_t ts, struct tm *out);
+
+/**
+ * Format the local date of a timestamp as YYYY-MM-DD
+ * @param ts Unix timestamp
+ * @param buf Output buffer (at least 11 bytes)
+ * @param buf_size Buffer size
+ */
+void time_util_format_date(uint32_t ts, char *buf, size_t buf_size);
+
+/**
+ * Time zone abbreviation in effect at a moment (e.g. "CET" / "CEST")
+ * @param ts Unix timestamp
+ */
+const char* time_util_zone_abbr(uint32_t ts);
+
+#endif // TIME_UTIL_H
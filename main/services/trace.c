@@ -0,0 +1,202 @@
+/**
+ * DayZ Server Tracker - Latency Tracing Implementation
+ *
+ * Writers claim a ring slot with one atomic add and publish it by storing
+ * its sequence number last; the exporter copies a slot and keeps it only
+ * if the sequence is still the one it expects, so a span overwritten
+ * mid-copy is dropped rather than torn. No locks on the recording path.
+ */
+
+#include "trace.h"
+#include "metrics.h"
+#include "arena.h"
+#include "storage_backend.h"
+#include "storage_config.h"
+#include "storage_paths.h"
+#include "drivers/sd_card.h"
+#include "esp_log.h"
+#include "freertos/FreeRTOS.h"
+#include "freertos/task.h"
+#include <stdio.h>
+#include <string.h>
+
+static const char *TAG = "trace";
+
+#define CYCLE_SLOTS         8       // Open fetch cycles tracked at once
+#define EXPORT_MAX_TRACKS   16
+#define EXPORT_BYTES_PER_SPAN 128   // Upper bound of one JSON event line
+
+typedef struct {
+    uint32_t seq;                   // Ring index + 1 once written, 0 while writing
+    uint32_t id;
+    const char *name;
+    int64_t start_us;
+    uint32_t dur_us;
+    char track[TRACE_TRACK_LEN];
+} trace_event_t;
+
+static trace_event_t *s_ring = NULL;        // PSRAM, TRACE_RING_SIZE
+static uint32_t s_next = 0;                 // Next ring index (monotonic)
+static uint32_t s_next_id = 0;
+static uint32_t s_exported_next = 0;
+static int64_t s_last_export_us = 0;
+
+static struct {
+    uint32_t id;
+    int64_t start_us;
+} s_cycles[CYCLE_SLOTS];
+
+static __thread uint32_t s_context;
+
+void trace_init(void) {
+#if TRACE_ENABLED
+    if (s_ring) return;
+    s_ring = arena_calloc(ARENA_BULK, TRACE_RING_SIZE, sizeof(trace_event_t), "trace");
+    if (!s_ring) {
+        ESP_LOGW(TAG, "No memory for the span ring, tracing off");
+        return;
+    }
+    s_last_export_us = esp_timer_get_time();
+    ESP_LOGI(TAG, "Tracing on (%d spans, %d bytes PSRAM)",
+             TRACE_RING_SIZE, (int)(TRACE_RING_SIZE * sizeof(trace_event_t)));
+#endif
+}
+
+bool trace_is_enabled(void) {
+    return s_ring != NULL;
+}
+
+void trace_set_context(uint32_t id) {
+    s_context = id;
+}
+
+uint32_t trace_get_context(void) {
+    return s_context;
+}
+
+void trace_record(const char *name, uint32_t id, int64_t start_us, int64_t end_us,
+                  const char *track) {
+    if (!s_ring || !name) return;
+
+    uint32_t idx = __atomic_fetch_add(&s_next, 1, __ATOMIC_RELAXED);
+    trace_event_t *ev = &s_ring[idx % TRACE_RING_SIZE];
+
+    __atomic_store_n(&ev->seq, 0, __ATOMIC_RELAXED);
+    __atomic_thread_fence(__ATOMIC_RELEASE);
+    ev->id = id;
+    ev->name = name;
+    ev->start_us = start_us;
+    int64_t dur = end_us - start_us;
+    ev->dur_us = dur < 0 ? 0 : (dur > UINT32_MAX ? UINT32_MAX : (uint32_t)dur);
+    if (!track) track = pcTaskGetName(NULL);
+    strncpy(ev->track, track ? track : "?", sizeof(ev->track) - 1);
+    ev->track[sizeof(ev->track) - 1] = '\0';
+    __atomic_store_n(&ev->seq, idx + 1, __ATOMIC_RELEASE);
+}
+
+uint32_t trace_cycle_begin(void) {
+    if (!s_ring) return 0;
+
+    uint32_t id = __atomic_add_fetch(&s_next_id, 1, __ATOMIC_RELAXED);
+    if (id == 0) id = __atomic_add_fetch(&s_next_id, 1, __ATOMIC_RELAXED);
+
+    // Writers are the two fetch tasks; a stale slot only loses one e2e sample
+    int slot = id % CYCLE_SLOTS;
+    s_cycles[slot].start_us = esp_timer_get_time();
+    __atomic_store_n(&s_cycles[slot].id, id, __ATOMIC_RELEASE);
+
+    s_context = id;
+    return id;
+}
+
+void trace_cycle_end(uint32_t id) {
+    if (!s_ring || id == 0) return;
+
+    int slot = id % CYCLE_SLOTS;
+    uint32_t expected = id;
+    int64_t start = s_cycles[slot].start_us;
+    if (!__atomic_compare_exchange_n(&s_cycles[slot].id, &expected, 0, false,
+                                     __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+        return;
+    }
+
+    int64_t now = esp_timer_get_time();
+    trace_record("fetch_to_photon", id, start, now, "pipeline");
+    metrics_observe_since(METRIC_H_FETCH_E2E, start);
+}
+
+// ============== EXPORT ==============
+
+static int track_index(char tracks[][TRACE_TRACK_LEN], int *count, const char *track) {
+    for (int i = 0; i < *count; i++) {
+        if (strcmp(tracks[i], track) == 0) return i;
+    }
+    if (*count >= EXPORT_MAX_TRACKS) return EXPORT_MAX_TRACKS - 1;     // Last one shared
+    snprintf(tracks[*count], TRACE_TRACK_LEN, "%s", track);
+    return (*count)++;
+}
+
+int trace_export_to_sd(void) {
+    if (!s_ring || !sd_card_is_mounted()) return -1;
+
+    size_t cap = (size_t)TRACE_RING_SIZE * EXPORT_BYTES_PER_SPAN +
+                 EXPORT_MAX_TRACKS * EXPORT_BYTES_PER_SPAN + 128;
+    char *buf = arena_alloc(ARENA_SCRATCH, cap, "trace_export");
+    if (!buf) return -1;
+
+    static char tracks[EXPORT_MAX_TRACKS][TRACE_TRACK_LEN];
+    int n_tracks = 0;
+    int spans = 0;
+
+    uint32_t end = __atomic_load_n(&s_next, __ATOMIC_ACQUIRE);
+    uint32_t begin = end > TRACE_RING_SIZE ? end - TRACE_RING_SIZE : 0;
+
+    size_t len = (size_t)snprintf(buf, cap, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+    for (uint32_t idx = begin; idx != end; idx++) {
+        const trace_event_t *slot = &s_ring[idx % TRACE_RING_SIZE];
+        if (__atomic_load_n(&slot->seq, __ATOMIC_ACQUIRE) != idx + 1) continue;
+        trace_event_t ev = *slot;
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        if (__atomic_load_n(&slot->seq, __ATOMIC_RELAXED) != idx + 1) continue;   // Overwritten
+
+        int tid = track_index(tracks, &n_tracks, ev.track);
+        len += (size_t)snprintf(buf + len, cap - len,
+                                "%s{\"name\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lu,"
+                                "\"pid\":1,\"tid\":%d,\"args\":{\"trace\":%lu}}\n",
+                                spans ? "," : "", ev.name, (long long)ev.start_us,
+                                (unsigned long)ev.dur_us, tid, (unsigned long)ev.id);
+        spans++;
+        if (len >= cap - EXPORT_BYTES_PER_SPAN) break;
+    }
+
+    // Name the timelines after their tasks
+    for (int i = 0; i < n_tracks && len < cap - EXPORT_BYTES_PER_SPAN; i++) {
+        len += (size_t)snprintf(buf + len, cap - len,
+                                "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%d,"
+                                "\"args\":{\"name\":\"%s\"}}\n",
+                                (spans || i) ? "," : "", i, tracks[i]);
+    }
+    len += (size_t)snprintf(buf + len, cap - len, "]}\n");
+
+    char path[STORAGE_PATH_MAX_LEN];
+    storage_path_trace(path, sizeof(path));
+    storage_result_t res = storage_atomic_write(path, buf, len);
+    arena_free(buf);
+
+    s_exported_next = end;
+    if (res != STORAGE_OK) return -1;
+    ESP_LOGD(TAG, "Exported %d spans to %s", spans, path);
+    return spans;
+}
+
+void trace_tick(void) {
+    if (!s_ring) return;
+
+    int64_t now = esp_timer_get_time();
+    if (now - s_last_export_us < (int64_t)TRACE_EXPORT_INTERVAL_SEC * 1000000) return;
+    s_last_export_us = now;
+
+    // Nothing new since the last file - keep it
+    if (__atomic_load_n(&s_next, __ATOMIC_RELAXED) == s_exported_next) return;
+    trace_export_to_sd();
+}
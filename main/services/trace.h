@@ -0,0 +1,112 @@
+/**
+ * DayZ Server Tracker - Latency Tracing
+ * Spans along the fetch -> state -> event -> render pipeline
+ *
+ * A fetch cycle gets a trace ID (trace_cycle_begin). The ID follows the
+ * work as the calling task's trace context, rides in app_event_t to the
+ * main loop, and is handed to the display hook, which closes the cycle
+ * when the next LVGL refresh has drawn the update (trace_cycle_end).
+ * Each closed cycle adds a METRIC_H_FETCH_E2E sample ("network to
+ * photon").
+ *
+ * Spans go into a lock-free ring in PSRAM (one atomic add per span) and
+ * are written to /sdcard/trace.json in Chrome trace format every
+ * TRACE_EXPORT_INTERVAL_SEC - open it in chrome://tracing or Perfetto.
+ *
+ *   TRACE_BEGIN(sp, "history_add");
+ *   history_add_entry(players);
+ *   TRACE_END(sp);
+ *
+ * Span names must be string literals (the ring keeps the pointer).
+ * With TRACE_ENABLED 0 the macros compile to nothing.
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "config.h"
+#include "esp_timer.h"
+
+#define TRACE_TRACK_LEN     12      // Task name chars kept per span
+
+typedef struct {
+    const char *name;
+    uint32_t id;
+    int64_t start_us;               // 0 = tracing off when the span began
+} trace_span_t;
+
+/**
+ * Allocate the span ring (PSRAM). Call once at startup; until then all
+ * tracing calls are no-ops.
+ */
+void trace_init(void);
+
+/**
+ * @return true if spans are being recorded
+ */
+bool trace_is_enabled(void);
+
+/**
+ * Start a fetch cycle: new trace ID, made the calling task's context
+ * @return Trace ID (never 0 while enabled, 0 when off)
+ */
+uint32_t trace_cycle_begin(void);
+
+/**
+ * Close a cycle once its result is on screen
+ * Records the whole cycle on the "pipeline" track and a METRIC_H_FETCH_E2E
+ * sample. Unknown or already closed IDs are ignored.
+ */
+void trace_cycle_end(uint32_t id);
+
+/**
+ * Trace ID new spans on this task belong to (0 = none)
+ */
+void trace_set_context(uint32_t id);
+uint32_t trace_get_context(void);
+
+/**
+ * Record a finished span
+ * @param name String literal
+ * @param id Trace ID (0 = not part of a cycle)
+ * @param start_us esp_timer_get_time() at the start
+ * @param end_us esp_timer_get_time() at the end
+ * @param track Timeline to show it on, NULL = the calling task
+ */
+void trace_record(const char *name, uint32_t id, int64_t start_us, int64_t end_us,
+                  const char *track);
+
+static inline int64_t trace_now_us(void) {
+    return trace_is_enabled() ? esp_timer_get_time() : 0;
+}
+
+static inline void trace_span_end(const trace_span_t *span) {
+    if (span->start_us) {
+        trace_record(span->name, span->id, span->start_us, esp_timer_get_time(), NULL);
+    }
+}
+
+#if TRACE_ENABLED
+#define TRACE_BEGIN(span, name_) \
+    trace_span_t span = { (name_), trace_get_context(), trace_now_us() }
+#define TRACE_END(span)         trace_span_end(&(span))
+#else
+#define TRACE_BEGIN(span, name_) do { } while (0)
+#define TRACE_END(span)         do { } while (0)
+#endif
+
+/**
+ * Write the ring to the SD card as Chrome trace JSON (atomic replace)
+ * @return Number of spans written, -1 on failure
+ */
+int trace_export_to_sd(void);
+
+/**
+ * Periodic export every TRACE_EXPORT_INTERVAL_SEC. Call from the main loop.
+ */
+void trace_tick(void);
+
+#endif // TRACE_H
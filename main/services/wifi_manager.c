@@ -8,13 +8,18 @@
 #include "events.h"
 #include "services/settings_store.h"
 #include <string.h>
+#include <stdlib.h>
+#include <time.h>
 #include "freertos/FreeRTOS.h"
 #include "freertos/event_groups.h"
+#include "freertos/queue.h"
+#include "freertos/task.h"
 #include "esp_wifi.h"
 #include "esp_event.h"
 #include "esp_netif.h"
 #include "esp_sntp.h"
 #include "esp_log.h"
+#include "esp_timer.h"
 
 static const char *TAG = "wifi_manager";
 
@@ -25,111 +30,654 @@ static EventGroupHandle_t s_wifi_event_group = NULL;
 
 static bool sntp_initialized = false;
 static bool wifi_initialized = false;
+
+// ============== ROAMING STATE MACHINE ==============
+// All connection decisions run on a dedicated task. The system event loop
+// only forwards events into s_roam_queue, so IP/SNTP/HTTP events keep
+// flowing while a scan or candidate attempt is in progress.
+//
+// Each credential carries a persisted connection cache (last BSSID/channel,
+// success/failure counts). Reconnects first try the cached AP on its single
+// channel and only fall back to a full scan when that fails.
+
+typedef enum {
+    ROAM_IDLE = 0,          // Not started yet
+    ROAM_CONNECTED,         // Have an IP
+    ROAM_RECONNECTING,      // Fast retry of the current network
+    ROAM_SCANNING,          // Non-blocking scan for known networks
+    ROAM_CONNECTING,        // Trying candidates one by one
+    ROAM_BACKOFF            // All candidates failed, waiting to rescan
+} roam_state_t;
+
+typedef enum {
+    ROAM_MSG_STA_START,
+    ROAM_MSG_DISCONNECTED,
+    ROAM_MSG_GOT_IP,
+    ROAM_MSG_SCAN_DONE,
+    ROAM_MSG_AUTO_CONNECT,  // Pick the best known network
+    ROAM_MSG_CONNECT        // Connect to explicit credentials (user request)
+} roam_msg_type_t;
+
+typedef struct {
+    roam_msg_type_t type;
+    char ssid[33];          // DISCONNECTED: network that dropped, CONNECT: target
+    char password[65];      // CONNECT only
+} roam_msg_t;
+
+typedef struct {
+    int cred_idx;
+    int8_t rssi;
+    uint8_t bssid[6];
+    uint8_t channel;        // 0 = let the driver scan all channels
+    int score;              // Higher is better
+} roam_candidate_t;
+
+static QueueHandle_t s_roam_queue = NULL;
+static TaskHandle_t s_roam_task = NULL;
+static roam_state_t s_roam_state = ROAM_IDLE;
+static int64_t s_roam_deadline_ms = 0;     // 0 = no pending timeout
 static int s_reconnect_attempts = 0;
-static bool s_auto_connect_in_progress = false;
+static uint32_t s_backoff_ms = WIFI_ROAM_BACKOFF_MIN_MS;
+static roam_candidate_t s_candidates[MAX_WIFI_CREDENTIALS];
+static int s_candidate_count = 0;
+static int s_candidate_pos = 0;
+static bool s_candidates_cached = false;    // List built from cache, not a scan
+
+// Network currently being joined
+static char s_target_ssid[33] = {0};
+static char s_target_pass[65] = {0};
+static int s_target_idx = -1;               // Credential index (-1 = unsaved)
+static bool s_target_pinned = false;        // Config has BSSID/channel set
+
+static int64_t roam_now_ms(void) {
+    return esp_timer_get_time() / 1000;
+}
 
-static void wifi_event_handler(void *arg, esp_event_base_t event_base,
-                               int32_t event_id, void *event_data) {
-    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
-        esp_wifi_connect();
-    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
-        app_state_set_wifi_connected(false);
+static void roam_set_deadline(uint32_t timeout_ms) {
+    s_roam_deadline_ms = roam_now_ms() + timeout_ms;
+}
 
-        if (s_wifi_event_group) {
-            xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+static bool roam_post(const roam_msg_t *msg) {
+    if (!s_roam_queue) return false;
+    if (xQueueSend(s_roam_queue, msg, 0) != pdTRUE) {
+        ESP_LOGW(TAG, "Roam queue full, dropping msg %d", msg->type);
+        return false;
+    }
+    return true;
+}
+
+// ============== CONNECTION CACHE ==============
+
+static bool cache_is_usable(const wifi_conn_cache_t *c) {
+    if (c->channel == 0) return false;
+    if (c->consecutive_fails >= WIFI_CACHE_MAX_CONSECUTIVE_FAILS) return false;
+
+    // Only judge age when the clock is valid (not right after a cold boot)
+    time_t now = time(NULL);
+    if (now >= STORAGE_TIMESTAMP_MIN_VALID && c->last_success >= STORAGE_TIMESTAMP_MIN_VALID &&
+        now - (time_t)c->last_success > WIFI_CACHE_MAX_AGE_SEC) {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Rank a credential: historical success ratio dominates, signal strength
+ * breaks ties, and a run of recent failures pushes it down the list.
+ */
+static int cache_score(const wifi_conn_cache_t *c, int8_t rssi) {
+    uint32_t total = (uint32_t)c->success_count + c->fail_count;
+    int reliability = (int)(((uint32_t)c->success_count + 1) * 100 / (total + 2));  // 0-100
+    int signal = rssi + 100;
+    if (signal < 0) signal = 0;
+    if (signal > 70) signal = 70;
+    return reliability * 2 + signal - c->consecutive_fails * 20;
+}
+
+// Halve counters so old history does not outweigh recent behaviour
+static void cache_age_counts(wifi_conn_cache_t *c) {
+    if ((uint32_t)c->success_count + c->fail_count > WIFI_CACHE_COUNT_LIMIT) {
+        c->success_count /= 2;
+        c->fail_count /= 2;
+    }
+}
+
+static void cache_record_failure(int cred_idx) {
+    if (cred_idx < 0) return;
+    app_state_t *state = app_state_get();
+    if (!app_state_lock(100)) return;
+
+    if (cred_idx < state->wifi_multi.count) {
+        wifi_conn_cache_t *c = &state->wifi_multi.credentials[cred_idx].cache;
+        if (c->fail_count < UINT16_MAX) c->fail_count++;
+        if (c->consecutive_fails < UINT8_MAX) c->consecutive_fails++;
+        cache_age_counts(c);
+    }
+
+    app_state_unlock();
+    // Persisted together with the next success to spare flash writes
+}
+
+static void cache_record_success(int cred_idx, const wifi_ap_record_t *ap) {
+    if (cred_idx < 0) return;
+    app_state_t *state = app_state_get();
+    if (!app_state_lock(100)) return;
+
+    if (cred_idx < state->wifi_multi.count) {
+        wifi_conn_cache_t *c = &state->wifi_multi.credentials[cred_idx].cache;
+        memcpy(c->bssid, ap->bssid, sizeof(c->bssid));
+        c->channel = ap->primary;
+        c->rssi = ap->rssi;
+        time_t now = time(NULL);
+        if (now >= STORAGE_TIMESTAMP_MIN_VALID) {
+            c->last_success = (uint32_t)now;
         }
+        if (c->success_count < UINT16_MAX) c->success_count++;
+        c->consecutive_fails = 0;
+        cache_age_counts(c);
+    }
 
-        // Don't auto-reconnect during auto_connect sequence (we manage that ourselves)
-        if (s_auto_connect_in_progress) {
-            return;
+    app_state_unlock();
+    settings_save_wifi_cache();
+}
+
+static void roam_sort_candidates(void) {
+    // Insertion sort - at most MAX_WIFI_CREDENTIALS entries
+    for (int i = 1; i < s_candidate_count; i++) {
+        roam_candidate_t tmp = s_candidates[i];
+        int j = i - 1;
+        while (j >= 0 && s_candidates[j].score < tmp.score) {
+            s_candidates[j + 1] = s_candidates[j];
+            j--;
         }
+        s_candidates[j + 1] = tmp;
+    }
+}
+
+/**
+ * Build the candidate list from cached APs, most reliable first.
+ * @return Number of candidates
+ */
+static int roam_build_cached_candidates(void) {
+    app_state_t *state = app_state_get();
 
-        s_reconnect_attempts++;
-        ESP_LOGI(TAG, "Disconnected (attempt %d/%d)", s_reconnect_attempts, WIFI_RECONNECT_SCAN_THRESHOLD);
+    s_candidate_count = 0;
+    s_candidate_pos = 0;
+    s_candidates_cached = true;
 
-        if (s_reconnect_attempts < WIFI_RECONNECT_SCAN_THRESHOLD) {
-            // Fast retry same SSID for transient drops
-            esp_wifi_connect();
-        } else {
-            // Too many failures - try auto-connect to other known networks
-            ESP_LOGI(TAG, "Reconnect threshold reached, starting auto-connect...");
-            wifi_manager_auto_connect();
+    if (!app_state_lock(100)) return 0;
+
+    for (int i = 0; i < state->wifi_multi.count; i++) {
+        const wifi_conn_cache_t *c = &state->wifi_multi.credentials[i].cache;
+        if (!cache_is_usable(c)) continue;
+
+        roam_candidate_t *cand = &s_candidates[s_candidate_count++];
+        cand->cred_idx = i;
+        cand->rssi = c->rssi;
+        memcpy(cand->bssid, c->bssid, sizeof(cand->bssid));
+        cand->channel = c->channel;
+        cand->score = cache_score(c, c->rssi);
+    }
+
+    app_state_unlock();
+
+    roam_sort_candidates();
+    if (s_candidate_count > WIFI_ROAM_PINNED_MAX_TRIES) {
+        s_candidate_count = WIFI_ROAM_PINNED_MAX_TRIES;
+    }
+    return s_candidate_count;
+}
+
+// ============== ROAM ACTIONS ==============
+
+/**
+ * Apply STA credentials and start connecting (roam task only)
+ * @param bssid AP to pin to, or NULL to let the driver pick
+ * @param channel Channel to probe, or 0 for a full-channel scan
+ */
+static void roam_apply_credentials(const char *ssid, const char *password,
+                                   const uint8_t *bssid, uint8_t channel) {
+    wifi_config_t wifi_config = {0};
+    strncpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid) - 1);
+    strncpy((char *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
+    // Use WPA/WPA2 mixed threshold for broader compatibility
+    wifi_config.sta.threshold.authmode = (password && strlen(password) > 0)
+        ? WIFI_AUTH_WPA_WPA2_PSK : WIFI_AUTH_OPEN;
+
+    if (bssid && channel > 0) {
+        // Single-channel probe straight to the known AP
+        wifi_config.sta.bssid_set = true;
+        memcpy(wifi_config.sta.bssid, bssid, sizeof(wifi_config.sta.bssid));
+        wifi_config.sta.channel = channel;
+    }
+    s_target_pinned = (bssid && channel > 0);
+
+    if (ssid != s_target_ssid) {
+        strncpy(s_target_ssid, ssid, sizeof(s_target_ssid) - 1);
+        s_target_ssid[sizeof(s_target_ssid) - 1] = '\0';
+    }
+    if (password != s_target_pass) {
+        strncpy(s_target_pass, password, sizeof(s_target_pass) - 1);
+        s_target_pass[sizeof(s_target_pass) - 1] = '\0';
+    }
+
+    esp_wifi_disconnect();
+    esp_err_t err = esp_wifi_set_config(WIFI_IF_STA, &wifi_config);
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "set_config failed: %s", esp_err_to_name(err));
+    }
+    esp_wifi_connect();
+}
+
+/**
+ * Retry the target network. A pinned attempt uses the cached BSSID/channel
+ * (hundreds of ms); an unpinned one lets the driver scan every channel.
+ */
+static void roam_reconnect_target(bool try_pinned) {
+    app_state_t *state = app_state_get();
+    wifi_conn_cache_t cache = {0};
+    bool have_cache = false;
+
+    s_target_idx = settings_find_wifi_credential(s_target_ssid);
+    if (try_pinned && s_target_idx >= 0 && app_state_lock(100)) {
+        if (s_target_idx < state->wifi_multi.count) {
+            cache = state->wifi_multi.credentials[s_target_idx].cache;
+            have_cache = cache_is_usable(&cache);
         }
-    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE) {
-        // WiFi scan completed - process results
-        app_state_t *state = app_state_get();
-        uint16_t ap_count = 0;
-        esp_wifi_scan_get_ap_num(&ap_count);
+        app_state_unlock();
+    }
+
+    s_roam_state = ROAM_RECONNECTING;
+
+    if (have_cache) {
+        ESP_LOGI(TAG, "Fast reconnect to %s on ch %d", s_target_ssid, cache.channel);
+        roam_apply_credentials(s_target_ssid, s_target_pass, cache.bssid, cache.channel);
+        roam_set_deadline(WIFI_ROAM_PINNED_TIMEOUT_MS);
+    } else if (s_target_pinned) {
+        // Drop the stale BSSID/channel pin before a full retry
+        roam_apply_credentials(s_target_ssid, s_target_pass, NULL, 0);
+        roam_set_deadline(WIFI_ROAM_CANDIDATE_TIMEOUT_MS);
+    } else {
+        esp_wifi_connect();
+        roam_set_deadline(WIFI_ROAM_CANDIDATE_TIMEOUT_MS);
+    }
+}
+
+static void roam_enter_backoff(void) {
+    ESP_LOGW(TAG, "Roam: no usable network, rescanning in %lu ms", (unsigned long)s_backoff_ms);
+    s_roam_state = ROAM_BACKOFF;
+    roam_set_deadline(s_backoff_ms);
+    s_backoff_ms *= 2;
+    if (s_backoff_ms > WIFI_ROAM_BACKOFF_MAX_MS) {
+        s_backoff_ms = WIFI_ROAM_BACKOFF_MAX_MS;
+    }
+}
+
+static void roam_start_scan(void) {
+    app_state_t *state = app_state_get();
+
+    if (state->wifi_multi.count == 0) {
+        ESP_LOGW(TAG, "No saved WiFi credentials for auto-connect");
+        s_roam_state = ROAM_IDLE;
+        s_roam_deadline_ms = 0;
+        return;
+    }
+
+    // Abort any pending association so the radio is free to scan
+    esp_wifi_disconnect();
+
+    wifi_scan_config_t scan_config = {
+        .ssid = NULL,
+        .bssid = NULL,
+        .channel = 0,
+        .show_hidden = false,
+        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
+        .scan_time.active.min = 50,
+        .scan_time.active.max = 120,
+    };
+
+    esp_err_t err = esp_wifi_scan_start(&scan_config, false);  // Non-blocking
+    if (err != ESP_OK) {
+        ESP_LOGE(TAG, "Roam scan start failed: %s", esp_err_to_name(err));
+        roam_enter_backoff();
+        return;
+    }
+
+    ESP_LOGI(TAG, "Roam: scanning for known networks...");
+    s_roam_state = ROAM_SCANNING;
+    roam_set_deadline(WIFI_ROAM_SCAN_TIMEOUT_MS);
+}
+
+// Try the next candidate; cached list falls back to a scan, scan list to backoff
+static void roam_try_next_candidate(void) {
+    app_state_t *state = app_state_get();
 
-        if (ap_count > WIFI_SCAN_MAX_RESULTS) {
-            ap_count = WIFI_SCAN_MAX_RESULTS;
+    while (s_candidate_pos < s_candidate_count) {
+        roam_candidate_t *c = &s_candidates[s_candidate_pos];
+
+        char ssid[33];
+        char password[65];
+        if (!app_state_lock(100)) continue;     // Busy - retry the same candidate
+        s_candidate_pos++;
+        if (c->cred_idx >= state->wifi_multi.count) {
+            app_state_unlock();
+            continue;   // Credential deleted since the list was built
         }
+        strncpy(ssid, state->wifi_multi.credentials[c->cred_idx].ssid, sizeof(ssid) - 1);
+        ssid[sizeof(ssid) - 1] = '\0';
+        strncpy(password, state->wifi_multi.credentials[c->cred_idx].password, sizeof(password) - 1);
+        password[sizeof(password) - 1] = '\0';
+        app_state_unlock();
+
+        ESP_LOGI(TAG, "Roam: trying credential #%d %s (ch %d, RSSI: %d, score %d)",
+                 c->cred_idx, ssid, c->channel, c->rssi, c->score);
+        s_target_idx = c->cred_idx;
+        roam_apply_credentials(ssid, password, c->bssid, c->channel);
+        s_roam_state = ROAM_CONNECTING;
+        roam_set_deadline(s_candidates_cached ? WIFI_ROAM_PINNED_TIMEOUT_MS
+                                              : WIFI_ROAM_CANDIDATE_TIMEOUT_MS);
+        return;
+    }
+
+    if (s_candidates_cached) {
+        ESP_LOGI(TAG, "Roam: cached networks failed, full scan");
+        roam_start_scan();
+    } else {
+        roam_enter_backoff();
+    }
+}
 
-        wifi_ap_record_t *ap_records = malloc(sizeof(wifi_ap_record_t) * ap_count);
+// Cached APs first, full scan only if none are usable
+static void roam_start_roaming(void) {
+    if (roam_build_cached_candidates() > 0) {
+        roam_try_next_candidate();
+    } else {
+        roam_start_scan();
+    }
+}
+
+// Read scan results once: publish them for the UI and, when the scan was
+// the roam's own (ROAM_SCANNING), rank known networks as connection
+// candidates. A UI scan mid-roam leaves the list being walked alone.
+static void roam_process_scan_results(void) {
+    bool rank = (s_roam_state == ROAM_SCANNING);
+    app_state_t *state = app_state_get();
+    uint16_t ap_count = 0;
+    esp_wifi_scan_get_ap_num(&ap_count);
+
+    if (ap_count > WIFI_SCAN_MAX_RESULTS) {
+        ap_count = WIFI_SCAN_MAX_RESULTS;
+    }
+
+    wifi_ap_record_t *ap_records = NULL;
+    if (ap_count > 0) {
+        ap_records = malloc(sizeof(wifi_ap_record_t) * ap_count);
         if (ap_records) {
             esp_wifi_scan_get_ap_records(&ap_count, ap_records);
+        } else {
+            ap_count = 0;
+            esp_wifi_clear_ap_list();
+        }
+    }
 
-            if (app_state_lock(100)) {
-                state->wifi_multi.scan_count = 0;
-
-                for (int i = 0; i < ap_count && state->wifi_multi.scan_count < WIFI_SCAN_MAX_RESULTS; i++) {
-                    // Skip hidden/empty SSIDs
-                    if (ap_records[i].ssid[0] == '\0') continue;
-
-                    wifi_scan_result_t *r = &state->wifi_multi.scan_results[state->wifi_multi.scan_count];
-                    strncpy(r->ssid, (char *)ap_records[i].ssid, sizeof(r->ssid) - 1);
-                    r->ssid[sizeof(r->ssid) - 1] = '\0';
-                    r->rssi = ap_records[i].rssi;
-                    r->authmode = ap_records[i].authmode;
-
-                    // Check if this is a known network
-                    r->known = false;
-                    r->cred_idx = 0;
-                    for (int j = 0; j < state->wifi_multi.count; j++) {
-                        if (strcmp(state->wifi_multi.credentials[j].ssid, r->ssid) == 0) {
-                            r->known = true;
-                            r->cred_idx = j;
-                            break;
-                        }
-                    }
-
-                    state->wifi_multi.scan_count++;
+    if (rank) {
+        s_candidate_count = 0;
+        s_candidate_pos = 0;
+        s_candidates_cached = false;
+    }
+
+    if (app_state_lock(100)) {
+        state->wifi_multi.scan_count = 0;
+
+        // Records arrive sorted by RSSI, so the first hit per SSID is the strongest AP
+        for (int i = 0; i < ap_count; i++) {
+            // Skip hidden/empty SSIDs
+            if (ap_records[i].ssid[0] == '\0') continue;
+
+            int known_idx = -1;
+            for (int j = 0; j < state->wifi_multi.count; j++) {
+                if (strcmp(state->wifi_multi.credentials[j].ssid, (char *)ap_records[i].ssid) == 0) {
+                    known_idx = j;
+                    break;
                 }
+            }
 
-                state->wifi_multi.scan_in_progress = false;
-                app_state_unlock();
+            if (state->wifi_multi.scan_count < WIFI_SCAN_MAX_RESULTS) {
+                wifi_scan_result_t *r = &state->wifi_multi.scan_results[state->wifi_multi.scan_count];
+                strncpy(r->ssid, (char *)ap_records[i].ssid, sizeof(r->ssid) - 1);
+                r->ssid[sizeof(r->ssid) - 1] = '\0';
+                r->rssi = ap_records[i].rssi;
+                r->authmode = ap_records[i].authmode;
+                r->known = (known_idx >= 0);
+                r->cred_idx = (known_idx >= 0) ? known_idx : 0;
+                state->wifi_multi.scan_count++;
             }
 
-            free(ap_records);
+            if (!rank || known_idx < 0 || s_candidate_count >= MAX_WIFI_CREDENTIALS) continue;
+
+            bool seen = false;
+            for (int k = 0; k < s_candidate_count; k++) {
+                if (s_candidates[k].cred_idx == known_idx) {
+                    seen = true;
+                    break;
+                }
+            }
+            if (!seen) {
+                roam_candidate_t *cand = &s_candidates[s_candidate_count++];
+                cand->cred_idx = known_idx;
+                cand->rssi = ap_records[i].rssi;
+                memcpy(cand->bssid, ap_records[i].bssid, sizeof(cand->bssid));
+                cand->channel = ap_records[i].primary;
+                cand->score = cache_score(&state->wifi_multi.credentials[known_idx].cache,
+                                          ap_records[i].rssi);
+            }
         }
 
+        state->wifi_multi.scan_in_progress = false;
+        app_state_unlock();
+    }
+
+    free(ap_records);
+    if (rank) {
+        roam_sort_candidates();
+        ESP_LOGI(TAG, "Scan complete: %d networks found, %d known",
+                 state->wifi_multi.scan_count, s_candidate_count);
+    } else {
         ESP_LOGI(TAG, "Scan complete: %d networks found", state->wifi_multi.scan_count);
-        events_post_simple(EVT_WIFI_SCAN_COMPLETE);
+    }
+    events_post_simple(EVT_WIFI_SCAN_COMPLETE);
+}
+
+static void roam_on_got_ip(void) {
+    s_roam_state = ROAM_CONNECTED;
+    s_roam_deadline_ms = 0;
+    s_reconnect_attempts = 0;
+    s_backoff_ms = WIFI_ROAM_BACKOFF_MIN_MS;
+
+    // Update active_idx and the connection cache based on current AP
+    app_state_t *state = app_state_get();
+    wifi_ap_record_t ap_info;
+    if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
+        int idx = settings_find_wifi_credential((char *)ap_info.ssid);
+        if (idx >= 0 && app_state_lock(100)) {
+            state->wifi_multi.active_idx = idx;
+            app_state_unlock();
+        }
+        cache_record_success(idx, &ap_info);
+    }
+
+    // Initialize SNTP for time sync
+    wifi_manager_init_sntp();
+}
+
+static void roam_on_disconnected(const roam_msg_t *msg) {
+    switch (s_roam_state) {
+        case ROAM_SCANNING:
+        case ROAM_BACKOFF:
+            // Expected while we deliberately hold the link down
+            return;
+
+        case ROAM_CONNECTING:
+            // Ignore stale events from the network we just left
+            if (msg->ssid[0] != '\0' && strcmp(msg->ssid, s_target_ssid) != 0) {
+                return;
+            }
+            ESP_LOGI(TAG, "Roam: %s rejected, next candidate", s_target_ssid);
+            cache_record_failure(s_target_idx);
+            roam_try_next_candidate();
+            return;
+
+        case ROAM_RECONNECTING:
+            cache_record_failure(s_target_idx);
+            break;
+
+        default:
+            break;
+    }
+
+    // A fresh drop from a working link gets one cached fast retry first
+    bool was_connected = (s_roam_state == ROAM_CONNECTED);
+
+    s_reconnect_attempts++;
+    ESP_LOGI(TAG, "Disconnected (attempt %d/%d)", s_reconnect_attempts, WIFI_RECONNECT_SCAN_THRESHOLD);
+
+    if (s_reconnect_attempts < WIFI_RECONNECT_SCAN_THRESHOLD) {
+        // Fast retry same SSID for transient drops
+        roam_reconnect_target(was_connected);
+    } else {
+        // Too many failures - try other known networks
+        ESP_LOGI(TAG, "Reconnect threshold reached, roaming...");
+        s_reconnect_attempts = 0;
+        roam_start_roaming();
+    }
+}
+
+static void roam_on_timeout(void) {
+    s_roam_deadline_ms = 0;
+
+    switch (s_roam_state) {
+        case ROAM_RECONNECTING: {
+            // No event within the window - count it as a failed attempt
+            roam_msg_t msg = { .type = ROAM_MSG_DISCONNECTED };
+            roam_on_disconnected(&msg);
+            break;
+        }
+        case ROAM_SCANNING:
+            ESP_LOGW(TAG, "Roam: scan timed out");
+            esp_wifi_scan_stop();
+            roam_enter_backoff();
+            break;
+        case ROAM_CONNECTING:
+            ESP_LOGW(TAG, "Roam: %s timed out", s_target_ssid);
+            cache_record_failure(s_target_idx);
+            roam_try_next_candidate();
+            break;
+        case ROAM_BACKOFF:
+            roam_start_roaming();
+            break;
+        default:
+            break;
+    }
+}
 
+static void roam_handle_msg(const roam_msg_t *msg) {
+    switch (msg->type) {
+        case ROAM_MSG_STA_START:
+            s_reconnect_attempts = 0;
+            roam_reconnect_target(true);
+            break;
+
+        case ROAM_MSG_GOT_IP:
+            roam_on_got_ip();
+            break;
+
+        case ROAM_MSG_DISCONNECTED:
+            roam_on_disconnected(msg);
+            break;
+
+        case ROAM_MSG_SCAN_DONE: {
+            roam_process_scan_results();
+            if (s_roam_state == ROAM_SCANNING) {
+                roam_try_next_candidate();
+            }
+            break;
+        }
+
+        case ROAM_MSG_AUTO_CONNECT:
+            if (s_roam_state != ROAM_SCANNING && s_roam_state != ROAM_CONNECTING) {
+                roam_start_roaming();
+            }
+            break;
+
+        case ROAM_MSG_CONNECT:
+            ESP_LOGI(TAG, "Connecting to %s", msg->ssid);
+            s_reconnect_attempts = 0;
+            s_backoff_ms = WIFI_ROAM_BACKOFF_MIN_MS;
+            strncpy(s_target_ssid, msg->ssid, sizeof(s_target_ssid) - 1);
+            s_target_ssid[sizeof(s_target_ssid) - 1] = '\0';
+            strncpy(s_target_pass, msg->password, sizeof(s_target_pass) - 1);
+            s_target_pass[sizeof(s_target_pass) - 1] = '\0';
+            roam_reconnect_target(true);
+            break;
+    }
+}
+
+static void wifi_roam_task(void *arg) {
+    ESP_LOGI(TAG, "WiFi roam task started");
+
+    roam_msg_t msg;
+    while (1) {
+        TickType_t wait = portMAX_DELAY;
+        if (s_roam_deadline_ms > 0) {
+            int64_t remaining = s_roam_deadline_ms - roam_now_ms();
+            wait = remaining > 0 ? pdMS_TO_TICKS(remaining) : 0;
+        }
+
+        if (xQueueReceive(s_roam_queue, &msg, wait) == pdTRUE) {
+            roam_handle_msg(&msg);
+        } else if (s_roam_deadline_ms > 0) {
+            roam_on_timeout();
+        }
+    }
+}
+
+// Runs on the default event loop task - must never block
+static void wifi_event_handler(void *arg, esp_event_base_t event_base,
+                               int32_t event_id, void *event_data) {
+    roam_msg_t msg = {0};
+
+    if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_START) {
+        msg.type = ROAM_MSG_STA_START;
+        roam_post(&msg);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_STA_DISCONNECTED) {
+        app_state_set_wifi_connected(false);
+
+        if (s_wifi_event_group) {
+            xEventGroupClearBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
+        }
+
+        wifi_event_sta_disconnected_t *event = (wifi_event_sta_disconnected_t *)event_data;
+        msg.type = ROAM_MSG_DISCONNECTED;
+        if (event) {
+            size_t len = event->ssid_len < sizeof(msg.ssid) - 1 ? event->ssid_len : sizeof(msg.ssid) - 1;
+            memcpy(msg.ssid, event->ssid, len);
+            msg.ssid[len] = '\0';
+        }
+        roam_post(&msg);
+    } else if (event_base == WIFI_EVENT && event_id == WIFI_EVENT_SCAN_DONE) {
+        msg.type = ROAM_MSG_SCAN_DONE;
+        roam_post(&msg);
     } else if (event_base == IP_EVENT && event_id == IP_EVENT_STA_GOT_IP) {
         ip_event_got_ip_t *event = (ip_event_got_ip_t *)event_data;
         ESP_LOGI(TAG, "Got IP: " IPSTR, IP2STR(&event->ip_info.ip));
         app_state_set_wifi_connected(true);
-        s_reconnect_attempts = 0;  // Reset on successful connect
-        s_auto_connect_in_progress = false;
 
         if (s_wifi_event_group) {
             xEventGroupSetBits(s_wifi_event_group, WIFI_CONNECTED_BIT);
         }
 
-        // Update active_idx based on current SSID
-        app_state_t *state = app_state_get();
-        wifi_ap_record_t ap_info;
-        if (esp_wifi_sta_get_ap_info(&ap_info) == ESP_OK) {
-            int idx = settings_find_wifi_credential((char *)ap_info.ssid);
-            if (idx >= 0 && app_state_lock(100)) {
-                state->wifi_multi.active_idx = idx;
-                app_state_unlock();
-            }
-        }
-
-        // Initialize SNTP for time sync
-        wifi_manager_init_sntp();
+        msg.type = ROAM_MSG_GOT_IP;
+        roam_post(&msg);
     }
 }
 
@@ -140,6 +688,14 @@ esp_err_t wifi_manager_init(const char *ssid, const char *password) {
 
     s_wifi_event_group = xEventGroupCreate();
 
+    s_roam_queue = xQueueCreate(WIFI_ROAM_QUEUE_SIZE, sizeof(roam_msg_t));
+    if (!s_roam_queue ||
+        xTaskCreate(wifi_roam_task, "wifi_roam", WIFI_ROAM_TASK_STACK, NULL,
+                    WIFI_ROAM_TASK_PRIORITY, &s_roam_task) != pdPASS) {
+        ESP_LOGE(TAG, "Failed to create WiFi roam task");
+        return ESP_ERR_NO_MEM;
+    }
+
     ESP_ERROR_CHECK(esp_netif_init());
     ESP_ERROR_CHECK(esp_event_loop_create_default());
     esp_netif_create_default_wifi_sta();
@@ -161,6 +717,10 @@ esp_err_t wifi_manager_init(const char *ssid, const char *password) {
     wifi_config.sta.threshold.authmode = (password && strlen(password) > 0)
         ? WIFI_AUTH_WPA_WPA2_PSK : WIFI_AUTH_OPEN;
 
+    // STA_START picks these up and tries the cached AP first
+    strncpy(s_target_ssid, ssid, sizeof(s_target_ssid) - 1);
+    strncpy(s_target_pass, password ? password : "", sizeof(s_target_pass) - 1);
+
     ESP_ERROR_CHECK(esp_wifi_set_mode(WIFI_MODE_STA));
     ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
     ESP_ERROR_CHECK(esp_wifi_start());
@@ -172,25 +732,15 @@ esp_err_t wifi_manager_init(const char *ssid, const char *password) {
 }
 
 esp_err_t wifi_manager_reconnect(const char *ssid, const char *password) {
-    ESP_LOGI(TAG, "Reconnecting WiFi with new credentials...");
-
-    s_reconnect_attempts = 0;
-    s_auto_connect_in_progress = false;
-
-    esp_wifi_disconnect();
-    // Small delay to allow disconnect to complete
-    vTaskDelay(pdMS_TO_TICKS(100));
+    if (!ssid) return ESP_ERR_INVALID_ARG;
 
-    wifi_config_t wifi_config = {0};
-    strncpy((char *)wifi_config.sta.ssid, ssid, sizeof(wifi_config.sta.ssid) - 1);
-    strncpy((char *)wifi_config.sta.password, password, sizeof(wifi_config.sta.password) - 1);
-    wifi_config.sta.threshold.authmode = (password && strlen(password) > 0)
-        ? WIFI_AUTH_WPA_WPA2_PSK : WIFI_AUTH_OPEN;
+    ESP_LOGI(TAG, "Reconnecting WiFi with new credentials...");
 
-    ESP_ERROR_CHECK(esp_wifi_set_config(WIFI_IF_STA, &wifi_config));
-    esp_wifi_connect();
+    roam_msg_t msg = { .type = ROAM_MSG_CONNECT };
+    strncpy(msg.ssid, ssid, sizeof(msg.ssid) - 1);
+    strncpy(msg.password, password ? password : "", sizeof(msg.password) - 1);
 
-    return ESP_OK;
+    return roam_post(&msg) ? ESP_OK : ESP_ERR_TIMEOUT;
 }
 
 bool wifi_manager_is_connected(void) {
@@ -215,11 +765,8 @@ void wifi_manager_stop(void) {
 void wifi_manager_init_sntp(void) {
     if (sntp_initialized) return;
 
-    ESP_LOGI(TAG, "Initializing SNTP for CET timezone...");
-
-    // Set timezone to CET (Central European Time) with DST
-    setenv("TZ", "CET-1CEST,M3.5.0,M10.5.0/3", 1);
-    tzset();
+    // Time zone (TIMEZONE_POSIX) is applied at boot by app_init
+    ESP_LOGI(TAG, "Initializing SNTP...");
 
     esp_sntp_setoperatingmode(SNTP_OPMODE_POLL);
     esp_sntp_setservername(0, "pool.ntp.org");
@@ -378,113 +925,6 @@ esp_err_t wifi_manager_auto_connect(void) {
         return ESP_ERR_NOT_FOUND;
     }
 
-    s_auto_connect_in_progress = true;
-    ESP_LOGI(TAG, "Auto-connect: scanning for known networks...");
-
-    // Start a blocking scan
-    wifi_scan_config_t scan_config = {
-        .ssid = NULL,
-        .bssid = NULL,
-        .channel = 0,
-        .show_hidden = false,
-        .scan_type = WIFI_SCAN_TYPE_ACTIVE,
-        .scan_time.active.min = 100,
-        .scan_time.active.max = 300,
-    };
-
-    // Disconnect first to allow scanning
-    esp_wifi_disconnect();
-    vTaskDelay(pdMS_TO_TICKS(100));
-
-    esp_err_t err = esp_wifi_scan_start(&scan_config, true);  // Blocking scan
-    if (err != ESP_OK) {
-        ESP_LOGE(TAG, "Auto-connect scan failed: %s", esp_err_to_name(err));
-        s_auto_connect_in_progress = false;
-        // Fall back to reconnecting with first credential
-        if (state->wifi_multi.count > 0) {
-            wifi_manager_connect_index(0);
-        }
-        return err;
-    }
-
-    // Get scan results
-    uint16_t ap_count = 0;
-    esp_wifi_scan_get_ap_num(&ap_count);
-
-    if (ap_count == 0) {
-        ESP_LOGW(TAG, "Auto-connect: no networks found");
-        s_auto_connect_in_progress = false;
-        return ESP_ERR_NOT_FOUND;
-    }
-
-    if (ap_count > WIFI_SCAN_MAX_RESULTS) {
-        ap_count = WIFI_SCAN_MAX_RESULTS;
-    }
-
-    wifi_ap_record_t *ap_records = malloc(sizeof(wifi_ap_record_t) * ap_count);
-    if (!ap_records) {
-        s_auto_connect_in_progress = false;
-        return ESP_ERR_NO_MEM;
-    }
-
-    esp_wifi_scan_get_ap_records(&ap_count, ap_records);
-
-    // Build list of known networks sorted by RSSI (strongest first, already sorted by esp_wifi)
-    typedef struct { int cred_idx; int8_t rssi; } known_ap_t;
-    known_ap_t known_aps[MAX_WIFI_CREDENTIALS];
-    int known_count = 0;
-
-    if (app_state_lock(100)) {
-        for (int i = 0; i < ap_count; i++) {
-            if (ap_records[i].ssid[0] == '\0') continue;
-
-            for (int j = 0; j < state->wifi_multi.count; j++) {
-                if (strcmp(state->wifi_multi.credentials[j].ssid, (char *)ap_records[i].ssid) == 0) {
-                    known_aps[known_count].cred_idx = j;
-                    known_aps[known_count].rssi = ap_records[i].rssi;
-                    known_count++;
-                    break;
-                }
-            }
-            if (known_count >= MAX_WIFI_CREDENTIALS) break;
-        }
-        app_state_unlock();
-    }
-
-    free(ap_records);
-
-    if (known_count == 0) {
-        ESP_LOGW(TAG, "Auto-connect: no known networks in range");
-        s_auto_connect_in_progress = false;
-        return ESP_ERR_NOT_FOUND;
-    }
-
-    ESP_LOGI(TAG, "Auto-connect: found %d known networks, trying strongest first", known_count);
-
-    // Try each known network in RSSI order (already sorted by scan)
-    for (int i = 0; i < known_count; i++) {
-        int idx = known_aps[i].cred_idx;
-        ESP_LOGI(TAG, "Auto-connect: trying credential #%d (RSSI: %d)", idx, known_aps[i].rssi);
-
-        wifi_manager_connect_index(idx);
-
-        // Wait for connection
-        if (wifi_manager_wait_connected(WIFI_CONNECT_TIMEOUT_MS)) {
-            ESP_LOGI(TAG, "Auto-connect: connected to credential #%d", idx);
-            s_auto_connect_in_progress = false;
-            s_reconnect_attempts = 0;
-            return ESP_OK;
-        }
-    }
-
-    ESP_LOGW(TAG, "Auto-connect: all known networks failed");
-    s_auto_connect_in_progress = false;
-    s_reconnect_attempts = 0;
-
-    // Retry with first credential as fallback
-    if (state->wifi_multi.count > 0) {
-        wifi_manager_connect_index(0);
-    }
-
-    return ESP_FAIL;
+    roam_msg_t msg = { .type = ROAM_MSG_AUTO_CONNECT };
+    return roam_post(&msg) ? ESP_OK : ESP_ERR_TIMEOUT;
 }
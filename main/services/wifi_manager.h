@@ -20,9 +20,10 @@ esp_err_t wifi_manager_init(const char *ssid, const char *password);
 
 /**
  * Reconnect WiFi with new credentials
+ * Non-blocking: the request is handed to the roaming task.
  * @param ssid New WiFi network SSID
  * @param password New WiFi password
- * @return ESP_OK on success
+ * @return ESP_OK if the request was queued
  */
 esp_err_t wifi_manager_reconnect(const char *ssid, const char *password);
 
@@ -44,7 +45,7 @@ bool wifi_manager_wait_connected(uint32_t timeout_ms);
 void wifi_manager_stop(void);
 
 /**
- * Initialize SNTP for CET timezone
+ * Initialize SNTP time sync
  */
 void wifi_manager_init_sntp(void);
 
@@ -104,6 +105,9 @@ esp_err_t wifi_manager_connect_index(int credential_idx);
 
 /**
  * Auto-connect: scan for networks and connect to strongest known one
+ * Non-blocking: the roaming task scans and tries candidates in RSSI order,
+ * use wifi_manager_wait_connected() to wait for the result.
+ * @return ESP_OK if queued, ESP_ERR_NOT_FOUND if no credentials are saved
  */
 esp_err_t wifi_manager_auto_connect(void);
 
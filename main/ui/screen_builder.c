@@ -36,6 +36,9 @@ static const char *TAG = "screen_builder";
 #define screen_add_server   (UI_CTX->screen_add_server)
 #define screen_history      (UI_CTX->screen_history)
 #define screen_heatmap      (UI_CTX->screen_heatmap)
+#define screen_compare      (UI_CTX->screen_compare)
+#define screen_diagnostics  (UI_CTX->screen_diagnostics)
+#define screen_tasks        (UI_CTX->screen_tasks)
 
 #define main_card           (UI_CTX->main_card)
 #define lbl_wifi_icon       (UI_CTX->lbl_wifi_icon)
@@ -54,6 +57,7 @@ static const char *TAG = "screen_builder";
 #define lbl_rank            (UI_CTX->lbl_rank)
 #define lbl_sd_status       (UI_CTX->lbl_sd_status)
 #define lbl_cet_time        (UI_CTX->lbl_cet_time)
+#define lbl_forecast        (UI_CTX->lbl_forecast)
 
 #define kb                      (UI_CTX->kb)
 #define kb_add                  (UI_CTX->kb_add)
@@ -157,7 +161,7 @@ static void on_alert_slider_changed(lv_event_t *e) {
 
 static void on_server_save_clicked(lv_event_t *e) {
     (void)e;
-    if (lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) {
+    if (ui_lock(UI_LOCK_TIMEOUT_MS)) {
         const char *map_name = "";
         if (dropdown_map) {
             uint16_t map_idx = lv_dropdown_get_selected(dropdown_map);
@@ -235,6 +239,20 @@ void screen_builder_create_main(void) {
     lv_obj_set_style_text_color(lbl_heatmap, COLOR_INFO, 0);
     lv_obj_center(lbl_heatmap);
 
+    // Server comparison button
+    lv_obj_t *btn_compare = lv_btn_create(screen_main);
+    lv_obj_set_size(btn_compare, 50, 50);
+    lv_obj_set_pos(btn_compare, 260, 10);
+    lv_obj_set_style_bg_opa(btn_compare, LV_OPA_TRANSP, 0);
+    lv_obj_set_style_shadow_width(btn_compare, 0, 0);
+    lv_obj_set_style_border_width(btn_compare, 0, 0);
+    lv_obj_add_event_cb(btn_compare, cb_compare_clicked, LV_EVENT_CLICKED, NULL);
+    lv_obj_t *lbl_compare = lv_label_create(btn_compare);
+    lv_label_set_text(lbl_compare, LV_SYMBOL_BARS);
+    lv_obj_set_style_text_font(lbl_compare, &lv_font_montserrat_24, 0);
+    lv_obj_set_style_text_color(lbl_compare, COLOR_INFO, 0);
+    lv_obj_center(lbl_compare);
+
     lv_obj_t *wifi_btn = lv_btn_create(screen_main);
     lv_obj_set_size(wifi_btn, 50, 50);
     lv_obj_align(wifi_btn, LV_ALIGN_TOP_LEFT, 140, 10);
@@ -249,7 +267,7 @@ void screen_builder_create_main(void) {
     lv_obj_set_style_text_color(lbl_wifi_icon, COLOR_TEXT_MUTED, 0);
     lv_obj_center(lbl_wifi_icon);
 
-    // CET time display in the center of the top bar
+    // Local time display in the center of the top bar
     lbl_cet_time = lv_label_create(screen_main);
     lv_label_set_text(lbl_cet_time, "--:--");
     lv_obj_set_style_text_font(lbl_cet_time, &lv_font_montserrat_24, 0);
@@ -342,6 +360,13 @@ void screen_builder_create_main(void) {
     lv_obj_set_style_radius(bar_players, 8, 0);
     lv_obj_set_style_radius(bar_players, 8, LV_PART_INDICATOR);
 
+    // Forecast line between the bar and the info row
+    lbl_forecast = lv_label_create(main_card);
+    lv_label_set_text(lbl_forecast, "");
+    lv_obj_set_style_text_font(lbl_forecast, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(lbl_forecast, COLOR_TEXT_SECONDARY, 0);
+    lv_obj_align(lbl_forecast, LV_ALIGN_TOP_MID, 0, 146);
+
     lv_obj_t *info_row = ui_create_row(main_card, 680, 35);
     lv_obj_align(info_row, LV_ALIGN_TOP_MID, 0, 160);
 
@@ -391,6 +416,8 @@ void screen_builder_create_settings(void) {
 
     ui_create_menu_button(cont, "WiFi Settings", LV_SYMBOL_WIFI, COLOR_BUTTON_PRIMARY, cb_wifi_settings_clicked);
     ui_create_menu_button(cont, "Server Settings", LV_SYMBOL_LIST, COLOR_SUCCESS, cb_server_settings_clicked);
+    ui_create_menu_button(cont, "Diagnostics", LV_SYMBOL_EYE_OPEN, COLOR_BUTTON_SECONDARY, cb_diagnostics_clicked);
+    ui_create_menu_button(cont, "USB Export (start/stop)", LV_SYMBOL_USB, COLOR_BUTTON_SECONDARY, cb_usb_export_clicked);
 
     lv_obj_t *refresh_row = ui_create_row(cont, 660, 55);
     slider_refresh = ui_create_slider(refresh_row, "Refresh:", MIN_REFRESH_INTERVAL_SEC, MAX_REFRESH_INTERVAL_SEC,
@@ -436,7 +463,7 @@ void screen_builder_create_settings(void) {
     snprintf(buf, sizeof(buf), "%d players", threshold);
     lv_label_set_text(lbl_alert_val, buf);
 
-    ui_create_section_header(cont, "Restart Schedule (CET)", lv_color_hex(0xFF9800));
+    ui_create_section_header(cont, "Restart Schedule (local time)", lv_color_hex(0xFF9800));
 
     lv_obj_t *restart_enable_row = ui_create_row(cont, 660, 45);
     bool manual_on = srv ? srv->manual_restart_set : false;
@@ -514,7 +541,7 @@ static void on_wifi_ta_clicked(lv_event_t *e) {
 
 static void on_wifi_manual_save_clicked(lv_event_t *e) {
     (void)e;
-    if (lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) {
+    if (ui_lock(UI_LOCK_TIMEOUT_MS)) {
         events_post_wifi_save(lv_textarea_get_text(ta_ssid),
                               lv_textarea_get_text(ta_password));
         lvgl_port_unlock();
@@ -1136,6 +1163,155 @@ void screen_builder_create_heatmap(void) {
     screen_heatmap_schedule_refresh();
 }
 
+void screen_builder_create_compare(void) {
+    screen_compare = ui_create_screen();
+    lv_obj_add_event_cb(screen_compare, screensaver_get_touch_pressed_cb(), LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(screen_compare, screensaver_get_touch_released_cb(), LV_EVENT_RELEASED, NULL);
+    ui_create_back_button(screen_compare, cb_back_clicked);
+    ui_create_title(screen_compare, "Compare Servers");
+
+    // Column layout shared by header and rows
+    static const int col_x[COMPARE_COLUMNS] = { 12, 55, 320, 420, 500, 640 };
+    static const int col_w[COMPARE_COLUMNS] = { 40, 255, 95, 75, 135, 110 };
+    static const char *col_titles[COMPARE_COLUMNS] = { "#", "Server", "Now", "2h", "Peak 24h", "Restart" };
+
+    lv_obj_t *header = ui_create_row(screen_compare, 760, 25);
+    lv_obj_align(header, LV_ALIGN_TOP_MID, 0, 70);
+    for (int c = 0; c < COMPARE_COLUMNS; c++) {
+        lv_obj_t *lbl = lv_label_create(header);
+        lv_label_set_text(lbl, col_titles[c]);
+        lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+        lv_obj_set_style_text_color(lbl, COLOR_TEXT_MUTED, 0);
+        lv_obj_set_pos(lbl, col_x[c], 4);
+    }
+
+    for (int r = 0; r < MAX_SERVERS; r++) {
+        lv_obj_t *row = lv_obj_create(screen_compare);
+        lv_obj_set_size(row, 760, 58);
+        lv_obj_align(row, LV_ALIGN_TOP_MID, 0, 100 + r * 64);
+        lv_obj_set_style_bg_color(row, COLOR_CARD_BG, 0);
+        lv_obj_set_style_radius(row, 12, 0);
+        lv_obj_set_style_border_width(row, 0, 0);
+        lv_obj_set_style_pad_all(row, 0, 0);
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_SCROLLABLE);
+        lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+        UI_CTX->compare_rows[r] = row;
+
+        for (int c = 0; c < COMPARE_COLUMNS; c++) {
+            lv_obj_t *lbl = lv_label_create(row);
+            lv_label_set_text(lbl, "");
+            lv_obj_set_width(lbl, col_w[c]);
+            lv_label_set_long_mode(lbl, LV_LABEL_LONG_DOT);
+            lv_obj_set_style_text_font(lbl, (c == 1 || c == 2) ? &lv_font_montserrat_18
+                                                                : &lv_font_montserrat_14, 0);
+            lv_obj_set_style_text_color(lbl, COLOR_TEXT_PRIMARY, 0);
+            lv_obj_align(lbl, LV_ALIGN_LEFT_MID, col_x[c], 0);
+            UI_CTX->compare_cells[r][c] = lbl;
+        }
+    }
+}
+
+void screen_builder_create_diagnostics(void) {
+    screen_diagnostics = ui_create_screen();
+    lv_obj_add_event_cb(screen_diagnostics, screensaver_get_touch_pressed_cb(), LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(screen_diagnostics, screensaver_get_touch_released_cb(), LV_EVENT_RELEASED, NULL);
+    ui_create_back_button(screen_diagnostics, cb_back_clicked);
+    lv_obj_t *title = ui_create_title(screen_diagnostics, "Diagnostics");
+
+    // Hidden: long-press the title for the task profiler
+    lv_obj_add_flag(title, LV_OBJ_FLAG_CLICKABLE);
+    lv_obj_add_event_cb(title, cb_tasks_long_pressed, LV_EVENT_LONG_PRESSED, NULL);
+
+    static const int col_x[DIAG_COLUMNS] = { 12, 150, 240, 340, 440 };
+    static const char *col_titles[DIAG_COLUMNS] = { "Latency", "Count", "p50", "p95", "Max" };
+
+    lv_obj_t *table = lv_obj_create(screen_diagnostics);
+    lv_obj_set_size(table, 540, 30 + METRIC_HIST_COUNT * 28);
+    lv_obj_align(table, LV_ALIGN_TOP_LEFT, 20, 70);
+    lv_obj_set_style_bg_color(table, COLOR_CARD_BG, 0);
+    lv_obj_set_style_radius(table, 12, 0);
+    lv_obj_set_style_border_width(table, 0, 0);
+    lv_obj_set_style_pad_all(table, 0, 0);
+    lv_obj_clear_flag(table, LV_OBJ_FLAG_SCROLLABLE);
+
+    for (int c = 0; c < DIAG_COLUMNS; c++) {
+        lv_obj_t *lbl = lv_label_create(table);
+        lv_label_set_text(lbl, col_titles[c]);
+        lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+        lv_obj_set_style_text_color(lbl, COLOR_TEXT_MUTED, 0);
+        lv_obj_set_pos(lbl, col_x[c], 8);
+    }
+
+    for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+        for (int c = 0; c < DIAG_COLUMNS; c++) {
+            lv_obj_t *lbl = lv_label_create(table);
+            lv_label_set_text(lbl, c == 0 ? metrics_hist_name((metric_hist_t)h) : "-");
+            lv_obj_set_style_text_font(lbl, &lv_font_montserrat_18, 0);
+            lv_obj_set_style_text_color(lbl, c == 0 ? COLOR_TEXT_SECONDARY : COLOR_TEXT_PRIMARY, 0);
+            lv_obj_set_pos(lbl, col_x[c], 32 + h * 28);
+            UI_CTX->diag_hist_cells[h][c] = lbl;
+        }
+    }
+
+    // Counters and gauges as plain "name value" lines
+    UI_CTX->lbl_diag_counters = lv_label_create(screen_diagnostics);
+    lv_label_set_text(UI_CTX->lbl_diag_counters, "");
+    lv_obj_set_style_text_font(UI_CTX->lbl_diag_counters, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(UI_CTX->lbl_diag_counters, COLOR_TEXT_PRIMARY, 0);
+    lv_obj_align(UI_CTX->lbl_diag_counters, LV_ALIGN_TOP_LEFT, 590, 70);
+
+    UI_CTX->lbl_diag_gauges = lv_label_create(screen_diagnostics);
+    lv_label_set_text(UI_CTX->lbl_diag_gauges, "");
+    lv_obj_set_style_text_font(UI_CTX->lbl_diag_gauges, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(UI_CTX->lbl_diag_gauges, COLOR_TEXT_SECONDARY, 0);
+    lv_obj_align(UI_CTX->lbl_diag_gauges, LV_ALIGN_TOP_LEFT, 20, 100 + METRIC_HIST_COUNT * 28 + 10);
+}
+
+void screen_builder_create_tasks(void) {
+    screen_tasks = ui_create_screen();
+    lv_obj_add_event_cb(screen_tasks, screensaver_get_touch_pressed_cb(), LV_EVENT_PRESSED, NULL);
+    lv_obj_add_event_cb(screen_tasks, screensaver_get_touch_released_cb(), LV_EVENT_RELEASED, NULL);
+    ui_create_back_button(screen_tasks, cb_back_clicked);
+    ui_create_title(screen_tasks, "Tasks");
+
+    static const int col_x[TASK_COLUMNS] = { 12, 200, 280, 390, 500, 630 };
+    static const char *col_titles[TASK_COLUMNS] = { "Task", "Prio", "CPU avg", "CPU peak", "Stack free", "Heap" };
+
+    lv_obj_t *table = lv_obj_create(screen_tasks);
+    lv_obj_set_size(table, 760, 30 + TASK_ROWS * 25);
+    lv_obj_align(table, LV_ALIGN_TOP_MID, 0, 65);
+    lv_obj_set_style_bg_color(table, COLOR_CARD_BG, 0);
+    lv_obj_set_style_radius(table, 12, 0);
+    lv_obj_set_style_border_width(table, 0, 0);
+    lv_obj_set_style_pad_all(table, 0, 0);
+    lv_obj_clear_flag(table, LV_OBJ_FLAG_SCROLLABLE);
+
+    for (int c = 0; c < TASK_COLUMNS; c++) {
+        lv_obj_t *lbl = lv_label_create(table);
+        lv_label_set_text(lbl, col_titles[c]);
+        lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+        lv_obj_set_style_text_color(lbl, COLOR_TEXT_MUTED, 0);
+        lv_obj_set_pos(lbl, col_x[c], 8);
+    }
+
+    for (int r = 0; r < TASK_ROWS; r++) {
+        for (int c = 0; c < TASK_COLUMNS; c++) {
+            lv_obj_t *lbl = lv_label_create(table);
+            lv_label_set_text(lbl, "");
+            lv_obj_set_style_text_font(lbl, &lv_font_montserrat_14, 0);
+            lv_obj_set_style_text_color(lbl, c == 0 ? COLOR_TEXT_SECONDARY : COLOR_TEXT_PRIMARY, 0);
+            lv_obj_set_pos(lbl, col_x[c], 30 + r * 25);
+            UI_CTX->task_cells[r][c] = lbl;
+        }
+    }
+
+    UI_CTX->lbl_task_footer = lv_label_create(screen_tasks);
+    lv_label_set_text(UI_CTX->lbl_task_footer, "");
+    lv_obj_set_style_text_font(UI_CTX->lbl_task_footer, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(UI_CTX->lbl_task_footer, COLOR_TEXT_MUTED, 0);
+    lv_obj_align(UI_CTX->lbl_task_footer, LV_ALIGN_BOTTOM_MID, 0, -12);
+}
+
 void screen_builder_create_secondary_boxes(void) {
     app_state_t *state = app_state_get();
 
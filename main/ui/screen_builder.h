@@ -41,6 +41,21 @@ void screen_builder_create_history(void);
  */
 void screen_builder_create_heatmap(void);
 
+/**
+ * Create the server comparison screen (rows filled by ui_update_compare)
+ */
+void screen_builder_create_compare(void);
+
+/**
+ * Create the diagnostics screen (filled by ui_update_diagnostics)
+ */
+void screen_builder_create_diagnostics(void);
+
+/**
+ * Create the task profiler screen (filled by ui_update_tasks)
+ */
+void screen_builder_create_tasks(void);
+
 /**
  * Create secondary server watch boxes on main screen
  */
@@ -5,14 +5,11 @@
 
 #include "screen_heatmap.h"
 #include <string.h>
-#include <time.h>
 #include "esp_log.h"
-#include "esp_heap_caps.h"
 
 #include "config.h"
 #include "app_state.h"
 #include "ui_styles.h"
-#include "services/history_store.h"
 
 static const char *TAG = "screen_heatmap";
 
@@ -68,83 +65,6 @@ lv_color_t heatmap_get_color(int value, int min_val, int max_val) {
     }
 }
 
-void heatmap_calculate(int server_index, heatmap_data_t *heatmap) {
-    ESP_LOGI(TAG, "Calculating heatmap for server %d", server_index);
-
-    memset(heatmap, 0, sizeof(heatmap_data_t));
-
-    time_t now;
-    time(&now);
-    uint32_t end_time = (uint32_t)now;
-    uint32_t start_time = end_time - (28 * 86400);  // 28 days back
-
-    // Allocate buffer for history entries in PSRAM
-    // 28 days of hourly JSON samples ~= 672, generous cap at 2000
-    int max_entries = 2000;
-    history_entry_t *entries = heap_caps_malloc(
-        max_entries * sizeof(history_entry_t),
-        MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT
-    );
-
-    if (!entries) {
-        ESP_LOGE(TAG, "Failed to allocate entry buffer");
-        return;
-    }
-
-    int count = history_load_range_json(server_index, start_time, end_time,
-                                         entries, max_entries);
-
-    ESP_LOGI(TAG, "Loaded %d history entries", count);
-
-    if (count <= 0) {
-        heap_caps_free(entries);
-        return;
-    }
-
-    // Bucket entries into period/day slots (4-hour periods)
-    for (int i = 0; i < count; i++) {
-        time_t ts = (time_t)entries[i].timestamp;
-        struct tm tm_buf;
-        localtime_r(&ts, &tm_buf);
-
-        // Convert to Monday=0 format (tm_wday has Sunday=0)
-        int day = (tm_buf.tm_wday + 6) % 7;
-        int period = tm_buf.tm_hour / 4;  // 0-5 for 6 periods
-
-        if (period >= HEATMAP_PERIODS) period = HEATMAP_PERIODS - 1;
-
-        // Accumulate (with overflow protection)
-        if (heatmap->cells[day][period].count < 255) {
-            heatmap->cells[day][period].sum += entries[i].player_count;
-            heatmap->cells[day][period].count++;
-        }
-    }
-
-    heap_caps_free(entries);
-
-    // Calculate min/max averages for normalization
-    heatmap->min_avg = INT16_MAX;
-    heatmap->max_avg = 0;
-
-    for (int d = 0; d < HEATMAP_DAYS; d++) {
-        for (int p = 0; p < HEATMAP_PERIODS; p++) {
-            if (heatmap->cells[d][p].count > 0) {
-                int avg = heatmap->cells[d][p].sum / heatmap->cells[d][p].count;
-                if (avg < heatmap->min_avg) heatmap->min_avg = avg;
-                if (avg > heatmap->max_avg) heatmap->max_avg = avg;
-            }
-        }
-    }
-
-    if (heatmap->min_avg == INT16_MAX) {
-        heatmap->min_avg = 0;
-        heatmap->max_avg = 60;
-    }
-
-    heatmap->valid = true;
-    ESP_LOGI(TAG, "Heatmap calculated: min=%d, max=%d", heatmap->min_avg, heatmap->max_avg);
-}
-
 static void on_cell_clicked(lv_event_t *e) {
     if (!s_widgets) return;
 
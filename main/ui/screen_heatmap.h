@@ -9,23 +9,7 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include "lvgl.h"
-
-#define HEATMAP_PERIODS 6   // 4-hour blocks instead of 24 hours
-#define HEATMAP_DAYS 7
-
-// Single cell accumulator
-typedef struct {
-    uint16_t sum;       // Sum of player counts
-    uint8_t count;      // Number of samples
-} heatmap_cell_t;
-
-// Complete heatmap data
-typedef struct {
-    heatmap_cell_t cells[HEATMAP_DAYS][HEATMAP_PERIODS];  // [day][period]
-    int16_t min_avg;    // Minimum average found
-    int16_t max_avg;    // Maximum average found
-    bool valid;         // Data loaded successfully
-} heatmap_data_t;
+#include "services/heatmap.h"
 
 // Widget pointers for heatmap screen
 typedef struct {
@@ -55,13 +39,6 @@ void screen_heatmap_refresh(void);
  */
 void screen_heatmap_schedule_refresh(void);
 
-/**
- * Calculate heatmap data from history
- * @param server_index Server to analyze
- * @param heatmap Output heatmap data
- */
-void heatmap_calculate(int server_index, heatmap_data_t *heatmap);
-
 /**
  * Get color for a heatmap value
  * @param value Player count average
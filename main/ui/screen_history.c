@@ -5,6 +5,7 @@
 #include "screen_history.h"
 #include "app_state.h"
 #include "services/history_store.h"
+#include "services/time_util.h"
 #include "ui_styles.h"
 #include <time.h>
 #include <stdio.h>
@@ -28,34 +29,26 @@ void screen_history_refresh(void) {
 
     int total_count = history_get_count();
 
-    // Single pass: count entries, find min/max, and collect sampled values
-    int entries_in_range = 0;
-    int min_players = 9999;
-    int max_players = 0;
+    // Count and min/max straight from the packed count array
+    history_stats_t stats;
+    history_get_stats(range_seconds, &stats);
+    int entries_in_range = stats.count;
+    int min_players = stats.min;
+    int max_players = stats.max;
 
     // Temporary buffer for sampled player counts (max 120 chart points)
     int16_t sampled[120];
     int sampled_count = 0;
 
-    // First, count entries in range to determine sample rate
-    for (int i = 0; i < total_count; i++) {
-        history_entry_t entry;
-        if (history_get_entry(i, &entry) == 0 && entry.timestamp >= cutoff_time && entry.player_count >= 0) {
-            entries_in_range++;
-        }
-    }
-
     int display_points = (entries_in_range > 120) ? 120 : (entries_in_range > 0 ? entries_in_range : 1);
     int sample_rate = (entries_in_range > 120) ? (entries_in_range / 120) : 1;
 
-    // Second pass: collect samples and track min/max
+    // Single pass to collect samples
     int sample_counter = 0;
     for (int i = 0; i < total_count && sampled_count < display_points; i++) {
         history_entry_t entry;
         if (history_get_entry(i, &entry) == 0 &&
             entry.timestamp >= cutoff_time && entry.player_count >= 0) {
-            if (entry.player_count < min_players) min_players = entry.player_count;
-            if (entry.player_count > max_players) max_players = entry.player_count;
             if (sample_counter % sample_rate == 0) {
                 sampled[sampled_count++] = entry.player_count;
             }
@@ -65,7 +58,7 @@ void screen_history_refresh(void) {
 
     // Calculate dynamic Y-axis range with padding
     int range_min, range_max;
-    if (entries_in_range == 0 || min_players == 9999) {
+    if (entries_in_range == 0) {
         range_min = 0;
         range_max = 60;
     } else {
@@ -106,7 +99,9 @@ void screen_history_refresh(void) {
     for (int i = 0; i < 5; i++) {
         if (g_widgets->lbl_x_axis[i]) {
             time_t label_time = now - range_seconds + (i * range_seconds / 4);
-            struct tm *tm_info = localtime(&label_time);
+            struct tm tm_label;
+            time_util_to_tm((uint32_t)label_time, &tm_label);
+            struct tm *tm_info = &tm_label;
 
             char time_buf[16];
             if (state->ui.current_history_range == HISTORY_RANGE_1H) {
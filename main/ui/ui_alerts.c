@@ -3,6 +3,7 @@
  */
 
 #include "ui_alerts.h"
+#include "ui_context.h"
 #include "config.h"
 #include "lvgl.h"
 #include "esp_lvgl_port.h"
@@ -21,7 +22,7 @@ void ui_alerts_init(void) {
 void ui_alerts_show(const char *message, uint32_t color_hex) {
     if (!message) return;
 
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) {
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) {
         ESP_LOGW(TAG, "Failed to acquire LVGL lock for alert show");
         return;
     }
@@ -64,7 +65,7 @@ void ui_alerts_show(const char *message, uint32_t color_hex) {
 void ui_alerts_hide(void) {
     if (!alert_overlay) return;
 
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) {
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) {
         ESP_LOGW(TAG, "Failed to acquire LVGL lock for alert hide");
         return;
     }
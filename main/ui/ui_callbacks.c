@@ -39,6 +39,26 @@ void cb_heatmap_clicked(lv_event_t *e) {
     events_post_screen_change(SCREEN_HEATMAP);
 }
 
+void cb_compare_clicked(lv_event_t *e) {
+    (void)e;
+    events_post_screen_change(SCREEN_COMPARE);
+}
+
+void cb_diagnostics_clicked(lv_event_t *e) {
+    (void)e;
+    events_post_screen_change(SCREEN_DIAGNOSTICS);
+}
+
+void cb_usb_export_clicked(lv_event_t *e) {
+    (void)e;
+    events_post_simple(EVT_USB_EXPORT_TOGGLE);
+}
+
+void cb_tasks_long_pressed(lv_event_t *e) {
+    (void)e;
+    events_post_screen_change(SCREEN_TASKS);
+}
+
 void cb_back_clicked(lv_event_t *e) {
     (void)e;
     events_post_screen_change(SCREEN_MAIN);
@@ -14,6 +14,10 @@ void cb_card_clicked(lv_event_t *e);
 void cb_settings_clicked(lv_event_t *e);
 void cb_history_clicked(lv_event_t *e);
 void cb_heatmap_clicked(lv_event_t *e);
+void cb_compare_clicked(lv_event_t *e);
+void cb_diagnostics_clicked(lv_event_t *e);
+void cb_usb_export_clicked(lv_event_t *e);
+void cb_tasks_long_pressed(lv_event_t *e);
 void cb_back_clicked(lv_event_t *e);
 void cb_wifi_settings_clicked(lv_event_t *e);
 void cb_server_settings_clicked(lv_event_t *e);
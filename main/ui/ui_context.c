@@ -3,6 +3,10 @@
  */
 
 #include "ui_context.h"
+#include "esp_lvgl_port.h"
+#include "esp_timer.h"
+#include "services/metrics.h"
+#include "services/trace.h"
 #include <string.h>
 
 // Global UI context singleton
@@ -15,3 +19,77 @@ ui_context_t* ui_context_get(void) {
 void ui_context_init(void) {
     memset(&g_ui_context, 0, sizeof(ui_context_t));
 }
+
+bool ui_lock(uint32_t timeout_ms) {
+    int64_t t_start = esp_timer_get_time();
+    bool locked = lvgl_port_lock(timeout_ms);
+    metrics_observe_since(METRIC_H_LVGL_LOCK_WAIT, t_start);
+    if (!locked) {
+        metrics_count(METRIC_CNT_LVGL_LOCK_TIMEOUTS);
+    }
+    return locked;
+}
+
+// ============== FRAME TRACING ==============
+
+// Cycle waiting for its frame; written by the main loop, consumed on the LVGL task
+static uint32_t s_frame_trace_id;
+static int64_t s_frame_mark_us;
+static int64_t s_refr_start_us;
+static bool s_refr_rendered;
+
+static void refresh_event_cb(lv_event_t *e) {
+    int64_t now = esp_timer_get_time();
+
+    switch (lv_event_get_code(e)) {
+        case LV_EVENT_REFR_START:
+            s_refr_start_us = now;
+            s_refr_rendered = false;
+            break;
+
+        case LV_EVENT_RENDER_START:
+            s_refr_rendered = true;
+            break;
+
+        case LV_EVENT_REFR_READY: {
+            // REFR_READY follows the last flush, so the update is on the panel
+            uint32_t id = __atomic_load_n(&s_frame_trace_id, __ATOMIC_ACQUIRE);
+            if (id == 0) break;
+            int64_t mark = s_frame_mark_us;
+
+            if (now - mark > (int64_t)TRACE_FRAME_TIMEOUT_MS * 1000) {
+                // Nothing drew the update (other screen) - drop the cycle
+                __atomic_compare_exchange_n(&s_frame_trace_id, &id, 0, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED);
+                break;
+            }
+            // A refresh that began before the update can't contain it
+            if (!s_refr_rendered || s_refr_start_us < mark) break;
+
+            if (__atomic_compare_exchange_n(&s_frame_trace_id, &id, 0, false,
+                                            __ATOMIC_ACQ_REL, __ATOMIC_RELAXED)) {
+                trace_record("lvgl_refresh", id, s_refr_start_us, now, NULL);
+                trace_cycle_end(id);
+            }
+            break;
+        }
+
+        default:
+            break;
+    }
+}
+
+void ui_trace_attach(lv_display_t *disp) {
+    if (!disp || !trace_is_enabled()) return;
+
+    lv_display_add_event_cb(disp, refresh_event_cb, LV_EVENT_REFR_START, NULL);
+    lv_display_add_event_cb(disp, refresh_event_cb, LV_EVENT_RENDER_START, NULL);
+    lv_display_add_event_cb(disp, refresh_event_cb, LV_EVENT_REFR_READY, NULL);
+}
+
+void ui_trace_frame(uint32_t id) {
+    if (id == 0) return;
+
+    s_frame_mark_us = esp_timer_get_time();
+    __atomic_store_n(&s_frame_trace_id, id, __ATOMIC_RELEASE);
+}
@@ -9,6 +9,17 @@
 #include "lvgl.h"
 #include "ui_widgets.h"
 #include "config.h"
+#include "services/metrics.h"
+
+// Comparison screen columns: rank, name, now, 2h trend, peak, restart
+#define COMPARE_COLUMNS 6
+
+// Diagnostics latency table columns: name, count, p50, p95, max
+#define DIAG_COLUMNS 5
+
+// Task profiler table: name, priority, cpu avg, cpu peak, stack free, heap
+#define TASK_COLUMNS 6
+#define TASK_ROWS    12
 
 /**
  * UI Context - holds all widget pointers for the application
@@ -23,6 +34,9 @@ typedef struct {
     lv_obj_t *screen_add_server;
     lv_obj_t *screen_history;
     lv_obj_t *screen_heatmap;
+    lv_obj_t *screen_compare;
+    lv_obj_t *screen_diagnostics;
+    lv_obj_t *screen_tasks;
     lv_obj_t *screen_screensaver;
 
     // Main screen widgets
@@ -43,6 +57,7 @@ typedef struct {
     lv_obj_t *lbl_rank;
     lv_obj_t *lbl_sd_status;
     lv_obj_t *lbl_cet_time;
+    lv_obj_t *lbl_forecast;
 
     // Settings widgets
     lv_obj_t *kb;           // Keyboard for WiFi settings
@@ -71,6 +86,19 @@ typedef struct {
     lv_obj_t *lbl_y_axis[5];
     lv_obj_t *lbl_x_axis[5];
 
+    // Comparison widgets (one row per server, filled in rank order)
+    lv_obj_t *compare_rows[MAX_SERVERS];
+    lv_obj_t *compare_cells[MAX_SERVERS][COMPARE_COLUMNS];
+
+    // Diagnostics widgets (latency table plus counter/gauge text)
+    lv_obj_t *diag_hist_cells[METRIC_HIST_COUNT][DIAG_COLUMNS];
+    lv_obj_t *lbl_diag_counters;
+    lv_obj_t *lbl_diag_gauges;
+
+    // Task profiler widgets (busiest tasks first)
+    lv_obj_t *task_cells[TASK_ROWS][TASK_COLUMNS];
+    lv_obj_t *lbl_task_footer;
+
     // Multi-server watch widgets
     lv_obj_t *secondary_container;
     secondary_box_widgets_t secondary_boxes[MAX_SECONDARY_SERVERS];
@@ -96,4 +124,25 @@ ui_context_t* ui_context_get(void);
  */
 void ui_context_init(void);
 
+/**
+ * Take the LVGL lock, recording the wait and any timeout in metrics
+ * (release with lvgl_port_unlock)
+ * @param timeout_ms Max wait
+ * @return true if locked
+ */
+bool ui_lock(uint32_t timeout_ms);
+
+/**
+ * Hook display refresh events so fetch cycles can be closed on screen
+ * (no-op when tracing is off)
+ * @param disp Display from app_init_display()
+ */
+void ui_trace_attach(lv_display_t *disp);
+
+/**
+ * Close trace cycle `id` at the end of the next refresh that renders
+ * (call after the UI update for that cycle; 0 is ignored)
+ */
+void ui_trace_frame(uint32_t id);
+
 #endif // UI_CONTEXT_H
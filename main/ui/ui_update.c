@@ -18,6 +18,11 @@
 #include "app_state.h"
 #include "services/wifi_manager.h"
 #include "services/restart_manager.h"
+#include "services/forecast.h"
+#include "services/analytics_cache.h"
+#include "services/time_util.h"
+#include "services/metrics.h"
+#include "services/profiler.h"
 #include "drivers/sd_card.h"
 
 // ============== UI WIDGET ACCESS MACROS ==============
@@ -49,7 +54,11 @@
 #define lbl_rank            (UI_CTX->lbl_rank)
 #define lbl_sd_status       (UI_CTX->lbl_sd_status)
 #define lbl_cet_time        (UI_CTX->lbl_cet_time)
+#define lbl_forecast        (UI_CTX->lbl_forecast)
 #define screen_heatmap      (UI_CTX->screen_heatmap)
+#define screen_compare      (UI_CTX->screen_compare)
+#define screen_diagnostics  (UI_CTX->screen_diagnostics)
+#define screen_tasks        (UI_CTX->screen_tasks)
 
 // Settings widgets
 #define kb                      (UI_CTX->kb)
@@ -141,6 +150,10 @@ static void ui_update_secondary_unlocked(void) {
                 status->valid
             );
 
+            // Countdown learned in the background from this server's own samples
+            ui_update_secondary_box_restart(&secondary_boxes[slot],
+                wifi_manager_is_time_synced() ? restart_get_countdown(srv) : -1);
+
             // Make sure the box is visible
             lv_obj_clear_flag(secondary_boxes[slot].container, LV_OBJ_FLAG_HIDDEN);
 
@@ -166,15 +179,248 @@ static void ui_update_secondary_unlocked(void) {
 
 void ui_update_secondary(void) {
     if (!secondary_container) return;
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
     ui_update_secondary_unlocked();
     lvgl_port_unlock();
 }
 
+// ============== SERVER COMPARISON ==============
+
+// Private helper: fill comparison rows from the analytics cache (LVGL locked)
+// Reads RAM only - the cache is refreshed by the fetch tasks on ingest.
+static void ui_update_compare_unlocked(void) {
+    if (!screen_compare) return;
+
+    app_state_t *state = app_state_get();
+    int order[MAX_SERVERS];
+    int n = analytics_cache_get_ranking(order, MAX_SERVERS);
+
+    time_t now;
+    time(&now);
+    bool synced = wifi_manager_is_time_synced();
+
+    for (int r = 0; r < MAX_SERVERS; r++) {
+        lv_obj_t *row = UI_CTX->compare_rows[r];
+        lv_obj_t **cell = UI_CTX->compare_cells[r];
+        if (!row) continue;
+
+        if (r >= n) {
+            lv_obj_add_flag(row, LV_OBJ_FLAG_HIDDEN);
+            continue;
+        }
+        lv_obj_clear_flag(row, LV_OBJ_FLAG_HIDDEN);
+
+        int idx = order[r];
+        server_config_t *srv = &state->settings.servers[idx];
+        analytics_summary_t s;
+        bool have = analytics_cache_get(idx, &s);
+        char buf[32];
+
+        snprintf(buf, sizeof(buf), "%d", r + 1);
+        lv_label_set_text(cell[0], buf);
+        lv_obj_set_style_text_color(cell[0], COLOR_TEXT_MUTED, 0);
+
+        lv_label_set_text(cell[1], srv->display_name);
+        lv_obj_set_style_text_color(cell[1], idx == state->settings.active_server_index
+                                    ? COLOR_DAYZ_GREEN : COLOR_TEXT_PRIMARY, 0);
+
+        // Current players (muted while showing last-known values from before boot)
+        if (!have) {
+            lv_label_set_text(cell[2], "--");
+            lv_obj_set_style_text_color(cell[2], COLOR_TEXT_MUTED, 0);
+        } else if (!s.online) {
+            lv_label_set_text(cell[2], "offline");
+            lv_obj_set_style_text_color(cell[2], COLOR_DANGER, 0);
+        } else {
+            snprintf(buf, sizeof(buf), "%d/%d", s.players, s.max_players);
+            lv_label_set_text(cell[2], buf);
+            float ratio = s.max_players > 0 ? (float)s.players / s.max_players : 0.0f;
+            lv_obj_set_style_text_color(cell[2], s.stale ? COLOR_TEXT_MUTED
+                                        : ui_get_capacity_color(ratio), 0);
+        }
+
+        // 2h trend
+        if (have && s.has_trend && !s.stale) {
+            snprintf(buf, sizeof(buf), "%+d", s.trend_2h);
+            lv_label_set_text(cell[3], buf);
+            lv_obj_set_style_text_color(cell[3], s.trend_2h > 0 ? COLOR_SUCCESS
+                                        : s.trend_2h < 0 ? COLOR_DANGER : COLOR_TEXT_MUTED, 0);
+        } else {
+            lv_label_set_text(cell[3], "--");
+            lv_obj_set_style_text_color(cell[3], COLOR_TEXT_MUTED, 0);
+        }
+
+        // Forecast peak in the next 24h
+        if (have && s.has_peak && synced && s.peak_ts > (uint32_t)now - 3600) {
+            struct tm peak_tm;
+            time_util_to_tm(s.peak_ts, &peak_tm);
+            snprintf(buf, sizeof(buf), "%d @ %02d:00", s.peak_players, peak_tm.tm_hour);
+            lv_label_set_text(cell[4], buf);
+            lv_obj_set_style_text_color(cell[4], COLOR_TEXT_SECONDARY, 0);
+        } else {
+            lv_label_set_text(cell[4], "--");
+            lv_obj_set_style_text_color(cell[4], COLOR_TEXT_MUTED, 0);
+        }
+
+        // Restart ETA from the prediction made at ingest
+        int eta = -1;
+        if (have && s.next_restart_ts > 0 && synced) {
+            if (s.next_restart_ts > (uint32_t)now) {
+                eta = (int)(s.next_restart_ts - (uint32_t)now);
+            } else if ((uint32_t)now - s.next_restart_ts < RESTART_OVERDUE_GRACE_SEC) {
+                eta = 0;
+            }
+        }
+        if (eta >= 0) {
+            restart_format_countdown(eta, buf, sizeof(buf));
+            lv_label_set_text(cell[5], buf);
+            lv_obj_set_style_text_color(cell[5], ui_get_restart_color(eta), 0);
+        } else {
+            lv_label_set_text(cell[5], "--");
+            lv_obj_set_style_text_color(cell[5], COLOR_TEXT_MUTED, 0);
+        }
+    }
+}
+
+void ui_update_compare(void) {
+    if (app_state_get_current_screen() != SCREEN_COMPARE) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
+    ui_update_compare_unlocked();
+    lvgl_port_unlock();
+}
+
+// ============== DIAGNOSTICS ==============
+
+static void format_us(char *buf, size_t len, uint32_t us) {
+    if (us < 1000) {
+        snprintf(buf, len, "%luus", (unsigned long)us);
+    } else if (us < 1000000) {
+        snprintf(buf, len, "%.1fms", us / 1000.0f);
+    } else {
+        snprintf(buf, len, "%.2fs", us / 1000000.0f);
+    }
+}
+
+// Private helper: fill the diagnostics screen from a metrics snapshot (LVGL locked)
+static void ui_update_diagnostics_unlocked(void) {
+    if (!screen_diagnostics) return;
+
+    // UI task only - snapshot is ~1.6KB
+    static metrics_snapshot_t snap;
+    metrics_snapshot(&snap);
+
+    char buf[24];
+    for (int h = 0; h < METRIC_HIST_COUNT; h++) {
+        const metrics_hist_snapshot_t *hs = &snap.hist[h];
+        lv_obj_t **cell = UI_CTX->diag_hist_cells[h];
+
+        snprintf(buf, sizeof(buf), "%lu", (unsigned long)hs->count);
+        lv_label_set_text(cell[1], buf);
+        if (hs->count == 0) {
+            lv_label_set_text(cell[2], "-");
+            lv_label_set_text(cell[3], "-");
+            lv_label_set_text(cell[4], "-");
+            continue;
+        }
+        format_us(buf, sizeof(buf), metrics_hist_percentile(hs, 50));
+        lv_label_set_text(cell[2], buf);
+        format_us(buf, sizeof(buf), metrics_hist_percentile(hs, 95));
+        lv_label_set_text(cell[3], buf);
+        format_us(buf, sizeof(buf), hs->max_us);
+        lv_label_set_text(cell[4], buf);
+    }
+
+    char text[320];
+    int len = 0;
+    for (int i = 0; i < METRIC_COUNTER_COUNT && len < (int)sizeof(text); i++) {
+        len += snprintf(text + len, sizeof(text) - len, "%s%s: %lu", i ? "\n" : "",
+                        metrics_counter_name((metric_counter_t)i), (unsigned long)snap.counters[i]);
+    }
+    lv_label_set_text(UI_CTX->lbl_diag_counters, text);
+
+    snprintf(text, sizeof(text),
+             "Uptime %luh%02lum   Events %ld queued, peak %ld\n"
+             "Heap %ldK free, %ldK min, %ldK block   PSRAM %ldK free, %ldK min\n"
+             "Arenas: bulk %ldK, scratch %ldK, dma %ldK in use",
+             (unsigned long)(snap.uptime_s / 3600), (unsigned long)(snap.uptime_s / 60 % 60),
+             (long)snap.gauges[METRIC_G_EVENT_QUEUE_DEPTH], (long)snap.gauges[METRIC_G_EVENT_QUEUE_PEAK],
+             (long)snap.gauges[METRIC_G_HEAP_INTERNAL_FREE] / 1024,
+             (long)snap.gauges[METRIC_G_HEAP_INTERNAL_MIN] / 1024,
+             (long)snap.gauges[METRIC_G_HEAP_INTERNAL_LARGEST] / 1024,
+             (long)snap.gauges[METRIC_G_PSRAM_FREE] / 1024,
+             (long)snap.gauges[METRIC_G_PSRAM_MIN] / 1024,
+             (long)snap.gauges[METRIC_G_ARENA_BULK] / 1024,
+             (long)snap.gauges[METRIC_G_ARENA_SCRATCH] / 1024,
+             (long)snap.gauges[METRIC_G_ARENA_DMA] / 1024);
+    lv_label_set_text(UI_CTX->lbl_diag_gauges, text);
+}
+
+void ui_update_diagnostics(void) {
+    if (app_state_get_current_screen() != SCREEN_DIAGNOSTICS) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
+    ui_update_diagnostics_unlocked();
+    lvgl_port_unlock();
+}
+
+// Private helper: fill the task table from the profiler window (LVGL locked)
+static void ui_update_tasks_unlocked(void) {
+    if (!screen_tasks) return;
+
+    static profiler_task_summary_t tasks[TASK_ROWS];
+    uint32_t window_sec = 0;
+    int n = profiler_get_summary(tasks, TASK_ROWS, &window_sec);
+
+    char buf[24];
+    for (int r = 0; r < TASK_ROWS; r++) {
+        lv_obj_t **cell = UI_CTX->task_cells[r];
+        if (r >= n) {
+            for (int c = 0; c < TASK_COLUMNS; c++) lv_label_set_text(cell[c], "");
+            continue;
+        }
+        const profiler_task_summary_t *t = &tasks[r];
+
+        lv_label_set_text(cell[0], t->name);
+        snprintf(buf, sizeof(buf), "%u", t->priority);
+        lv_label_set_text(cell[1], buf);
+        snprintf(buf, sizeof(buf), "%u.%u%%", t->cpu_avg_permille / 10, t->cpu_avg_permille % 10);
+        lv_label_set_text(cell[2], buf);
+        snprintf(buf, sizeof(buf), "%u.%u%%", t->cpu_peak_permille / 10, t->cpu_peak_permille % 10);
+        lv_label_set_text(cell[3], buf);
+        snprintf(buf, sizeof(buf), "%lu B", (unsigned long)t->stack_free_min);
+        lv_label_set_text(cell[4], buf);
+        // Stack headroom under 512 bytes is worth a look
+        lv_obj_set_style_text_color(cell[4], t->stack_free_min < 512 ? COLOR_WARNING : COLOR_TEXT_PRIMARY, 0);
+        if (t->heap_internal < 0) {
+            lv_label_set_text(cell[5], "-");
+        } else {
+            snprintf(buf, sizeof(buf), "%ldK / %ldK", (long)t->heap_internal / 1024, (long)t->heap_psram / 1024);
+            lv_label_set_text(cell[5], buf);
+        }
+    }
+
+    if (!profiler_is_enabled()) {
+        lv_label_set_text(UI_CTX->lbl_task_footer, "Profiler disabled - enable FreeRTOS run time stats");
+    } else if (n == 0) {
+        lv_label_set_text(UI_CTX->lbl_task_footer, "Collecting first samples...");
+    } else {
+        char text[96];
+        snprintf(text, sizeof(text), "Last %lu min, min stack free, heap internal / PSRAM, 100%% = one core",
+                 (unsigned long)((window_sec + 59) / 60));
+        lv_label_set_text(UI_CTX->lbl_task_footer, text);
+    }
+}
+
+void ui_update_tasks(void) {
+    if (app_state_get_current_screen() != SCREEN_TASKS) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
+    ui_update_tasks_unlocked();
+    lvgl_port_unlock();
+}
+
 // ============== SCREEN NAVIGATION ==============
 
 void ui_switch_screen(screen_id_t screen) {
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
 
     // Delete old screens to free memory (except main)
     if (screen != SCREEN_SETTINGS && screen_settings) {
@@ -215,6 +461,25 @@ void ui_switch_screen(screen_id_t screen) {
         lv_obj_delete(screen_heatmap);
         screen_heatmap = NULL;
     }
+    if (screen != SCREEN_COMPARE && screen_compare) {
+        lv_obj_delete(screen_compare);
+        screen_compare = NULL;
+        memset(UI_CTX->compare_rows, 0, sizeof(UI_CTX->compare_rows));
+        memset(UI_CTX->compare_cells, 0, sizeof(UI_CTX->compare_cells));
+    }
+    if (screen != SCREEN_DIAGNOSTICS && screen_diagnostics) {
+        lv_obj_delete(screen_diagnostics);
+        screen_diagnostics = NULL;
+        memset(UI_CTX->diag_hist_cells, 0, sizeof(UI_CTX->diag_hist_cells));
+        UI_CTX->lbl_diag_counters = NULL;
+        UI_CTX->lbl_diag_gauges = NULL;
+    }
+    if (screen != SCREEN_TASKS && screen_tasks) {
+        lv_obj_delete(screen_tasks);
+        screen_tasks = NULL;
+        memset(UI_CTX->task_cells, 0, sizeof(UI_CTX->task_cells));
+        UI_CTX->lbl_task_footer = NULL;
+    }
 
     app_state_set_current_screen(screen);
 
@@ -250,6 +515,21 @@ void ui_switch_screen(screen_id_t screen) {
             // Defer heavy heatmap calculation to avoid watchdog timeout
             // Will be refreshed on next timer tick or can be triggered manually
             break;
+        case SCREEN_COMPARE:
+            screen_builder_create_compare();
+            ui_update_compare_unlocked();
+            lv_screen_load(screen_compare);
+            break;
+        case SCREEN_DIAGNOSTICS:
+            screen_builder_create_diagnostics();
+            ui_update_diagnostics_unlocked();
+            lv_screen_load(screen_diagnostics);
+            break;
+        case SCREEN_TASKS:
+            screen_builder_create_tasks();
+            ui_update_tasks_unlocked();
+            lv_screen_load(screen_tasks);
+            break;
         default:
             break;
     }
@@ -386,11 +666,27 @@ static void ui_update_main_unlocked(void) {
         lv_label_set_text(lbl_update, buf);
     }
 
-    // Last restart time (show CET time)
+    // Restart: predicted countdown when known, otherwise last restart (local time)
     if (srv && lbl_restart) {
         int time_since = restart_get_time_since_last(srv);
+        int countdown = wifi_manager_is_time_synced() ? restart_get_countdown(srv) : -1;
 
-        if (time_since >= 0 && wifi_manager_is_time_synced()) {
+        if (countdown >= 0) {
+            char restart_buf[64];
+            char cd_str[24];
+            char time_str[16];
+            restart_format_countdown(countdown, cd_str, sizeof(cd_str));
+            restart_format_last_time(srv, time_str, sizeof(time_str));
+            if (time_str[0] != '\0') {
+                snprintf(restart_buf, sizeof(restart_buf), "Restart %s (%d%%) | last %s",
+                         cd_str, restart_get_confidence(srv), time_str);
+            } else {
+                snprintf(restart_buf, sizeof(restart_buf), "Restart %s (%d%%)",
+                         cd_str, restart_get_confidence(srv));
+            }
+            lv_label_set_text(lbl_restart, restart_buf);
+            lv_obj_set_style_text_color(lbl_restart, ui_get_restart_color(countdown), 0);
+        } else if (time_since >= 0 && wifi_manager_is_time_synced()) {
             char restart_buf[64];
             char time_str[16];
             char ago_str[32];
@@ -419,24 +715,46 @@ static void ui_update_main_unlocked(void) {
         }
     }
 
-    // CET time display
+    // Forecast line
+    if (lbl_forecast) {
+        forecast_summary_t fc;
+        int max_p = state->runtime.max_players;
+        if (wifi_manager_is_time_synced() &&
+            forecast_get_summary(state->settings.active_server_index, max_p, &fc)) {
+            char fc_buf[96];
+            int len = snprintf(fc_buf, sizeof(fc_buf), "Next 1h: ~%d  3h: ~%d",
+                               fc.expected_1h, fc.expected_3h);
+            if (fc.has_best_join && len > 0 && len < (int)sizeof(fc_buf)) {
+                struct tm join_tm;
+                time_util_to_tm(fc.best_join_ts, &join_tm);
+                snprintf(fc_buf + len, sizeof(fc_buf) - len, " | Best join %02d:00 (~%d)",
+                         join_tm.tm_hour, fc.best_join_players);
+            }
+            lv_label_set_text(lbl_forecast, fc_buf);
+        } else {
+            lv_label_set_text(lbl_forecast, "");
+        }
+    }
+
+    // Local time display with the zone in effect (CET/CEST)
     if (lbl_cet_time && wifi_manager_is_time_synced()) {
         time_t now;
         time(&now);
         struct tm tm_buf;
-        localtime_r(&now, &tm_buf);
+        time_util_to_tm((uint32_t)now, &tm_buf);
         char time_buf[16];
-        snprintf(time_buf, sizeof(time_buf), "%02d:%02d CET", tm_buf.tm_hour, tm_buf.tm_min);
+        snprintf(time_buf, sizeof(time_buf), "%02d:%02d %.5s", tm_buf.tm_hour, tm_buf.tm_min,
+                 time_util_zone_abbr((uint32_t)now));
         lv_label_set_text(lbl_cet_time, time_buf);
     } else if (lbl_cet_time) {
-        lv_label_set_text(lbl_cet_time, "--:-- CET");
+        lv_label_set_text(lbl_cet_time, "--:--");
     }
 
 }
 
 void ui_update_main(void) {
     if (app_state_get_current_screen() != SCREEN_MAIN) return;
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
     ui_update_main_unlocked();
     lvgl_port_unlock();
 }
@@ -468,14 +786,14 @@ static void ui_update_sd_status_unlocked(void) {
 
 void ui_update_sd_status(void) {
     if (!lbl_sd_status) return;
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
     ui_update_sd_status_unlocked();
     lvgl_port_unlock();
 }
 
 void ui_update_all(void) {
     if (app_state_get_current_screen() != SCREEN_MAIN) return;
-    if (!lvgl_port_lock(UI_LOCK_TIMEOUT_MS)) return;
+    if (!ui_lock(UI_LOCK_TIMEOUT_MS)) return;
     ui_update_main_unlocked();
     ui_update_secondary_unlocked();
     ui_update_sd_status_unlocked();
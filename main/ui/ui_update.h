@@ -23,6 +23,21 @@ void ui_switch_screen(screen_id_t screen);
  */
 void ui_update_main(void);
 
+/**
+ * Refresh the server comparison screen (no-op on other screens)
+ */
+void ui_update_compare(void);
+
+/**
+ * Refresh the diagnostics screen from a metrics snapshot (no-op on other screens)
+ */
+void ui_update_diagnostics(void);
+
+/**
+ * Refresh the task profiler screen (no-op on other screens)
+ */
+void ui_update_tasks(void);
+
 /**
  * Update SD card status indicator
  */
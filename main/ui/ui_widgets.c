@@ -334,6 +334,13 @@ secondary_box_widgets_t ui_create_secondary_box(lv_obj_t *parent, int width, int
     lv_obj_set_style_text_color(widgets.lbl_trend, COLOR_TEXT_SECONDARY, 0);
     lv_obj_align(widgets.lbl_trend, LV_ALIGN_BOTTOM_RIGHT, 0, 0);
 
+    // Restart countdown (right, under server time)
+    widgets.lbl_restart = lv_label_create(widgets.container);
+    lv_label_set_text(widgets.lbl_restart, "");
+    lv_obj_set_style_text_font(widgets.lbl_restart, &lv_font_montserrat_14, 0);
+    lv_obj_set_style_text_color(widgets.lbl_restart, COLOR_TEXT_MUTED, 0);
+    lv_obj_align(widgets.lbl_restart, LV_ALIGN_RIGHT_MID, 0, 10);
+
     return widgets;
 }
 
@@ -456,3 +463,24 @@ void ui_update_secondary_box(secondary_box_widgets_t *widgets, const char *name,
         lv_obj_set_style_border_opa(widgets->container, LV_OPA_100, 0);
     }
 }
+
+void ui_update_secondary_box_restart(secondary_box_widgets_t *widgets, int countdown_sec) {
+    if (!widgets || !widgets->lbl_restart) return;
+
+    if (countdown_sec < 0) {
+        lv_label_set_text(widgets->lbl_restart, "");
+        return;
+    }
+
+    char buf[24];
+    if (countdown_sec == 0) {
+        snprintf(buf, sizeof(buf), LV_SYMBOL_REFRESH " now");
+    } else if (countdown_sec >= 3600) {
+        snprintf(buf, sizeof(buf), LV_SYMBOL_REFRESH " %dh%02dm",
+                 countdown_sec / 3600, (countdown_sec % 3600) / 60);
+    } else {
+        snprintf(buf, sizeof(buf), LV_SYMBOL_REFRESH " %dm", countdown_sec / 60);
+    }
+    lv_label_set_text(widgets->lbl_restart, buf);
+    lv_obj_set_style_text_color(widgets->lbl_restart, ui_get_restart_color(countdown_sec), 0);
+}
@@ -257,6 +257,7 @@ typedef struct {
     lv_obj_t *lbl_time;             // Server time label
     lv_obj_t *lbl_trend;            // Trend label (e.g., "+12" or "-5")
     lv_obj_t *day_night_indicator;  // Day/night icon
+    lv_obj_t *lbl_restart;          // Predicted restart countdown
 } secondary_box_widgets_t;
 
 /**
@@ -299,4 +300,11 @@ void ui_update_secondary_box(secondary_box_widgets_t *widgets, const char *name,
                               const char *server_time, bool is_daytime,
                               int trend_delta, bool valid);
 
+/**
+ * Update the restart countdown of a secondary box
+ * @param widgets Widgets to update
+ * @param countdown_sec Seconds until restart, 0 if imminent, -1 to hide
+ */
+void ui_update_secondary_box_restart(secondary_box_widgets_t *widgets, int countdown_sec);
+
 #endif // UI_WIDGETS_H